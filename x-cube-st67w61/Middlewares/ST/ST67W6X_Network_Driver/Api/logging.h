@@ -60,9 +60,68 @@ extern "C" {
 
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
+#include <stdarg.h>
 #include "logging_config.h"
 #include "logging_levels.h"
 
+/* Exported types ------------------------------------------------------------*/
+/** @defgroup ST67W6X_Utilities_Logging_Types ST67W6X Utility Logging Types
+  * @ingroup  ST67W6X_Utilities_Logging
+  * @{
+  */
+
+/**
+  * @brief  Log transport statistics
+  */
+typedef struct
+{
+  uint32_t ring_size;                       /*!< Size of the ring buffer, in bytes */
+  uint32_t high_water;                      /*!< Max number of bytes used in the ring buffer */
+  uint32_t messages;                        /*!< Number of messages posted */
+  uint32_t dropped_messages;                /*!< Number of messages dropped, ring buffer full */
+  uint32_t dropped_bytes;                   /*!< Number of bytes dropped, ring buffer full */
+} LogStats_t;
+
+/** @} */
+
+/* Exported constants --------------------------------------------------------*/
+/** @defgroup ST67W6X_Utilities_Logging_Constants ST67W6X Utility Logging Constants
+  * @ingroup  ST67W6X_Utilities_Logging
+  * @{
+  */
+
+/** System module, SYS_LOG_xxx */
+#define LOG_MODULE_SYS        0U
+
+/** Wi-Fi module, WIFI_LOG_xxx */
+#define LOG_MODULE_WIFI       1U
+
+/** BLE module, BLE_LOG_xxx */
+#define LOG_MODULE_BLE        2U
+
+/** Network module, NET_LOG_xxx */
+#define LOG_MODULE_NET        3U
+
+/** MQTT module, MQTT_LOG_xxx */
+#define LOG_MODULE_MQTT       4U
+
+/** Number of log modules */
+#define LOG_MODULE_COUNT      5U
+
+/** @} */
+
+/* Exported variables --------------------------------------------------------*/
+/** @defgroup ST67W6X_Utilities_Logging_Variables ST67W6X Utility Logging Variables
+  * @ingroup  ST67W6X_Utilities_Logging
+  * @{
+  */
+
+/** Runtime module masks, one per log level: bit LOG_MODULE_xxx is set when the module logs at that level.
+  * Use vLoggingSetModuleLevel to update it */
+extern volatile uint32_t ulLoggingModuleMask[LOG_DEBUG + 1];
+
+/** @} */
+
 /* Exported macros -----------------------------------------------------------*/
 /** @defgroup ST67W6X_Utilities_Logging_Macros ST67W6X Utility Logging Macros
   * @ingroup  ST67W6X_Utilities_Logging
@@ -164,6 +223,54 @@ extern "C" {
 #endif /* ( LOG_LEVEL >= LOG_DEBUG ) */
 #endif /* LOG_LEVEL */
 
+/**
+  * \def LogModuleEnabled( module, level )
+  * Check the runtime mask of a module for a log level.
+  */
+#define LogModuleEnabled( module, level )  ( ( ulLoggingModuleMask[ ( level ) ] & ( 1UL << ( module ) ) ) != 0U )
+
+/**
+  * \def LogModuleError( module, ... )
+  * Send a message of a module to the log with level ::LOG_ERROR.
+  * The arguments are not evaluated when the module is masked at runtime.
+  * The compile-time threshold is checked by the module macros, e.g. NET_LOG_ERROR.
+  */
+#define LogModuleError( module, ... ) \
+  do { if ( LogModuleEnabled( module, LOG_ERROR ) ) { \
+      ( void )vLoggingPrintf( LOG_ERROR, 1, __LINE__, __FILE_NAME__, REMOVE_PARENS( __VA_ARGS__ ) ); } } while ( 0 )
+
+/**
+  * \def LogModuleErrorEx( module, line, file, ... )
+  * Send a message of a module with line number and file name to the log with level ::LOG_ERROR.
+  */
+#define LogModuleErrorEx( module, line, file, ... ) \
+  do { if ( LogModuleEnabled( module, LOG_ERROR ) ) { \
+      ( void )vLoggingPrintf( LOG_ERROR, 1, line, file, REMOVE_PARENS( __VA_ARGS__ ) ); } } while ( 0 )
+
+/**
+  * \def LogModuleWarn( module, ... )
+  * Send a message of a module to the log with level ::LOG_WARN.
+  */
+#define LogModuleWarn( module, ... ) \
+  do { if ( LogModuleEnabled( module, LOG_WARN ) ) { \
+      ( void )vLoggingPrintf( LOG_WARN, 1, __LINE__, __FILE_NAME__, REMOVE_PARENS( __VA_ARGS__ ) ); } } while ( 0 )
+
+/**
+  * \def LogModuleInfo( module, ... )
+  * Send a message of a module to the log with level ::LOG_INFO.
+  */
+#define LogModuleInfo( module, ... ) \
+  do { if ( LogModuleEnabled( module, LOG_INFO ) ) { \
+      ( void )vLoggingPrintf( LOG_INFO, 0, 0, NULL, REMOVE_PARENS( __VA_ARGS__ ) ); } } while ( 0 )
+
+/**
+  * \def LogModuleDebug( module, ... )
+  * Send a message of a module to the log with level ::LOG_DEBUG.
+  */
+#define LogModuleDebug( module, ... ) \
+  do { if ( LogModuleEnabled( module, LOG_DEBUG ) ) { \
+      ( void )vLoggingPrintf( LOG_DEBUG, 0, 0, NULL, REMOVE_PARENS( __VA_ARGS__ ) ); } } while ( 0 )
+
 /** @} */
 
 /* Exported functions ------------------------------------------------------- */
@@ -187,7 +294,7 @@ extern "C" {
   *                        is automatically generated by the log macros.
   * @param  p_format       printf like format string
   * @return -1 in case of error,
-  *         0 or above: amount of data posted in the queue (0 in allocation)
+  *         0 or above: amount of data posted in the ring buffer (0 if the ring buffer is full)
   */
 int32_t vLoggingPrintf(uint32_t logLevel,
                        const uint8_t metadata_print,
@@ -196,6 +303,16 @@ int32_t vLoggingPrintf(uint32_t logLevel,
                        const char *const p_format,
                        ...);
 
+/**
+  * @brief  Post a message in the log, without level filtering nor metadata, e.g. the shell output
+  * @param  max_len        specifies the max length of the message, '\0' included
+  * @param  p_format       printf like format string
+  * @param  args           arguments of the format string
+  * @return -1 in case of error,
+  *         0 or above: amount of data posted in the ring buffer (0 if the ring buffer is full)
+  */
+int32_t vLoggingVPrintf(uint32_t max_len, const char *const p_format, va_list args);
+
 /**
   * @brief  Initialize the logging service
   * @param  LogOutput [IN] specifies the callback to output the message. \
@@ -204,6 +321,25 @@ int32_t vLoggingPrintf(uint32_t logLevel,
   */
 void *vLoggingInit(void (*LogOutput)(const char *message));
 
+/**
+  * @brief  Get the log transport statistics
+  * @param  p_stats [OUT] statistics structure to fill
+  */
+void vLoggingGetStats(LogStats_t *p_stats);
+
+/**
+  * @brief  Reset the dropped counters and the high-water mark of the log transport
+  */
+void vLoggingResetStats(void);
+
+/**
+  * @brief  Measure the cost of vLoggingPrintf for the caller, in immediate and deferred modes.
+  *         The messages are discarded and the results printed with LogInfo
+  * @param  count [IN] number of messages logged in each mode
+  * @param  get_cycle [IN] function returning the CPU cycle counter
+  */
+void vLoggingBenchmark(uint32_t count, uint32_t (*get_cycle)(void));
+
 /**
   * @brief  Reset the logging service
   */
@@ -215,6 +351,21 @@ void vLoggingDeInit(void);
   */
 void vLoggingSetVerbosity(uint32_t logLevel);
 
+/**
+  * @brief  Set the runtime level of a module. The messages above the compile-time threshold of the module
+  *         are not compiled in and cannot be enabled
+  * @param  module [IN] the module, LOG_MODULE_xxx
+  * @param  logLevel [IN] the maximum log level to be printed for the module
+  */
+void vLoggingSetModuleLevel(uint32_t module, uint32_t logLevel);
+
+/**
+  * @brief  Get the runtime level of a module
+  * @param  module [IN] the module, LOG_MODULE_xxx
+  * @return the maximum log level printed for the module
+  */
+uint32_t vLoggingGetModuleLevel(uint32_t module);
+
 /** @} */
 
 #ifdef __cplusplus
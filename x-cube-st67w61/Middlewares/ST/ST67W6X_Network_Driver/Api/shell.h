@@ -296,8 +296,8 @@ struct shell
 
 /**
   * @brief  Initialize the shell based on FreeRTOS. It creates a task that read the input chars from the uart and parse
-  *         the input using the upper layer shell API. The output of the shell is sent to the stream buffer ::tx_stream.
-  * @param  xLogQueue [IN] specifies the queue where to send all the output produced by the shell
+  *         the input using the upper layer shell API. The output of the shell is posted in the log ring buffer.
+  * @param  xLogQueue [IN] specifies the logging service returned by vLoggingInit, NULL to output with printf
   */
 void shell_freertos_init(void *xLogQueue);
 
@@ -727,13 +727,38 @@ int32_t W6X_Net_Accept(int32_t sock, struct sockaddr *addr, socklen_t *addrlen);
   */
 ssize_t W6X_Net_Send(int32_t sock, const void *buf, size_t len, int32_t flags);
 
+/**
+  * @brief  Send the writes coalesced on a socket
+  * @param  sock: Socket ID to flush
+  * @return 0 on success, or -1 on error, also when a previous delayed send of the socket failed
+  */
+int32_t W6X_Net_Flush(int32_t sock);
+
+/**
+  * @brief  Get the socket read statistics
+  * @param  Reads: Number of W6X_Net_Recv() calls that returned data
+  * @param  Hits: Number of them served by the read-ahead buffer
+  * @param  Pulls: Number of AT pulls of socket data
+  * @return Operation status
+  */
+W6X_Status_t W6X_Net_GetReadStats(uint32_t *Reads, uint32_t *Hits, uint32_t *Pulls);
+
+/**
+  * @brief  Get the write coalescing statistics
+  * @param  Writes: Number of writes coalesced
+  * @param  Transactions: Number of AT+CIPSEND transactions used to send them
+  * @return Operation status
+  */
+W6X_Status_t W6X_Net_GetCoalesceStats(uint32_t *Writes, uint32_t *Transactions);
+
 /**
   * @brief  Receive data from a socket
   * @param  sock: Socket ID to receive on
   * @param  buf: Buffer to receive into
   * @param  max_len: Maximum length of the buffer
-  * @param  flags: Flags to use
-  * @return Number of bytes received, or -1 on error
+  * @param  flags: MSG_PEEK to keep the data for the next read, MSG_DONTWAIT to not wait for data
+  * @return Number of bytes received, W6X_NET_EAGAIN if no data is available on a non-blocking call,
+  *         or -1 on error
   */
 ssize_t W6X_Net_Recv(int32_t sock, void *buf, size_t max_len, int32_t flags);
 
@@ -755,14 +780,39 @@ ssize_t W6X_Net_Sendto(int32_t sock, const void *buf, size_t len, int32_t flags,
   * @param  sock: Socket ID to receive on
   * @param  buf: Buffer to receive into
   * @param  max_len: Maximum length of the buffer
-  * @param  flags: Flags to use
+  * @param  flags: MSG_DONTWAIT to not wait for data, MSG_PEEK on a connected socket
   * @param  src_addr: Address to receive from
   * @param  addrlen: Length of the address
-  * @return Number of bytes received, or -1 on error
+  * @return Number of bytes received, W6X_NET_EAGAIN if no data is available on a non-blocking call,
+  *         or -1 on error
   */
 ssize_t W6X_Net_Recvfrom(int32_t sock, void *buf, size_t max_len, int32_t flags, struct sockaddr *src_addr,
                          socklen_t *addrlen);
 
+#if (ST67_ARCH == W6X_ARCH_T01)
+/**
+  * @brief  Wait until one of the sockets is ready
+  * @param  fds: Sockets and events to wait for, revents filled on return
+  * @param  nfds: Number of entries in fds
+  * @param  timeout_ms: Maximum time to wait, 0 to return immediately, -1 to wait forever
+  * @return Number of sockets with returned events, 0 on timeout or right away when all the entries are
+  *         ignored (negative fd), or -1 on error
+  */
+int32_t W6X_Net_Poll(W6X_Net_Pollfd_t *fds, uint32_t nfds, int32_t timeout_ms);
+
+/**
+  * @brief  Wait until one of the sockets is ready, sets are updated with the ready sockets
+  * @param  nfds: Highest socket ID in the sets plus one
+  * @param  readfds: Sockets to check for reading, or NULL
+  * @param  writefds: Sockets to check for writing, or NULL
+  * @param  exceptfds: Sockets to check for errors, or NULL
+  * @param  timeout_ms: Maximum time to wait, 0 to return immediately, -1 to wait forever
+  * @return Number of ready sockets, 0 on timeout, or -1 on error
+  */
+int32_t W6X_Net_Select(int32_t nfds, W6X_Net_Fdset_t *readfds, W6X_Net_Fdset_t *writefds,
+                       W6X_Net_Fdset_t *exceptfds, int32_t timeout_ms);
+#endif /* ST67_ARCH */
+
 /**
   * @brief  Get a socket option
   * @param  sock: Socket ID to get the option from
@@ -891,6 +941,65 @@ W6X_Status_t W6X_HTTP_Client_Request(const ip_addr_t *server_addr, uint16_t port
                                      void *callback_arg, W6X_HTTP_headers_done_cb_t headers_done_fn,
                                      W6X_HTTP_data_cb_t data_fn, const W6X_HTTP_connection_t *settings);
 
+/**
+  * @brief  Get a connection to an HTTP server from the connection pool.
+  *         An idle connection to the same server, port and server name is reused, else a new one is opened.
+  * @param  server_addr: Server address
+  * @param  port: Server port, 443 for HTTPS
+  * @param  settings: Settings to use for the HTTP requests. The certificate strings must remain valid
+  *         until the connection is released since the connection may be opened again
+  * @return Connection handle, NULL if no connection could be opened
+  */
+W6X_HTTP_Client_t *W6X_HTTP_Client_Open(const ip_addr_t *server_addr, uint16_t port,
+                                        const W6X_HTTP_connection_t *settings);
+
+/**
+  * @brief  Send an HTTP request on a connection without waiting for its response.
+  *         Up to W6X_HTTP_CLIENT_PIPELINE_DEPTH requests can be sent before reading their responses,
+  *         once a response of the server kept the connection open (HTTP/1.1 keep-alive).
+  *         The connection is opened again if the server closed it after the previous response.
+  * @param  client: Connection handle
+  * @param  method: HTTP method to use, "GET", "HEAD", "POST" or "PUT"
+  * @param  uri: URI to request
+  * @param  post_data: Data to post, NULL if none
+  * @param  post_data_len: Length of the data to post
+  * @return Operation status, W6X_STATUS_BUSY if a request is pending and the connection is not yet known
+  *         to be kept open: read its response first
+  */
+W6X_Status_t W6X_HTTP_Client_Send(W6X_HTTP_Client_t *client, const char *method, const char *uri,
+                                  const W6X_HTTP_Post_Data_t *post_data, size_t post_data_len);
+
+/**
+  * @brief  Read the response of the oldest request sent on a connection.
+  *         The header and the body are passed to the callbacks of the connection settings.
+  * @param  client: Connection handle
+  * @param  http_status: HTTP status code of the response, can be NULL
+  * @return Operation status
+  */
+W6X_Status_t W6X_HTTP_Client_Receive(W6X_HTTP_Client_t *client, W6X_HTTP_Status_Code_e *http_status);
+
+/**
+  * @brief  Give a connection back to the pool, where it stays open for the next W6X_HTTP_Client_Open.
+  *         A connection with unread responses is closed.
+  * @param  client: Connection handle
+  * @return Operation status
+  */
+W6X_Status_t W6X_HTTP_Client_Release(W6X_HTTP_Client_t *client);
+
+/**
+  * @brief  Close the idle connections of the pool
+  * @return Operation status
+  */
+W6X_Status_t W6X_HTTP_Client_FlushPool(void);
+
+/**
+  * @brief  Get the HTTP client connection statistics
+  * @param  Connects: Number of connections opened to a server
+  * @param  Requests: Number of requests sent
+  * @return Operation status
+  */
+W6X_Status_t W6X_HTTP_Client_GetPoolStats(uint32_t *Connects, uint32_t *Requests);
+
 /** @} */
 
 /* ===================================================================== */
@@ -912,13 +1021,22 @@ W6X_Status_t W6X_MQTT_Init(W6X_MQTT_Data_t *p_mqtt_config);
 void W6X_MQTT_DeInit(void);
 
 /**
-  * @brief  Set/change the pointer where to copy the Recv Data
+  * @brief  Set/change the pointer where to copy the Recv Data and the delivery mode of the received messages
   * @param  p_mqtt_config: MQTT Received data configuration
   * @return Operation status
   * @note   This function shall only be called when executing the callback (never on applicative task)
   */
 W6X_Status_t W6X_MQTT_SetRecvDataPtr(W6X_MQTT_Data_t *p_mqtt_config);
 
+/**
+  * @brief  Release a received message once the application is done with it
+  * @param  Data: Message given by the W6X_MQTT_EVT_SUBSCRIPTION_RECEIVED_ID event
+  * @return Operation status
+  * @note   The topic and message of a message lent in zero-copy mode stay valid until this call,
+  *         those of a copied message only until the next one is received. Can be called from any task.
+  */
+W6X_Status_t W6X_MQTT_Release(W6X_MQTT_CbParamData_t *Data);
+
 /**
   * @brief  MQTT Set user configuration
   * @param  Config: MQTT configuration
@@ -1455,6 +1573,23 @@ void W6X_Netif_DeInit(void);
   */
 int32_t W6X_Netif_output(uint32_t link_id, uint8_t *pBuf, uint32_t len);
 
+/**
+  * @brief  Send a frame made of several segments on the Network Interface
+  * @param  link_id: Link ID of the network interface
+  * @param  segments: Array of segments composing the frame
+  * @param  count: Number of segments
+  * @param  headroom: Writable bytes available in front of the first segment
+  * @param  release_fn: Function called once the driver no longer references the segments, can be NULL
+  * @param  arg: Argument passed to release_fn
+  * @return Number of bytes queued, negative value otherwise
+  * @note   A single 4-byte aligned segment with at least W6X_NETIF_HEADROOM bytes of headroom
+  *         and a release_fn is sent without copy. It must stay valid until release_fn is called
+  *         from the SPI transfer task. Otherwise the segments are gathered into a single message
+  *         and release_fn is called before returning. release_fn is not called on error.
+  */
+int32_t W6X_Netif_output_vec(uint32_t link_id, const W6X_Netif_Segment_t *segments, uint32_t count,
+                             uint32_t headroom, W6X_Netif_release_func_t release_fn, void *arg);
+
 /**
   * @brief  Read data from the Network Interface
   * @param  link_id: Link ID of the network interface
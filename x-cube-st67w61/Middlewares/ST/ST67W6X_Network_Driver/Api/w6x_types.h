@@ -249,6 +249,32 @@ typedef enum
 #define SO_RCVBUF         0x1002        /*!< Receive buffer size */
 #define SO_SNDTIMEO       0x1005        /*!< Send timeout */
 #define SO_RCVTIMEO       0x1006        /*!< Receive timeout */
+#define SO_RCVMODE        0x4001        /*!< Receive mode, W6X_NET_RECV_LATENCY or W6X_NET_RECV_THROUGHPUT */
+#define SO_NONBLOCK       0x4002        /*!< Non-blocking mode, 0 or 1 */
+
+/* Send and receive flags */
+#define MSG_PEEK          0x01          /*!< Return the data without removing it from the socket */
+#define MSG_DONTWAIT      0x08          /*!< Non-blocking operation for this call only */
+
+/** Return value of the socket functions when the operation would block */
+#define W6X_NET_EAGAIN    (-2)
+
+/* SO_RCVMODE values */
+#define W6X_NET_RECV_LATENCY     0      /*!< Pull the data as soon as it is notified */
+#define W6X_NET_RECV_THROUGHPUT  1      /*!< Gather the data notifications before pulling larger chunks */
+
+/* W6X_Net_Poll events */
+#define W6X_NET_POLLIN    0x01          /*!< Data to read, or connection to accept on a listening socket */
+#define W6X_NET_POLLOUT   0x04          /*!< Data can be sent */
+#define W6X_NET_POLLERR   0x08          /*!< Error condition, always reported */
+#define W6X_NET_POLLHUP   0x10          /*!< Connection closed by the peer, always reported */
+#define W6X_NET_POLLNVAL  0x20          /*!< Invalid socket, always reported */
+
+/* W6X_Net_Select socket sets */
+#define W6X_NET_FD_ZERO(set)      (*(set) = 0U)                                 /*!< Clear a socket set */
+#define W6X_NET_FD_SET(fd, set)   (*(set) |= (1UL << (uint32_t)(fd)))           /*!< Add a socket to a set */
+#define W6X_NET_FD_CLR(fd, set)   (*(set) &= ~(1UL << (uint32_t)(fd)))          /*!< Remove a socket from a set */
+#define W6X_NET_FD_ISSET(fd, set) ((*(set) & (1UL << (uint32_t)(fd))) != 0U)    /*!< Check a socket in a set */
 #endif /* ST67_ARCH */
 
 #define TLS_SEC_TAG_LIST  1             /*!< Security tag list */
@@ -1136,6 +1162,21 @@ struct sockaddr_storage
   uint32_t    s2_data3[3];                /*!< Reserved */
 #endif /* NET_IPV6 */
 };
+
+/**
+  * @brief  Socket polled by W6X_Net_Poll
+  */
+typedef struct
+{
+  int32_t fd;                             /*!< Socket ID, ignored if negative */
+  int16_t events;                         /*!< Requested events, W6X_NET_POLLIN and/or W6X_NET_POLLOUT */
+  int16_t revents;                        /*!< Returned events */
+} W6X_Net_Pollfd_t;
+
+/**
+  * @brief  Socket set of W6X_Net_Select, one bit per socket ID
+  */
+typedef uint32_t W6X_Net_Fdset_t;
 #endif /* ST67_ARCH */
 
 /** @} */
@@ -1159,6 +1200,9 @@ typedef struct
 {
   uint32_t topic_length;          /*!< Length of the topic */
   uint32_t message_length;        /*!< Length of the message */
+  uint8_t *topic;                 /*!< Topic, null terminated */
+  uint8_t *message;               /*!< Message of message_length bytes, null terminated */
+  int32_t slot;                   /*!< Inbox slot lent to the application, -1 if the message has been copied */
 } W6X_MQTT_CbParamData_t;
 
 /**
@@ -1195,7 +1239,11 @@ typedef struct
 typedef struct
 {
   uint8_t *p_recv_data;           /*!< Pointer to Data buffer allocated by the application */
-  uint32_t recv_data_buf_size;    /*!< Length of the buffer to contain received topic + message strings */
+  uint32_t recv_data_buf_size;    /*!< Length of the buffer to contain received topic + message strings,
+                                       both null terminated */
+  /** 1 to lend the received messages in place until W6X_MQTT_Release, the buffer above is then only used
+    * when all the inbox slots are lent */
+  uint32_t zero_copy;
 } W6X_MQTT_Data_t;
 
 /** @} */
@@ -1487,6 +1535,11 @@ typedef struct
   uint32_t max_response_len;                  /*!< Maximum response length */
 } W6X_HTTP_connection_t;
 
+/**
+  * @brief  HTTP client connection kept open between the requests, see W6X_HTTP_Client_Open
+  */
+typedef struct W6X_HTTP_Client_s W6X_HTTP_Client_t;
+
 /** @} */
 
 /* ===================================================================== */
@@ -1496,6 +1549,9 @@ typedef struct
   */
 /* ===================================================================== */
 
+/** Minimum headroom in front of a frame for W6X_Netif_output_vec() to send it without copy */
+#define W6X_NETIF_HEADROOM                8
+
 /**
   * @brief  Network interface link up/down function type
   * @return Status of the operation (0 for success, negative for error)
@@ -1521,6 +1577,22 @@ typedef struct
   W6X_Net_if_rxd_notify_func_t rxd_ap_notify_fn;    /*!< Function to handle RX AP notifications */
 } W6X_Net_if_cb_t;
 
+/**
+  * @brief  Segment of a frame sent with W6X_Netif_output_vec()
+  */
+typedef struct
+{
+  void *data;                                       /*!< Segment data */
+  uint32_t len;                                     /*!< Segment length */
+} W6X_Netif_Segment_t;
+
+/**
+  * @brief  Network interface TX release function type
+  * @param  arg: Argument given to W6X_Netif_output_vec()
+  * @note   Called once the driver no longer references the frame segments.
+  */
+typedef void (*W6X_Netif_release_func_t)(void *arg);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -55,29 +55,35 @@ extern "C" {
 /** Max message length */
 #define MAX_LOG_MESSAGE_LENGTH                  2000
 
-/** Max queue length */
-#define MAX_LOG_QUEUE_LENGTH                    200
+/** Size in bytes of the ring buffer carrying the log records to the output task */
+#define LOG_RING_SIZE                           4096
 
 /** Max log level */
 #define MAX_LOG_LEVEL                           LOG_DEBUG
 
-/** Max log level */
-#define MAX_LOG_MEMORY                          4096
-
-/** Log id. must be unique per queue producer */
-#define LOG_MESSAGE_ID                          1
-
 /** Log thread stack size */
 #define LOG_THREAD_STACK_SIZE                   256
 
 /** Log thread priority */
 #define LOG_THREAD_PRIO                         25
 
-/** Log memory allocator */
-#define LOG_MALLOC                              pvPortMalloc
+/** Defer the formatting of the log messages to the output task */
+#define LOG_DEFERRED_ENABLE                     0
+
+/** Max size in bytes of a deferred record, header and copied strings included */
+#define LOG_DEFERRED_MAX_RECORD                 128
+
+/** Max number of characters copied for each string argument of a deferred record */
+#define LOG_DEFERRED_MAX_STRING                 32
+
+/** Size of the buffer of the output task formatting the deferred records */
+#define LOG_DEFERRED_OUTPUT_SIZE                256
+
+/** Output the deferred records in hexadecimal, to be decoded on the host */
+#define LOG_DEFERRED_RAW                        0
 
-/** Log memory deallocator */
-#define LOG_FREE                                vPortFree
+/** Log thread stack size when the output task formats the deferred records */
+#define LOG_DEFERRED_THREAD_STACK_SIZE          1024
 
 /* USER CODE BEGIN EC */
 
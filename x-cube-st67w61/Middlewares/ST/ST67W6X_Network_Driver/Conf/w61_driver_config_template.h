@@ -45,6 +45,9 @@ extern "C" {
 /** Enable/Disable Wi-Fi module logging */
 #define WIFI_LOG_ENABLE                         1
 
+/** Highest Wi-Fi module log level compiled in (LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG) */
+#define WIFI_LOG_LEVEL                          LOG_LEVEL
+
 /** ============================
   * AT Net
   * All available configuration defines in
@@ -55,6 +58,9 @@ extern "C" {
 /** Enable/Disable Network module logging */
 #define NET_LOG_ENABLE                          1
 
+/** Highest Network module log level compiled in (LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG) */
+#define NET_LOG_LEVEL                           LOG_LEVEL
+
 /** ============================
   * AT BLE
   * All available configuration defines in
@@ -68,6 +74,9 @@ extern "C" {
 /** Enable/Disable BLE module logging */
 #define BLE_LOG_ENABLE                          1
 
+/** Highest BLE module log level compiled in (LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG) */
+#define BLE_LOG_LEVEL                           LOG_LEVEL
+
 /** ============================
   * AT MQTT
   * All available configuration defines in
@@ -77,6 +86,12 @@ extern "C" {
 
 #define MQTT_LOG_ENABLE                         1
 
+/** Highest MQTT module log level compiled in (LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG) */
+#define MQTT_LOG_LEVEL                          LOG_LEVEL
+
+/** Number of received MQTT messages that can be lent to the application at the same time in zero-copy mode */
+#define W61_MQTT_INBOX_SLOTS                    4
+
 /** ============================
   * AT Common
   * All available configuration defines in
@@ -92,6 +107,30 @@ extern "C" {
 /** SPI thread priority */
 #define SPI_THREAD_PRIO                         53
 
+/** Number of MTU sized buffers in the SPI buffer pool (0 to always use the heap) */
+#define SPI_BUF_POOL_MTU_COUNT                  8
+
+/** Number of small buffers in the SPI buffer pool (0 to always use the heap) */
+#define SPI_BUF_POOL_SMALL_COUNT                16
+
+/** Capacity of the small SPI buffers, sized for AT replies and TCP ACKs */
+#define SPI_BUF_POOL_SMALL_SIZE                 256
+
+/** SPI RX buffer strategy: 0: MTU buffer then copy of short messages, 1: buffer sized from the slave header */
+#define SPI_RX_BUF_MODE                         1
+
+/** Prepare the next TX buffer while the current transfer waits for DMA or header ack */
+#define SPI_XFER_PIPELINE                       1
+
+/** Debugging only: Record the SPI trace points and report per-stage latency in spi_dump */
+#define SPI_TRACE_ENABLE                        0
+
+/** SPI clock frequency used as line rate reference by spi_perf, 0 if unknown */
+#define SPI_XFER_CLOCK_HZ                       0
+
+/** Testing only: Use the simulated NCP of spi_port_sim.c instead of the project spi_port.c */
+#define SPI_PORT_SIM_ENABLE                     0
+
 /** Maximum size of AT log */
 #define W61_MAX_AT_LOG_LENGTH                   30
 
@@ -111,6 +150,10 @@ extern "C" {
 /** Timeout for remote network operation (e.g. server) */
 #define W61_NET_TIMEOUT                         6000
 
+/** Carry socket payloads in SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA messages instead of AT+CIPSEND / AT+CIPRECVDATA.
+  * Requires NCP firmware support of AT+CIPDATACHAN, the AT commands are used otherwise */
+#define W61_NET_DATA_CHANNEL_ENABLE             0
+
 /** Timeout for remote BLE device operation */
 #define W61_BLE_TIMEOUT                         2000
 
@@ -121,12 +164,23 @@ extern "C" {
 /** Enable/Disable System module logging */
 #define SYS_LOG_ENABLE                          1
 
+/** Highest System module log level compiled in (LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG) */
+#define SYS_LOG_LEVEL                           LOG_LEVEL
+
 /** Stack required especially for Log messages */
 #define W61_MDM_RX_TASK_STACK_SIZE_BYTES        1280
 
 /** W61_Modem_Process task priority, recommended to be higher than application tasks */
 #define W61_MDM_RX_TASK_PRIO                    54
 
+/** Enable the asynchronous AT request engine (W61_AT_Request_Submit / W61_AT_Request_Wait).
+  * W61_AT_Common_SetExecute commands, e.g. the socket and Wi-Fi join ones, are then queued to its task too.
+  * Requires configSUPPORT_STATIC_ALLOCATION */
+#define W61_AT_REQ_ENABLE                       0
+
+/** Number of AT requests that can be queued ahead of the one being executed */
+#define W61_AT_REQ_QUEUE_LEN                    8
+
 /* USER CODE BEGIN EC */
 
 /* USER CODE END EC */
@@ -118,6 +118,19 @@ extern "C" {
   * So in order to get optimal performances, the buffer on NCP side should be twice as big */
 #define W6X_NET_RECV_BUFFER_SIZE                (2 * 3 * 1536)
 
+/** Default receive mode of the sockets (SO_RCVMODE): W6X_NET_RECV_LATENCY or W6X_NET_RECV_THROUGHPUT */
+#define W6X_NET_RECV_MODE                       W6X_NET_RECV_LATENCY
+
+/** Pull ahead the data of a TCP/TLS socket on small W6X_Net_Recv() calls and serve the next reads from RAM */
+#define W6X_NET_READAHEAD_ENABLE                0
+
+/** Coalesce the small W6X_Net_Send() writes of a TCP/TLS socket into fewer AT+CIPSEND transactions.
+  * Disabled per socket with TCP_NODELAY */
+#define W6X_NET_COALESCE_ENABLE                 0
+
+/** Maximum time in ms the coalesced bytes are held before they are sent */
+#define W6X_NET_COALESCE_DELAY                  5
+
 /** ============================
   * HTTP
   *
@@ -139,10 +152,16 @@ extern "C" {
   * when retrieving data from an HTTP server for example */
 #define W6X_HTTP_CLIENT_TCP_SOCK_RECV_TIMEOUT   1000
 
+/** Maximum time in ms without data from the server while an HTTP response is read */
+#define W6X_HTTP_CLIENT_RESPONSE_TIMEOUT        10000
+
 /** Size of the TCP socket used by the HTTP client, recommended to be at least 0x2000 when fetching lots of data.
   * 0x2000 is the value used in the SPI host project for OTA update, which retrieves around 1 mega bytes of data. */
 #define W6X_HTTP_CLIENT_TCP_SOCKET_SIZE         0x3000
 
+/** Number of HTTP client connections kept open between the requests */
+#define W6X_HTTP_CLIENT_POOL_SIZE               2
+
 /** ============================
   * Utility Performance network wrapper functions
   *
@@ -128,6 +128,47 @@ extern "C" {
 #define W6X_NET_RECV_BUFFER_SIZE                (2 * 3 * 1536)
 #endif /* W6X_NET_RECV_BUFFER_SIZE */
 
+#ifndef W6X_NET_RECV_MODE
+/** Default receive mode of the sockets (SO_RCVMODE): W6X_NET_RECV_LATENCY or W6X_NET_RECV_THROUGHPUT */
+#define W6X_NET_RECV_MODE                       W6X_NET_RECV_LATENCY
+#endif /* W6X_NET_RECV_MODE */
+
+#ifndef W6X_NET_RECV_GATHER_TIME
+/** Maximum time in ms a W6X_NET_RECV_THROUGHPUT socket waits for more data before pulling it */
+#define W6X_NET_RECV_GATHER_TIME                3
+#endif /* W6X_NET_RECV_GATHER_TIME */
+
+#ifndef W6X_NET_READAHEAD_ENABLE
+/** Pull ahead the data of a TCP/TLS socket on small W6X_Net_Recv() calls and serve the next reads from RAM */
+#define W6X_NET_READAHEAD_ENABLE                0
+#endif /* W6X_NET_READAHEAD_ENABLE */
+
+#ifndef W6X_NET_READAHEAD_SIZE
+/** Size of the read-ahead buffer allocated per socket, bounding the pull length */
+#define W6X_NET_READAHEAD_SIZE                  (W61_MAX_SPI_XFER - 64)
+#endif /* W6X_NET_READAHEAD_SIZE */
+
+#ifndef W6X_NET_PEEK_SIZE
+/** Size of the buffer allocated per socket on the first MSG_PEEK, bounding the length peeked at once */
+#define W6X_NET_PEEK_SIZE                       64
+#endif /* W6X_NET_PEEK_SIZE */
+
+#ifndef W6X_NET_COALESCE_ENABLE
+/** Coalesce the small W6X_Net_Send() writes of a TCP/TLS socket into fewer AT+CIPSEND transactions.
+  * Disabled per socket with TCP_NODELAY */
+#define W6X_NET_COALESCE_ENABLE                 0
+#endif /* W6X_NET_COALESCE_ENABLE */
+
+#ifndef W6X_NET_COALESCE_BUF_SIZE
+/** Maximum number of bytes coalesced per socket before they are sent, up to the SPI MTU */
+#define W6X_NET_COALESCE_BUF_SIZE               1460
+#endif /* W6X_NET_COALESCE_BUF_SIZE */
+
+#ifndef W6X_NET_COALESCE_DELAY
+/** Maximum time in ms the coalesced bytes are held before they are sent */
+#define W6X_NET_COALESCE_DELAY                  5
+#endif /* W6X_NET_COALESCE_DELAY */
+
 /** @} */
 
 /** @addtogroup ST67W6X_API_HTTP_Public_Constants
@@ -141,12 +182,32 @@ extern "C" {
 #define W6X_HTTP_CLIENT_TCP_SOCK_RECV_TIMEOUT   1000
 #endif /* W6X_HTTP_CLIENT_TCP_SOCK_RECV_TIMEOUT */
 
+#ifndef W6X_HTTP_CLIENT_RESPONSE_TIMEOUT
+/** Maximum time in ms without data from the server while an HTTP response is read */
+#define W6X_HTTP_CLIENT_RESPONSE_TIMEOUT        10000
+#endif /* W6X_HTTP_CLIENT_RESPONSE_TIMEOUT */
+
 #ifndef W6X_HTTP_CLIENT_TCP_SOCKET_SIZE
 /** Size of the TCP socket used by the HTTP client, recommended to be at least 0x2000 when fetching lots of data.
   * 0x2000 is the value used in the SPI host project for OTA update, which retrieves around 1 mega bytes of data. */
 #define W6X_HTTP_CLIENT_TCP_SOCKET_SIZE         0x3000
 #endif /* W6X_HTTP_CLIENT_TCP_SOCKET_SIZE */
 
+#ifndef W6X_HTTP_CLIENT_POOL_SIZE
+/** Number of HTTP client connections kept open between the requests */
+#define W6X_HTTP_CLIENT_POOL_SIZE               2
+#endif /* W6X_HTTP_CLIENT_POOL_SIZE */
+
+#ifndef W6X_HTTP_CLIENT_POOL_IDLE_TIMEOUT
+/** Time in ms after which an idle pooled connection is opened again instead of being reused */
+#define W6X_HTTP_CLIENT_POOL_IDLE_TIMEOUT       30000
+#endif /* W6X_HTTP_CLIENT_POOL_IDLE_TIMEOUT */
+
+#ifndef W6X_HTTP_CLIENT_PIPELINE_DEPTH
+/** Maximum number of requests sent on a connection before their responses are read */
+#define W6X_HTTP_CLIENT_PIPELINE_DEPTH          4
+#endif /* W6X_HTTP_CLIENT_PIPELINE_DEPTH */
+
 /** @} */
 
 #ifdef __cplusplus
@@ -73,6 +73,7 @@
 #include "w61_io.h"        /* Prototypes of the BUS functions to be registered */
 #include "common_parser.h" /* Common Parser functions */
 #include "w6x_default_config.h"
+#include "w6x_http_parser.h"
 
 /* Global variables ----------------------------------------------------------*/
 /* Private typedef -----------------------------------------------------------*/
@@ -81,18 +82,47 @@
   * @{
   */
 
+/**
+  * @brief  HTTP client connection structure
+  */
+struct W6X_HTTP_Client_s
+{
+  int32_t sock;                         /*!< Socket of the connection */
+  uint8_t connected;                    /*!< Socket is connected to the server */
+  uint8_t in_use;                       /*!< Connection is owned by a caller */
+  uint8_t keep_alive;                   /*!< Server accepts more requests on the connection */
+  uint8_t persistent;                   /*!< A response kept the connection open, requests can be pipelined */
+  uint8_t pending;                      /*!< Number of requests sent whose response has not been read */
+  uint8_t methods[W6X_HTTP_CLIENT_PIPELINE_DEPTH]; /*!< Methods of the pending requests, oldest first */
+  uint16_t port;                        /*!< Server port */
+  ip_addr_t server;                     /*!< Server IP address */
+  TickType_t last_used;                 /*!< Tick count of the last release */
+  W6X_HTTP_connection_t settings;       /*!< HTTP connection settings, server name owned by the connection */
+  char host_name[65];                   /*!< Host header value */
+  uint8_t *buffer;                      /*!< Response buffer */
+  uint32_t buffer_len;                  /*!< Bytes of the next responses already received in buffer */
+};
+
 /**
   * @brief  HTTP request task context structure
   */
 struct http_request_task_obj
 {
-  int32_t sock;                         /*!< Socket used for the HTTP request */
+  W6X_HTTP_Client_t *client;            /*!< Connection used for the HTTP request */
   char *uri;                            /*!< URI to request */
-  ip_addr_t server;                     /*!< Server IP address */
   char method[6];                       /*!< HTTP method to use */
   W6X_HTTP_Post_Data_t post_data;       /*!< Data to post */
   size_t post_data_len;                 /*!< Length of the data to post */
-  W6X_HTTP_connection_t settings;       /*!< HTTP connection settings */
+};
+
+/**
+  * @brief  HTTP response parsing context structure
+  */
+struct http_response_obj
+{
+  W6X_HTTP_Client_t *client;            /*!< Connection the response is read from */
+  W6X_HTTP_Status_Code_e status;        /*!< Status code of the response */
+  uint8_t deliver;                      /*!< Body is passed to the receive callback */
 };
 
 /** @} */
@@ -134,6 +164,15 @@ struct http_request_task_obj
 /** HTTP client agent string */
 #define W6X_HTTP_CLIENT_AGENT                       "w6x/" W6X_HTTP_CLIENT_CUSTOM_VERSION_STRING
 
+/** Connection header value of the requests closing the connection */
+#define W6X_HTTP_CLIENT_CONNECTION_CLOSE            "close"
+
+/** Connection header value of the requests keeping the connection open */
+#define W6X_HTTP_CLIENT_CONNECTION_KEEP_ALIVE       "keep-alive"
+
+/** Maximum number of digits of the Content-Length header value */
+#define W6X_HTTP_CLIENT_CONTENT_LENGTH_DIGITS       10U
+
 /** @} */
 
 /* Private macros ------------------------------------------------------------*/
@@ -161,12 +200,12 @@ struct http_request_task_obj
   "User-Agent: %s\r\n"    /* User-Agent */                                             \
   "Accept: */*\r\n"                                                                    \
   "Host: %s\r\n"          /* Server name */                                            \
-  "Connection: close\r\n" /* Don't yet support persistent connections */               \
+  "Connection: %s\r\n"    /* close or keep-alive */                                    \
   "\r\n"
 
 /** HEAD request basic format */
-#define HTTPC_REQ_HEAD_11_FORMAT(uri, srv_name) \
-  HTTPC_REQ_HEAD_11, uri, W6X_HTTP_CLIENT_AGENT, srv_name
+#define HTTPC_REQ_HEAD_11_FORMAT(uri, srv_name, conn) \
+  HTTPC_REQ_HEAD_11, uri, W6X_HTTP_CLIENT_AGENT, srv_name, conn
 
 /** GET request basic */
 #define HTTPC_REQ_10                                                                   \
@@ -193,12 +232,12 @@ struct http_request_task_obj
   "User-Agent: %s\r\n"    /* User-Agent */                                             \
   "Accept: */*\r\n"                                                                    \
   "Host: %s\r\n"          /* Server name */                                            \
-  "Connection: close\r\n" /* Don't yet support persistent connections */               \
+  "Connection: %s\r\n"    /* close or keep-alive */                                    \
   "\r\n"
 
 /** GET request with host format */
-#define HTTPC_REQ_11_HOST_FORMAT(uri, srv_name) \
-  HTTPC_REQ_11_HOST, uri, W6X_HTTP_CLIENT_AGENT, srv_name
+#define HTTPC_REQ_11_HOST_FORMAT(uri, srv_name, conn) \
+  HTTPC_REQ_11_HOST, uri, W6X_HTTP_CLIENT_AGENT, srv_name, conn
 
 /** GET request with proxy */
 #define HTTPC_REQ_11_PROXY                                                             \
@@ -226,7 +265,7 @@ struct http_request_task_obj
 #define HTTPC_REQ_11_PROXY_PORT_FORMAT(host, host_port, uri, srv_name) \
   HTTPC_REQ_11_PROXY_PORT, host, host_port, uri, W6X_HTTP_CLIENT_AGENT, srv_name
 
-/** POST/PUT request basic format */
+/** POST/PUT request basic format, the body is appended after the header */
 #define HTTPC_REQ_POST_PUT_11                                                          \
   "%s %s HTTP/1.1\r\n"                                                                 \
   "User-Agent: %s\r\n"              /* User-Agent */                                   \
@@ -234,17 +273,17 @@ struct http_request_task_obj
   "Accept-Encoding: deflate, gzip\r\n"                                                 \
   "Host: %s\r\n"                                                                       \
   "Content-Type: %s\r\n"                                                               \
-  "Content-Length: %d\r\n"                                                             \
-  "Connection: close\r\n"           /* Don't yet support persistent connections */     \
-  "\r\n%s"
+  "Content-Length: %" PRIu32 "\r\n"                                                    \
+  "Connection: %s\r\n"              /* close or keep-alive */                          \
+  "\r\n"
 
 /** POST request with host */
-#define HTTPC_REQ_POST_11_FORMAT(uri, srv_name, content_type, length, data) \
-  HTTPC_REQ_POST_PUT_11, "POST", uri, W6X_HTTP_CLIENT_AGENT, srv_name, content_type, length, data
+#define HTTPC_REQ_POST_11_FORMAT(uri, srv_name, content_type, length, conn) \
+  HTTPC_REQ_POST_PUT_11, "POST", uri, W6X_HTTP_CLIENT_AGENT, srv_name, content_type, length, conn
 
 /** PUT request with host */
-#define HTTPC_REQ_PUT_11_FORMAT(uri, srv_name, content_type, length, data) \
-  HTTPC_REQ_POST_PUT_11, "PUT", uri, W6X_HTTP_CLIENT_AGENT, srv_name, content_type, length, data
+#define HTTPC_REQ_PUT_11_FORMAT(uri, srv_name, content_type, length, conn) \
+  HTTPC_REQ_POST_PUT_11, "PUT", uri, W6X_HTTP_CLIENT_AGENT, srv_name, content_type, length, conn
 
 /** @} */
 
@@ -259,6 +298,18 @@ const static int32_t optval = W6X_HTTP_CLIENT_TCP_SOCKET_SIZE;
 /** HTTP client TCP socket data receive timeout */
 const static int32_t timeout = W6X_HTTP_CLIENT_TCP_SOCK_RECV_TIMEOUT;
 
+/** HTTP client TCP socket receive mode */
+const static int32_t recv_mode = W6X_NET_RECV_LATENCY;
+
+/** Connections kept open between the requests */
+static W6X_HTTP_Client_t http_pool[W6X_HTTP_CLIENT_POOL_SIZE];
+
+/** Number of connections opened to a server */
+static uint32_t http_pool_connects = 0;
+
+/** Number of requests sent */
+static uint32_t http_pool_requests = 0;
+
 /* Private function prototypes -----------------------------------------------*/
 /** @defgroup ST67W6X_Private_HTTP_Functions ST67W6X HTTP Functions
   * @ingroup  ST67W6X_Private_HTTP
@@ -272,22 +323,65 @@ const static int32_t timeout = W6X_HTTP_CLIENT_TCP_SOCK_RECV_TIMEOUT;
 static void W6X_HTTP_Client_task(void *arg);
 
 /**
-  * @brief  Parse the response header content length value
-  * @param  buffer: buffer containing the http response
-  * @param  content_length: pointer to the content length value
+  * @brief  Set the server and the settings of a connection
+  * @param  client: Connection to set
+  * @param  server_addr: Server address
+  * @param  port: Server port
+  * @param  settings: Settings to use for the HTTP requests
+  * @return W6X_STATUS_OK if success, W6X_STATUS_ERROR otherwise
+  */
+static W6X_Status_t W6X_HTTP_Client_Setup(W6X_HTTP_Client_t *client, const ip_addr_t *server_addr, uint16_t port,
+                                         const W6X_HTTP_connection_t *settings);
+
+/**
+  * @brief  Open the socket of a connection and connect it to the server
+  * @param  client: Connection to open
   * @return W6X_STATUS_OK if success, W6X_STATUS_ERROR otherwise
   */
-static W6X_Status_t W6X_HTTP_Parse_Content_Length(const uint8_t *buffer, uint32_t *content_length);
+static W6X_Status_t W6X_HTTP_Client_Connect(W6X_HTTP_Client_t *client);
+
+/**
+  * @brief  Close the socket of a connection, the unread responses are lost
+  * @param  client: Connection to close
+  */
+static void W6X_HTTP_Client_Disconnect(W6X_HTTP_Client_t *client);
+
+/**
+  * @brief  Check that an idle connection can still be used
+  * @param  client: Connection to check
+  * @return 1 if the connection can be used, 0 otherwise
+  */
+static int32_t W6X_HTTP_Client_Is_Alive(W6X_HTTP_Client_t *client);
 
 /**
-  * @brief  Parse http header response status
-  * @param  buffer: buffer containing the http response
-  * @param  http_version: http version
-  * @param  http_status: http status code
+  * @brief  Format and send an HTTP request
+  * @param  client: Connection to send the request on
+  * @param  method: HTTP method type, W6X_HTTP_REQ_TYPE_xxx
+  * @param  uri: URI to request
+  * @param  post_data: Data to post, NULL if none
+  * @param  post_data_len: Length of the data to post
+  * @param  keep_alive: 1 to ask the server to keep the connection open, 0 otherwise
   * @return W6X_STATUS_OK if success, W6X_STATUS_ERROR otherwise
   */
-static W6X_Status_t W6X_HTTP_Parse_Response_Status(const uint8_t *buffer, uint16_t *http_version,
-                                                   W6X_HTTP_Status_Code_e *http_status);
+static W6X_Status_t W6X_HTTP_Client_Write_Request(W6X_HTTP_Client_t *client, int8_t method, const char *uri,
+                                                  const W6X_HTTP_Post_Data_t *post_data, size_t post_data_len,
+                                                  uint8_t keep_alive);
+
+/**
+  * @brief  Read the response of the oldest pending request and pass it to the connection callbacks.
+  *         The bytes received beyond the response are kept for the next one.
+  * @param  client: Connection to read the response from
+  * @param  http_status: HTTP status code of the response
+  * @return W6X_STATUS_OK if the response has been read, W6X_STATUS_ERROR otherwise
+  */
+static W6X_Status_t W6X_HTTP_Client_Read_Response(W6X_HTTP_Client_t *client, W6X_HTTP_Status_Code_e *http_status);
+
+/**
+  * @brief  Get the method type of an HTTP method string
+  * @param  method: HTTP method string
+  * @return W6X_HTTP_REQ_TYPE_xxx, or -1 if the method is not supported
+  */
+static int8_t W6X_HTTP_Get_Method(const char *method);
 
 /**
   * @brief  Function to get the category of a status code
@@ -298,17 +392,21 @@ static W6X_Status_t W6X_HTTP_Parse_Response_Status(const uint8_t *buffer, uint16
 static W6X_Status_t W6X_HTTP_Get_Status_Category(W6X_HTTP_Status_Code_e status, W6X_HTTP_Status_Category_e *category);
 
 /**
-  * @brief  Wait for for full header response to be received \
-  *         Ending of an header response is CRLF CRLF \
-  *         buffer should be big enough to receive the whole response header
-  * @param  sock: socket to use
-  * @param  buffer: buffer to store the response
-  * @param  body_start_offset: buffer containing the start of the HTTP request body if any.
-  *         If none is expected or yet received, body_start points to the end of the HTTP header in buffer.
-  * @return W6X_STATUS_OK if header was received successfully, W6X_STATUS_ERROR otherwise
+  * @brief  Parser callback called once the header of the response is parsed
+  * @param  arg: Response parsing context
+  * @param  parser: HTTP response parser
+  * @return 0 to continue, negative value to abort the parsing
+  */
+static int32_t W6X_HTTP_Client_Headers_cb(void *arg, const W6X_HTTP_Parser_t *parser);
+
+/**
+  * @brief  Parser callback called for each span of body data
+  * @param  arg: Response parsing context
+  * @param  data: Body data, in place in the response buffer
+  * @param  len: Length of the body data
+  * @return 0 to continue, negative value to abort the parsing
   */
-static W6X_Status_t W6X_HTTP_Client_Wait_For_Header(int32_t sock, W6X_HTTP_buffer_t *buffer,
-                                                    uint32_t *body_start_offset);
+static int32_t W6X_HTTP_Client_Body_cb(void *arg, const uint8_t *data, uint32_t len);
 
 /** @} */
 
@@ -318,109 +416,45 @@ W6X_Status_t W6X_HTTP_Client_Request(const ip_addr_t *server_addr, uint16_t port
                                      void *callback_arg, W6X_HTTP_headers_done_cb_t headers_done_fn,
                                      W6X_HTTP_data_cb_t data_fn, const W6X_HTTP_connection_t *settings)
 {
-  int32_t sock;
-  struct sockaddr_in addr = {0};
-  uint8_t sec_tag_list[] = { 0 };
+  W6X_HTTP_Client_t *client;
   struct http_request_task_obj *Obj = NULL;
-  /* Create a TCP socket  if the port is not 443 which is used for https */
-  if (port != 443)
+
+  client = pvPortMalloc(sizeof(W6X_HTTP_Client_t));
+  if (client == NULL)
   {
-    sock = W6X_Net_Socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (sock < 0)
-    {
-      NET_LOG_ERROR("Socket creation failed\n");
-      return W6X_STATUS_ERROR;
-    }
+    NET_LOG_ERROR("Connection structure allocation failed\n");
+    return W6X_STATUS_ERROR;
   }
-  else
+  memset(client, 0, sizeof(W6X_HTTP_Client_t));
+  if (W6X_HTTP_Client_Setup(client, server_addr, port, settings) != W6X_STATUS_OK)
   {
-    sock = W6X_Net_Socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
-    if (sock < 0)
-    {
-      NET_LOG_ERROR("Socket creation failed\n");
-      return W6X_STATUS_ERROR;
-    }
-
-    /** Use a tag that has the value of the socket id to be able to run multiple
-      * without waiting for the previous to end */
-    if (settings->https_certificate.name != NULL)
-    {
-      sec_tag_list[0] = sock;
-      if (settings->https_certificate.content == NULL)
-      {
-        if (W6X_Net_TLS_Credential_AddByName(sec_tag_list[0], W6X_NET_TLS_CREDENTIAL_CA_CERTIFICATE,
-                                             settings->https_certificate.name) != 0)
-        {
-          NET_LOG_ERROR("Socket creation failed\n");
-          W6X_Net_Close(sock);
-          return W6X_STATUS_ERROR;
-        }
-      }
-      else
-      {
-        if (W6X_Net_TLS_Credential_AddByContent(sec_tag_list[0], W6X_NET_TLS_CREDENTIAL_CA_CERTIFICATE,
-                                                settings->https_certificate.name,
-                                                settings->https_certificate.content,
-                                                strlen(settings->https_certificate.content)) != 0)
-        {
-          NET_LOG_ERROR("Socket creation failed\n");
-          W6X_Net_Close(sock);
-          return W6X_STATUS_ERROR;
-        }
-      }
-
-      if (W6X_Net_Setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tag_list, sizeof(sec_tag_list)) != 0)
-      {
-        NET_LOG_ERROR("Set socket option failed\n");
-        goto _err;
-      }
-    }
-
-    NET_LOG_DEBUG("Socket option set\n");
-
-    if (W6X_Net_Setsockopt(sock, SOL_TLS, TLS_ALPN_LIST, alpn_list, 2) != 0)
-    {
-      NET_LOG_ERROR("Set ALPN failed\n");
-      goto _err;
-    }
-
-    NET_LOG_DEBUG("ALPN set\n");
-
-    if (W6X_Net_Setsockopt(sock, SOL_TLS, TLS_HOSTNAME, settings->server_name, strlen(settings->server_name)) != 0)
-    {
-      NET_LOG_ERROR("Set SNI failed\n");
-      goto _err;
-    }
-
-    NET_LOG_DEBUG("SNI set\n");
+    vPortFree(client);
+    return W6X_STATUS_ERROR;
   }
 
-  NET_LOG_DEBUG("Socket creation done\n");
-  /* Configure receive data timeout for the TCP socket */
-  if (0 != W6X_Net_Setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)))
+  /* Since callbacks info is duplicated, if the one is not set, try using the other */
+  if (client->settings.headers_done_fn == NULL)
   {
-    NET_LOG_ERROR("Socket set timeout option failed\n");
-    goto _err;
+    client->settings.headers_done_fn = headers_done_fn;
   }
-
-  /* Configure the socket receive buffer size */
-  if (0 != W6X_Net_Setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &optval, sizeof(optval)))
+  if (client->settings.result_fn == NULL)
   {
-    NET_LOG_ERROR("Socket set receive buff option failed\n");
-    goto _err;
+    client->settings.result_fn = result_fn;
+  }
+  if (client->settings.callback_arg == NULL)
+  {
+    client->settings.callback_arg = callback_arg;
+  }
+  if (client->settings.recv_fn == NULL)
+  {
+    client->settings.recv_fn = data_fn;
   }
 
-  /* Supports only IPv4 without DNS */
-  addr.sin_family = AF_INET;
-  addr.sin_port = PP_HTONS(port);
-  addr.sin_addr.s_addr = server_addr->u_addr.ip4.addr;
-  if (0 != W6X_Net_Connect(sock, (struct sockaddr *)&addr, sizeof(addr)))
+  if (W6X_HTTP_Client_Connect(client) != W6X_STATUS_OK)
   {
-    NET_LOG_ERROR("Socket connection failed\n");
     goto _err;
   }
 
-  NET_LOG_DEBUG("Socket %" PRIi32 " connected\n", sock);
   Obj = pvPortMalloc(sizeof(struct http_request_task_obj));
   if (Obj == NULL)
   {
@@ -428,7 +462,7 @@ W6X_Status_t W6X_HTTP_Client_Request(const ip_addr_t *server_addr, uint16_t port
     goto _err;
   }
   memset(Obj, 0, sizeof(struct http_request_task_obj));
-  Obj->sock = sock;
+  Obj->client = client;
   Obj->post_data_len = post_data_len;
 
   if ((post_data != NULL) && (post_data_len > 0))
@@ -456,49 +490,10 @@ W6X_Status_t W6X_HTTP_Client_Request(const ip_addr_t *server_addr, uint16_t port
   strncpy(Obj->uri, uri, strlen(uri));
   Obj->uri[strlen(uri)] = 0;
   strncpy(Obj->method, method, 5);
-  memcpy(&Obj->server, server_addr, sizeof(ip_addr_t));
-  memcpy(&Obj->settings, settings, sizeof(W6X_HTTP_connection_t));
-
-  if (settings->server_name == NULL)
-  {
-    Obj->settings.server_name = NULL;
-  }
-  else
-  {
-    Obj->settings.server_name = pvPortMalloc(strlen(settings->server_name) + 1);
-    if (Obj->settings.server_name == NULL)
-    {
-      vPortFree(Obj->uri);
-      vPortFree(Obj->post_data.data);
-      vPortFree(Obj);
-      NET_LOG_ERROR("Callback structure allocation failed\n");
-      goto _err;
-    }
-    strncpy(Obj->settings.server_name, settings->server_name, strlen(settings->server_name));
-    Obj->settings.server_name[strlen(settings->server_name)] = 0;
-  }
 
-  /* Since callbacks info is duplicated, if the one is not set, try using the other */
-  if (Obj->settings.headers_done_fn == NULL)
-  {
-    Obj->settings.headers_done_fn = headers_done_fn;
-  }
-  if (Obj->settings.result_fn == NULL)
-  {
-    Obj->settings.result_fn = result_fn;
-  }
-  if (Obj->settings.callback_arg == NULL)
-  {
-    Obj->settings.callback_arg = callback_arg;
-  }
-  if (Obj->settings.recv_fn == NULL)
-  {
-    Obj->settings.recv_fn = data_fn;
-  }
-
-  if ((Obj->settings.headers_done_fn == NULL) &&
-      (Obj->settings.result_fn == NULL) &&
-      (Obj->settings.recv_fn == NULL))
+  if ((client->settings.headers_done_fn == NULL) &&
+      (client->settings.result_fn == NULL) &&
+      (client->settings.recv_fn == NULL))
   {
     NET_LOG_WARN("No callback has been registered to the HTTP Client task, any error would not be reported\n");
   }
@@ -510,362 +505,727 @@ W6X_Status_t W6X_HTTP_Client_Request(const ip_addr_t *server_addr, uint16_t port
   }
 
   /*Failed to start the task, need to free buffer and structures */
-  if (Obj->settings.server_name != NULL)
-  {
-    vPortFree(Obj->settings.server_name);
-  }
   vPortFree(Obj->post_data.data);
   vPortFree(Obj->uri);
   vPortFree(Obj);
 _err:
-  W6X_Net_TLS_Credential_Delete(sock, W6X_NET_TLS_CREDENTIAL_CA_CERTIFICATE);
-  W6X_Net_Close(sock);
+  W6X_HTTP_Client_Disconnect(client);
+  vPortFree(client->settings.server_name);
+  vPortFree(client);
   return W6X_STATUS_ERROR;
 }
 
-/* Private Functions Definition ----------------------------------------------*/
-/** @addtogroup ST67W6X_Private_HTTP_Functions
-  * @{
-  */
-
-static void W6X_HTTP_Client_task(void *arg)
+W6X_HTTP_Client_t *W6X_HTTP_Client_Open(const ip_addr_t *server_addr, uint16_t port,
+                                        const W6X_HTTP_connection_t *settings)
 {
-  struct http_request_task_obj *Obj = (struct http_request_task_obj *) arg;
-  uint32_t content_length = 0;
-  int32_t req_len = 0;
-  int32_t req_len2 = 0;
-  int32_t total_recv_data = 0;
-  uint8_t *req_buffer = NULL;
-  int32_t bytes_sent;
-  int32_t error = -1;
-  W6X_HTTP_buffer_t http_buffer = {0};
-  W6X_HTTP_Status_Code_e http_status = HTTP_VERSION_NOT_SUPPORTED;
-  W6X_HTTP_Status_Category_e http_category = HTTP_CATEGORY_UNKNOWN;
-  char *content_type = NULL;
-  uint16_t http_version = 0;
-  uint32_t offset = 0;
-  int8_t method;
-  /* SNI max size is used for hostname since it is the same information used
-   * in both instances and SNI is limited to 64 bytes on NCP */
-  char host_name[65] = {0};
-
-  if ((Obj->settings.server_name != NULL) && (strlen(Obj->settings.server_name) <= 64))
-  {
-    strncpy(host_name, Obj->settings.server_name, sizeof(host_name) - 1);
-  }
-  else
-  {
-    (void)W6X_Net_Inet_ntop(AF_INET, (void *) &Obj->server.u_addr.ip4, host_name, INET_ADDRSTRLEN);
-  }
+  W6X_HTTP_Client_t *client = NULL;
+  W6X_HTTP_Client_t *p;
+  uint8_t warm = 0;
 
-  switch (Obj->post_data.type)
+  if ((server_addr == NULL) || (settings == NULL))
   {
-    case W6X_HTTP_CONTENT_TYPE_PLAIN_TEXT:
-      content_type = "text/plain";
-      break;
-    case W6X_HTTP_CONTENT_TYPE_URL_ENCODED:
-      content_type = "application/x-www-form-urlencoded";
-      break;
-    case W6X_HTTP_CONTENT_TYPE_JSON:
-      content_type = "application/json";
-      break;
-    case W6X_HTTP_CONTENT_TYPE_XML:
-      content_type = "application/xml";
-      break;
-    case W6X_HTTP_CONTENT_TYPE_OCTET_STREAM:
-      content_type = "application/octet-stream";
-      break;
-    default:
-      content_type = "text/plain";
+    NET_LOG_ERROR("Server address and settings are required\n");
+    return NULL;
   }
 
-  if (strncmp(Obj->method, "HEAD", 4) == 0)
-  {
-    method = W6X_HTTP_REQ_TYPE_HEAD;
-    /* Get the length of the HTTP request */
-    req_len = strlen(HTTPC_REQ_HEAD_11) + strlen(Obj->uri) + strlen(W6X_HTTP_CLIENT_AGENT) + strlen(host_name);
-    /* Allocate dynamically the HTTP request based on previous result */
-    req_buffer = pvPortMalloc(req_len);
-    if (req_buffer == NULL)
-    {
-      goto _err;
-    }
-    /* Prepare send request */
-    req_len2 = snprintf((char *)req_buffer, req_len, HTTPC_REQ_HEAD_11_FORMAT(Obj->uri, host_name));
-  }
-  else if (strncmp(Obj->method, "GET", 3) == 0)
+  /* Claim an idle connection to the same server, else a free slot, else the least recently used idle one */
+  taskENTER_CRITICAL();
+  for (int32_t i = 0; i < W6X_HTTP_CLIENT_POOL_SIZE; i++)
   {
-    method = W6X_HTTP_REQ_TYPE_GET;
-    /* Get the length of the HTTP request */
-    req_len = strlen(HTTPC_REQ_11_HOST) + strlen(Obj->uri) + strlen(W6X_HTTP_CLIENT_AGENT) + strlen(host_name);
-    /* Allocate dynamically the HTTP request based on previous result */
-    req_buffer = pvPortMalloc(req_len);
-    if (req_buffer == NULL)
+    p = &http_pool[i];
+    if (p->in_use != 0)
     {
-      goto _err;
+      continue;
     }
-    /* Prepare send request */
-    req_len2 = snprintf((char *)req_buffer, req_len, HTTPC_REQ_11_HOST_FORMAT(Obj->uri, host_name));
-  }
-  else if (strncmp(Obj->method, "PUT", 3) == 0)
-  {
-    method = W6X_HTTP_REQ_TYPE_PUT;
-    /* Get the length of the HTTP request */
-    req_len = strlen(HTTPC_REQ_POST_PUT_11) + strlen(Obj->uri) + strlen(W6X_HTTP_CLIENT_AGENT)
-              + strlen(host_name) + Obj->post_data_len + strlen(content_type);
-    /* Allocate dynamically the HTTP request based on previous result */
-    req_buffer = pvPortMalloc(req_len);
-    if (req_buffer == NULL)
+    if ((p->connected != 0) && (p->port == port) &&
+        (p->server.u_addr.ip4.addr == server_addr->u_addr.ip4.addr) &&
+        (((p->settings.server_name == NULL) && (settings->server_name == NULL)) ||
+         ((p->settings.server_name != NULL) && (settings->server_name != NULL) &&
+          (strcmp(p->settings.server_name, settings->server_name) == 0))))
     {
-      goto _err;
+      client = p;
+      warm = 1;
+      break;
     }
-    /* Prepare send request */
-    req_len2 = snprintf((char *)req_buffer, req_len,
-                        HTTPC_REQ_PUT_11_FORMAT(Obj->uri, host_name, content_type,
-                                                Obj->post_data_len, (char *)Obj->post_data.data));
-  }
-  else if (strncmp(Obj->method, "POST", 4) == 0)
-  {
-    method = W6X_HTTP_REQ_TYPE_POST;
-    /* Get the length of the HTTP request */
-    req_len = strlen(HTTPC_REQ_POST_PUT_11) + strlen(Obj->uri) + strlen(W6X_HTTP_CLIENT_AGENT)
-              + strlen(host_name) + Obj->post_data_len + strlen(content_type);
-    /* Allocate dynamically the HTTP request based on previous result */
-    req_buffer = pvPortMalloc(req_len);
-    if (req_buffer == NULL)
+    if ((client == NULL) || ((client->connected != 0) &&
+                             ((p->connected == 0) || ((int32_t)(p->last_used - client->last_used) < 0))))
     {
-      goto _err;
+      client = p;
     }
-    /* Prepare send request */
-    req_len2 = snprintf((char *)req_buffer, req_len,
-                        HTTPC_REQ_POST_11_FORMAT(Obj->uri, host_name, content_type,
-                                                 Obj->post_data_len, (char *)Obj->post_data.data));
   }
-  else
+  if (client != NULL)
   {
-    NET_LOG_ERROR("Unknown Request type\n");
-    goto _err;
+    client->in_use = 1;
   }
+  taskEXIT_CRITICAL();
 
-  if ((req_len2 <= 0) || (req_len2 > req_len))
+  if (client == NULL)
   {
-    vPortFree(req_buffer);
-    goto _err;
+    NET_LOG_ERROR("No HTTP connection available in the pool\n");
+    return NULL;
   }
 
-  NET_LOG_DEBUG("Sending HTTP request, request size: (%" PRIi32 ")\n", req_len2);
-
-  /* We only use the variable for a pointer copy temporarily, limited to this scope*/
+  if ((warm == 1) && (W6X_HTTP_Client_Is_Alive(client) == 1))
   {
-    /* Save the pointer of the request buffer for any free later on.
-     * Original request buffer pointer will be incremented possibly */
-    uint8_t *data = req_buffer;
-    do
-    {
-      /* Send the HTTP request to the HTTP server via the TCP socket */
-      bytes_sent = W6X_Net_Send(Obj->sock, data, req_len2, 0);
-      if (bytes_sent < 0)
-      {
-        NET_LOG_ERROR("Failed to send data to tcp server (%" PRIi32 "), try again\n", bytes_sent);
-        vPortFree(req_buffer);
-        goto _err;
-      }
-      req_len2 -= bytes_sent;
-      data += bytes_sent;
-    } while (req_len2 > 0);
-
-    vPortFree(req_buffer);
+    /* Keep the socket, only the callbacks may change between the users */
+    client->settings.headers_done_fn = settings->headers_done_fn;
+    client->settings.result_fn = settings->result_fn;
+    client->settings.callback_arg = settings->callback_arg;
+    client->settings.recv_fn = settings->recv_fn;
+    client->settings.recv_fn_arg = settings->recv_fn_arg;
+    NET_LOG_DEBUG("Reusing HTTP connection on socket %" PRIi32 "\n", client->sock);
+    return client;
   }
-  vTaskDelay(100);
-  http_buffer.data = pvPortMalloc(W6X_HTTP_CLIENT_MAX_DATA_SEND_BUFFER_SIZE + 1);
-  if (http_buffer.data == NULL)
+
+  W6X_HTTP_Client_Disconnect(client);
+  vPortFree(client->settings.server_name);
+  client->settings.server_name = NULL;
+  if ((W6X_HTTP_Client_Setup(client, server_addr, port, settings) != W6X_STATUS_OK) ||
+      (W6X_HTTP_Client_Connect(client) != W6X_STATUS_OK))
   {
-    goto _err;
+    client->in_use = 0;
+    return NULL;
   }
+  return client;
+}
+
+W6X_Status_t W6X_HTTP_Client_Send(W6X_HTTP_Client_t *client, const char *method, const char *uri,
+                                  const W6X_HTTP_Post_Data_t *post_data, size_t post_data_len)
+{
+  int8_t method_type;
+  NULL_ASSERT(client, W6X_Obj_Null_str);
+  NULL_ASSERT(uri, W6X_Obj_Null_str);
 
-  memset(http_buffer.data, 0x00, W6X_HTTP_CLIENT_MAX_DATA_SEND_BUFFER_SIZE + 1);
-  /* Wait to receive an answer to the HTTP request sent */
-  if (W6X_STATUS_OK != W6X_HTTP_Client_Wait_For_Header(Obj->sock, &http_buffer, &offset))
+  method_type = W6X_HTTP_Get_Method(method);
+  if (method_type < 0)
   {
-    NET_LOG_ERROR("Get HTTP header failed\n");
-    vPortFree(http_buffer.data);
-    goto _err;
+    NET_LOG_ERROR("Unknown Request type\n");
+    return W6X_STATUS_ERROR;
   }
-
-  /* Parse the HTTP response status */
-  if (W6X_HTTP_Parse_Response_Status(http_buffer.data, &http_version, &http_status) != W6X_STATUS_OK)
+  if (client->pending >= W6X_HTTP_CLIENT_PIPELINE_DEPTH)
   {
-    NET_LOG_ERROR("Parse of HTTP response status failed\n");
-    vPortFree(http_buffer.data);
-    goto _err;
+    NET_LOG_ERROR("Too many requests pending on the HTTP connection\n");
+    return W6X_STATUS_ERROR;
+  }
+  if ((client->pending > 0) && (client->persistent == 0))
+  {
+    /* An HTTP/1.0 server closes the connection after the first response and drops the next requests */
+    return W6X_STATUS_BUSY;
   }
 
-  /* Get the returned status category and check if it is a success. Only support 200 OK currently */
-  (void)W6X_HTTP_Get_Status_Category(http_status, &http_category);
-
-  /* Parse the content length field of the HTTP response to know how much body content to expect.
-     If a body is not expected, set the content length value to 0 */
-  if (method == W6X_HTTP_REQ_TYPE_GET)
+  /* The server closed the connection after the previous response: open a new one */
+  if (client->connected == 0)
   {
-    if (W6X_HTTP_Parse_Content_Length(http_buffer.data, &content_length) != W6X_STATUS_OK)
+    if (W6X_HTTP_Client_Connect(client) != W6X_STATUS_OK)
     {
-      NET_LOG_DEBUG("Content Length tag not found in header\n");
+      return W6X_STATUS_ERROR;
     }
   }
-
-  if (Obj->settings.headers_done_fn)
+  else if (client->keep_alive == 0)
   {
-    Obj->settings.headers_done_fn(NULL, Obj->settings.callback_arg, http_buffer.data,
-                                  offset, content_length);
+    NET_LOG_ERROR("HTTP connection is closing, wait for the pending responses\n");
+    return W6X_STATUS_ERROR;
   }
 
-  if (Obj->settings.result_fn)
+  if (W6X_HTTP_Client_Write_Request(client, method_type, uri, post_data, post_data_len, 1) != W6X_STATUS_OK)
   {
-    Obj->settings.result_fn(Obj->settings.callback_arg, http_status, content_length, 0, 0);
+    W6X_HTTP_Client_Disconnect(client);
+    return W6X_STATUS_ERROR;
   }
+  client->methods[client->pending] = (uint8_t)method_type;
+  client->pending++;
+  return W6X_STATUS_OK;
+}
 
-  /* If an error occurred, No need to read data, but status code must be returned */
-  if (http_category >= HTTP_CATEGORY_CLIENT_ERROR)
+W6X_Status_t W6X_HTTP_Client_Receive(W6X_HTTP_Client_t *client, W6X_HTTP_Status_Code_e *http_status)
+{
+  W6X_HTTP_Status_Code_e status = HTTP_VERSION_NOT_SUPPORTED;
+  NULL_ASSERT(client, W6X_Obj_Null_str);
+
+  if ((client->connected == 0) || (client->pending == 0))
   {
-    NET_LOG_ERROR("W6X_HTTP_Client_Get_Status_Category failed\n");
-    vPortFree(http_buffer.data);
-    goto _err;
+    NET_LOG_ERROR("No HTTP request pending on the connection\n");
+    return W6X_STATUS_ERROR;
   }
 
-  if (offset > 0)
+  if (W6X_HTTP_Client_Read_Response(client, &status) != W6X_STATUS_OK)
+  {
+    W6X_HTTP_Client_Disconnect(client);
+    return W6X_STATUS_ERROR;
+  }
+  if (http_status != NULL)
   {
-    http_buffer.length -= offset;
-    memcpy(http_buffer.data, &http_buffer.data[offset], http_buffer.length);
-    http_buffer.data[http_buffer.length] = 0;
+    *http_status = status;
   }
 
-  if (http_buffer.length == 0)
+  /* The server closes the connection after this response, the next request opens a new one */
+  if ((client->keep_alive == 0) && (client->pending == 0))
   {
-    http_buffer.length = W6X_Net_Recv(Obj->sock, http_buffer.data, W6X_HTTP_CLIENT_DATA_RECV_SIZE, 0);
+    W6X_HTTP_Client_Disconnect(client);
   }
+  return W6X_STATUS_OK;
+}
+
+W6X_Status_t W6X_HTTP_Client_Release(W6X_HTTP_Client_t *client)
+{
+  NULL_ASSERT(client, W6X_Obj_Null_str);
 
-  while (http_buffer.length > 0)
+  /* The unread responses would be taken for the ones of the next user */
+  if ((client->pending > 0) || (client->keep_alive == 0))
   {
-    total_recv_data += http_buffer.length;
-    /* Pass Data to callback if not NULL */
-    if ((Obj->settings.recv_fn) && (Obj->settings.recv_fn(Obj->settings.recv_fn_arg, &http_buffer, 0) < 0))
-    {
-      NET_LOG_ERROR("User function for received data processing returned an error");
-      break;
-    }
-    if ((content_length > 0) && (total_recv_data >= content_length))
-    {
-      break;
-    }
-    memset(http_buffer.data, 0, W6X_HTTP_CLIENT_DATA_RECV_SIZE);
-    http_buffer.length = W6X_Net_Recv(Obj->sock, http_buffer.data, W6X_HTTP_CLIENT_DATA_RECV_SIZE, 0);
+    W6X_HTTP_Client_Disconnect(client);
   }
+  client->settings.headers_done_fn = NULL;
+  client->settings.result_fn = NULL;
+  client->settings.callback_arg = NULL;
+  client->settings.recv_fn = NULL;
+  client->settings.recv_fn_arg = NULL;
+  client->last_used = xTaskGetTickCount();
+  client->in_use = 0;
+  return W6X_STATUS_OK;
+}
 
-  vPortFree(http_buffer.data);
-  error = 0;
+W6X_Status_t W6X_HTTP_Client_FlushPool(void)
+{
+  W6X_HTTP_Client_t *client;
 
-_err:
-  if (error != 0)
+  for (int32_t i = 0; i < W6X_HTTP_CLIENT_POOL_SIZE; i++)
   {
-    if (Obj->settings.result_fn)
+    client = &http_pool[i];
+    taskENTER_CRITICAL();
+    if (client->in_use != 0)
     {
-      Obj->settings.result_fn(Obj->settings.callback_arg, http_status, 0, 0, -1);
+      client = NULL;
     }
-    if ((Obj->settings.recv_fn))
+    else
     {
-      Obj->settings.recv_fn(Obj->settings.callback_arg, NULL, -1);
+      client->in_use = 1;
+    }
+    taskEXIT_CRITICAL();
+    if (client != NULL)
+    {
+      W6X_HTTP_Client_Disconnect(client);
+      client->in_use = 0;
     }
   }
-  W6X_Net_TLS_Credential_Delete(Obj->sock, W6X_NET_TLS_CREDENTIAL_CA_CERTIFICATE);
-  W6X_Net_Close(Obj->sock);
-  if (Obj->settings.server_name != NULL)
-  {
-    vPortFree(Obj->settings.server_name);
-  }
-  vPortFree(Obj->post_data.data);
-  vPortFree(Obj->uri);
-  vPortFree(Obj);
-  vTaskDelete(NULL);
+  return W6X_STATUS_OK;
 }
 
-static W6X_Status_t W6X_HTTP_Parse_Content_Length(const uint8_t *buffer, uint32_t *content_length)
+W6X_Status_t W6X_HTTP_Client_GetPoolStats(uint32_t *Connects, uint32_t *Requests)
 {
-  W6X_Status_t ret = W6X_STATUS_ERROR;
-  uint8_t *content_len_hdr;
-  uint32_t rx_data_len;
-  uint8_t *endptr;
-  NULL_ASSERT(buffer, W6X_Obj_Null_str);
+  NULL_ASSERT(Connects, W6X_Obj_Null_str);
+  NULL_ASSERT(Requests, W6X_Obj_Null_str);
+
+  *Connects = http_pool_connects;
+  *Requests = http_pool_requests;
+  return W6X_STATUS_OK;
+}
+
+/* Private Functions Definition ----------------------------------------------*/
+/** @addtogroup ST67W6X_Private_HTTP_Functions
+  * @{
+  */
 
-  /* Look for the Content-Length header field */
-  content_len_hdr = (uint8_t *)strstr((const char *)buffer, "Content-Length: ");
-  if (content_len_hdr == NULL)
+static void W6X_HTTP_Client_task(void *arg)
+{
+  struct http_request_task_obj *Obj = (struct http_request_task_obj *) arg;
+  W6X_HTTP_Client_t *client = Obj->client;
+  int32_t error = -1;
+  W6X_HTTP_Status_Code_e http_status = HTTP_VERSION_NOT_SUPPORTED;
+  W6X_HTTP_Status_Category_e http_category = HTTP_CATEGORY_UNKNOWN;
+  int8_t method;
+
+  method = W6X_HTTP_Get_Method(Obj->method);
+  if (method < 0)
   {
+    NET_LOG_ERROR("Unknown Request type\n");
     goto _err;
   }
-  content_len_hdr += 16; /* Move past "Content-Length: " */
 
-  /* Parse content len value */
-  rx_data_len = strtol((char *)content_len_hdr, (char **)&endptr, 10);
-  if ((endptr == content_len_hdr) || (*endptr != '\r'))
+  if (W6X_HTTP_Client_Write_Request(client, method, Obj->uri, &Obj->post_data, Obj->post_data_len, 0) != W6X_STATUS_OK)
   {
     goto _err;
   }
-  *content_length = rx_data_len;
-  ret = W6X_STATUS_OK;
+  client->methods[0] = (uint8_t)method;
+  client->pending = 1;
+
+  if (W6X_HTTP_Client_Read_Response(client, &http_status) != W6X_STATUS_OK)
+  {
+    goto _err;
+  }
+
+  /* Get the returned status category and check if it is a success. Only support 200 OK currently */
+  (void)W6X_HTTP_Get_Status_Category(http_status, &http_category);
+
+  /* If an error occurred, status code must be returned */
+  if (http_category >= HTTP_CATEGORY_CLIENT_ERROR)
+  {
+    NET_LOG_ERROR("W6X_HTTP_Client_Get_Status_Category failed\n");
+    goto _err;
+  }
+  error = 0;
 
 _err:
-  return ret;
+  if (error != 0)
+  {
+    if (client->settings.result_fn)
+    {
+      client->settings.result_fn(client->settings.callback_arg, http_status, 0, 0, -1);
+    }
+    if ((client->settings.recv_fn))
+    {
+      client->settings.recv_fn(client->settings.callback_arg, NULL, -1);
+    }
+  }
+  W6X_HTTP_Client_Disconnect(client);
+  vPortFree(client->settings.server_name);
+  vPortFree(client);
+  vPortFree(Obj->post_data.data);
+  vPortFree(Obj->uri);
+  vPortFree(Obj);
+  vTaskDelete(NULL);
 }
 
-static W6X_Status_t W6X_HTTP_Parse_Response_Status(const uint8_t *buffer, uint16_t *http_version,
-                                                   W6X_HTTP_Status_Code_e *http_status)
+static W6X_Status_t W6X_HTTP_Client_Setup(W6X_HTTP_Client_t *client, const ip_addr_t *server_addr, uint16_t port,
+                                         const W6X_HTTP_connection_t *settings)
 {
-  W6X_Status_t ret = W6X_STATUS_ERROR;
-  uint8_t *space1;
-  NULL_ASSERT(buffer, W6X_Obj_Null_str);
+  memcpy(&client->server, server_addr, sizeof(ip_addr_t));
+  client->port = port;
+  memcpy(&client->settings, settings, sizeof(W6X_HTTP_connection_t));
 
-  /* Look for the end of the header */
-  if ((uint8_t *)strstr((char *)buffer, "\r\n\r\n") == NULL)
+  if (settings->server_name != NULL)
   {
+    client->settings.server_name = pvPortMalloc(strlen(settings->server_name) + 1);
+    if (client->settings.server_name == NULL)
+    {
+      NET_LOG_ERROR("Callback structure allocation failed\n");
+      return W6X_STATUS_ERROR;
+    }
+    strncpy(client->settings.server_name, settings->server_name, strlen(settings->server_name));
+    client->settings.server_name[strlen(settings->server_name)] = 0;
+  }
+
+  /* SNI max size is used for hostname since it is the same information used
+   * in both instances and SNI is limited to 64 bytes on NCP */
+  memset(client->host_name, 0, sizeof(client->host_name));
+  if ((client->settings.server_name != NULL) && (strlen(client->settings.server_name) <= 64))
+  {
+    strncpy(client->host_name, client->settings.server_name, sizeof(client->host_name) - 1);
+  }
+  else
+  {
+    (void)W6X_Net_Inet_ntop(AF_INET, (void *) &client->server.u_addr.ip4, client->host_name, INET_ADDRSTRLEN);
+  }
+  return W6X_STATUS_OK;
+}
+
+static W6X_Status_t W6X_HTTP_Client_Connect(W6X_HTTP_Client_t *client)
+{
+  int32_t sock;
+  struct sockaddr_in addr = {0};
+  uint8_t sec_tag_list[] = { 0 };
+  W6X_HTTP_connection_t *settings = &client->settings;
+
+  /* Create a TCP socket  if the port is not 443 which is used for https */
+  if (client->port != 443)
+  {
+    sock = W6X_Net_Socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0)
+    {
+      NET_LOG_ERROR("Socket creation failed\n");
+      return W6X_STATUS_ERROR;
+    }
+  }
+  else
+  {
+    sock = W6X_Net_Socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+    if (sock < 0)
+    {
+      NET_LOG_ERROR("Socket creation failed\n");
+      return W6X_STATUS_ERROR;
+    }
+
+    /** Use a tag that has the value of the socket id to be able to run multiple
+      * without waiting for the previous to end */
+    if (settings->https_certificate.name != NULL)
+    {
+      sec_tag_list[0] = sock;
+      if (settings->https_certificate.content == NULL)
+      {
+        if (W6X_Net_TLS_Credential_AddByName(sec_tag_list[0], W6X_NET_TLS_CREDENTIAL_CA_CERTIFICATE,
+                                             settings->https_certificate.name) != 0)
+        {
+          NET_LOG_ERROR("Socket creation failed\n");
+          W6X_Net_Close(sock);
+          return W6X_STATUS_ERROR;
+        }
+      }
+      else
+      {
+        if (W6X_Net_TLS_Credential_AddByContent(sec_tag_list[0], W6X_NET_TLS_CREDENTIAL_CA_CERTIFICATE,
+                                                settings->https_certificate.name,
+                                                settings->https_certificate.content,
+                                                strlen(settings->https_certificate.content)) != 0)
+        {
+          NET_LOG_ERROR("Socket creation failed\n");
+          W6X_Net_Close(sock);
+          return W6X_STATUS_ERROR;
+        }
+      }
+
+      if (W6X_Net_Setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tag_list, sizeof(sec_tag_list)) != 0)
+      {
+        NET_LOG_ERROR("Set socket option failed\n");
+        goto _err;
+      }
+    }
+
+    NET_LOG_DEBUG("Socket option set\n");
+
+    if (W6X_Net_Setsockopt(sock, SOL_TLS, TLS_ALPN_LIST, alpn_list, 2) != 0)
+    {
+      NET_LOG_ERROR("Set ALPN failed\n");
+      goto _err;
+    }
+
+    NET_LOG_DEBUG("ALPN set\n");
+
+    if (W6X_Net_Setsockopt(sock, SOL_TLS, TLS_HOSTNAME, settings->server_name, strlen(settings->server_name)) != 0)
+    {
+      NET_LOG_ERROR("Set SNI failed\n");
+      goto _err;
+    }
+
+    NET_LOG_DEBUG("SNI set\n");
+  }
+
+  NET_LOG_DEBUG("Socket creation done\n");
+  /* Configure receive data timeout for the TCP socket */
+  if (0 != W6X_Net_Setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)))
+  {
+    NET_LOG_ERROR("Socket set timeout option failed\n");
     goto _err;
   }
 
-  space1 = (uint8_t *)strstr((char *)buffer, " ");
-  if (space1 == NULL)
+  /* Configure the socket receive buffer size */
+  if (0 != W6X_Net_Setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &optval, sizeof(optval)))
   {
+    NET_LOG_ERROR("Socket set receive buff option failed\n");
     goto _err;
   }
-  space1++; /* Move past the first space */
 
-  if ((strncmp((char *)buffer, "HTTP/", 5) == 0) && (buffer[6] == '.'))
+  /* Pull each response slice as soon as it is notified, whatever the default receive mode */
+  if (0 != W6X_Net_Setsockopt(sock, SOL_SOCKET, SO_RCVMODE, &recv_mode, sizeof(recv_mode)))
   {
-    uint8_t *endptr;
-    uint32_t rx_data_len;
-    uint32_t status;
-    /* Parse http version */
-    uint16_t version = buffer[5] - '0';
-    version <<= 8;
-    version |= buffer[7] - '0';
-    *http_version = version;
+    NET_LOG_ERROR("Socket set receive mode option failed\n");
+    goto _err;
+  }
+
+  /* Supports only IPv4 without DNS */
+  addr.sin_family = AF_INET;
+  addr.sin_port = PP_HTONS(client->port);
+  addr.sin_addr.s_addr = client->server.u_addr.ip4.addr;
+  if (0 != W6X_Net_Connect(sock, (struct sockaddr *)&addr, sizeof(addr)))
+  {
+    NET_LOG_ERROR("Socket connection failed\n");
+    goto _err;
+  }
+
+  client->buffer = pvPortMalloc(W6X_HTTP_CLIENT_MAX_DATA_SEND_BUFFER_SIZE + 1);
+  if (client->buffer == NULL)
+  {
+    NET_LOG_ERROR("Response buffer allocation failed\n");
+    goto _err;
+  }
+
+  NET_LOG_DEBUG("Socket %" PRIi32 " connected\n", sock);
+  client->sock = sock;
+  client->connected = 1;
+  client->keep_alive = 1;
+  client->persistent = 0;
+  client->pending = 0;
+  client->buffer_len = 0;
+  http_pool_connects++;
+  return W6X_STATUS_OK;
+
+_err:
+  W6X_Net_TLS_Credential_Delete(sock, W6X_NET_TLS_CREDENTIAL_CA_CERTIFICATE);
+  W6X_Net_Close(sock);
+  return W6X_STATUS_ERROR;
+}
+
+static void W6X_HTTP_Client_Disconnect(W6X_HTTP_Client_t *client)
+{
+  if (client->connected != 0)
+  {
+    W6X_Net_TLS_Credential_Delete(client->sock, W6X_NET_TLS_CREDENTIAL_CA_CERTIFICATE);
+    W6X_Net_Close(client->sock);
+    NET_LOG_DEBUG("Socket %" PRIi32 " closed\n", client->sock);
+  }
+  vPortFree(client->buffer);
+  client->buffer = NULL;
+  client->buffer_len = 0;
+  client->connected = 0;
+  client->pending = 0;
+}
+
+static int32_t W6X_HTTP_Client_Is_Alive(W6X_HTTP_Client_t *client)
+{
+  W6X_Net_Pollfd_t pfd = {0};
+
+  if ((xTaskGetTickCount() - client->last_used) > pdMS_TO_TICKS(W6X_HTTP_CLIENT_POOL_IDLE_TIMEOUT))
+  {
+    return 0;
+  }
+
+  /* An idle connection has nothing to read: data or an error means the server is closing it */
+  pfd.fd = client->sock;
+  pfd.events = W6X_NET_POLLIN;
+  if ((W6X_Net_Poll(&pfd, 1, 0) != 0) || (client->buffer_len > 0))
+  {
+    return 0;
+  }
+  return 1;
+}
 
-    /* Parse HTTP status number */
-    rx_data_len = strtol((char *)space1, (char **)&endptr, 10);
-    if ((endptr == space1) || (*endptr != ' '))
+static W6X_Status_t W6X_HTTP_Client_Write_Request(W6X_HTTP_Client_t *client, int8_t method, const char *uri,
+                                                  const W6X_HTTP_Post_Data_t *post_data, size_t post_data_len,
+                                                  uint8_t keep_alive)
+{
+  W6X_Status_t ret = W6X_STATUS_ERROR;
+  int32_t req_len;
+  int32_t req_len2 = 0;
+  int32_t bytes_sent;
+  uint8_t *req_buffer = NULL;
+  uint8_t *data;
+  char *content_type = "text/plain";
+  const char *connection = (keep_alive == 1) ? W6X_HTTP_CLIENT_CONNECTION_KEEP_ALIVE :
+                           W6X_HTTP_CLIENT_CONNECTION_CLOSE;
+
+  if ((post_data == NULL) || (post_data->data == NULL))
+  {
+    post_data_len = 0;
+  }
+  else
+  {
+    switch (post_data->type)
     {
-      goto _err;
+      case W6X_HTTP_CONTENT_TYPE_PLAIN_TEXT:
+        content_type = "text/plain";
+        break;
+      case W6X_HTTP_CONTENT_TYPE_URL_ENCODED:
+        content_type = "application/x-www-form-urlencoded";
+        break;
+      case W6X_HTTP_CONTENT_TYPE_JSON:
+        content_type = "application/json";
+        break;
+      case W6X_HTTP_CONTENT_TYPE_XML:
+        content_type = "application/xml";
+        break;
+      case W6X_HTTP_CONTENT_TYPE_OCTET_STREAM:
+        content_type = "application/octet-stream";
+        break;
+      default:
+        content_type = "text/plain";
     }
-    status = rx_data_len;
-    if ((status > 0) && (status <= 0xFFFF))
+  }
+
+  /* Get the length of the HTTP request, the longest format is the POST/PUT one */
+  req_len = strlen(HTTPC_REQ_POST_PUT_11) + strlen(uri) + strlen(W6X_HTTP_CLIENT_AGENT) + strlen(client->host_name)
+            + strlen(content_type) + W6X_HTTP_CLIENT_CONTENT_LENGTH_DIGITS + strlen(connection) + post_data_len;
+  /* Allocate dynamically the HTTP request based on previous result */
+  req_buffer = pvPortMalloc(req_len);
+  if (req_buffer == NULL)
+  {
+    return W6X_STATUS_ERROR;
+  }
+
+  /* Prepare send request */
+  switch (method)
+  {
+    case W6X_HTTP_REQ_TYPE_HEAD:
+      req_len2 = snprintf((char *)req_buffer, req_len, HTTPC_REQ_HEAD_11_FORMAT(uri, client->host_name, connection));
+      break;
+    case W6X_HTTP_REQ_TYPE_GET:
+      req_len2 = snprintf((char *)req_buffer, req_len, HTTPC_REQ_11_HOST_FORMAT(uri, client->host_name, connection));
+      break;
+    case W6X_HTTP_REQ_TYPE_PUT:
+      req_len2 = snprintf((char *)req_buffer, req_len,
+                          HTTPC_REQ_PUT_11_FORMAT(uri, client->host_name, content_type,
+                                                  (uint32_t)post_data_len, connection));
+      break;
+    case W6X_HTTP_REQ_TYPE_POST:
+      req_len2 = snprintf((char *)req_buffer, req_len,
+                          HTTPC_REQ_POST_11_FORMAT(uri, client->host_name, content_type,
+                                                   (uint32_t)post_data_len, connection));
+      break;
+    default:
+      NET_LOG_ERROR("Unknown Request type\n");
+      goto _err;
+  }
+
+  if ((req_len2 <= 0) || ((req_len2 + (int32_t)post_data_len) > req_len))
+  {
+    goto _err;
+  }
+  if ((method == W6X_HTTP_REQ_TYPE_PUT) || (method == W6X_HTTP_REQ_TYPE_POST))
+  {
+    /* The body goes in the same send as the header */
+    if (post_data_len > 0)
     {
-      *http_status = (W6X_HTTP_Status_Code_e)status;
-      ret = W6X_STATUS_OK;
+      memcpy(&req_buffer[req_len2], post_data->data, post_data_len);
     }
+    req_len2 += (int32_t)post_data_len;
   }
 
+  NET_LOG_DEBUG("Sending HTTP request, request size: (%" PRIi32 ")\n", req_len2);
+
+  data = req_buffer;
+  do
+  {
+    /* Send the HTTP request to the HTTP server via the TCP socket */
+    bytes_sent = W6X_Net_Send(client->sock, data, req_len2, 0);
+    if (bytes_sent < 0)
+    {
+      NET_LOG_ERROR("Failed to send data to tcp server (%" PRIi32 ")\n", bytes_sent);
+      goto _err;
+    }
+    req_len2 -= bytes_sent;
+    data += bytes_sent;
+  } while (req_len2 > 0);
+
+  http_pool_requests++;
+  ret = W6X_STATUS_OK;
+
 _err:
+  vPortFree(req_buffer);
   return ret;
 }
 
+static W6X_Status_t W6X_HTTP_Client_Read_Response(W6X_HTTP_Client_t *client, W6X_HTTP_Status_Code_e *http_status)
+{
+  W6X_HTTP_Parser_t parser;
+  struct http_response_obj response;
+  uint32_t start = 0;
+  uint32_t end = client->buffer_len;
+  uint32_t length;
+  int32_t ret;
+  TickType_t last_rx;
+  uint8_t method = client->methods[0];
+
+  /* Pop the method of the oldest pending request */
+  client->pending--;
+  memmove(&client->methods[0], &client->methods[1], client->pending);
+
+  response.client = client;
+  response.status = (W6X_HTTP_Status_Code_e)0;
+  response.deliver = 0;
+  W6X_HTTP_Parser_Init(&parser, (method == W6X_HTTP_REQ_TYPE_HEAD) ? W6X_HTTP_PARSER_FLAG_NO_BODY : 0,
+                       W6X_HTTP_Client_Headers_cb, W6X_HTTP_Client_Body_cb, &response);
+  client->buffer_len = 0;
+  client->buffer[end] = 0;
+
+  /* Feed the parser with the bytes kept from the previous response, then with each slice as soon as it is
+     notified. Each receive blocks on the data notification of the socket, up to the socket timeout */
+  last_rx = xTaskGetTickCount();
+  while (1)
+  {
+    ret = W6X_HTTP_Parser_Execute(&parser, &client->buffer[start], end - start);
+    if (ret < 0)
+    {
+      NET_LOG_ERROR("Parse of HTTP response failed\n");
+      client->keep_alive = 0;
+      return W6X_STATUS_ERROR;
+    }
+    start += (uint32_t)ret;
+    if ((parser.state & W6X_HTTP_PARSER_STATE_MASK) == W6X_HTTP_PARSER_STATE_COMPLETE)
+    {
+      break;
+    }
+
+    if ((parser.state & W6X_HTTP_PARSER_STATE_MASK) == W6X_HTTP_PARSER_STATE_HEADER)
+    {
+      /* The header is kept contiguous for the headers done callback */
+      if (end >= W6X_HTTP_CLIENT_HEAD_MAX_RESP_BUFFER_SIZE)
+      {
+        NET_LOG_ERROR("Failed to receive HTTP headers\n");
+        client->keep_alive = 0;
+        return W6X_STATUS_ERROR;
+      }
+      length = W6X_HTTP_CLIENT_HEAD_MAX_RESP_BUFFER_SIZE - end;
+    }
+    else
+    {
+      /* Read at most the rest of a body with a known length so that the next response stays in the socket */
+      length = W6X_HTTP_CLIENT_DATA_RECV_SIZE;
+      if (((parser.flags & W6X_HTTP_PARSER_FLAG_LENGTH) != 0) && (parser.remaining < length))
+      {
+        length = parser.remaining;
+      }
+      start = 0;
+      end = 0;
+    }
+
+    ret = W6X_Net_Recv(client->sock, &client->buffer[end], length, 0);
+    if (ret > 0)
+    {
+      end += (uint32_t)ret;
+      client->buffer[end] = 0;
+      last_rx = xTaskGetTickCount();
+      continue;
+    }
+    if ((ret == 0) && ((xTaskGetTickCount() - last_rx) < pdMS_TO_TICKS(W6X_HTTP_CLIENT_RESPONSE_TIMEOUT)))
+    {
+      continue;
+    }
+
+    /* Connection closed or server silent: only a body delimited by the end of the connection is complete */
+    if (W6X_HTTP_Parser_Finish(&parser) == 0)
+    {
+      break;
+    }
+    NET_LOG_ERROR("Connection ended before the end of the HTTP response\n");
+    client->keep_alive = 0;
+    return W6X_STATUS_ERROR;
+  }
+
+  /* Move the start of the next pipelined response to the beginning of the buffer */
+  client->keep_alive &= (uint8_t)W6X_HTTP_Parser_Keep_Alive(&parser);
+  client->persistent = client->keep_alive;
+  if ((client->keep_alive == 1) && (end > start))
+  {
+    client->buffer_len = end - start;
+    memmove(client->buffer, &client->buffer[start], client->buffer_len);
+  }
+  *http_status = response.status;
+  return W6X_STATUS_OK;
+}
+
+static int8_t W6X_HTTP_Get_Method(const char *method)
+{
+  if (method == NULL)
+  {
+    return -1;
+  }
+  if (strncmp(method, "HEAD", 4) == 0)
+  {
+    return W6X_HTTP_REQ_TYPE_HEAD;
+  }
+  if (strncmp(method, "GET", 3) == 0)
+  {
+    return W6X_HTTP_REQ_TYPE_GET;
+  }
+  if (strncmp(method, "PUT", 3) == 0)
+  {
+    return W6X_HTTP_REQ_TYPE_PUT;
+  }
+  if (strncmp(method, "POST", 4) == 0)
+  {
+    return W6X_HTTP_REQ_TYPE_POST;
+  }
+  return -1;
+}
+
 static W6X_Status_t W6X_HTTP_Get_Status_Category(W6X_HTTP_Status_Code_e status, W6X_HTTP_Status_Category_e *category)
 {
   switch (status / 100)
@@ -892,51 +1252,51 @@ static W6X_Status_t W6X_HTTP_Get_Status_Category(W6X_HTTP_Status_Code_e status,
   return W6X_STATUS_OK;
 }
 
-static W6X_Status_t W6X_HTTP_Client_Wait_For_Header(int32_t sock, W6X_HTTP_buffer_t *buffer,
-                                                    uint32_t *body_start_offset)
+static int32_t W6X_HTTP_Client_Headers_cb(void *arg, const W6X_HTTP_Parser_t *parser)
 {
-  W6X_Status_t ret = W6X_STATUS_ERROR;
-  uint8_t header_received = 0;
-  int32_t data_received = 0;
-  uint32_t total_data_received = 0;
-  uint8_t *header_end;
-  NULL_ASSERT(buffer, W6X_Obj_Null_str);
-  /* Read the headers */
-  do
-  {
-    data_received = W6X_Net_Recv(sock, &buffer->data[total_data_received],
-                                 W6X_HTTP_CLIENT_HEAD_MAX_RESP_BUFFER_SIZE - total_data_received, 0);
-    if (data_received < 0)
-    {
-      NET_LOG_ERROR("Receive failed with %" PRIi32 "\n", data_received);
-      goto _err;
-    }
+  struct http_response_obj *response = (struct http_response_obj *)arg;
+  W6X_HTTP_Client_t *client = response->client;
+  W6X_HTTP_Status_Category_e http_category = HTTP_CATEGORY_UNKNOWN;
 
-    total_data_received += data_received;
+  response->status = (W6X_HTTP_Status_Code_e)parser->status;
+  (void)W6X_HTTP_Get_Status_Category(response->status, &http_category);
 
-    /* Look for the end of the headers */
-    header_end = (uint8_t *) strstr((char *)buffer->data, "\r\n\r\n");
-    if (header_end != NULL)
-    {
-      header_received = 1;
-      header_end += 4U; /** + 4U to go past the "\r\n\r\n" termination */
+  /* The body of an error response is read to keep the connection usable, but not passed on */
+  response->deliver = (http_category >= HTTP_CATEGORY_CLIENT_ERROR) ? 0 : 1;
 
-      /** Copy body content to the provided buffer */
-      *body_start_offset = (uint32_t)(header_end - &buffer->data[0]);
-      break;
-    }
-  } while (!header_received && (total_data_received < W6X_HTTP_CLIENT_HEAD_MAX_RESP_BUFFER_SIZE));
-  buffer->length = total_data_received;
-  if (!header_received)
+  if (client->settings.headers_done_fn)
   {
-    NET_LOG_ERROR("Failed to receive HTTP headers\n");
-    goto _err;
+    client->settings.headers_done_fn(NULL, client->settings.callback_arg, client->buffer,
+                                     parser->header_len, parser->content_length);
   }
 
-  ret = W6X_STATUS_OK;
+  if (client->settings.result_fn)
+  {
+    client->settings.result_fn(client->settings.callback_arg, response->status, parser->content_length, 0, 0);
+  }
+  return 0;
+}
 
-_err:
-  return ret;
+static int32_t W6X_HTTP_Client_Body_cb(void *arg, const uint8_t *data, uint32_t len)
+{
+  struct http_response_obj *response = (struct http_response_obj *)arg;
+  W6X_HTTP_Client_t *client = response->client;
+  W6X_HTTP_buffer_t http_buffer;
+
+  if ((response->deliver == 0) || (client->settings.recv_fn == NULL))
+  {
+    return 0;
+  }
+
+  /* Pass the data in place to the callback */
+  http_buffer.data = (uint8_t *)data;
+  http_buffer.length = (int32_t)len;
+  if (client->settings.recv_fn(client->settings.recv_fn_arg, &http_buffer, 0) < 0)
+  {
+    NET_LOG_ERROR("User function for received data processing returned an error");
+    return -1;
+  }
+  return 0;
 }
 
 /** @} */
@@ -0,0 +1,603 @@
+/**
+  ******************************************************************************
+  * @file    w6x_http_parser.c
+  * @author  GPM Application Team
+  * @brief   This file provides code for the incremental HTTP response parser
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*
+ * The parser is a byte driven state machine. It keeps no copy of the response, so it can be fed the
+ * slices returned by the socket as they come, and it has no dependency on the RTOS or on the network
+ * stack so that it can be built and exercised on a host.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "w6x_http_parser.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private defines -----------------------------------------------------------*/
+/** @addtogroup ST67W6X_Private_HTTP_Constants
+  * @{
+  */
+
+/* Header states */
+#define HP_START            (W6X_HTTP_PARSER_STATE_HEADER | 0x00U) /*!< Before the status line */
+#define HP_PROTOCOL         (W6X_HTTP_PARSER_STATE_HEADER | 0x01U) /*!< In "HTTP/" */
+#define HP_MAJOR            (W6X_HTTP_PARSER_STATE_HEADER | 0x02U) /*!< Major version digit */
+#define HP_DOT              (W6X_HTTP_PARSER_STATE_HEADER | 0x03U) /*!< Version dot */
+#define HP_MINOR            (W6X_HTTP_PARSER_STATE_HEADER | 0x04U) /*!< Minor version digit */
+#define HP_STATUS_SP        (W6X_HTTP_PARSER_STATE_HEADER | 0x05U) /*!< Space before the status code */
+#define HP_STATUS           (W6X_HTTP_PARSER_STATE_HEADER | 0x06U) /*!< Status code digits */
+#define HP_REASON           (W6X_HTTP_PARSER_STATE_HEADER | 0x07U) /*!< Reason phrase */
+#define HP_FIELD_START      (W6X_HTTP_PARSER_STATE_HEADER | 0x08U) /*!< Start of a header line */
+#define HP_FIELD            (W6X_HTTP_PARSER_STATE_HEADER | 0x09U) /*!< Field name */
+#define HP_VALUE            (W6X_HTTP_PARSER_STATE_HEADER | 0x0AU) /*!< Field value */
+#define HP_HEADER_LF        (W6X_HTTP_PARSER_STATE_HEADER | 0x0BU) /*!< LF ending the header */
+
+/* Body states */
+#define HP_BODY             (W6X_HTTP_PARSER_STATE_BODY | 0x00U)   /*!< Body of known length */
+#define HP_BODY_EOF         (W6X_HTTP_PARSER_STATE_BODY | 0x01U)   /*!< Body up to the end of the connection */
+#define HP_CHUNK_SIZE       (W6X_HTTP_PARSER_STATE_BODY | 0x02U)   /*!< Chunk size digits */
+#define HP_CHUNK_EXT        (W6X_HTTP_PARSER_STATE_BODY | 0x03U)   /*!< Chunk extensions */
+#define HP_CHUNK_SIZE_LF    (W6X_HTTP_PARSER_STATE_BODY | 0x04U)   /*!< LF ending the chunk size line */
+#define HP_CHUNK_DATA       (W6X_HTTP_PARSER_STATE_BODY | 0x05U)   /*!< Chunk data */
+#define HP_CHUNK_DATA_CR    (W6X_HTTP_PARSER_STATE_BODY | 0x06U)   /*!< CR after the chunk data */
+#define HP_CHUNK_DATA_LF    (W6X_HTTP_PARSER_STATE_BODY | 0x07U)   /*!< LF after the chunk data */
+#define HP_TRAILER          (W6X_HTTP_PARSER_STATE_BODY | 0x08U)   /*!< Start of a trailer line */
+#define HP_TRAILER_LINE     (W6X_HTTP_PARSER_STATE_BODY | 0x09U)   /*!< Trailer line */
+#define HP_TRAILER_LF       (W6X_HTTP_PARSER_STATE_BODY | 0x0AU)   /*!< LF ending the trailer */
+
+/* Header fields of interest, index in hp_fields */
+#define HP_FIELD_CONTENT_LENGTH     0U      /*!< Content-Length */
+#define HP_FIELD_TRANSFER_ENCODING  1U      /*!< Transfer-Encoding */
+#define HP_FIELD_CONNECTION         2U      /*!< Connection */
+#define HP_FIELD_OTHER              0xFFU   /*!< Any other field */
+
+/* Tokens of interest in the field values, index in hp_tokens */
+#define HP_TOKEN_CHUNKED            0U      /*!< chunked */
+#define HP_TOKEN_CLOSE              1U      /*!< close */
+#define HP_TOKEN_KEEP_ALIVE         2U      /*!< keep-alive */
+
+/** Number of names in hp_fields and hp_tokens */
+#define HP_NAMES_COUNT              3U
+
+/** Candidates mask of all the names */
+#define HP_NAMES_ALL                ((1U << HP_NAMES_COUNT) - 1U)
+
+/** @} */
+
+/* Private macros ------------------------------------------------------------*/
+/** @addtogroup ST67W6X_Private_HTTP_Macros
+  * @{
+  */
+
+/** Lower case of an ASCII character */
+#define HP_LOWER(c)         ((((c) >= 'A') && ((c) <= 'Z')) ? (uint8_t)((c) | 0x20U) : (uint8_t)(c))
+
+/** Optional white space */
+#define HP_IS_OWS(c)        (((c) == ' ') || ((c) == '\t'))
+
+/** @} */
+
+/* Private variables ---------------------------------------------------------*/
+/** Names of the header fields of interest, lower case */
+static const char *const hp_fields[HP_NAMES_COUNT] = {"content-length", "transfer-encoding", "connection"};
+
+/** Tokens of interest in the header field values, lower case */
+static const char *const hp_tokens[HP_NAMES_COUNT] = {"chunked", "close", "keep-alive"};
+
+/* Private function prototypes -----------------------------------------------*/
+/** @addtogroup ST67W6X_Private_HTTP_Functions
+  * @{
+  */
+
+/**
+  * @brief  Drop the names that do not match the next character
+  * @param  names: Names to match
+  * @param  candidates: Names still matching
+  * @param  index: Position of the character in the name
+  * @param  c: Character, lower case
+  * @return Names still matching after the character
+  */
+static uint8_t W6X_HTTP_Parser_Match(const char *const *names, uint8_t candidates, uint8_t index, uint8_t c);
+
+/**
+  * @brief  Get the name fully matched
+  * @param  names: Names to match
+  * @param  candidates: Names still matching
+  * @param  len: Length of the parsed name
+  * @return Index of the name, 0xFF if none
+  */
+static uint8_t W6X_HTTP_Parser_Matched(const char *const *names, uint8_t candidates, uint8_t len);
+
+/**
+  * @brief  Parse one character of a header field value
+  * @param  parser: Parser
+  * @param  c: Character, CR excluded
+  * @return 0 if success, -1 if the value is malformed
+  */
+static int32_t W6X_HTTP_Parser_Value(W6X_HTTP_Parser_t *parser, uint8_t c);
+
+/**
+  * @brief  Handle the end of the header and select how the body is delimited
+  * @param  parser: Parser
+  * @return 0 if success, -1 if the header callback aborted
+  */
+static int32_t W6X_HTTP_Parser_Headers_Done(W6X_HTTP_Parser_t *parser);
+
+/** @} */
+
+/* Functions Definition ------------------------------------------------------*/
+/** @addtogroup ST67W6X_Private_HTTP_Functions
+  * @{
+  */
+
+void W6X_HTTP_Parser_Init(W6X_HTTP_Parser_t *parser, uint8_t flags, W6X_HTTP_Parser_Headers_cb_t headers_fn,
+                          W6X_HTTP_Parser_Body_cb_t body_fn, void *arg)
+{
+  parser->state = HP_START;
+  parser->flags = flags & W6X_HTTP_PARSER_FLAG_NO_BODY;
+  parser->field = HP_FIELD_OTHER;
+  parser->candidates = 0;
+  parser->match = 0;
+  parser->version = 0;
+  parser->status = 0;
+  parser->content_length = 0;
+  parser->remaining = 0;
+  parser->header_len = 0;
+  parser->headers_fn = headers_fn;
+  parser->body_fn = body_fn;
+  parser->arg = arg;
+}
+
+int32_t W6X_HTTP_Parser_Execute(W6X_HTTP_Parser_t *parser, const uint8_t *data, uint32_t len)
+{
+  uint32_t i = 0;
+  uint32_t n;
+  uint8_t c;
+
+  while ((i < len) && ((parser->state & W6X_HTTP_PARSER_STATE_MASK) < W6X_HTTP_PARSER_STATE_COMPLETE))
+  {
+    /* Body data is passed by spans, in place */
+    if ((parser->state == HP_BODY) || (parser->state == HP_CHUNK_DATA) || (parser->state == HP_BODY_EOF))
+    {
+      n = len - i;
+      if ((parser->state != HP_BODY_EOF) && (n > parser->remaining))
+      {
+        n = parser->remaining;
+      }
+      if ((parser->body_fn != NULL) && (parser->body_fn(parser->arg, &data[i], n) < 0))
+      {
+        parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+        break;
+      }
+      i += n;
+      if (parser->state != HP_BODY_EOF)
+      {
+        parser->remaining -= n;
+        if (parser->remaining == 0)
+        {
+          parser->state = (parser->state == HP_BODY) ? W6X_HTTP_PARSER_STATE_COMPLETE : HP_CHUNK_DATA_CR;
+        }
+      }
+      continue;
+    }
+
+    c = data[i++];
+    if ((parser->state & W6X_HTTP_PARSER_STATE_MASK) == W6X_HTTP_PARSER_STATE_HEADER)
+    {
+      parser->header_len++;
+    }
+
+    switch (parser->state)
+    {
+      case HP_START:
+        /* Tolerate empty lines left before the status line */
+        if ((c == '\r') || (c == '\n'))
+        {
+          break;
+        }
+        parser->match = 0;
+        parser->state = HP_PROTOCOL;
+      /* fall through */
+      case HP_PROTOCOL:
+        if (c != (uint8_t)"HTTP/"[parser->match])
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+        }
+        else if (++parser->match == 5U)
+        {
+          parser->state = HP_MAJOR;
+        }
+        break;
+
+      case HP_MAJOR:
+      case HP_MINOR:
+        if ((c < '0') || (c > '9'))
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+          break;
+        }
+        parser->version |= (parser->state == HP_MAJOR) ? (uint16_t)((c - '0') << 8) : (uint16_t)(c - '0');
+        parser->state = (parser->state == HP_MAJOR) ? HP_DOT : HP_STATUS_SP;
+        break;
+
+      case HP_DOT:
+        parser->state = (c == '.') ? HP_MINOR : W6X_HTTP_PARSER_STATE_ERROR;
+        break;
+
+      case HP_STATUS_SP:
+        if (c != ' ')
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+          break;
+        }
+        parser->match = 0;
+        parser->state = HP_STATUS;
+        break;
+
+      case HP_STATUS:
+        if (parser->match == 3U)
+        {
+          /* The reason phrase is optional */
+          if ((c == ' ') || (c == '\r'))
+          {
+            parser->state = HP_REASON;
+          }
+          else
+          {
+            parser->state = (c == '\n') ? HP_FIELD_START : W6X_HTTP_PARSER_STATE_ERROR;
+          }
+        }
+        else if ((c >= '0') && (c <= '9'))
+        {
+          parser->status = (uint16_t)((parser->status * 10U) + (c - '0'));
+          parser->match++;
+        }
+        else
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+        }
+        break;
+
+      case HP_REASON:
+        if (c == '\n')
+        {
+          parser->state = HP_FIELD_START;
+        }
+        break;
+
+      case HP_FIELD_START:
+        if (c == '\r')
+        {
+          parser->state = HP_HEADER_LF;
+        }
+        else if (c == '\n')
+        {
+          if (W6X_HTTP_Parser_Headers_Done(parser) < 0)
+          {
+            parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+          }
+        }
+        else if (HP_IS_OWS(c))
+        {
+          /* Obsolete line folding: the value goes on, but a folded length is ambiguous */
+          parser->candidates = HP_NAMES_ALL;
+          parser->match = 0;
+          parser->state = (parser->field == HP_FIELD_CONTENT_LENGTH) ? W6X_HTTP_PARSER_STATE_ERROR : HP_VALUE;
+        }
+        else if (c == ':')
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+        }
+        else
+        {
+          parser->candidates = W6X_HTTP_Parser_Match(hp_fields, HP_NAMES_ALL, 0, HP_LOWER(c));
+          parser->match = 1;
+          parser->state = HP_FIELD;
+        }
+        break;
+
+      case HP_FIELD:
+        if (c == ':')
+        {
+          parser->field = W6X_HTTP_Parser_Matched(hp_fields, parser->candidates, parser->match);
+          if ((parser->field == HP_FIELD_CONTENT_LENGTH) &&
+              ((parser->flags & W6X_HTTP_PARSER_FLAG_LENGTH) != 0U))
+          {
+            /* Several lengths make the body boundary ambiguous */
+            parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+            break;
+          }
+          if (parser->field == HP_FIELD_TRANSFER_ENCODING)
+          {
+            /* Only the last transfer coding applied tells if the body is chunked */
+            parser->flags &= (uint8_t)~W6X_HTTP_PARSER_FLAG_CHUNKED;
+          }
+          parser->candidates = HP_NAMES_ALL;
+          parser->match = 0;
+          parser->state = HP_VALUE;
+        }
+        else if ((c == '\r') || (c == '\n') || HP_IS_OWS(c))
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+        }
+        else
+        {
+          parser->candidates = W6X_HTTP_Parser_Match(hp_fields, parser->candidates, parser->match, HP_LOWER(c));
+          parser->match = (parser->match < 0xFFU) ? (uint8_t)(parser->match + 1U) : parser->match;
+        }
+        break;
+
+      case HP_VALUE:
+        if (c == '\r')
+        {
+          break;
+        }
+        if (W6X_HTTP_Parser_Value(parser, c) < 0)
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+        }
+        else if (c == '\n')
+        {
+          parser->state = HP_FIELD_START;
+        }
+        break;
+
+      case HP_HEADER_LF:
+        if ((c != '\n') || (W6X_HTTP_Parser_Headers_Done(parser) < 0))
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+        }
+        break;
+
+      case HP_CHUNK_SIZE:
+        if (((c >= '0') && (c <= '9')) || ((HP_LOWER(c) >= 'a') && (HP_LOWER(c) <= 'f')))
+        {
+          if (parser->remaining > 0x0FFFFFFFU)
+          {
+            parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+            break;
+          }
+          c = (c <= '9') ? (uint8_t)(c - '0') : (uint8_t)(HP_LOWER(c) - 'a' + 10U);
+          parser->remaining = (parser->remaining << 4) | c;
+          parser->match = 1;
+        }
+        else if (parser->match == 0U)
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+        }
+        else if (c == '\r')
+        {
+          parser->state = HP_CHUNK_SIZE_LF;
+        }
+        else if (c == '\n')
+        {
+          parser->state = (parser->remaining == 0U) ? HP_TRAILER : HP_CHUNK_DATA;
+        }
+        else
+        {
+          parser->state = ((c == ';') || HP_IS_OWS(c)) ? HP_CHUNK_EXT : W6X_HTTP_PARSER_STATE_ERROR;
+        }
+        break;
+
+      case HP_CHUNK_EXT:
+        if (c == '\n')
+        {
+          parser->state = (parser->remaining == 0U) ? HP_TRAILER : HP_CHUNK_DATA;
+        }
+        break;
+
+      case HP_CHUNK_SIZE_LF:
+        if (c != '\n')
+        {
+          parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+          break;
+        }
+        /* A zero size chunk ends the body, trailer fields may follow */
+        parser->state = (parser->remaining == 0U) ? HP_TRAILER : HP_CHUNK_DATA;
+        break;
+
+      case HP_CHUNK_DATA_CR:
+        parser->state = (c == '\r') ? HP_CHUNK_DATA_LF : ((c == '\n') ? HP_CHUNK_SIZE : W6X_HTTP_PARSER_STATE_ERROR);
+        parser->match = 0;
+        break;
+
+      case HP_CHUNK_DATA_LF:
+        parser->state = (c == '\n') ? HP_CHUNK_SIZE : W6X_HTTP_PARSER_STATE_ERROR;
+        parser->match = 0;
+        break;
+
+      case HP_TRAILER:
+        parser->state = (c == '\r') ? HP_TRAILER_LF : ((c == '\n') ? W6X_HTTP_PARSER_STATE_COMPLETE : HP_TRAILER_LINE);
+        break;
+
+      case HP_TRAILER_LINE:
+        if (c == '\n')
+        {
+          parser->state = HP_TRAILER;
+        }
+        break;
+
+      case HP_TRAILER_LF:
+        parser->state = (c == '\n') ? W6X_HTTP_PARSER_STATE_COMPLETE : W6X_HTTP_PARSER_STATE_ERROR;
+        break;
+
+      default:
+        parser->state = W6X_HTTP_PARSER_STATE_ERROR;
+        break;
+    }
+  }
+
+  return (parser->state == W6X_HTTP_PARSER_STATE_ERROR) ? -1 : (int32_t)i;
+}
+
+int32_t W6X_HTTP_Parser_Finish(W6X_HTTP_Parser_t *parser)
+{
+  if (parser->state == HP_BODY_EOF)
+  {
+    parser->state = W6X_HTTP_PARSER_STATE_COMPLETE;
+  }
+  return (parser->state == W6X_HTTP_PARSER_STATE_COMPLETE) ? 0 : -1;
+}
+
+int32_t W6X_HTTP_Parser_Keep_Alive(const W6X_HTTP_Parser_t *parser)
+{
+  if ((parser->state != W6X_HTTP_PARSER_STATE_COMPLETE) || ((parser->flags & W6X_HTTP_PARSER_FLAG_EOF) != 0U) ||
+      ((parser->flags & W6X_HTTP_PARSER_FLAG_CLOSE) != 0U))
+  {
+    return 0;
+  }
+  /* HTTP/1.1 connections are persistent by default, HTTP/1.0 ones only on request */
+  return ((parser->version >= 0x0101U) || ((parser->flags & W6X_HTTP_PARSER_FLAG_KEEP_ALIVE) != 0U)) ? 1 : 0;
+}
+
+/* Private Functions Definition ----------------------------------------------*/
+static uint8_t W6X_HTTP_Parser_Match(const char *const *names, uint8_t candidates, uint8_t index, uint8_t c)
+{
+  for (uint8_t i = 0; i < HP_NAMES_COUNT; i++)
+  {
+    /* A name is dropped on its terminating character, so index never goes past it */
+    if (((candidates & (1U << i)) != 0U) && ((names[i][index] == '\0') || ((uint8_t)names[i][index] != c)))
+    {
+      candidates &= (uint8_t)~(1U << i);
+    }
+  }
+  return candidates;
+}
+
+static uint8_t W6X_HTTP_Parser_Matched(const char *const *names, uint8_t candidates, uint8_t len)
+{
+  for (uint8_t i = 0; i < HP_NAMES_COUNT; i++)
+  {
+    if (((candidates & (1U << i)) != 0U) && (names[i][len] == '\0'))
+    {
+      return i;
+    }
+  }
+  return HP_FIELD_OTHER;
+}
+
+static int32_t W6X_HTTP_Parser_Value(W6X_HTTP_Parser_t *parser, uint8_t c)
+{
+  uint8_t token;
+
+  if (parser->field == HP_FIELD_CONTENT_LENGTH)
+  {
+    if ((c >= '0') && (c <= '9'))
+    {
+      if ((parser->match == 2U) || (parser->content_length > ((UINT32_MAX - 9U) / 10U)))
+      {
+        /* Digits after a space, or a length beyond 32 bits */
+        return -1;
+      }
+      parser->content_length = (parser->content_length * 10U) + (c - '0');
+      parser->match = 1;
+    }
+    else if (HP_IS_OWS(c))
+    {
+      parser->match = (parser->match == 1U) ? 2U : parser->match;
+    }
+    else if ((c == '\n') && (parser->match != 0U))
+    {
+      parser->flags |= W6X_HTTP_PARSER_FLAG_LENGTH;
+    }
+    else
+    {
+      return -1;
+    }
+    return 0;
+  }
+
+  if ((parser->field != HP_FIELD_TRANSFER_ENCODING) && (parser->field != HP_FIELD_CONNECTION))
+  {
+    return 0;
+  }
+
+  /* Comma separated list of tokens */
+  if ((c == ',') || (c == '\n') || HP_IS_OWS(c))
+  {
+    if (parser->match > 0U)
+    {
+      token = W6X_HTTP_Parser_Matched(hp_tokens, parser->candidates, parser->match);
+      if (parser->field == HP_FIELD_TRANSFER_ENCODING)
+      {
+        parser->flags = (token == HP_TOKEN_CHUNKED) ? (parser->flags | W6X_HTTP_PARSER_FLAG_CHUNKED) :
+                        (parser->flags & (uint8_t)~W6X_HTTP_PARSER_FLAG_CHUNKED);
+      }
+      else if (token == HP_TOKEN_CLOSE)
+      {
+        parser->flags |= W6X_HTTP_PARSER_FLAG_CLOSE;
+      }
+      else if (token == HP_TOKEN_KEEP_ALIVE)
+      {
+        parser->flags |= W6X_HTTP_PARSER_FLAG_KEEP_ALIVE;
+      }
+    }
+    parser->candidates = HP_NAMES_ALL;
+    parser->match = 0;
+  }
+  else
+  {
+    parser->candidates = W6X_HTTP_Parser_Match(hp_tokens, parser->candidates, parser->match, HP_LOWER(c));
+    parser->match = (parser->match < 0xFFU) ? (uint8_t)(parser->match + 1U) : parser->match;
+  }
+  return 0;
+}
+
+static int32_t W6X_HTTP_Parser_Headers_Done(W6X_HTTP_Parser_t *parser)
+{
+  uint8_t no_body = parser->flags & W6X_HTTP_PARSER_FLAG_NO_BODY;
+
+  if ((parser->status / 100U) == 1U)
+  {
+    /* Interim response: the final one follows */
+    parser->flags = no_body;
+    parser->version = 0;
+    parser->status = 0;
+    parser->content_length = 0;
+    parser->state = HP_START;
+    return 0;
+  }
+
+  if ((parser->headers_fn != NULL) && (parser->headers_fn(parser->arg, parser) < 0))
+  {
+    return -1;
+  }
+
+  parser->match = 0;
+  parser->remaining = 0;
+  if ((no_body != 0U) || (parser->status == 204U) || (parser->status == 304U))
+  {
+    parser->state = W6X_HTTP_PARSER_STATE_COMPLETE;
+  }
+  else if ((parser->flags & W6X_HTTP_PARSER_FLAG_CHUNKED) != 0U)
+  {
+    parser->state = HP_CHUNK_SIZE;
+  }
+  else if ((parser->flags & W6X_HTTP_PARSER_FLAG_LENGTH) != 0U)
+  {
+    parser->remaining = parser->content_length;
+    parser->state = (parser->remaining == 0U) ? W6X_HTTP_PARSER_STATE_COMPLETE : HP_BODY;
+  }
+  else
+  {
+    parser->flags |= W6X_HTTP_PARSER_FLAG_EOF;
+    parser->state = HP_BODY_EOF;
+  }
+  return 0;
+}
+
+/** @} */
@@ -0,0 +1,162 @@
+/**
+  ******************************************************************************
+  * @file    w6x_http_parser.h
+  * @author  GPM Application Team
+  * @brief   This file provides the definitions of the incremental HTTP response parser
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef W6X_HTTP_PARSER_H
+#define W6X_HTTP_PARSER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/** @addtogroup ST67W6X_Private_HTTP_Constants
+  * @{
+  */
+
+/** Parser is waiting for the status line or the header fields */
+#define W6X_HTTP_PARSER_STATE_HEADER        0x00U
+
+/** Parser is in the body of the response */
+#define W6X_HTTP_PARSER_STATE_BODY          0x40U
+
+/** Response has been parsed completely */
+#define W6X_HTTP_PARSER_STATE_COMPLETE      0x80U
+
+/** Response is malformed or a callback aborted the parsing */
+#define W6X_HTTP_PARSER_STATE_ERROR         0xC0U
+
+/** Mask of the parser state category */
+#define W6X_HTTP_PARSER_STATE_MASK          0xC0U
+
+/** Response to a HEAD request, no body follows the header */
+#define W6X_HTTP_PARSER_FLAG_NO_BODY        0x01U
+
+/** Content-Length header received */
+#define W6X_HTTP_PARSER_FLAG_LENGTH         0x02U
+
+/** Body sent with the chunked transfer coding */
+#define W6X_HTTP_PARSER_FLAG_CHUNKED        0x04U
+
+/** Body delimited by the end of the connection */
+#define W6X_HTTP_PARSER_FLAG_EOF            0x08U
+
+/** Connection: close header received */
+#define W6X_HTTP_PARSER_FLAG_CLOSE          0x10U
+
+/** Connection: keep-alive header received */
+#define W6X_HTTP_PARSER_FLAG_KEEP_ALIVE     0x20U
+
+/** @} */
+
+/* Exported types ------------------------------------------------------------*/
+/** @addtogroup ST67W6X_Private_HTTP_Types
+  * @{
+  */
+
+struct W6X_HTTP_Parser_s;
+
+/**
+  * @brief  Called once the header of the final response is parsed
+  * @param  arg: Callback argument
+  * @param  parser: Parser, header_len gives the length of the header including the interim responses
+  * @return 0 to continue, negative value to abort the parsing
+  */
+typedef int32_t (*W6X_HTTP_Parser_Headers_cb_t)(void *arg, const struct W6X_HTTP_Parser_s *parser);
+
+/**
+  * @brief  Called for each span of body data, in place in the parsed slice
+  * @param  arg: Callback argument
+  * @param  data: Body data
+  * @param  len: Length of the body data
+  * @return 0 to continue, negative value to abort the parsing
+  */
+typedef int32_t (*W6X_HTTP_Parser_Body_cb_t)(void *arg, const uint8_t *data, uint32_t len);
+
+/**
+  * @brief  HTTP response parser structure
+  */
+typedef struct W6X_HTTP_Parser_s
+{
+  uint8_t state;                              /*!< Parser state, W6X_HTTP_PARSER_STATE_xxx category */
+  uint8_t flags;                              /*!< Response properties, W6X_HTTP_PARSER_FLAG_xxx */
+  uint8_t field;                              /*!< Header field whose value is being parsed */
+  uint8_t candidates;                         /*!< Known names still matching the current name or token */
+  uint8_t match;                              /*!< Characters of the current name or token parsed */
+  uint16_t version;                           /*!< HTTP version, major in the high byte */
+  uint16_t status;                            /*!< Status code */
+  uint32_t content_length;                    /*!< Content-Length value */
+  uint32_t remaining;                         /*!< Bytes left in the body or in the current chunk */
+  uint32_t header_len;                        /*!< Bytes of header parsed */
+  W6X_HTTP_Parser_Headers_cb_t headers_fn;    /*!< Header callback */
+  W6X_HTTP_Parser_Body_cb_t body_fn;          /*!< Body callback */
+  void *arg;                                  /*!< Callbacks argument */
+} W6X_HTTP_Parser_t;
+
+/** @} */
+
+/* Exported functions --------------------------------------------------------*/
+/** @addtogroup ST67W6X_Private_HTTP_Functions
+  * @{
+  */
+
+/**
+  * @brief  Prepare the parser for a new response
+  * @param  parser: Parser to initialize
+  * @param  flags: W6X_HTTP_PARSER_FLAG_NO_BODY for the response to a HEAD request, 0 otherwise
+  * @param  headers_fn: Header callback, can be NULL
+  * @param  body_fn: Body callback, can be NULL
+  * @param  arg: Callbacks argument
+  */
+void W6X_HTTP_Parser_Init(W6X_HTTP_Parser_t *parser, uint8_t flags, W6X_HTTP_Parser_Headers_cb_t headers_fn,
+                          W6X_HTTP_Parser_Body_cb_t body_fn, void *arg);
+
+/**
+  * @brief  Parse the next slice of a response. The parsing stops at the end of the response,
+  *         the bytes after it belong to the next one.
+  * @param  parser: Parser
+  * @param  data: Response bytes
+  * @param  len: Number of bytes
+  * @return Number of bytes consumed, -1 if the response is malformed or a callback aborted
+  */
+int32_t W6X_HTTP_Parser_Execute(W6X_HTTP_Parser_t *parser, const uint8_t *data, uint32_t len);
+
+/**
+  * @brief  Signal the end of the connection to the parser
+  * @param  parser: Parser
+  * @return 0 if the response is complete, -1 if it has been cut
+  */
+int32_t W6X_HTTP_Parser_Finish(W6X_HTTP_Parser_t *parser);
+
+/**
+  * @brief  Tell if the connection can carry another request after this response
+  * @param  parser: Parser of a complete response
+  * @return 1 if the connection can be kept, 0 otherwise
+  */
+int32_t W6X_HTTP_Parser_Keep_Alive(const W6X_HTTP_Parser_t *parser);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* W6X_HTTP_PARSER_H */
@@ -100,7 +100,14 @@ W6X_Status_t W6X_MQTT_Init(W6X_MQTT_Data_t *p_mqtt_config)
                    W6X_MQTT_cb,
                    NULL);
 
-  return TranslateErrorStatus(W61_MQTT_Init(p_DrvObj, p_mqtt_config->p_recv_data, p_mqtt_config->recv_data_buf_size));
+  ret = TranslateErrorStatus(W61_MQTT_Init(p_DrvObj, p_mqtt_config->p_recv_data, p_mqtt_config->recv_data_buf_size));
+  if (ret != W6X_STATUS_OK)
+  {
+    return ret;
+  }
+
+  /* Select the delivery mode of the received messages */
+  return TranslateErrorStatus(W61_MQTT_SetZeroCopy(p_DrvObj, (p_mqtt_config->zero_copy == 1) ? 1 : 0));
 }
 
 void W6X_MQTT_DeInit(void)
@@ -116,12 +123,30 @@ void W6X_MQTT_DeInit(void)
 
 W6X_Status_t W6X_MQTT_SetRecvDataPtr(W6X_MQTT_Data_t *p_mqtt_config)
 {
+  W6X_Status_t ret;
   NULL_ASSERT(p_mqtt_config, "MQTT configuration pointer is NULL");
 
   p_DrvObj = W61_ObjGet();
   NULL_ASSERT(p_DrvObj, W6X_Obj_Null_str);
 
-  return TranslateErrorStatus(W61_MQTT_Init(p_DrvObj, p_mqtt_config->p_recv_data, p_mqtt_config->recv_data_buf_size));
+  ret = TranslateErrorStatus(W61_MQTT_Init(p_DrvObj, p_mqtt_config->p_recv_data, p_mqtt_config->recv_data_buf_size));
+  if (ret != W6X_STATUS_OK)
+  {
+    return ret;
+  }
+
+  /* The delivery mode can be changed as well */
+  return TranslateErrorStatus(W61_MQTT_SetZeroCopy(p_DrvObj, (p_mqtt_config->zero_copy == 1) ? 1 : 0));
+}
+
+W6X_Status_t W6X_MQTT_Release(W6X_MQTT_CbParamData_t *Data)
+{
+  /* The driver object is used directly: a slot lent before W6X_MQTT_DeInit is still given back */
+  W61_Object_t *p_obj = W61_ObjGet();
+  NULL_ASSERT(p_obj, W6X_Obj_Null_str);
+  NULL_ASSERT(Data, "MQTT data pointer is NULL");
+
+  return TranslateErrorStatus(W61_MQTT_Release(p_obj, Data->slot));
 }
 
 W6X_Status_t W6X_MQTT_Configure(W6X_MQTT_Connect_t *Config)
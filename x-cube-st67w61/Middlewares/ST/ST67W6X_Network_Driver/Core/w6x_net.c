@@ -66,6 +66,8 @@ typedef struct
   uint8_t Number;                   /*!< Connection number */
   uint32_t RemoteIP;                /*!< IP address of device */
   uint8_t TcpNoDelay;               /*!< BSD Socket option TCP_NODELAY */
+  uint8_t RecvMode;                 /*!< Socket option SO_RCVMODE */
+  uint8_t NonBlocking;              /*!< Socket option SO_NONBLOCK */
   char *Ca_Cert;                    /*!< CA certificate */
   char *Private_Key;                /*!< Private key */
   char *Certificate;                /*!< Server Certificate */
@@ -75,6 +77,22 @@ typedef struct
   char SNI[64];                     /*!< Server Name Indication */
   W6X_Net_Socket_Status_t Status;   /*!< Socket status */
   W6X_Net_Protocol_e Protocol;      /*!< Connection type. Parameter is valid only if connection is made as client */
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  uint8_t *TxBuf;                   /*!< Coalesced writes not yet sent */
+  uint32_t TxLen;                   /*!< Length of the coalesced writes */
+  TickType_t TxStart;               /*!< Time of the first coalesced write */
+  uint8_t TxError;                  /*!< Set when a deferred send failed, reported by the next send or flush */
+#endif /* W6X_NET_COALESCE_ENABLE */
+#if (W6X_NET_READAHEAD_ENABLE == 1)
+  uint8_t *RxBuf;                   /*!< Data pulled ahead of the application reads */
+  uint32_t RxOff;                   /*!< Offset of the first unread byte in RxBuf */
+  uint32_t RxLen;                   /*!< Number of unread bytes in RxBuf */
+#endif /* W6X_NET_READAHEAD_ENABLE */
+  uint8_t *PeekBuf;                 /*!< Data pulled by MSG_PEEK, returned by the next reads */
+  uint32_t PeekOff;                 /*!< Offset of the first unread byte in PeekBuf */
+  uint32_t PeekLen;                 /*!< Number of unread bytes in PeekBuf */
+  uint32_t PeekRemoteIP;            /*!< Source IP address of the data peeked on a listening UDP socket */
+  uint16_t PeekRemotePort;          /*!< Source port of the data peeked on a listening UDP socket */
 } W6X_Net_Socket_t;
 
 /**
@@ -93,8 +111,10 @@ typedef struct
 typedef struct
 {
   uint8_t SocketConnected;          /*!< Socket connected status */
+  uint8_t RemoteValid;              /*!< Set when RemoteIP and RemotePort are known for the current connection */
   uint16_t RemotePort;              /*!< Remote PORT number */
   uint32_t RemoteIP;                /*!< IP address of device */
+  int32_t Owner;                    /*!< Socket using the connection, -1 if none */
   SemaphoreHandle_t DataAvailable;  /*!< Semaphore for data available */
   uint32_t DataAvailableSize;       /*!< Counter for data available */
 } W6X_Net_Connection_t;
@@ -108,6 +128,19 @@ typedef struct
   W6X_Net_Connection_t Connection[W61_NET_MAX_CONNECTIONS];       /*!< NCP connections context */
   W6X_Net_Credential_t Credentials[W61_NET_MAX_CONNECTIONS * 3];  /*!< Credentials context */
   int32_t NextSocketToUse;                                        /*!< Next socket to use */
+  EventGroupHandle_t PollEvents;                                  /*!< One bit per connection, set on its events */
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  SemaphoreHandle_t TxLock[W61_NET_MAX_CONNECTIONS + 1];          /*!< Per socket lock of the coalesced writes */
+  SemaphoreHandle_t TxSendLock[W61_NET_MAX_CONNECTIONS + 1];      /*!< Per socket lock ordering the coalesced sends */
+  TaskHandle_t TxFlushTask;                                       /*!< Task sending the expired writes */
+  volatile uint8_t TxStop;                                        /*!< Set to stop the coalescing task */
+  SemaphoreHandle_t TxStopped;                                    /*!< Given by the coalescing task when it exits */
+  uint32_t TxWrites;                                              /*!< Number of writes coalesced */
+  uint32_t TxTransactions;                                        /*!< Number of AT sends of coalesced writes */
+#endif /* W6X_NET_COALESCE_ENABLE */
+  uint32_t RxReads;                                               /*!< Reads returning data, peeks excluded */
+  uint32_t RxHits;                                                /*!< Reads served by read-ahead, peeks excluded */
+  uint32_t RxPulls;                                               /*!< Number of AT pulls of socket data */
 } W6X_NetCtx_t;
 
 /** @} */
@@ -128,6 +161,20 @@ typedef struct
   * Pull data might fail during heavy load if timeout is too small */
 #define W6X_NET_PULL_DATA_TIMEOUT  100
 
+/** Event bit of a connection in PollEvents */
+#define W6X_NET_POLL_EVT(conn)     (1UL << (conn))
+
+/** All the connection event bits in PollEvents */
+#define W6X_NET_POLL_EVT_ALL       (W6X_NET_POLL_EVT(W61_NET_MAX_CONNECTIONS) - 1UL)
+
+#if (W6X_NET_COALESCE_ENABLE == 1)
+/** Stack size of the task sending the expired coalesced writes */
+#define W6X_NET_COALESCE_THREAD_STACK_SIZE  1024
+
+/** Priority of the task sending the expired coalesced writes */
+#define W6X_NET_COALESCE_THREAD_PRIO        30
+#endif /* W6X_NET_COALESCE_ENABLE */
+
 /** @} */
 
 /* Private macros ------------------------------------------------------------*/
@@ -176,12 +223,19 @@ static void W6X_Net_cb(W61_event_id_t event_id, void *event_args);
 static int32_t W6X_Net_TranslateErrorStatus(W61_Status_t ret61);
 
 /**
-  * @brief  Find a connection by remote IP and port
-  * @param  remote_ip: remote IP address
+  * @brief  Find the connection of a remote peer not used by a connected socket
+  * @param  remote_ip: remote IP address, in network byte order
   * @param  remoteport: remote port number
-  * @retval Connection number
+  * @retval Connection number, -1 if not found
   */
-static int32_t W6X_Net_Find_Connection(char *remote_ip, uint32_t remoteport);
+static int32_t W6X_Net_Find_Connection(uint32_t remote_ip, uint32_t remoteport);
+
+/**
+  * @brief  Record the socket using a connection
+  * @param  sock: socket number
+  * @param  connection_id: connection number
+  */
+static void W6X_Net_Set_Owner(int32_t sock, int32_t connection_id);
 
 /**
   * @brief  Poll the UDP sockets
@@ -196,9 +250,96 @@ static int32_t W6X_Net_Poll_UDP_Sockets(struct sockaddr_in *remote_addr);
   * @param  connection_id: connection number
   * @param  buf: buffer to store the data
   * @param  max_len: maximum length of the buffer
+  * @param  flags: MSG_DONTWAIT to return W6X_NET_EAGAIN instead of waiting for data
   * @retval Number of bytes received
   */
-static int32_t W6X_Net_Wait_Pull_Data(int32_t sock, int32_t connection_id, void *buf, size_t max_len);
+static int32_t W6X_Net_Wait_Pull_Data(int32_t sock, int32_t connection_id, void *buf, size_t max_len,
+                                      int32_t flags);
+
+/**
+  * @brief  Copy the data pulled by MSG_PEEK on a socket
+  * @param  sock: socket number
+  * @param  buf: buffer to store the data
+  * @param  max_len: maximum length of the buffer
+  * @param  flags: MSG_PEEK to keep the data for the next read
+  * @retval Number of bytes copied
+  */
+static int32_t W6X_Net_Peek_Copy(int32_t sock, void *buf, size_t max_len, int32_t flags);
+
+/**
+  * @brief  Pull up to W6X_NET_PEEK_SIZE bytes on a socket and copy the head of them, keeping them for the next read
+  * @param  sock: socket number
+  * @param  connection_id: connection number
+  * @param  buf: buffer to store the data
+  * @param  max_len: maximum length of the buffer
+  * @param  flags: flags given to W6X_Net_Recv
+  * @retval Number of bytes copied, negative value on error
+  */
+static int32_t W6X_Net_Peek_Fill(int32_t sock, int32_t connection_id, void *buf, size_t max_len, int32_t flags);
+
+/**
+  * @brief  Get the readiness of a socket
+  * @param  sock: socket number
+  * @param  events: requested events
+  * @param  wait_bits: PollEvents bits to wait on for a change, updated
+  * @retval Ready events
+  */
+static int16_t W6X_Net_Poll_Socket(int32_t sock, int16_t events, EventBits_t *wait_bits);
+
+#if (W6X_NET_COALESCE_ENABLE == 1)
+/**
+  * @brief  Coalesce a write with the previous ones of the socket
+  * @param  sock: socket number
+  * @param  buf: data to write
+  * @param  len: length of the data
+  * @retval Number of bytes coalesced, 0 if the data must be sent directly, -1 on error
+  */
+static int32_t W6X_Net_Coalesce_Write(int32_t sock, const void *buf, size_t len);
+
+/**
+  * @brief  Send the coalesced writes of a socket, its TxLock must not be held
+  * @param  sock: socket number
+  * @retval 0 on success, -1 on error
+  */
+static int32_t W6X_Net_Coalesce_Flush(int32_t sock);
+
+/**
+  * @brief  Report and clear the failure of a deferred send of a socket
+  * @param  sock: socket number
+  * @retval 0 if no deferred send failed, -1 otherwise
+  */
+static int32_t W6X_Net_Coalesce_Error(int32_t sock);
+
+/**
+  * @brief  Task sending the coalesced writes held for W6X_NET_COALESCE_DELAY
+  * @param  arg: unused
+  */
+static void W6X_Net_Coalesce_task(void *arg);
+#endif /* W6X_NET_COALESCE_ENABLE */
+
+#if (W6X_NET_READAHEAD_ENABLE == 1)
+/**
+  * @brief  Copy the data pulled ahead on a socket
+  * @param  sock: socket number
+  * @param  buf: buffer to store the data
+  * @param  max_len: maximum length of the buffer
+  * @param  flags: MSG_PEEK to keep the data for the next read
+  * @retval Number of bytes copied
+  */
+static int32_t W6X_Net_ReadAhead_Copy(int32_t sock, void *buf, size_t max_len, int32_t flags);
+
+/**
+  * @brief  Pull up to W6X_NET_READAHEAD_SIZE bytes on a socket and copy the head of them
+  * @param  sock: socket number
+  * @param  connection_id: connection number
+  * @param  buf: buffer to store the data
+  * @param  max_len: maximum length of the buffer
+  * @param  flags: flags given to W6X_Net_Recv
+  * @retval Number of bytes copied, negative value on error
+  */
+static int32_t W6X_Net_ReadAhead_Fill(int32_t sock, int32_t connection_id, void *buf, size_t max_len,
+                                      int32_t flags);
+#endif /* W6X_NET_READAHEAD_ENABLE */
 
 /** @} */
 
@@ -304,10 +445,17 @@ W6X_Status_t W6X_Net_Init(void)
     goto _err;
   }
 
+  p_net_ctx->PollEvents = xEventGroupCreate();
+  if (p_net_ctx->PollEvents == NULL)
+  {
+    goto _err;
+  }
+
   /* Initialize the connections */
   for (uint8_t i = 0; i < W61_NET_MAX_CONNECTIONS; i++)
   {
     memset(&p_net_ctx->Connection[i], 0, sizeof(W6X_Net_Connection_t));
+    p_net_ctx->Connection[i].Owner = -1;
     /* Initialize a semaphore for each connection */
     p_net_ctx->Connection[i].DataAvailable = xSemaphoreCreateBinary();
     if (p_net_ctx->Connection[i].DataAvailable == NULL)
@@ -348,6 +496,7 @@ W6X_Status_t W6X_Net_Init(void)
     p_net_ctx->Sockets[i].Number = W61_NET_MAX_CONNECTIONS + 1; /* Set the socket number to an invalid value */
     p_net_ctx->Sockets[i].SoSndTimeo = W6X_NET_SEND_TIMEOUT; /* Default value for SO_SNDTIMEO */
     p_net_ctx->Sockets[i].RecvTimeout = W6X_NET_RECV_TIMEOUT; /* Default value for SO_RCVTIMEO */
+    p_net_ctx->Sockets[i].RecvMode = W6X_NET_RECV_MODE; /* Default value for SO_RCVMODE */
   }
 
   for (uint8_t i = 0; i < (W61_NET_MAX_CONNECTIONS * 3); i++)
@@ -357,6 +506,34 @@ W6X_Status_t W6X_Net_Init(void)
     p_net_ctx->Credentials[i].name = NULL;
   }
   p_net_ctx->NextSocketToUse = 0; /* Initialize the rotary index for the socket usage */
+
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  for (uint32_t i = 0; i < (W61_NET_MAX_CONNECTIONS + 1); i++)
+  {
+    p_net_ctx->TxLock[i] = xSemaphoreCreateMutex();
+    p_net_ctx->TxSendLock[i] = xSemaphoreCreateMutex();
+    if ((p_net_ctx->TxLock[i] == NULL) || (p_net_ctx->TxSendLock[i] == NULL))
+    {
+      NET_LOG_ERROR("Could not create the write coalescing locks\n");
+      ret = W6X_STATUS_ERROR;
+      goto _err;
+    }
+  }
+  p_net_ctx->TxStop = 0;
+  p_net_ctx->TxStopped = xSemaphoreCreateBinary();
+  if (p_net_ctx->TxStopped == NULL)
+  {
+    NET_LOG_ERROR("Could not create the write coalescing locks\n");
+    ret = W6X_STATUS_ERROR;
+    goto _err;
+  }
+  if ((xTaskCreate(W6X_Net_Coalesce_task, "Net coalesce", W6X_NET_COALESCE_THREAD_STACK_SIZE >> 2, NULL,
+                   W6X_NET_COALESCE_THREAD_PRIO, &p_net_ctx->TxFlushTask) != pdPASS))
+  {
+    NET_LOG_ERROR("Could not create the write coalescing task\n");
+    ret = W6X_STATUS_ERROR;
+  }
+#endif /* W6X_NET_COALESCE_ENABLE */
 _err:
   return ret;
 }
@@ -371,6 +548,57 @@ void W6X_Net_DeInit(void)
   {
     vSemaphoreDelete(p_net_ctx->Connection[i].DataAvailable);
   }
+  if (p_net_ctx->PollEvents != NULL)
+  {
+    vEventGroupDelete(p_net_ctx->PollEvents);
+  }
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  if (p_net_ctx->TxFlushTask != NULL)
+  {
+    /* Let the task finish the flush in progress: it may hold the socket locks and the AT ones */
+    p_net_ctx->TxStop = 1;
+    (void)xTaskNotifyGive(p_net_ctx->TxFlushTask);
+    (void)xSemaphoreTake(p_net_ctx->TxStopped, portMAX_DELAY);
+    p_net_ctx->TxFlushTask = NULL;
+  }
+  if (p_net_ctx->TxStopped != NULL)
+  {
+    vSemaphoreDelete(p_net_ctx->TxStopped);
+    p_net_ctx->TxStopped = NULL;
+  }
+  for (uint32_t i = 0; i < (W61_NET_MAX_CONNECTIONS + 1); i++) /* Drop the writes not yet sent */
+  {
+    if (p_net_ctx->TxLock[i] != NULL)
+    {
+      vSemaphoreDelete(p_net_ctx->TxLock[i]);
+    }
+    if (p_net_ctx->TxSendLock[i] != NULL)
+    {
+      vSemaphoreDelete(p_net_ctx->TxSendLock[i]);
+    }
+    if (p_net_ctx->Sockets[i].TxBuf != NULL)
+    {
+      vPortFree(p_net_ctx->Sockets[i].TxBuf);
+    }
+  }
+#endif /* W6X_NET_COALESCE_ENABLE */
+
+#if (W6X_NET_READAHEAD_ENABLE == 1)
+  for (uint32_t i = 0; i < (W61_NET_MAX_CONNECTIONS + 1); i++) /* Drop the data pulled ahead */
+  {
+    if (p_net_ctx->Sockets[i].RxBuf != NULL)
+    {
+      vPortFree(p_net_ctx->Sockets[i].RxBuf);
+    }
+  }
+#endif /* W6X_NET_READAHEAD_ENABLE */
+  for (uint32_t i = 0; i < (W61_NET_MAX_CONNECTIONS + 1); i++) /* Drop the data peeked */
+  {
+    if (p_net_ctx->Sockets[i].PeekBuf != NULL)
+    {
+      vPortFree(p_net_ctx->Sockets[i].PeekBuf);
+    }
+  }
 
   W61_Net_DeInit(p_DrvObj); /* Deinitialize the Net context */
   vPortFree(p_net_ctx); /* Free the Net context */
@@ -753,6 +981,7 @@ int32_t W6X_Net_Socket(int32_t family, int32_t type, int32_t proto)
       p_net_ctx->Sockets[socket_to_use].Status = W6X_NET_SOCKET_ALLOCATED;
       p_net_ctx->Sockets[socket_to_use].SoLinger = -1;
       p_net_ctx->Sockets[socket_to_use].RecvTimeout = W6X_NET_RECV_TIMEOUT;
+      p_net_ctx->Sockets[socket_to_use].RecvMode = W6X_NET_RECV_MODE;
       p_net_ctx->Sockets[socket_to_use].RecvBuffSize = W6X_NET_RECV_BUFFER_SIZE;
       p_net_ctx->Sockets[socket_to_use].Number = W61_NET_MAX_CONNECTIONS + 1;
 
@@ -780,8 +1009,12 @@ int32_t W6X_Net_Close(int32_t sock)
   if (p_net_ctx->Sockets[sock].Status == W6X_NET_SOCKET_CONNECTED)
   {
     conn.Number = p_net_ctx->Sockets[sock].Number;
+    /* Send the coalesced writes before the connection is stopped */
+    (void)W6X_Net_Flush(sock);
     /* Set the socket status to closing to terminate remaining process */
     p_net_ctx->Sockets[sock].Status = W6X_NET_SOCKET_CLOSING;
+    /* Release the unread data so that the NCP is not held back while closing */
+    (void)W61_Net_DataChannel_Flush(p_DrvObj, conn.Number);
 
     /* Stop the connection */
     int32_t retry = 0;
@@ -805,6 +1038,12 @@ int32_t W6X_Net_Close(int32_t sock)
     p_net_ctx->Connection[p_net_ctx->Sockets[sock].Number].SocketConnected = 0;
   }
 
+  if (p_net_ctx->Sockets[sock].Number < W61_NET_MAX_CONNECTIONS)
+  {
+    /* Discard the data left on the connection before it is reused */
+    (void)W61_Net_DataChannel_Flush(p_DrvObj, p_net_ctx->Sockets[sock].Number);
+  }
+
   /* Free credentials that were allocated */
   if (p_net_ctx->Sockets[sock].Ca_Cert != NULL)
   {
@@ -826,6 +1065,35 @@ int32_t W6X_Net_Close(int32_t sock)
   {
     vPortFree(p_net_ctx->Sockets[sock].PSK_Identity);
   }
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  /* Wait for a coalesced send in progress, its buffer is returned to the socket */
+  (void)xSemaphoreTake(p_net_ctx->TxSendLock[sock], portMAX_DELAY);
+  (void)xSemaphoreTake(p_net_ctx->TxLock[sock], portMAX_DELAY);
+  if (p_net_ctx->Sockets[sock].TxBuf != NULL)
+  {
+    vPortFree(p_net_ctx->Sockets[sock].TxBuf);
+    p_net_ctx->Sockets[sock].TxBuf = NULL;
+  }
+  p_net_ctx->Sockets[sock].TxLen = 0; /* Nothing left for the coalescing task */
+  (void)xSemaphoreGive(p_net_ctx->TxLock[sock]);
+  (void)xSemaphoreGive(p_net_ctx->TxSendLock[sock]);
+#endif /* W6X_NET_COALESCE_ENABLE */
+#if (W6X_NET_READAHEAD_ENABLE == 1)
+  if (p_net_ctx->Sockets[sock].RxBuf != NULL)
+  {
+    vPortFree(p_net_ctx->Sockets[sock].RxBuf);
+  }
+#endif /* W6X_NET_READAHEAD_ENABLE */
+  if (p_net_ctx->Sockets[sock].PeekBuf != NULL)
+  {
+    vPortFree(p_net_ctx->Sockets[sock].PeekBuf);
+  }
+
+  if ((p_net_ctx->Sockets[sock].Number < W61_NET_MAX_CONNECTIONS) &&
+      (p_net_ctx->Connection[p_net_ctx->Sockets[sock].Number].Owner == sock))
+  {
+    p_net_ctx->Connection[p_net_ctx->Sockets[sock].Number].Owner = -1; /* Release the connection */
+  }
 
   memset(&p_net_ctx->Sockets[sock], 0, sizeof(W6X_Net_Socket_t)); /* Erase the socket context */
 
@@ -958,7 +1226,7 @@ int32_t W6X_Net_Connect(int32_t sock, const struct sockaddr *addr, socklen_t add
   {
     return ret;
   }
-  p_net_ctx->Sockets[sock].Number = conn_to_use;  /* Set the connection number */
+  W6X_Net_Set_Owner(sock, conn_to_use);  /* Set the connection number */
 
   /* Set the connection parameters */
   conn.Number = p_net_ctx->Sockets[sock].Number;
@@ -1202,19 +1470,11 @@ int32_t W6X_Net_Accept(int32_t sock, struct sockaddr *addr, socklen_t *addrlen)
   {
     for (int32_t i = 0; i < W61_NET_MAX_CONNECTIONS; i++)
     {
-      int32_t found = 0;
+      int32_t owner = p_net_ctx->Connection[i].Owner;
       if (p_net_ctx->Connection[i].SocketConnected == 1) /* Check if the socket is connected */
       {
-        for (int32_t j = 0; j < W61_NET_MAX_CONNECTIONS + 1; j++)
-        {
-          /* Check if the connected socket found is already in use */
-          if ((p_net_ctx->Sockets[j].Number == i) && (p_net_ctx->Sockets[j].Status == W6X_NET_SOCKET_CONNECTED))
-          {
-            found = 1;
-            break;
-          }
-        }
-        if (found == 0) /* If the connected socket is not in use */
+        /* Check if the connected socket found is already in use */
+        if ((owner < 0) || (p_net_ctx->Sockets[owner].Status != W6X_NET_SOCKET_CONNECTED))
         {
           ret = W6X_Net_TranslateErrorStatus(W61_Net_GetSocketInformation(p_DrvObj, i, &conn));
           if (ret == 0)
@@ -1227,9 +1487,13 @@ int32_t W6X_Net_Accept(int32_t sock, struct sockaddr *addr, socklen_t *addrlen)
             addr_in->sin_port = PP_HTONS(conn.RemotePort); /* Set the remote port */
             /* Convert the IP address to binary format */
             (void)W6X_Net_Inet_pton(AF_INET, conn.RemoteIP, (void *)&addr_in->sin_addr.s_addr);
+            /* Keep the peer in the connection table */
+            p_net_ctx->Connection[i].RemotePort = (uint16_t)conn.RemotePort;
+            p_net_ctx->Connection[i].RemoteIP = addr_in->sin_addr.s_addr;
+            p_net_ctx->Connection[i].RemoteValid = 1;
           }
           /* Set the new socket parameters */
-          p_net_ctx->Sockets[new_socket].Number = i;
+          W6X_Net_Set_Owner(new_socket, i);
           p_net_ctx->Sockets[new_socket].IsConnected = 1;
           p_net_ctx->Sockets[new_socket].Client = 0;
           p_net_ctx->Sockets[new_socket].RecvTimeout = p_net_ctx->Sockets[sock].RecvTimeout;
@@ -1259,6 +1523,22 @@ ssize_t W6X_Net_Send(int32_t sock, const void *buf, size_t len, int32_t flags)
     return ret;
   }
 
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  if ((p_net_ctx->Sockets[sock].TcpNoDelay == 0) && (p_net_ctx->Sockets[sock].Protocol != W6X_NET_UDP_PROTOCOL))
+  {
+    /* Stream socket: the small writes are coalesced, the large ones are sent directly */
+    ret = W6X_Net_Coalesce_Write(sock, buf, len);
+    if (ret != 0)
+    {
+      return (ssize_t)ret;
+    }
+  }
+  else if (W6X_Net_Coalesce_Error(sock) != 0)
+  {
+    return (ssize_t)-1;
+  }
+#endif /* W6X_NET_COALESCE_ENABLE */
+
   /* Send the data */
   ret = W6X_Net_TranslateErrorStatus(W61_Net_SendData(p_DrvObj, p_net_ctx->Sockets[sock].Number,
                                                       (uint8_t *)buf, (uint32_t)len, &SentDataLen,
@@ -1271,6 +1551,194 @@ ssize_t W6X_Net_Send(int32_t sock, const void *buf, size_t len, int32_t flags)
   return (ssize_t) SentDataLen;
 }
 
+int32_t W6X_Net_Flush(int32_t sock)
+{
+  int32_t ret = 0;
+  NULL_ASSERT(p_DrvObj, W6X_Net_Uninit_str);
+  NULL_ASSERT(p_net_ctx, W6X_Ctx_Null_str);
+
+  if ((sock < 0) || (sock >= W61_NET_MAX_CONNECTIONS + 1))
+  {
+    return -1;
+  }
+
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  ret = W6X_Net_Coalesce_Flush(sock);
+  if (W6X_Net_Coalesce_Error(sock) != 0)
+  {
+    ret = -1;
+  }
+#endif /* W6X_NET_COALESCE_ENABLE */
+  return ret;
+}
+
+int32_t W6X_Net_Poll(W6X_Net_Pollfd_t *fds, uint32_t nfds, int32_t timeout_ms)
+{
+  TickType_t timeout = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  TickType_t t0 = xTaskGetTickCount();
+  TickType_t elapsed;
+  EventBits_t wait_bits;
+  int32_t ready;
+  NULL_ASSERT(p_net_ctx, W6X_Ctx_Null_str);
+  NULL_ASSERT(fds, W6X_Buf_Null_str);
+
+  for (;;)
+  {
+    /* Collect the bits to wait on, then clear them before checking the sockets
+     * so that an event raised during the check ends the wait */
+    wait_bits = 0;
+    for (uint32_t i = 0; i < nfds; i++)
+    {
+      (void)W6X_Net_Poll_Socket(fds[i].fd, fds[i].events, &wait_bits);
+    }
+    (void)xEventGroupClearBits(p_net_ctx->PollEvents, wait_bits);
+
+    ready = 0;
+    for (uint32_t i = 0; i < nfds; i++)
+    {
+      fds[i].revents = W6X_Net_Poll_Socket(fds[i].fd, fds[i].events, &wait_bits);
+      if (fds[i].revents != 0)
+      {
+        ready++;
+      }
+    }
+    if (ready > 0)
+    {
+      return ready;
+    }
+
+    elapsed = xTaskGetTickCount() - t0;
+    if ((timeout != portMAX_DELAY) && (elapsed >= timeout))
+    {
+      return 0;
+    }
+    if (wait_bits == 0)
+    {
+      return 0; /* All the entries are ignored */
+    }
+    (void)xEventGroupWaitBits(p_net_ctx->PollEvents, wait_bits, pdFALSE, pdFALSE,
+                              (timeout == portMAX_DELAY) ? portMAX_DELAY : timeout - elapsed);
+  }
+}
+
+int32_t W6X_Net_Select(int32_t nfds, W6X_Net_Fdset_t *readfds, W6X_Net_Fdset_t *writefds,
+                       W6X_Net_Fdset_t *exceptfds, int32_t timeout_ms)
+{
+  W6X_Net_Pollfd_t fds[W61_NET_MAX_CONNECTIONS + 1];
+  uint32_t count = 0;
+  int32_t ret;
+  NULL_ASSERT(p_net_ctx, W6X_Ctx_Null_str);
+
+  if ((nfds < 0) || (nfds > W61_NET_MAX_CONNECTIONS + 1))
+  {
+    return -1;
+  }
+
+  for (int32_t fd = 0; fd < nfds; fd++)
+  {
+    int16_t events = 0;
+    if ((readfds != NULL) && W6X_NET_FD_ISSET(fd, readfds))
+    {
+      events |= W6X_NET_POLLIN;
+    }
+    if ((writefds != NULL) && W6X_NET_FD_ISSET(fd, writefds))
+    {
+      events |= W6X_NET_POLLOUT;
+    }
+    if ((events != 0) || ((exceptfds != NULL) && W6X_NET_FD_ISSET(fd, exceptfds)))
+    {
+      fds[count].fd = fd;
+      fds[count].events = events;
+      fds[count].revents = 0;
+      count++;
+    }
+  }
+
+  ret = W6X_Net_Poll(fds, count, timeout_ms);
+  if (ret < 0)
+  {
+    return ret;
+  }
+
+  /* Report the ready sockets in the sets, hang-up and errors wake up readers */
+  ret = 0;
+  for (int32_t fd = 0; fd < nfds; fd++)
+  {
+    int16_t revents = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      if (fds[i].fd == fd)
+      {
+        revents = fds[i].revents;
+        break;
+      }
+    }
+    if ((readfds != NULL) && W6X_NET_FD_ISSET(fd, readfds))
+    {
+      if ((revents & (W6X_NET_POLLIN | W6X_NET_POLLHUP | W6X_NET_POLLERR)) != 0)
+      {
+        ret++;
+      }
+      else
+      {
+        W6X_NET_FD_CLR(fd, readfds);
+      }
+    }
+    if ((writefds != NULL) && W6X_NET_FD_ISSET(fd, writefds))
+    {
+      if ((revents & (W6X_NET_POLLOUT | W6X_NET_POLLERR)) != 0)
+      {
+        ret++;
+      }
+      else
+      {
+        W6X_NET_FD_CLR(fd, writefds);
+      }
+    }
+    if ((exceptfds != NULL) && W6X_NET_FD_ISSET(fd, exceptfds))
+    {
+      if ((revents & (W6X_NET_POLLERR | W6X_NET_POLLNVAL)) != 0)
+      {
+        ret++;
+      }
+      else
+      {
+        W6X_NET_FD_CLR(fd, exceptfds);
+      }
+    }
+  }
+  return ret;
+}
+
+W6X_Status_t W6X_Net_GetReadStats(uint32_t *Reads, uint32_t *Hits, uint32_t *Pulls)
+{
+  NULL_ASSERT(p_net_ctx, W6X_Ctx_Null_str);
+  NULL_ASSERT(Reads, W6X_Buf_Null_str);
+  NULL_ASSERT(Hits, W6X_Buf_Null_str);
+  NULL_ASSERT(Pulls, W6X_Buf_Null_str);
+
+  *Reads = p_net_ctx->RxReads;
+  *Hits = p_net_ctx->RxHits;
+  *Pulls = p_net_ctx->RxPulls;
+  return W6X_STATUS_OK;
+}
+
+W6X_Status_t W6X_Net_GetCoalesceStats(uint32_t *Writes, uint32_t *Transactions)
+{
+  NULL_ASSERT(p_net_ctx, W6X_Ctx_Null_str);
+  NULL_ASSERT(Writes, W6X_Buf_Null_str);
+  NULL_ASSERT(Transactions, W6X_Buf_Null_str);
+
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  *Writes = p_net_ctx->TxWrites;
+  *Transactions = p_net_ctx->TxTransactions;
+#else
+  *Writes = 0;
+  *Transactions = 0;
+#endif /* W6X_NET_COALESCE_ENABLE */
+  return W6X_STATUS_OK;
+}
+
 ssize_t W6X_Net_Recv(int32_t sock, void *buf, size_t max_len, int32_t flags)
 {
   int32_t ret = -1;
@@ -1283,13 +1751,57 @@ ssize_t W6X_Net_Recv(int32_t sock, void *buf, size_t max_len, int32_t flags)
     NET_LOG_ERROR("Socket state is not connected\n");
     return ret;
   }
+  if (p_net_ctx->Sockets[sock].NonBlocking == 1)
+  {
+    flags |= MSG_DONTWAIT;
+  }
+  /* A peek followed by the read of the same data counts once */
+  if (p_net_ctx->Sockets[sock].PeekLen > 0) /* Serve the read from the data already peeked */
+  {
+    p_net_ctx->RxReads += ((flags & MSG_PEEK) == 0) ? 1U : 0U;
+    return (ssize_t)W6X_Net_Peek_Copy(sock, buf, max_len, flags);
+  }
+#if (W6X_NET_READAHEAD_ENABLE == 1)
+  if (p_net_ctx->Sockets[sock].RxLen > 0) /* Serve the read from the data pulled ahead */
+  {
+    if ((flags & MSG_PEEK) == 0)
+    {
+      p_net_ctx->RxReads++;
+      p_net_ctx->RxHits++;
+    }
+    return (ssize_t)W6X_Net_ReadAhead_Copy(sock, buf, max_len, flags);
+  }
+#endif /* W6X_NET_READAHEAD_ENABLE */
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  /* The peer cannot answer the writes still held on the host */
+  (void)W6X_Net_Flush(sock);
+#endif /* W6X_NET_COALESCE_ENABLE */
   if ((p_net_ctx->Connection[p_net_ctx->Sockets[sock].Number].SocketConnected == 0) &&
       (p_net_ctx->Connection[p_net_ctx->Sockets[sock].Number].DataAvailableSize == 0))
   {
     return -1;
   }
   /* Pull data from the socket */
-  ret = W6X_Net_Wait_Pull_Data(sock, p_net_ctx->Sockets[sock].Number, buf, max_len);
+  if ((flags & MSG_PEEK) != 0)
+  {
+    /* Keep the data pulled on the host for the next read */
+    ret = W6X_Net_Peek_Fill(sock, p_net_ctx->Sockets[sock].Number, buf, max_len, flags);
+  }
+#if (W6X_NET_READAHEAD_ENABLE == 1)
+  else if ((p_net_ctx->Sockets[sock].Protocol != W6X_NET_UDP_PROTOCOL) && (max_len < W6X_NET_READAHEAD_SIZE))
+  {
+    /* Small read on a stream socket: pull ahead to serve the next ones from RAM */
+    ret = W6X_Net_ReadAhead_Fill(sock, p_net_ctx->Sockets[sock].Number, buf, max_len, flags);
+  }
+#endif /* W6X_NET_READAHEAD_ENABLE */
+  else
+  {
+    ret = W6X_Net_Wait_Pull_Data(sock, p_net_ctx->Sockets[sock].Number, buf, max_len, flags);
+  }
+  if ((ret > 0) && ((flags & MSG_PEEK) == 0))
+  {
+    p_net_ctx->RxReads++;
+  }
   if ((ret < 0) && (ret != -2))
   {
     NET_LOG_ERROR("Pull data from socket failed\n");
@@ -1351,7 +1863,7 @@ ssize_t W6X_Net_Sendto(int32_t sock, const void *buf, size_t len, int32_t flags,
       NET_LOG_ERROR("No connection available\n");
       return ret;
     }
-    p_net_ctx->Sockets[sock].Number = conn_to_use;
+    W6X_Net_Set_Owner(sock, conn_to_use);
     p_net_ctx->Connection[conn_to_use].SocketConnected = 1;
     p_net_ctx->Sockets[sock].Status = W6X_NET_SOCKET_CONNECTED;
   }
@@ -1371,7 +1883,7 @@ ssize_t W6X_Net_Sendto(int32_t sock, const void *buf, size_t len, int32_t flags,
   else if (p_net_ctx->Sockets[sock].Status == W6X_NET_SOCKET_LISTENING)
   {
     /* Check if the socket is a server */
-    connection_id = W6X_Net_Find_Connection(ipaddr, p_net_ctx->Sockets[sock].RemotePort);
+    connection_id = W6X_Net_Find_Connection(addr_in->sin_addr.s_addr, p_net_ctx->Sockets[sock].RemotePort);
     if (connection_id >= 0) /* Check if the connection is found */
     {
       /* Send the data */
@@ -1410,6 +1922,10 @@ ssize_t W6X_Net_Recvfrom(int32_t sock, void *buf, size_t max_len, int32_t flags,
   {
     return ret;
   }
+  if (p_net_ctx->Sockets[sock].NonBlocking == 1)
+  {
+    flags |= MSG_DONTWAIT;
+  }
 
   /* If the socket is connected, receive data */
   if (p_net_ctx->Sockets[sock].Status == W6X_NET_SOCKET_CONNECTED)
@@ -1432,25 +1948,53 @@ ssize_t W6X_Net_Recvfrom(int32_t sock, void *buf, size_t max_len, int32_t flags,
   /* If the socket is a server, receive data from the client */
   if (p_net_ctx->Sockets[sock].Status == W6X_NET_SOCKET_LISTENING)
   {
+    if (p_net_ctx->Sockets[sock].PeekLen > 0) /* Serve the read from the data already peeked */
+    {
+      addr_in->sin_port = PP_HTONS(p_net_ctx->Sockets[sock].PeekRemotePort);
+      addr_in->sin_addr.s_addr = p_net_ctx->Sockets[sock].PeekRemoteIP;
+      return (ssize_t)W6X_Net_Peek_Copy(sock, buf, max_len, flags);
+    }
+
     while (1)
     {
+      /* Clear the events before polling so that a datagram received meanwhile ends the wait */
+      (void)xEventGroupClearBits(p_net_ctx->PollEvents, W6X_NET_POLL_EVT_ALL);
       udp_connection = W6X_Net_Poll_UDP_Sockets(addr_in); /* Poll the UDP sockets */
       if (udp_connection != -1)
       {
         break;
       }
+      if ((flags & MSG_DONTWAIT) != 0)
+      {
+        return W6X_NET_EAGAIN; /* No datagram pending */
+      }
 
-      vTaskDelay(1); /* Wait a bit before polling again */
       currentTime = xPortIsInsideInterrupt() ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
       /* Check if time to receive data has elapsed */
-      if ((currentTime - startTime) > (TickType_t) p_net_ctx->Sockets[sock].RecvTimeout)
+      if ((currentTime - startTime) >= (TickType_t) p_net_ctx->Sockets[sock].RecvTimeout)
       {
         NET_LOG_ERROR("No data received within %" PRIu32 " s\n", p_net_ctx->Sockets[sock].RecvTimeout / 1000);
         return 0;
       }
+      /* Wait for an event on any connection */
+      (void)xEventGroupWaitBits(p_net_ctx->PollEvents, W6X_NET_POLL_EVT_ALL, pdFALSE, pdFALSE,
+                                (TickType_t) p_net_ctx->Sockets[sock].RecvTimeout - (currentTime - startTime));
     }
 
-    ret = W6X_Net_Wait_Pull_Data(sock, udp_connection, buf, max_len); /* Pull data from the socket */
+    if ((flags & MSG_PEEK) != 0)
+    {
+      /* Keep the data pulled and its source on the host for the next read */
+      ret = W6X_Net_Peek_Fill(sock, udp_connection, buf, max_len, flags);
+      if (ret > 0)
+      {
+        p_net_ctx->Sockets[sock].PeekRemoteIP = addr_in->sin_addr.s_addr;
+        p_net_ctx->Sockets[sock].PeekRemotePort = p_net_ctx->Connection[udp_connection].RemotePort;
+      }
+    }
+    else
+    {
+      ret = W6X_Net_Wait_Pull_Data(sock, udp_connection, buf, max_len, flags); /* Pull data from the socket */
+    }
     if ((ret < 0) && (ret != -2))
     {
       NET_LOG_ERROR("Pull data from socket failed\n");
@@ -1499,6 +2043,12 @@ int32_t W6X_Net_Getsockopt(int32_t sock, int32_t level, int32_t optname, void *o
       case SO_RCVBUF: /* Get the Receive buffer length */
         value = p_net_ctx->Sockets[sock].RecvBuffSize;
         break;
+      case SO_RCVMODE: /* Get the Receive mode */
+        value = p_net_ctx->Sockets[sock].RecvMode;
+        break;
+      case SO_NONBLOCK: /* Get the Non-blocking mode */
+        value = p_net_ctx->Sockets[sock].NonBlocking;
+        break;
       default:
         return ret;
         break;
@@ -1522,12 +2072,27 @@ int32_t W6X_Net_Setsockopt(int32_t sock, int32_t level, int32_t optname, const v
   NULL_ASSERT(p_DrvObj, W6X_Net_Uninit_str);
   NULL_ASSERT(p_net_ctx, W6X_Ctx_Null_str);
 
+#if (W6X_NET_COALESCE_ENABLE == 1)
+  if ((level == SOL_SOCKET) && (optname == TCP_NODELAY) &&
+      (p_net_ctx->Sockets[sock].Status == W6X_NET_SOCKET_CONNECTED))
+  {
+    /* Once connected, TCP_NODELAY only switches the write coalescing of the host */
+    if ((value < 0) || (value > 1)) /* Only 0 or 1 */
+    {
+      return ret;
+    }
+    p_net_ctx->Sockets[sock].TcpNoDelay = value;
+    return (value == 1) ? W6X_Net_Flush(sock) : 0;
+  }
+#endif /* W6X_NET_COALESCE_ENABLE */
+
   /* Check if the socket is initialized but not yet used */
   if (p_net_ctx->Sockets[sock].Status != W6X_NET_SOCKET_ALLOCATED)
   {
-    if ((level == SOL_TLS) || ((optname != SO_SNDTIMEO) && (optname != SO_RCVTIMEO)))
+    if ((level == SOL_TLS) || ((optname != SO_SNDTIMEO) && (optname != SO_RCVTIMEO) && (optname != SO_RCVMODE) &&
+                               (optname != SO_NONBLOCK)))
     {
-      /* Only Timeouts can be set once server or client is started */
+      /* Only Timeouts, receive and non-blocking modes can be set once server or client is started */
       NET_LOG_ERROR("Socket has already been started\n");
       return ret;
     }
@@ -1564,6 +2129,20 @@ int32_t W6X_Net_Setsockopt(int32_t sock, int32_t level, int32_t optname, const v
         }
         p_net_ctx->Sockets[sock].RecvTimeout = value;
         break;
+      case SO_RCVMODE:
+        if ((value != W6X_NET_RECV_LATENCY) && (value != W6X_NET_RECV_THROUGHPUT))
+        {
+          return ret;
+        }
+        p_net_ctx->Sockets[sock].RecvMode = value;
+        break;
+      case SO_NONBLOCK:
+        if ((value < 0) || (value > 1)) /* Only 0 or 1 */
+        {
+          return ret;
+        }
+        p_net_ctx->Sockets[sock].NonBlocking = value;
+        break;
       case SO_RCVBUF: /* Set the Receive buffer length */
         if (value < 0)
         {
@@ -1888,10 +2467,12 @@ static void W6X_Net_cb(W61_event_id_t event_id, void *event_args)
       p_net_ctx->Connection[p_param_net_data->socket_id].RemotePort = p_param_net_data->remote_port;
       (void)W6X_Net_Inet_pton(AF_INET, p_param_net_data->remote_ip,
                               &p_net_ctx->Connection[p_param_net_data->socket_id].RemoteIP);
+      p_net_ctx->Connection[p_param_net_data->socket_id].RemoteValid = 1;
       if (p_net_ctx->Connection[p_param_net_data->socket_id].DataAvailable != NULL)
       {
         (void)xSemaphoreGive(p_net_ctx->Connection[p_param_net_data->socket_id].DataAvailable);
       }
+      (void)xEventGroupSetBits(p_net_ctx->PollEvents, W6X_NET_POLL_EVT(p_param_net_data->socket_id));
       /* Call the application callback to notify the data available */
       p_cb_handler->APP_net_cb(W6X_NET_EVT_SOCK_DATA_ID, (void *) p_param_net_data);
       break;
@@ -1899,11 +2480,20 @@ static void W6X_Net_cb(W61_event_id_t event_id, void *event_args)
     case W61_NET_EVT_SOCK_CONNECTED_ID:
       NET_LOG_DEBUG("Socket %" PRIu32 " connected\n", p_param_net_data->socket_id);
       p_net_ctx->Connection[p_param_net_data->socket_id].SocketConnected = 1;
+      p_net_ctx->Connection[p_param_net_data->socket_id].RemoteValid = 0; /* Known with the first data */
+      (void)xEventGroupSetBits(p_net_ctx->PollEvents, W6X_NET_POLL_EVT(p_param_net_data->socket_id));
       break;
 
     case W61_NET_EVT_SOCK_DISCONNECTED_ID:
       NET_LOG_DEBUG("Socket %" PRIu32 " disconnected\n", p_param_net_data->socket_id);
       p_net_ctx->Connection[p_param_net_data->socket_id].SocketConnected = 0;
+      p_net_ctx->Connection[p_param_net_data->socket_id].RemoteValid = 0;
+      /* Wake up the receiver waiting for data */
+      if (p_net_ctx->Connection[p_param_net_data->socket_id].DataAvailable != NULL)
+      {
+        (void)xSemaphoreGive(p_net_ctx->Connection[p_param_net_data->socket_id].DataAvailable);
+      }
+      (void)xEventGroupSetBits(p_net_ctx->PollEvents, W6X_NET_POLL_EVT(p_param_net_data->socket_id));
       break;
 
     default:
@@ -1925,67 +2515,59 @@ static int32_t W6X_Net_TranslateErrorStatus(W61_Status_t ret61)
   }
 }
 
-static int32_t W6X_Net_Find_Connection(char *remote_ip, uint32_t remoteport)
+static int32_t W6X_Net_Find_Connection(uint32_t remote_ip, uint32_t remoteport)
 {
-  int32_t ret = -1;
-  uint8_t ip_addr[4];
+  W6X_Net_Connection_t *p_conn;
   W61_Net_Connection_t conn;
 
-  Parser_StrToIP(remote_ip, ip_addr);
-
   for (int32_t i = 0; i < W61_NET_MAX_CONNECTIONS; i++)
   {
-    int32_t found = 0;
-    if (p_net_ctx->Connection[i].SocketConnected == 1)
+    p_conn = &p_net_ctx->Connection[i];
+    if ((p_conn->SocketConnected == 0) ||
+        ((p_conn->Owner >= 0) && (p_net_ctx->Sockets[p_conn->Owner].Status == W6X_NET_SOCKET_CONNECTED)))
     {
-      for (int32_t j = 0; j < W61_NET_MAX_CONNECTIONS + 1; j++)
+      continue; /* Connection not active or already used by a connected socket */
+    }
+    if (p_conn->RemoteValid == 0)
+    {
+      /* No data received yet on this connection: get its peer once from the NCP */
+      if (W61_Net_GetSocketInformation(p_DrvObj, i, &conn) != W61_STATUS_OK)
       {
-        if ((p_net_ctx->Sockets[j].Number == i) && (p_net_ctx->Sockets[j].Status == W6X_NET_SOCKET_CONNECTED))
-        {
-          found = 1; /* Already connected */
-          break;
-        }
-      }
-      if (found == 0)
-      {
-        /* Get the socket information */
-        ret = W6X_Net_TranslateErrorStatus(W61_Net_GetSocketInformation(p_DrvObj, i, &conn));
-
-        if (ret == 0)
-        {
-          /* Check if IP Address and port match with the current connection */
-          if ((strncmp(conn.RemoteIP, remote_ip, sizeof(conn.RemoteIP)) == 0) && (remoteport == conn.RemotePort))
-          {
-            return i; /* Found the connection */
-          }
-        }
+        continue;
       }
+      p_conn->RemotePort = (uint16_t)conn.RemotePort;
+      (void)W6X_Net_Inet_pton(AF_INET, conn.RemoteIP, &p_conn->RemoteIP);
+      p_conn->RemoteValid = 1;
+    }
+    if ((p_conn->RemoteIP == remote_ip) && (p_conn->RemotePort == remoteport))
+    {
+      return i; /* Found the connection */
     }
   }
-  return ret;
+  return -1;
+}
+
+static void W6X_Net_Set_Owner(int32_t sock, int32_t connection_id)
+{
+  int32_t previous = p_net_ctx->Sockets[sock].Number;
+
+  if ((previous < W61_NET_MAX_CONNECTIONS) && (p_net_ctx->Connection[previous].Owner == sock))
+  {
+    p_net_ctx->Connection[previous].Owner = -1;
+  }
+  p_net_ctx->Sockets[sock].Number = connection_id;
+  p_net_ctx->Connection[connection_id].Owner = sock;
 }
 
 static int32_t W6X_Net_Poll_UDP_Sockets(struct sockaddr_in *remote_addr)
 {
-  int32_t found_socket = 0;
   for (int32_t i = 0; i < W61_NET_MAX_CONNECTIONS ; i++)
   {
-    /* Find the first active connection with pending data */
-    if ((p_net_ctx->Connection[i].SocketConnected != 1) || (p_net_ctx->Connection[i].DataAvailableSize == 0))
-    {
-      continue; /* Connection not active or no data available */
-    }
-    /* Since this function is used for UDP server to look for data to read,
+    /* Find the first active connection with pending data.
+     * Since this function is used for UDP server to look for data to read,
      * skip a connection if used by an existing socket (which would be a client) */
-    for (int32_t j = 0; j < W61_NET_MAX_CONNECTIONS + 1 ; j++)
-    {
-      if (p_net_ctx->Sockets[j].Number == i)
-      {
-        found_socket = 1; /* Connection already used by a socket */
-        break;
-      }
-    }
-    if (found_socket == 0) /* Connection not used by any socket */
+    if ((p_net_ctx->Connection[i].SocketConnected == 1) && (p_net_ctx->Connection[i].DataAvailableSize > 0) &&
+        (p_net_ctx->Connection[i].Owner < 0))
     {
       remote_addr->sin_port = PP_HTONS(p_net_ctx->Connection[i].RemotePort);
       remote_addr->sin_addr.s_addr = p_net_ctx->Connection[i].RemoteIP;
@@ -1995,44 +2577,148 @@ static int32_t W6X_Net_Poll_UDP_Sockets(struct sockaddr_in *remote_addr)
   return -1;
 }
 
-static int32_t W6X_Net_Wait_Pull_Data(int32_t sock, int32_t connection_id, void *buf, size_t max_len)
+static int16_t W6X_Net_Poll_Socket(int32_t sock, int16_t events, EventBits_t *wait_bits)
+{
+  W6X_Net_Socket_t *p_sock;
+  W6X_Net_Connection_t *p_conn;
+  struct sockaddr_in remote_addr;
+  int16_t revents = 0;
+
+  if (sock < 0)
+  {
+    return 0; /* Ignored entry */
+  }
+  if ((sock >= W61_NET_MAX_CONNECTIONS + 1) || (p_net_ctx->Sockets[sock].Status == W6X_NET_SOCKET_RESET))
+  {
+    return W6X_NET_POLLNVAL;
+  }
+  p_sock = &p_net_ctx->Sockets[sock];
+
+  switch (p_sock->Status)
+  {
+    case W6X_NET_SOCKET_CONNECTED:
+      p_conn = &p_net_ctx->Connection[p_sock->Number];
+      *wait_bits |= W6X_NET_POLL_EVT(p_sock->Number);
+      if ((p_conn->DataAvailableSize > 0) || (p_sock->PeekLen > 0))
+      {
+        revents |= W6X_NET_POLLIN;
+      }
+#if (W6X_NET_READAHEAD_ENABLE == 1)
+      if (p_sock->RxLen > 0)
+      {
+        revents |= W6X_NET_POLLIN;
+      }
+#endif /* W6X_NET_READAHEAD_ENABLE */
+      if (p_conn->SocketConnected == 0)
+      {
+        revents |= W6X_NET_POLLHUP;
+      }
+      else
+      {
+        revents |= W6X_NET_POLLOUT; /* W6X_Net_Send blocks until the NCP accepted the data */
+      }
+#if (W6X_NET_COALESCE_ENABLE == 1)
+      if (p_sock->TxError == 1)
+      {
+        revents |= W6X_NET_POLLERR;
+      }
+#endif /* W6X_NET_COALESCE_ENABLE */
+      break;
+
+    case W6X_NET_SOCKET_LISTENING:
+      /* Any connection of the NCP can bring a client or a datagram */
+      *wait_bits |= W6X_NET_POLL_EVT_ALL;
+      if (p_sock->Protocol == W6X_NET_UDP_PROTOCOL)
+      {
+        if ((p_sock->PeekLen > 0) || (W6X_Net_Poll_UDP_Sockets(&remote_addr) >= 0))
+        {
+          revents |= W6X_NET_POLLIN;
+        }
+        break;
+      }
+      for (int32_t i = 0; (i < W61_NET_MAX_CONNECTIONS) && (revents == 0); i++)
+      {
+        int32_t owner = p_net_ctx->Connection[i].Owner;
+        /* Connection not yet accepted, unless a connected socket owns it */
+        if ((p_net_ctx->Connection[i].SocketConnected == 1) &&
+            ((owner < 0) || (p_net_ctx->Sockets[owner].Status != W6X_NET_SOCKET_CONNECTED)))
+        {
+          revents = W6X_NET_POLLIN;
+        }
+      }
+      break;
+
+    case W6X_NET_SOCKET_ALLOCATED:
+    case W6X_NET_SOCKET_BIND:
+      /* Another task may connect it, on a connection not known yet */
+      *wait_bits |= W6X_NET_POLL_EVT_ALL;
+      if (p_sock->Protocol == W6X_NET_UDP_PROTOCOL)
+      {
+        revents |= W6X_NET_POLLOUT; /* W6X_Net_Sendto opens the connection */
+      }
+      break;
+
+    default:
+      revents |= W6X_NET_POLLHUP; /* Closing */
+      break;
+  }
+
+  /* Errors and hang-up are reported even if not requested */
+  return revents & (events | W6X_NET_POLLERR | W6X_NET_POLLHUP | W6X_NET_POLLNVAL);
+}
+
+static int32_t W6X_Net_Wait_Pull_Data(int32_t sock, int32_t connection_id, void *buf, size_t max_len,
+                                      int32_t flags)
 {
   uint32_t received_data_len = 0;
   int32_t ret;
   NULL_ASSERT(p_net_ctx, W6X_Ctx_Null_str);
+  W6X_Net_Connection_t *p_conn = &p_net_ctx->Connection[connection_id];
+  TickType_t timeout = ((flags & MSG_DONTWAIT) != 0) ? 0 : (TickType_t)p_net_ctx->Sockets[sock].RecvTimeout;
+  TickType_t t0 = xTaskGetTickCount();
+  TickType_t elapsed;
+
+  if (p_conn->DataAvailable == NULL)
+  {
+    return 0;
+  }
 
-  int32_t cpt = 0;
-  BaseType_t sem_taken = pdFALSE;
-  do
+  /* Block until data is notified, the connection is closed or the deadline is reached.
+   * The semaphore may have been given for data already pulled, hence the size check */
+  while ((p_conn->DataAvailableSize == 0) && (p_conn->SocketConnected == 1))
   {
-    if ((p_net_ctx->Connection[connection_id].SocketConnected == 1) ||
-        (p_net_ctx->Connection[connection_id].DataAvailableSize > 0))
+    elapsed = xTaskGetTickCount() - t0;
+    if (elapsed >= timeout)
     {
-      if (p_net_ctx->Connection[connection_id].DataAvailable != NULL)
-      {
-        sem_taken = xSemaphoreTake(p_net_ctx->Connection[connection_id].DataAvailable,
-                                   (TickType_t)(100));
-      }
+      break;
     }
-    cpt ++;
-  } while (sem_taken != pdTRUE && cpt < (p_net_ctx->Sockets[sock].RecvTimeout / 100));
+    (void)xSemaphoreTake(p_conn->DataAvailable, timeout - elapsed);
+  }
 
-  /* Check recv len before semaphore take (in case previous set of data was not completely read) */
-  if (sem_taken == pdTRUE)
+  if ((p_conn->DataAvailableSize == 0) && (p_conn->SocketConnected == 1) && ((flags & MSG_DONTWAIT) != 0))
+  {
+    return W6X_NET_EAGAIN; /* Nothing to read yet */
+  }
+
+  if (p_conn->DataAvailableSize > 0)
   {
     if (max_len > p_net_ctx->Sockets[sock].RecvBuffSize) /* Attempt read */
     {
       max_len = p_net_ctx->Sockets[sock].RecvBuffSize;
     }
 
-    while (p_net_ctx->Connection[connection_id].DataAvailableSize < max_len)
+    if ((p_net_ctx->Sockets[sock].RecvMode == W6X_NET_RECV_THROUGHPUT) && ((flags & MSG_DONTWAIT) == 0))
     {
-      /* In TCP, wait another +IPD for maximum 3 ms to maximize data available to fetch */
-      /* In UDP, wait more +IPDs for maximum 3 ms to maximize data available to fetch */
-      BaseType_t sem_status = xSemaphoreTake(p_net_ctx->Connection[connection_id].DataAvailable, (TickType_t) 3);
-      if ((sem_status == pdFAIL) || (p_net_ctx->Sockets[sock].Protocol == W6X_NET_TCP_PROTOCOL))
+      /* Gather more data notifications, up to W6X_NET_RECV_GATHER_TIME, to pull larger chunks */
+      t0 = xTaskGetTickCount();
+      while ((p_conn->DataAvailableSize < max_len) && (p_conn->SocketConnected == 1))
       {
-        break;
+        elapsed = xTaskGetTickCount() - t0;
+        if ((elapsed >= pdMS_TO_TICKS(W6X_NET_RECV_GATHER_TIME)) ||
+            (xSemaphoreTake(p_conn->DataAvailable, pdMS_TO_TICKS(W6X_NET_RECV_GATHER_TIME) - elapsed) != pdPASS))
+        {
+          break;
+        }
       }
     }
     if (max_len > p_net_ctx->Connection[connection_id].DataAvailableSize) /* Attempt read */
@@ -2040,6 +2726,7 @@ static int32_t W6X_Net_Wait_Pull_Data(int32_t sock, int32_t connection_id, void
       max_len = p_net_ctx->Connection[connection_id].DataAvailableSize;
     }
     /* Request data from the socket */
+    p_net_ctx->RxPulls++;
     ret = W6X_Net_TranslateErrorStatus(W61_Net_PullDataFromSocket(p_DrvObj, connection_id,
                                                                   (uint32_t)max_len, (uint8_t *)buf,
                                                                   &received_data_len, W6X_NET_PULL_DATA_TIMEOUT));
@@ -2077,6 +2764,260 @@ static int32_t W6X_Net_Wait_Pull_Data(int32_t sock, int32_t connection_id, void
   return received_data_len;
 }
 
+#if (W6X_NET_READAHEAD_ENABLE == 1)
+static int32_t W6X_Net_ReadAhead_Copy(int32_t sock, void *buf, size_t max_len, int32_t flags)
+{
+  W6X_Net_Socket_t *p_sock = &p_net_ctx->Sockets[sock];
+  uint32_t len = (max_len < p_sock->RxLen) ? (uint32_t)max_len : p_sock->RxLen;
+
+  memcpy(buf, &p_sock->RxBuf[p_sock->RxOff], len);
+  if ((flags & MSG_PEEK) == 0)
+  {
+    p_sock->RxOff += len;
+    p_sock->RxLen -= len;
+  }
+  return (int32_t)len;
+}
+
+static int32_t W6X_Net_ReadAhead_Fill(int32_t sock, int32_t connection_id, void *buf, size_t max_len,
+                                      int32_t flags)
+{
+  W6X_Net_Socket_t *p_sock = &p_net_ctx->Sockets[sock];
+  int32_t ret;
+
+  if (p_sock->RxBuf == NULL)
+  {
+    p_sock->RxBuf = pvPortMalloc(W6X_NET_READAHEAD_SIZE);
+    if (p_sock->RxBuf == NULL)
+    {
+      /* No memory for the read-ahead, pull what is asked */
+      return W6X_Net_Wait_Pull_Data(sock, connection_id, buf, max_len, flags);
+    }
+  }
+
+  /* Pulls min(DataAvailableSize, W6X_NET_READAHEAD_SIZE) */
+  ret = W6X_Net_Wait_Pull_Data(sock, connection_id, p_sock->RxBuf, W6X_NET_READAHEAD_SIZE, flags);
+  if (ret <= 0)
+  {
+    return ret;
+  }
+  p_sock->RxOff = 0;
+  p_sock->RxLen = (uint32_t)ret;
+  return W6X_Net_ReadAhead_Copy(sock, buf, max_len, flags);
+}
+#endif /* W6X_NET_READAHEAD_ENABLE */
+
+static int32_t W6X_Net_Peek_Copy(int32_t sock, void *buf, size_t max_len, int32_t flags)
+{
+  W6X_Net_Socket_t *p_sock = &p_net_ctx->Sockets[sock];
+  uint32_t len = (max_len < p_sock->PeekLen) ? (uint32_t)max_len : p_sock->PeekLen;
+
+  memcpy(buf, &p_sock->PeekBuf[p_sock->PeekOff], len);
+  if ((flags & MSG_PEEK) == 0)
+  {
+    p_sock->PeekOff += len;
+    p_sock->PeekLen -= len;
+  }
+  return (int32_t)len;
+}
+
+static int32_t W6X_Net_Peek_Fill(int32_t sock, int32_t connection_id, void *buf, size_t max_len, int32_t flags)
+{
+  W6X_Net_Socket_t *p_sock = &p_net_ctx->Sockets[sock];
+  int32_t ret;
+
+  if (p_sock->PeekBuf == NULL)
+  {
+    p_sock->PeekBuf = pvPortMalloc(W6X_NET_PEEK_SIZE);
+    if (p_sock->PeekBuf == NULL)
+    {
+      NET_LOG_ERROR("Could not allocate the peek buffer\n");
+      return -1;
+    }
+  }
+
+  /* Pulls min(DataAvailableSize, max_len, W6X_NET_PEEK_SIZE) */
+  ret = W6X_Net_Wait_Pull_Data(sock, connection_id, p_sock->PeekBuf,
+                               (max_len < W6X_NET_PEEK_SIZE) ? max_len : W6X_NET_PEEK_SIZE, flags);
+  if (ret <= 0)
+  {
+    return ret;
+  }
+  p_sock->PeekOff = 0;
+  p_sock->PeekLen = (uint32_t)ret;
+  return W6X_Net_Peek_Copy(sock, buf, max_len, flags);
+}
+
+#if (W6X_NET_COALESCE_ENABLE == 1)
+static int32_t W6X_Net_Coalesce_Write(int32_t sock, const void *buf, size_t len)
+{
+  W6X_Net_Socket_t *p_sock = &p_net_ctx->Sockets[sock];
+  uint32_t held = 0;
+  uint8_t flushed = 0;
+
+  if (W6X_Net_Coalesce_Error(sock) != 0)
+  {
+    return -1;
+  }
+
+  while (held == 0)
+  {
+    (void)xSemaphoreTake(p_net_ctx->TxLock[sock], portMAX_DELAY);
+    if ((len < W6X_NET_COALESCE_BUF_SIZE) && ((p_sock->TxLen + len) <= W6X_NET_COALESCE_BUF_SIZE))
+    {
+      if (p_sock->TxBuf == NULL)
+      {
+        p_sock->TxBuf = pvPortMalloc(W6X_NET_COALESCE_BUF_SIZE);
+      }
+      if (p_sock->TxBuf != NULL)
+      {
+        memcpy(&p_sock->TxBuf[p_sock->TxLen], buf, len);
+        if (p_sock->TxLen == 0)
+        {
+          /* Arm the delayed send */
+          p_sock->TxStart = xTaskGetTickCount();
+          (void)xTaskNotifyGive(p_net_ctx->TxFlushTask);
+        }
+        p_sock->TxLen += len;
+        taskENTER_CRITICAL();
+        p_net_ctx->TxWrites++;
+        taskEXIT_CRITICAL();
+        held = p_sock->TxLen;
+      }
+    }
+    (void)xSemaphoreGive(p_net_ctx->TxLock[sock]);
+
+    if (held == 0)
+    {
+      if (flushed == 1)
+      {
+        return 0; /* Nothing to gain, let the caller send it */
+      }
+      /* Keep the byte order: send what is held before this write */
+      if (W6X_Net_Coalesce_Flush(sock) != 0)
+      {
+        return -1;
+      }
+      flushed = 1;
+    }
+  }
+
+  if ((held == W6X_NET_COALESCE_BUF_SIZE) && (W6X_Net_Coalesce_Flush(sock) != 0))
+  {
+    return -1;
+  }
+  return (int32_t)len;
+}
+
+static int32_t W6X_Net_Coalesce_Flush(int32_t sock)
+{
+  W6X_Net_Socket_t *p_sock = &p_net_ctx->Sockets[sock];
+  uint32_t SentDataLen = 0;
+  uint8_t *TxBuf;
+  uint32_t TxLen;
+  uint8_t Number;
+  int32_t ret = 0;
+
+  /* One send at a time per socket keeps the byte order, the writes go on in a new buffer meanwhile */
+  (void)xSemaphoreTake(p_net_ctx->TxSendLock[sock], portMAX_DELAY);
+  (void)xSemaphoreTake(p_net_ctx->TxLock[sock], portMAX_DELAY);
+  TxBuf = p_sock->TxBuf;
+  TxLen = p_sock->TxLen;
+  Number = p_sock->Number;
+  p_sock->TxBuf = NULL;
+  p_sock->TxLen = 0;
+  (void)xSemaphoreGive(p_net_ctx->TxLock[sock]);
+
+  if (TxLen > 0)
+  {
+    ret = W6X_Net_TranslateErrorStatus(W61_Net_SendData(p_DrvObj, Number, TxBuf, TxLen, &SentDataLen,
+                                                        p_sock->SoSndTimeo + 1000));
+    taskENTER_CRITICAL();
+    p_net_ctx->TxTransactions++;
+    taskEXIT_CRITICAL();
+    if ((ret != 0) || (SentDataLen != TxLen))
+    {
+      NET_LOG_ERROR("Coalesced send failed, %" PRIu32 " bytes dropped\n", TxLen - SentDataLen);
+      ret = -1;
+    }
+  }
+
+  /* Give the buffer back unless a write already allocated a new one */
+  (void)xSemaphoreTake(p_net_ctx->TxLock[sock], portMAX_DELAY);
+  if (p_sock->TxBuf == NULL)
+  {
+    p_sock->TxBuf = TxBuf;
+    TxBuf = NULL;
+  }
+  (void)xSemaphoreGive(p_net_ctx->TxLock[sock]);
+  if (TxBuf != NULL)
+  {
+    vPortFree(TxBuf);
+  }
+
+  (void)xSemaphoreGive(p_net_ctx->TxSendLock[sock]);
+  return ret;
+}
+
+static int32_t W6X_Net_Coalesce_Error(int32_t sock)
+{
+  int32_t ret = 0;
+
+  (void)xSemaphoreTake(p_net_ctx->TxLock[sock], portMAX_DELAY);
+  if (p_net_ctx->Sockets[sock].TxError == 1)
+  {
+    p_net_ctx->Sockets[sock].TxError = 0;
+    ret = -1;
+  }
+  (void)xSemaphoreGive(p_net_ctx->TxLock[sock]);
+  return ret;
+}
+
+static void W6X_Net_Coalesce_task(void *arg)
+{
+  TickType_t delay = pdMS_TO_TICKS(W6X_NET_COALESCE_DELAY);
+  TickType_t start;
+  uint32_t pending;
+  uint32_t held;
+
+  while (p_net_ctx->TxStop == 0)
+  {
+    /* Wait for the first write held on any socket, notified on stop as well */
+    (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    do
+    {
+      vTaskDelay(delay);
+      pending = 0;
+      for (int32_t sock = 0; (sock < (W61_NET_MAX_CONNECTIONS + 1)) && (p_net_ctx->TxStop == 0); sock++)
+      {
+        (void)xSemaphoreTake(p_net_ctx->TxLock[sock], portMAX_DELAY);
+        held = p_net_ctx->Sockets[sock].TxLen;
+        start = p_net_ctx->Sockets[sock].TxStart;
+        (void)xSemaphoreGive(p_net_ctx->TxLock[sock]);
+        if (held == 0)
+        {
+          continue;
+        }
+        if ((xTaskGetTickCount() - start) < delay)
+        {
+          pending++;
+        }
+        else if (W6X_Net_Coalesce_Flush(sock) != 0)
+        {
+          /* No caller to report to, keep the failure for the next send or flush of the socket */
+          (void)xSemaphoreTake(p_net_ctx->TxLock[sock], portMAX_DELAY);
+          p_net_ctx->Sockets[sock].TxError = 1;
+          (void)xSemaphoreGive(p_net_ctx->TxLock[sock]);
+        }
+      }
+    } while ((pending > 0) && (p_net_ctx->TxStop == 0));
+  }
+
+  (void)xSemaphoreGive(p_net_ctx->TxStopped);
+  vTaskDelete(NULL);
+}
+#endif /* W6X_NET_COALESCE_ENABLE */
+
 /** @} */
 
 #endif /* ST67_ARCH */
@@ -20,6 +20,7 @@
 #include "w6x_types.h"     /* W6X_ARCH_** */
 #if (ST67_ARCH == W6X_ARCH_T01)
 #include <string.h>
+#include <stdlib.h>
 #include "w6x_api.h"
 #include "shell.h"
 #include "logging.h"
@@ -35,6 +36,10 @@
   */
 #define PING_MAX_SIZE  10000 /*!< Max size of the ping request to send */
 
+#define W6X_SHELL_PINGPONG_MAX_SIZE  1024 /*!< Max size of the net_pingpong messages */
+
+#define W6X_SHELL_HTTP_LATENCY_MAX_COUNT  1000 /*!< Max number of http_latency requests */
+
 /** @} */
 
 /* Private macros ------------------------------------------------------------*/
@@ -124,6 +129,87 @@ int32_t W6X_Shell_Net_SNTP_GetTime(int32_t argc, char **argv);
   */
 int32_t W6X_Shell_Net_ResolveHostAddress(int32_t argc, char **argv);
 
+/**
+  * @brief  Display the write coalescing statistics shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  * @retval ::SHELL_STATUS_ERROR otherwise
+  */
+int32_t W6X_Shell_Net_CoalesceStats(int32_t argc, char **argv);
+
+/**
+  * @brief  Display the socket read statistics shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  * @retval ::SHELL_STATUS_ERROR otherwise
+  */
+int32_t W6X_Shell_Net_ReadStats(int32_t argc, char **argv);
+
+/**
+  * @brief  TCP ping-pong latency measurement shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  * @retval ::SHELL_STATUS_ERROR otherwise
+  */
+int32_t W6X_Shell_Net_PingPong(int32_t argc, char **argv);
+
+/**
+  * @brief  HTTP client request rate measurement shell function.
+  *         Connection reuse and pipelining need an HTTP/1.1 server, e.g. on the test PC:
+  *         python3 -m http.server --protocol HTTP/1.1 8000
+  *         The default HTTP/1.0 of http.server closes the connection after each response
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  * @retval ::SHELL_STATUS_ERROR otherwise
+  */
+int32_t W6X_Shell_HTTP_Bench(int32_t argc, char **argv);
+
+/**
+  * @brief  HTTP client request latency distribution shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  * @retval ::SHELL_STATUS_ERROR otherwise
+  */
+int32_t W6X_Shell_HTTP_Latency(int32_t argc, char **argv);
+
+/**
+  * @brief  Record the tick count at which the response header has been parsed
+  * @param  connection: HTTP connection state
+  * @param  arg: Tick count to set
+  * @param  hdr: Header
+  * @param  hdr_len: Header length
+  * @param  content_len: Content length
+  * @return 0
+  */
+static int32_t W6X_Shell_HTTP_Latency_Header_cb(W6X_HTTP_state_t *connection, void *arg, uint8_t *hdr,
+                                                uint16_t hdr_len, uint32_t content_len);
+
+/**
+  * @brief  Sort latency samples and print their distribution
+  * @param  name: Name of the measured latency
+  * @param  samples: Latency samples in ticks
+  * @param  count: Number of samples
+  */
+static void W6X_Shell_HTTP_Latency_Print(const char *name, TickType_t *samples, int32_t count);
+
+/**
+  * @brief  Compare two latency samples for qsort
+  * @param  a: First sample
+  * @param  b: Second sample
+  * @return Negative, zero or positive value as a is lower, equal or greater than b
+  */
+static int W6X_Shell_Compare_Ticks(const void *a, const void *b);
+
 /* Private Functions Definition ----------------------------------------------*/
 int32_t W6X_Shell_Net_Hostname(int32_t argc, char **argv)
 {
@@ -707,6 +793,463 @@ int32_t W6X_Shell_Net_ResolveHostAddress(int32_t argc, char **argv)
 SHELL_CMD_EXPORT_ALIAS(W6X_Shell_Net_ResolveHostAddress, dnslookup, dnslookup <hostname>);
 #endif /* SHELL_CMD_LEVEL */
 
+int32_t W6X_Shell_Net_CoalesceStats(int32_t argc, char **argv)
+{
+  uint32_t writes = 0;
+  uint32_t transactions = 0;
+
+  if (argc != 1)
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  if (W6X_Net_GetCoalesceStats(&writes, &transactions) != W6X_STATUS_OK)
+  {
+    SHELL_E("Get coalescing statistics failed\n");
+    return SHELL_STATUS_ERROR;
+  }
+  SHELL_PRINTF("Coalesced writes: %" PRIu32 "\n", writes);
+  SHELL_PRINTF("AT send transactions: %" PRIu32 "\n", transactions);
+  SHELL_PRINTF("AT send transactions saved: %" PRIu32 "\n", (writes > transactions) ? writes - transactions : 0);
+  return SHELL_STATUS_OK;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+/** Shell command to display the write coalescing statistics */
+SHELL_CMD_EXPORT_ALIAS(W6X_Shell_Net_CoalesceStats, net_coalesce, net_coalesce. Display the write coalescing statistics);
+#endif /* SHELL_CMD_LEVEL */
+
+int32_t W6X_Shell_Net_ReadStats(int32_t argc, char **argv)
+{
+  uint32_t reads = 0;
+  uint32_t hits = 0;
+  uint32_t pulls = 0;
+
+  if (argc != 1)
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  if (W6X_Net_GetReadStats(&reads, &hits, &pulls) != W6X_STATUS_OK)
+  {
+    SHELL_E("Get read statistics failed\n");
+    return SHELL_STATUS_ERROR;
+  }
+  SHELL_PRINTF("Reads: %" PRIu32 "\n", reads);
+  SHELL_PRINTF("Read-ahead hits: %" PRIu32 " (%" PRIu32 " %%)\n", hits, (reads > 0) ? (uint32_t)(((uint64_t)hits * 100) / reads) : 0);
+  SHELL_PRINTF("AT pulls: %" PRIu32 " (%" PRIu32 ".%02" PRIu32 " per read)\n", pulls,
+               (reads > 0) ? pulls / reads : 0, (reads > 0) ? (uint32_t)(((uint64_t)(pulls % reads) * 100) / reads) : 0);
+  return SHELL_STATUS_OK;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+/** Shell command to display the socket read statistics */
+SHELL_CMD_EXPORT_ALIAS(W6X_Shell_Net_ReadStats, net_readstats, net_readstats. Display the socket read statistics);
+#endif /* SHELL_CMD_LEVEL */
+
+int32_t W6X_Shell_Net_PingPong(int32_t argc, char **argv)
+{
+  static uint8_t buf[W6X_SHELL_PINGPONG_MAX_SIZE];
+  struct sockaddr_in addr = {0};
+  int32_t port;
+  int32_t count = 100;
+  int32_t size = 32;
+  int32_t mode = W6X_NET_RECV_LATENCY;
+  int32_t one = 1;
+  int32_t sock;
+  int32_t received;
+  int32_t len;
+  int32_t ret = SHELL_STATUS_ERROR;
+  TickType_t t0;
+  TickType_t rtt;
+  TickType_t rtt_min = portMAX_DELAY;
+  TickType_t rtt_max = 0;
+  uint64_t rtt_sum = 0;
+  int32_t done = 0;
+
+  if ((argc < 3) || (argc > 6))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  port = atoi(argv[2]);
+  if ((W6X_Net_Inet_pton(AF_INET, argv[1], &addr.sin_addr.s_addr) != 1) || (port <= 0) || (port > 0xFFFF))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+  if (argc > 3)
+  {
+    count = atoi(argv[3]);
+  }
+  if (argc > 4)
+  {
+    size = atoi(argv[4]);
+  }
+  if (argc > 5)
+  {
+    mode = atoi(argv[5]);
+  }
+  if ((count <= 0) || (size <= 0) || (size > W6X_SHELL_PINGPONG_MAX_SIZE) ||
+      ((mode != W6X_NET_RECV_LATENCY) && (mode != W6X_NET_RECV_THROUGHPUT)))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  addr.sin_len = sizeof(addr);
+  addr.sin_family = AF_INET;
+  addr.sin_port = PP_HTONS((uint16_t)port);
+
+  sock = W6X_Net_Socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (sock < 0)
+  {
+    SHELL_E("Socket creation failed\n");
+    return SHELL_STATUS_ERROR;
+  }
+  /* Each message goes out on its own, only the receive path is measured */
+  (void)W6X_Net_Setsockopt(sock, SOL_SOCKET, TCP_NODELAY, &one, sizeof(one));
+  (void)W6X_Net_Setsockopt(sock, SOL_SOCKET, SO_RCVMODE, &mode, sizeof(mode));
+  if (W6X_Net_Connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+  {
+    SHELL_E("Connection to the echo server failed\n");
+    goto _err;
+  }
+
+  memset(buf, 'p', size);
+  for (; done < count; done++)
+  {
+    t0 = xTaskGetTickCount();
+    if (W6X_Net_Send(sock, buf, size, 0) != size)
+    {
+      SHELL_E("Send failed\n");
+      goto _err;
+    }
+    for (received = 0; received < size; received += len)
+    {
+      len = W6X_Net_Recv(sock, &buf[received], size - received, 0);
+      if (len <= 0)
+      {
+        SHELL_E("No echo received\n");
+        goto _err;
+      }
+    }
+    rtt = xTaskGetTickCount() - t0;
+    rtt_sum += rtt;
+    rtt_min = (rtt < rtt_min) ? rtt : rtt_min;
+    rtt_max = (rtt > rtt_max) ? rtt : rtt_max;
+  }
+  ret = SHELL_STATUS_OK;
+
+_err:
+  (void)W6X_Net_Close(sock);
+  if (done > 0)
+  {
+    SHELL_PRINTF("%" PRIi32 " round trips of %" PRIi32 " bytes, %s mode\n", done, size,
+                 (mode == W6X_NET_RECV_LATENCY) ? "latency" : "throughput");
+    SHELL_PRINTF("RTT min/avg/max = %" PRIu32 "/%" PRIu32 "/%" PRIu32 " ms\n",
+                 (uint32_t)(((uint64_t)rtt_min * 1000) / configTICK_RATE_HZ),
+                 (uint32_t)((rtt_sum * 1000) / ((uint64_t)done * configTICK_RATE_HZ)),
+                 (uint32_t)(((uint64_t)rtt_max * 1000) / configTICK_RATE_HZ));
+  }
+  return ret;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+/** Shell command to measure the TCP round trip latency against an echo server */
+SHELL_CMD_EXPORT_ALIAS(W6X_Shell_Net_PingPong, net_pingpong,
+                       net_pingpong <echo server IP> <port> [ count ] [ size ] [ receive mode : 0 latency; 1 throughput ]);
+#endif /* SHELL_CMD_LEVEL */
+
+int32_t W6X_Shell_HTTP_Bench(int32_t argc, char **argv)
+{
+  ip_addr_t server = {0};
+  W6X_HTTP_connection_t settings = {0};
+  W6X_HTTP_Client_t *client = NULL;
+  W6X_HTTP_Status_Code_e status;
+  W6X_Status_t send_status;
+  const char *uri = "/";
+  int32_t port;
+  int32_t count = 100;
+  int32_t depth = 1;
+  int32_t reuse = 1;
+  int32_t sent = 0;
+  int32_t done = 0;
+  int32_t errors = 0;
+  int32_t in_flight = 0;
+  int32_t ret = SHELL_STATUS_ERROR;
+  uint32_t connects0 = 0;
+  uint32_t requests0 = 0;
+  uint32_t connects = 0;
+  uint32_t requests = 0;
+  uint32_t rate;
+  TickType_t t0;
+  TickType_t elapsed;
+
+  if ((argc < 3) || (argc > 7))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  port = atoi(argv[2]);
+  if ((W6X_Net_Inet_pton(AF_INET, argv[1], &server.u_addr.ip4.addr) != 1) || (port <= 0) || (port > 0xFFFF))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+  if (argc > 3)
+  {
+    uri = argv[3];
+  }
+  if (argc > 4)
+  {
+    count = atoi(argv[4]);
+  }
+  if (argc > 5)
+  {
+    depth = atoi(argv[5]);
+  }
+  if (argc > 6)
+  {
+    reuse = atoi(argv[6]);
+  }
+  if ((count <= 0) || (depth < 1) || (depth > W6X_HTTP_CLIENT_PIPELINE_DEPTH) || ((reuse != 0) && (reuse != 1)))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+  if (reuse == 0)
+  {
+    /* A new connection per request cannot carry several requests */
+    depth = 1;
+  }
+
+  /* Start from a cold pool so that the first connection is counted */
+  (void)W6X_HTTP_Client_FlushPool();
+  (void)W6X_HTTP_Client_GetPoolStats(&connects0, &requests0);
+  t0 = xTaskGetTickCount();
+  while (done < count)
+  {
+    if (client == NULL)
+    {
+      client = W6X_HTTP_Client_Open(&server, (uint16_t)port, &settings);
+      if (client == NULL)
+      {
+        SHELL_E("Connection to the HTTP server failed\n");
+        goto _err;
+      }
+    }
+    /* Keep up to depth requests in flight on the connection, once the server keeps it open */
+    while ((sent < count) && ((sent - done) < depth))
+    {
+      send_status = W6X_HTTP_Client_Send(client, "GET", uri, NULL, 0);
+      if (send_status == W6X_STATUS_BUSY)
+      {
+        break;
+      }
+      if (send_status != W6X_STATUS_OK)
+      {
+        SHELL_E("Send of request %" PRIi32 " failed\n", sent);
+        goto _err;
+      }
+      sent++;
+    }
+    in_flight = ((sent - done) > in_flight) ? (sent - done) : in_flight;
+    if (W6X_HTTP_Client_Receive(client, &status) != W6X_STATUS_OK)
+    {
+      SHELL_E("No response to request %" PRIi32 "\n", done);
+      goto _err;
+    }
+    if ((status / 100) != 2)
+    {
+      errors++;
+    }
+    done++;
+    if (reuse == 0)
+    {
+      (void)W6X_HTTP_Client_Release(client);
+      (void)W6X_HTTP_Client_FlushPool();
+      client = NULL;
+    }
+  }
+  ret = SHELL_STATUS_OK;
+
+_err:
+  elapsed = xTaskGetTickCount() - t0;
+  if (client != NULL)
+  {
+    (void)W6X_HTTP_Client_Release(client);
+  }
+  (void)W6X_HTTP_Client_GetPoolStats(&connects, &requests);
+  if (done > 0)
+  {
+    elapsed = (elapsed > 0) ? elapsed : 1;
+    rate = (uint32_t)(((uint64_t)done * 100 * configTICK_RATE_HZ) / elapsed);
+    SHELL_PRINTF("%" PRIi32 " requests in %" PRIu32 " ms, pipeline depth %" PRIi32 " (%" PRIi32 " reached), %" PRIi32
+                 " non 2xx responses\n", done, (uint32_t)(((uint64_t)elapsed * 1000) / configTICK_RATE_HZ), depth,
+                 in_flight, errors);
+    SHELL_PRINTF("%" PRIu32 ".%02" PRIu32 " requests/s over %" PRIu32 " connections\n",
+                 rate / 100, rate % 100, connects - connects0);
+    if ((reuse == 1) && ((connects - connects0) > 1))
+    {
+      /* HTTP/1.0 or "Connection: close" responses: the results are the ones of a connection per request */
+      SHELL_PRINTF("Connection not reused: the server closed it %" PRIu32 " times, use an HTTP/1.1 server\n",
+                   connects - connects0 - 1);
+    }
+  }
+  return ret;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+/** Shell command to measure the HTTP client request rate against a local server */
+SHELL_CMD_EXPORT_ALIAS(W6X_Shell_HTTP_Bench, http_bench,
+                       http_bench <server IP> <port> [ uri ] [ count ] [ pipeline depth ]
+                       [ 0 : new connection per request; 1 : reuse connection ]);
+#endif /* SHELL_CMD_LEVEL */
+
+int32_t W6X_Shell_HTTP_Latency(int32_t argc, char **argv)
+{
+  ip_addr_t server = {0};
+  W6X_HTTP_connection_t settings = {0};
+  W6X_HTTP_Client_t *client = NULL;
+  W6X_HTTP_Status_Code_e status;
+  TickType_t *samples;
+  TickType_t t_header = 0;
+  TickType_t t0;
+  const char *uri = "/";
+  int32_t port;
+  int32_t count = 100;
+  int32_t reuse = 1;
+  int32_t done = 0;
+  int32_t errors = 0;
+  int32_t ret = SHELL_STATUS_ERROR;
+
+  if ((argc < 3) || (argc > 6))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  port = atoi(argv[2]);
+  if ((W6X_Net_Inet_pton(AF_INET, argv[1], &server.u_addr.ip4.addr) != 1) || (port <= 0) || (port > 0xFFFF))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+  if (argc > 3)
+  {
+    uri = argv[3];
+  }
+  if (argc > 4)
+  {
+    count = atoi(argv[4]);
+  }
+  if (argc > 5)
+  {
+    reuse = atoi(argv[5]);
+  }
+  if ((count <= 0) || (count > W6X_SHELL_HTTP_LATENCY_MAX_COUNT) || ((reuse != 0) && (reuse != 1)))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  /* Time to the parsed header in the first half, time to the end of the response in the second one */
+  samples = pvPortMalloc(2 * count * sizeof(TickType_t));
+  if (samples == NULL)
+  {
+    SHELL_E("Samples allocation failed\n");
+    return SHELL_STATUS_ERROR;
+  }
+  settings.headers_done_fn = W6X_Shell_HTTP_Latency_Header_cb;
+  settings.callback_arg = &t_header;
+
+  (void)W6X_HTTP_Client_FlushPool();
+  for (; done < count; done++)
+  {
+    /* The connection set up is part of the latency of a request on a new connection */
+    t0 = xTaskGetTickCount();
+    if (client == NULL)
+    {
+      client = W6X_HTTP_Client_Open(&server, (uint16_t)port, &settings);
+      if (client == NULL)
+      {
+        SHELL_E("Connection to the HTTP server failed\n");
+        goto _err;
+      }
+    }
+    t_header = t0;
+    if (W6X_HTTP_Client_Send(client, "GET", uri, NULL, 0) != W6X_STATUS_OK)
+    {
+      SHELL_E("Send of request %" PRIi32 " failed\n", done);
+      goto _err;
+    }
+    if (W6X_HTTP_Client_Receive(client, &status) != W6X_STATUS_OK)
+    {
+      SHELL_E("No response to request %" PRIi32 "\n", done);
+      goto _err;
+    }
+    samples[count + done] = xTaskGetTickCount() - t0;
+    samples[done] = t_header - t0;
+    if ((status / 100) != 2)
+    {
+      errors++;
+    }
+    if (reuse == 0)
+    {
+      (void)W6X_HTTP_Client_Release(client);
+      (void)W6X_HTTP_Client_FlushPool();
+      client = NULL;
+    }
+  }
+  ret = SHELL_STATUS_OK;
+
+_err:
+  if (client != NULL)
+  {
+    (void)W6X_HTTP_Client_Release(client);
+  }
+  if (done > 0)
+  {
+    SHELL_PRINTF("%" PRIi32 " requests, %s, %" PRIi32 " non 2xx responses\n", done,
+                 (reuse == 1) ? "reused connection" : "new connection per request", errors);
+    W6X_Shell_HTTP_Latency_Print("Header  ", samples, done);
+    W6X_Shell_HTTP_Latency_Print("Complete", &samples[count], done);
+  }
+  vPortFree(samples);
+  return ret;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+/** Shell command to measure the HTTP client request latency distribution against a local server */
+SHELL_CMD_EXPORT_ALIAS(W6X_Shell_HTTP_Latency, http_latency,
+                       http_latency <server IP> <port> [ uri ] [ count ]
+                       [ 0 : new connection per request; 1 : reuse connection ]);
+#endif /* SHELL_CMD_LEVEL */
+
+static int32_t W6X_Shell_HTTP_Latency_Header_cb(W6X_HTTP_state_t *connection, void *arg, uint8_t *hdr,
+                                                uint16_t hdr_len, uint32_t content_len)
+{
+  (void)connection;
+  (void)hdr;
+  (void)hdr_len;
+  (void)content_len;
+  *(TickType_t *)arg = xTaskGetTickCount();
+  return 0;
+}
+
+static void W6X_Shell_HTTP_Latency_Print(const char *name, TickType_t *samples, int32_t count)
+{
+  qsort(samples, count, sizeof(TickType_t), W6X_Shell_Compare_Ticks);
+  SHELL_PRINTF("%s min/p50/p90/p99/max = %" PRIu32 "/%" PRIu32 "/%" PRIu32 "/%" PRIu32 "/%" PRIu32 " ms\n", name,
+               (uint32_t)(((uint64_t)samples[0] * 1000) / configTICK_RATE_HZ),
+               (uint32_t)(((uint64_t)samples[(count * 50) / 100] * 1000) / configTICK_RATE_HZ),
+               (uint32_t)(((uint64_t)samples[(count * 90) / 100] * 1000) / configTICK_RATE_HZ),
+               (uint32_t)(((uint64_t)samples[(count * 99) / 100] * 1000) / configTICK_RATE_HZ),
+               (uint32_t)(((uint64_t)samples[count - 1] * 1000) / configTICK_RATE_HZ));
+}
+
+static int W6X_Shell_Compare_Ticks(const void *a, const void *b)
+{
+  TickType_t ta = *(const TickType_t *)a;
+  TickType_t tb = *(const TickType_t *)b;
+
+  return (ta > tb) - (ta < tb);
+}
+
 /** @} */
 
 #endif /* ST67_ARCH */
@@ -20,6 +20,7 @@
 #include "w6x_types.h"     /* W6X_ARCH_** */
 #if (ST67_ARCH == W6X_ARCH_T02)
 #include <string.h>
+#include <stddef.h>
 #include "w6x_api.h"       /* Prototypes of the functions implemented in this file */
 #include "w61_at_api.h"    /* Prototypes of the functions called by this file */
 #include "w6x_internal.h"
@@ -30,6 +31,14 @@
 /* Global variables ----------------------------------------------------------*/
 /* Private typedef -----------------------------------------------------------*/
 /* Private defines -----------------------------------------------------------*/
+/* Segments are handed to the bus layer as is */
+_Static_assert((sizeof(W6X_Netif_Segment_t) == sizeof(struct spi_iovec)) &&
+               (offsetof(W6X_Netif_Segment_t, data) == offsetof(struct spi_iovec, base)) &&
+               (offsetof(W6X_Netif_Segment_t, len) == offsetof(struct spi_iovec, len)),
+               "W6X_Netif_Segment_t must match struct spi_iovec");
+
+_Static_assert(W6X_NETIF_HEADROOM >= SPI_XFER_HEADER_LEN, "W6X_NETIF_HEADROOM too small");
+
 /* Private macros ------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 /** @defgroup ST67W6X_Private_Netif_Variables ST67W6X Network Interface Variables
@@ -106,6 +115,27 @@ int32_t W6X_Netif_output(uint32_t link_id, uint8_t *pBuf, uint32_t len)
   return BusIo_SPI_SendData(type, pBuf, len, pdMS_TO_TICKS(10000));
 }
 
+int32_t W6X_Netif_output_vec(uint32_t link_id, const W6X_Netif_Segment_t *segments, uint32_t count,
+                             uint32_t headroom, W6X_Netif_release_func_t release_fn, void *arg)
+{
+  uint8_t type;
+
+  switch (link_id)
+  {
+    case W6X_NET_IF_STA:
+      type = SPI_MSG_CTRL_TRAFFIC_NETWORK_STA;
+      break;
+    case W6X_NET_IF_AP:
+      type = SPI_MSG_CTRL_TRAFFIC_NETWORK_AP;
+      break;
+    default:
+      return -1;
+  }
+
+  return BusIo_SPI_SendDataVec(type, (const struct spi_iovec *)segments, count, headroom,
+                               release_fn, arg, pdMS_TO_TICKS(10000));
+}
+
 int32_t W6X_Netif_input(uint32_t link_id, void **buffer, uint8_t **data)
 {
   uint8_t type;
@@ -25,6 +25,8 @@
 #include "common_parser.h" /* Common Parser functions */
 #include "FreeRTOS.h"
 #include "spi_iface.h" /* SPI dump function */
+#include "modem_cmd_handler.h" /* AT parser benchmark */
+#include "w61_at_api.h" /* AT request stress test */
 
 /* Global variables ----------------------------------------------------------*/
 /* Private typedef -----------------------------------------------------------*/
@@ -44,6 +46,24 @@ extern void HAL_NVIC_SystemReset(void);
 
 /* Private macros ------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
+/** @addtogroup ST67W6X_Private_System_Variables
+  * @{
+  */
+
+/** Names of the log modules, indexed by LOG_MODULE_xxx */
+static const char *const log_module_names[LOG_MODULE_COUNT] = {"sys", "wifi", "ble", "net", "mqtt"};
+
+/** Compile-time threshold of the log modules, indexed by LOG_MODULE_xxx */
+static const uint32_t log_module_thresholds[LOG_MODULE_COUNT] =
+{
+  SYS_LOG_LEVEL, WIFI_LOG_LEVEL, BLE_LOG_LEVEL, NET_LOG_LEVEL, MQTT_LOG_LEVEL
+};
+
+/** Names of the log levels, indexed by LOG_xxx */
+static const char *const log_level_names[LOG_DEBUG + 1] = {"none", "error", "warn", "info", "debug"};
+
+/** @} */
+
 /* Private function prototypes -----------------------------------------------*/
 /** @addtogroup ST67W6X_Private_System_Functions
   * @{
@@ -136,6 +156,55 @@ int32_t W6X_Shell_ATCommand(int32_t argc, char **argv);
   */
 int32_t spi_dump_shell(int32_t argc, char **argv);
 
+/**
+  * @brief  SPI goodput measurement shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  */
+int32_t spi_perf_shell(int32_t argc, char **argv);
+
+/**
+  * @brief  AT parser throughput measurement shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  * @retval ::SHELL_STATUS_ERROR otherwise
+  */
+int32_t at_perf_shell(int32_t argc, char **argv);
+
+/**
+  * @brief  Log transport statistics shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  */
+int32_t log_stats_shell(int32_t argc, char **argv);
+
+/**
+  * @brief  Log module level shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  */
+int32_t log_level_shell(int32_t argc, char **argv);
+
+#if (W61_AT_REQ_ENABLE == 1)
+/**
+  * @brief  AT request latency stress test shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_UNKNOWN_ARGS if wrong arguments
+  * @retval ::SHELL_STATUS_ERROR otherwise
+  */
+int32_t at_stress_shell(int32_t argc, char **argv);
+#endif /* W61_AT_REQ_ENABLE */
+
 /* Private Functions Definition ----------------------------------------------*/
 int32_t W6X_Shell_GetInfo(int32_t argc, char **argv)
 {
@@ -385,4 +454,193 @@ int32_t spi_dump_shell(int32_t argc, char **argv)
 SHELL_CMD_EXPORT_ALIAS(spi_dump_shell, spi_dump, spi_dump);
 #endif /* SHELL_CMD_LEVEL */
 
+int32_t spi_perf_shell(int32_t argc, char **argv)
+{
+  int32_t duration = 10;
+  int32_t clock_hz = 0;
+
+  if (argc > 3)
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  if (argc > 1)
+  {
+    duration = atoi(argv[1]);
+    if (duration <= 0)
+    {
+      return SHELL_STATUS_UNKNOWN_ARGS;
+    }
+  }
+
+  if (argc > 2)
+  {
+    clock_hz = atoi(argv[2]);
+    if (clock_hz < 0)
+    {
+      return SHELL_STATUS_UNKNOWN_ARGS;
+    }
+  }
+
+  spi_perf((uint32_t)duration * 1000, (uint32_t)clock_hz);
+  return SHELL_STATUS_OK;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+SHELL_CMD_EXPORT_ALIAS(spi_perf_shell, spi_perf,
+                       spi_perf [ duration in seconds ] [ SPI clock in Hz ]. Measure SPI goodput of the running traffic);
+#endif /* SHELL_CMD_LEVEL */
+
+int32_t at_perf_shell(int32_t argc, char **argv)
+{
+  int32_t iterations = 1000;
+
+  if (argc > 2)
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  if (argc > 1)
+  {
+    iterations = atoi(argv[1]);
+    if (iterations <= 0)
+    {
+      return SHELL_STATUS_UNKNOWN_ARGS;
+    }
+  }
+
+  if (modem_cmd_handler_perf((uint32_t)iterations) < 0)
+  {
+    SHELL_E("AT parser benchmark failed\n");
+    return SHELL_STATUS_ERROR;
+  }
+  return SHELL_STATUS_OK;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+SHELL_CMD_EXPORT_ALIAS(at_perf_shell, at_perf,
+                       at_perf [ iterations ]. Measure the AT parser throughput on a recorded AT stream);
+#endif /* SHELL_CMD_LEVEL */
+
+int32_t log_stats_shell(int32_t argc, char **argv)
+{
+  LogStats_t stats = {0};
+
+  if ((argc > 2) || ((argc == 2) && (strncmp(argv[1], "-r", 2) != 0)))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  vLoggingGetStats(&stats);
+  SHELL_PRINTF("Log ring: %" PRIu32 " bytes, high-water %" PRIu32 " bytes\n", stats.ring_size, stats.high_water);
+  SHELL_PRINTF("Messages: %" PRIu32 " posted, %" PRIu32 " dropped (%" PRIu32 " bytes)\n",
+               stats.messages, stats.dropped_messages, stats.dropped_bytes);
+
+  if (argc == 2)
+  {
+    vLoggingResetStats();
+  }
+  return SHELL_STATUS_OK;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+SHELL_CMD_EXPORT_ALIAS(log_stats_shell, log_stats,
+                       log_stats [ -r ]. Display and reset [ -r ] the log transport statistics);
+#endif /* SHELL_CMD_LEVEL */
+
+int32_t log_level_shell(int32_t argc, char **argv)
+{
+  uint32_t module = LOG_MODULE_COUNT;
+  uint32_t level = LOG_DEBUG + 1;
+
+  if ((argc != 1) && (argc != 3))
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  if (argc == 3)
+  {
+    for (uint32_t i = 0; i < LOG_MODULE_COUNT; i++)
+    {
+      if (strcmp(argv[1], log_module_names[i]) == 0)
+      {
+        module = i;
+      }
+    }
+    for (uint32_t i = 0; i <= LOG_DEBUG; i++)
+    {
+      if (strcmp(argv[2], log_level_names[i]) == 0)
+      {
+        level = i;
+      }
+    }
+    if ((module == LOG_MODULE_COUNT) || (level > LOG_DEBUG))
+    {
+      return SHELL_STATUS_UNKNOWN_ARGS;
+    }
+    if (level > log_module_thresholds[module])
+    {
+      SHELL_PRINTF("Warning: %s messages above %s are not compiled in\n",
+                   log_module_names[module], log_level_names[log_module_thresholds[module]]);
+    }
+    vLoggingSetModuleLevel(module, level);
+  }
+
+  for (uint32_t i = 0; i < LOG_MODULE_COUNT; i++)
+  {
+    SHELL_PRINTF("%-5s: %-5s (compiled: %s)\n", log_module_names[i], log_level_names[vLoggingGetModuleLevel(i)],
+                 log_level_names[log_module_thresholds[i]]);
+  }
+  return SHELL_STATUS_OK;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+SHELL_CMD_EXPORT_ALIAS(log_level_shell, log_level,
+                       log_level [ < sys | wifi | ble | net | mqtt > < none | error | warn | info | debug > ].
+                       Display or set the runtime log level of the modules);
+#endif /* SHELL_CMD_LEVEL */
+
+#if (W61_AT_REQ_ENABLE == 1)
+int32_t at_stress_shell(int32_t argc, char **argv)
+{
+  int32_t producers = 4;
+  int32_t requests = 100;
+
+  if (argc > 3)
+  {
+    return SHELL_STATUS_UNKNOWN_ARGS;
+  }
+
+  if (argc > 1)
+  {
+    producers = atoi(argv[1]);
+    if (producers <= 0)
+    {
+      return SHELL_STATUS_UNKNOWN_ARGS;
+    }
+  }
+
+  if (argc > 2)
+  {
+    requests = atoi(argv[2]);
+    if (requests <= 0)
+    {
+      return SHELL_STATUS_UNKNOWN_ARGS;
+    }
+  }
+
+  if (W61_AT_Request_Stress(W61_ObjGet(), (uint32_t)producers, (uint32_t)requests) < 0)
+  {
+    SHELL_E("AT request stress test failed\n");
+    return SHELL_STATUS_ERROR;
+  }
+  return SHELL_STATUS_OK;
+}
+
+#if (SHELL_CMD_LEVEL >= 1)
+SHELL_CMD_EXPORT_ALIAS(at_stress_shell, at_stress,
+                       at_stress [ producers ] [ requests per producer ]. Measure the AT request latency percentiles);
+#endif /* SHELL_CMD_LEVEL */
+#endif /* W61_AT_REQ_ENABLE */
+
 /** @} */
@@ -36,6 +36,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "FreeRTOS.h"
@@ -123,13 +124,21 @@ static uint16_t findcrlf(struct modem_cmd_handler_data *data, uint16_t *offset);
 static bool starts_with(const uint8_t *buf, size_t buf_len, const char *str);
 
 /**
-  * @brief  Skips the first n bytes in the given linear buffer
-  * @details This function advances the buffer pointer by n bytes and decreases the buffer length accordingly.
-  * @param  rx_buf: Pointer to the buffer to be modified
-  * @param  rx_buf_len: Pointer to the length of the buffer; will be updated after skipping
-  * @param  n: Number of bytes to skip from the beginning of the buffer
+  * @brief  Consumes the first n bytes of the RX buffer
+  * @details The read position is advanced in place, the remaining bytes are not moved.
+  *          The buffer is rewound to its start once it is empty.
+  * @param  data: Pointer to the modem_cmd_handler_data structure containing the buffer
+  * @param  n: Number of bytes to consume from the beginning of the buffer
+  */
+static void rx_buf_skip(struct modem_cmd_handler_data *data, size_t n);
+
+/**
+  * @brief  Moves the unprocessed bytes to the start of the RX buffer storage
+  * @details Called before reading from the interface so that the free room is contiguous.
+  *          Only the partial line left by the previous parsing is moved.
+  * @param  data: Pointer to the modem_cmd_handler_data structure containing the buffer
   */
-static void linear_buf_skip(uint8_t *rx_buf, size_t *rx_buf_len, size_t n);
+static void rx_buf_compact(struct modem_cmd_handler_data *data);
 
 /**
   * @brief  Parses parameters from the matched command in the modem command handler data
@@ -163,6 +172,27 @@ static int32_t parse_params(struct modem_cmd_handler_data *data, size_t match_le
   */
 static int32_t process_cmd(const struct modem_cmd *cmd, size_t match_len, struct modem_cmd_handler_data *data);
 
+/**
+  * @brief  Builds the prefix tree of the response and unsolicited command lists
+  * @details The lists are static, the tree is built once so that a line is matched by walking
+  *          its first characters instead of comparing it with every command.
+  * @param  data: Pointer to the modem_cmd_handler_data structure containing the command lists
+  * @return 0 on success, -ENOMEM if the lists are too large or the tree cannot be allocated
+  */
+static int32_t cmd_tree_build(struct modem_cmd_handler_data *data);
+
+/**
+  * @brief  Looks up the first command of the response and unsolicited lists matching a buffer
+  * @details The lists are scanned when the prefix tree could not be built.
+  * @param  data: Pointer to the modem_cmd_handler_data structure containing the prefix tree
+  * @param  buf: Buffer to match
+  * @param  buf_len: Length of the buffer in bytes
+  * @param  direct: true to only consider the direct commands
+  * @return Pointer to the matched modem_cmd structure if a match is found; NULL otherwise
+  */
+static const struct modem_cmd *cmd_tree_lookup(const struct modem_cmd_handler_data *data,
+                                               const uint8_t *buf, size_t buf_len, bool direct);
+
 /**
   * @brief  Finds a matching command in the modem command handler data
   * @details This function searches through the command lists in the modem_cmd_handler_data
@@ -236,7 +266,7 @@ static void skipcrlf(struct modem_cmd_handler_data *data)
   }
   if (skip_count > 0)
   {
-    linear_buf_skip(data->rx_buf, &data->rx_buf_len, skip_count);
+    rx_buf_skip(data, skip_count);
   }
 }
 
@@ -268,19 +298,26 @@ static bool starts_with(const uint8_t *buf, size_t buf_len, const char *str)
   return *str == 0;
 }
 
-static void linear_buf_skip(uint8_t *rx_buf, size_t *rx_buf_len, size_t n)
+static void rx_buf_skip(struct modem_cmd_handler_data *data, size_t n)
 {
-  if (n >= *rx_buf_len)
+  if (n >= data->rx_buf_len)
   {
-    *rx_buf_len = 0;
+    data->rx_buf = data->rx_buf_base;
+    data->rx_buf_len = 0;
   }
   else
   {
-    for (size_t i = 0; i < *rx_buf_len - n; ++i)
-    {
-      rx_buf[i] = rx_buf[i + n];
-    }
-    *rx_buf_len -= n;
+    data->rx_buf += n;
+    data->rx_buf_len -= n;
+  }
+}
+
+static void rx_buf_compact(struct modem_cmd_handler_data *data)
+{
+  if (data->rx_buf != data->rx_buf_base)
+  {
+    memmove(data->rx_buf_base, data->rx_buf, data->rx_buf_len);
+    data->rx_buf = data->rx_buf_base;
   }
 }
 
@@ -422,59 +459,185 @@ static int32_t process_cmd(const struct modem_cmd *cmd, size_t match_len, struct
   if (ret != -EAGAIN)
   {
     /* Skip in case consumed */
-    linear_buf_skip(data->rx_buf, &data->rx_buf_len, skip_len);
+    rx_buf_skip(data, skip_len);
   }
 
   return ret;
 }
 
-static const struct modem_cmd *find_cmd_match(struct modem_cmd_handler_data *data)
+static int32_t cmd_tree_build(struct modem_cmd_handler_data *data)
 {
-  int32_t j;
-  size_t i;
+  size_t nodes = 1;
+  size_t count = 0;
+  uint16_t used = 1;
 
-  for (j = 0; j < ARRAY_SIZE(data->cmds); j++)
+  data->cmd_tree = NULL;
+
+  /* Upper bound of the node count: one per command character, plus the root */
+  for (int32_t j = CMD_RESP; j <= CMD_UNSOL; j++)
   {
-    if (!data->cmds[j] || data->cmds_len[j] == 0U)
+    for (size_t i = 0; i < data->cmds_len[j]; i++)
     {
-      continue;
+      nodes += data->cmds[j][i].cmd_len;
     }
+    count += data->cmds_len[j];
+  }
+
+  if ((nodes >= MODEM_CMD_TREE_NONE) || (count >= MODEM_CMD_TREE_NONE))
+  {
+    return -ENOMEM;
+  }
+
+  data->cmd_tree = pvPortMalloc(nodes * sizeof(struct modem_cmd_node));
+  if (data->cmd_tree == NULL)
+  {
+    return -ENOMEM;
+  }
+  memset(data->cmd_tree, 0xFF, nodes * sizeof(struct modem_cmd_node)); /* MODEM_CMD_TREE_NONE in every index */
 
-    for (i = 0; i < data->cmds_len[j]; i++)
+  /* Commands are numbered in matching order: response list first, then unsolicited list */
+  count = 0;
+  for (int32_t j = CMD_RESP; j <= CMD_UNSOL; j++)
+  {
+    for (size_t i = 0; i < data->cmds_len[j]; i++, count++)
     {
-      /* Match on "empty" cmd */
-      if (strlen(data->cmds[j][i].cmd) == 0 ||
-          strncmp(data->match_buf, data->cmds[j][i].cmd,
-                  data->cmds[j][i].cmd_len) == 0)
+      const struct modem_cmd *cmd = &data->cmds[j][i];
+      struct modem_cmd_node *node = &data->cmd_tree[0];
+
+      for (size_t k = 0; cmd->cmd[k] != '\0'; k++)
+      {
+        uint16_t *link = &node->child;
+
+        while ((*link != MODEM_CMD_TREE_NONE) && (data->cmd_tree[*link].ch != (uint8_t)cmd->cmd[k]))
+        {
+          link = &data->cmd_tree[*link].sibling;
+        }
+        if (*link == MODEM_CMD_TREE_NONE)
+        {
+          *link = used;
+          data->cmd_tree[used++].ch = (uint8_t)cmd->cmd[k];
+        }
+        node = &data->cmd_tree[*link];
+      }
+
+      /* Keep the first command in case of duplicates, as the linear scan would */
+      if (node->match == MODEM_CMD_TREE_NONE)
+      {
+        node->match = (uint16_t)count;
+      }
+      if (cmd->direct && (node->direct == MODEM_CMD_TREE_NONE))
       {
-        return &data->cmds[j][i];
+        node->direct = (uint16_t)count;
       }
     }
   }
 
-  return NULL;
+  return 0;
 }
 
-static const struct modem_cmd *find_cmd_direct_match(struct modem_cmd_handler_data *data)
+static const struct modem_cmd *cmd_tree_lookup(const struct modem_cmd_handler_data *data,
+                                               const uint8_t *buf, size_t buf_len, bool direct)
 {
-  size_t j, i;
+  const struct modem_cmd_node *node;
+  const struct modem_cmd *cmd;
+  uint16_t best;
+  uint16_t next;
 
-  for (j = 0; j < ARRAY_SIZE(data->cmds); j++)
+  if (data->cmd_tree == NULL)
   {
-    if (!data->cmds[j] || data->cmds_len[j] == 0U)
+    for (int32_t j = CMD_RESP; j <= CMD_UNSOL; j++)
     {
-      continue;
+      for (size_t i = 0; i < data->cmds_len[j]; i++)
+      {
+        cmd = &data->cmds[j][i];
+        if ((!direct || cmd->direct) && starts_with(buf, buf_len, cmd->cmd))
+        {
+          return cmd;
+        }
+      }
     }
+    return NULL;
+  }
 
-    for (i = 0; i < data->cmds_len[j]; i++)
+  node = &data->cmd_tree[0];
+  best = direct ? node->direct : node->match;
+  /* Every command ending on the path is a prefix of buf, keep the first one in table order */
+  for (size_t i = 0; i < buf_len; i++)
+  {
+    next = node->child;
+    while ((next != MODEM_CMD_TREE_NONE) && (data->cmd_tree[next].ch != buf[i]))
     {
-      /* Match start of cmd */
-      if (data->cmds[j][i].direct &&
-          (data->cmds[j][i].cmd[0] == '\0' ||
-           starts_with(data->rx_buf, data->rx_buf_len, data->cmds[j][i].cmd)))
-      {
-        return &data->cmds[j][i];
-      }
+      next = data->cmd_tree[next].sibling;
+    }
+    if (next == MODEM_CMD_TREE_NONE)
+    {
+      break;
+    }
+    node = &data->cmd_tree[next];
+    if ((direct ? node->direct : node->match) < best)
+    {
+      best = direct ? node->direct : node->match;
+    }
+  }
+
+  if (best == MODEM_CMD_TREE_NONE)
+  {
+    return NULL;
+  }
+  if (best < data->cmds_len[CMD_RESP])
+  {
+    return &data->cmds[CMD_RESP][best];
+  }
+  return &data->cmds[CMD_UNSOL][best - data->cmds_len[CMD_RESP]];
+}
+
+static const struct modem_cmd *find_cmd_match(struct modem_cmd_handler_data *data)
+{
+  const struct modem_cmd *cmd;
+  size_t i;
+
+  /* Response and unsolicited commands take precedence over the per-request handlers */
+  /* No command contains a NUL character, the walk stops at the end of match_buf */
+  cmd = cmd_tree_lookup(data, (const uint8_t *)data->match_buf, data->match_buf_len, false);
+  if (cmd)
+  {
+    return cmd;
+  }
+
+  /* Few per-request handlers are attached at a time, scan them */
+  for (i = 0; i < data->cmds_len[CMD_HANDLER]; i++)
+  {
+    /* Match on "empty" cmd */
+    if (data->cmds[CMD_HANDLER][i].cmd[0] == '\0' ||
+        strncmp(data->match_buf, data->cmds[CMD_HANDLER][i].cmd,
+                data->cmds[CMD_HANDLER][i].cmd_len) == 0)
+    {
+      return &data->cmds[CMD_HANDLER][i];
+    }
+  }
+
+  return NULL;
+}
+
+static const struct modem_cmd *find_cmd_direct_match(struct modem_cmd_handler_data *data)
+{
+  const struct modem_cmd *cmd;
+  size_t i;
+
+  cmd = cmd_tree_lookup(data, data->rx_buf, data->rx_buf_len, true);
+  if (cmd)
+  {
+    return cmd;
+  }
+
+  for (i = 0; i < data->cmds_len[CMD_HANDLER]; i++)
+  {
+    /* Match start of cmd */
+    if (data->cmds[CMD_HANDLER][i].direct &&
+        (data->cmds[CMD_HANDLER][i].cmd[0] == '\0' ||
+         starts_with(data->rx_buf, data->rx_buf_len, data->cmds[CMD_HANDLER][i].cmd)))
+    {
+      return &data->cmds[CMD_HANDLER][i];
     }
   }
 
@@ -486,7 +649,8 @@ static int32_t cmd_handler_process_iface_data(struct modem_cmd_handler_data *dat
   size_t bytes_read = 0;
   int32_t ret;
 
-  /* Read as much as possible into the linear buffer */
+  /* Read as much as possible after the unprocessed bytes */
+  rx_buf_compact(data);
 
   size_t room = RX_BUF_SIZE - data->rx_buf_len;
   if (room == 0)
@@ -531,7 +695,7 @@ static void cmd_handler_process_rx_buf(struct modem_cmd_handler_data *data)
       else if (ret > 0)
       {
         LOG_DBG("match direct cmd [%s] (ret:%" PRIi32 ")\n", cmd->cmd, ret);
-        linear_buf_skip(data->rx_buf, &data->rx_buf_len, ret);
+        rx_buf_skip(data, ret);
       }
       continue;
     }
@@ -584,7 +748,7 @@ static void cmd_handler_process_rx_buf(struct modem_cmd_handler_data *data)
 
     if (data->rx_buf_len)
     {
-      linear_buf_skip(data->rx_buf, &data->rx_buf_len, offset + 1);
+      rx_buf_skip(data, offset + 1);
     }
   }
 }
@@ -862,6 +1026,21 @@ void modem_cmd_handler_tx_unlock(struct modem_cmd_handler *handler)
   (void)xSemaphoreGive(data->sem_tx_lock);
 }
 
+uint8_t *modem_cmd_handler_swap_rx_buf(struct modem_cmd_handler_data *data, uint8_t *buf, size_t consumed)
+{
+  uint8_t *prev = data->rx_buf_base;
+
+  if (consumed > data->rx_buf_len)
+  {
+    consumed = data->rx_buf_len;
+  }
+  memcpy(buf, data->rx_buf + consumed, data->rx_buf_len - consumed);
+  data->rx_buf_len -= consumed;
+  data->rx_buf_base = buf;
+  data->rx_buf = buf;
+  return prev;
+}
+
 int32_t modem_cmd_handler_init(struct modem_cmd_handler *handler,
                                struct modem_cmd_handler_data *data,
                                const struct modem_cmd_handler_config *config)
@@ -882,9 +1061,16 @@ int32_t modem_cmd_handler_init(struct modem_cmd_handler *handler,
     return -EINVAL;
   }
 
+  /* RX buffer storage is provided by the caller */
+  if (data->rx_buf_base == NULL)
+  {
+    return -EINVAL;
+  }
+
   /* Assign data to command handler */
   handler->cmd_handler_data = data;
-  /* Init rx_buf_len */
+  /* Init rx_buf */
+  data->rx_buf = data->rx_buf_base;
   data->rx_buf_len = 0U;
 
   /* Assign command process implementation to command handler */
@@ -899,6 +1085,12 @@ int32_t modem_cmd_handler_init(struct modem_cmd_handler *handler,
   data->cmds[CMD_UNSOL] = config->unsol_cmds;
   data->cmds_len[CMD_UNSOL] = config->unsol_cmds_len;
 
+  /* Index the static command lists, they are scanned if they cannot be */
+  if (cmd_tree_build(data) < 0)
+  {
+    LOG_ERR("Command lists not indexed, matched by scanning them\n");
+  }
+
   /* Process end of line */
   data->eol_len = data->eol == NULL ? 0 : strlen(data->eol);
 
@@ -912,4 +1104,235 @@ int32_t modem_cmd_handler_init(struct modem_cmd_handler *handler,
   return 0;
 }
 
+void modem_cmd_handler_deinit(struct modem_cmd_handler_data *data)
+{
+  if (data == NULL)
+  {
+    return;
+  }
+
+  if (data->cmd_tree != NULL)
+  {
+    vPortFree(data->cmd_tree);
+    data->cmd_tree = NULL;
+  }
+  if (data->sem_tx_lock != NULL)
+  {
+    vSemaphoreDelete(data->sem_tx_lock);
+    data->sem_tx_lock = NULL;
+  }
+  if (data->sem_parse_lock != NULL)
+  {
+    vSemaphoreDelete(data->sem_parse_lock);
+    data->sem_parse_lock = NULL;
+  }
+}
+
+/* Parser benchmark ----------------------------------------------------------*/
+/** Recorded AT stream replayed by modem_cmd_handler_perf() */
+static const char perf_stream[] =
+  "+CW:CONNECTED\r\n"
+  "+CW:GOTIP\r\n"
+  "+CIP:0,CONNECTED\r\n"
+  "+IPD:0,1460,\"192.168.1.10\",5001\r\n"
+  "+CIPRECVDATA:64,0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\r\n"
+  "OK\r\n"
+  "Recv 1024 bytes\r\n"
+  "SEND OK\r\n"
+  "+IPD:1,512,\"192.168.1.11\",80\r\n"
+  "+CIPRECVDATA:32,0123456789abcdef0123456789abcdef\r\n"
+  "OK\r\n"
+  "+CIP:0,DISCONNECTED\r\n"
+  "+CW:DISCONNECTED\r\n";
+
+/** Replay position in perf_stream */
+static size_t perf_stream_pos;
+
+/** Bytes left to replay */
+static size_t perf_stream_left;
+
+/** Lines matched during the replay */
+static uint32_t perf_matched;
+
+static int32_t perf_iface_read(struct modem_iface *iface, uint8_t *buf, size_t size, size_t *bytes_read)
+{
+  size_t len = 0;
+
+  /* Hand over the stream in chunks, like the SPI messages */
+  while ((len < size) && (perf_stream_left > 0))
+  {
+    size_t n = sizeof(perf_stream) - 1 - perf_stream_pos;
+    n = (n > size - len) ? size - len : n;
+    n = (n > perf_stream_left) ? perf_stream_left : n;
+    memcpy(&buf[len], &perf_stream[perf_stream_pos], n);
+    len += n;
+    perf_stream_left -= n;
+    perf_stream_pos = (perf_stream_pos + n) % (sizeof(perf_stream) - 1);
+  }
+
+  *bytes_read = len;
+  return 0;
+}
+
+MODEM_CMD_DEFINE(perf_on_cmd)
+{
+  perf_matched++;
+  return 0;
+}
+
+MODEM_CMD_DIRECT_DEFINE(perf_on_cmd_pulldata)
+{
+  uint8_t *ptr = data->rx_buf + len;
+  uint8_t *endptr;
+  uint32_t offset;
+  uint16_t rx_data_len;
+
+  data->rx_buf[data->rx_buf_len] = 0;
+
+  rx_data_len = strtol((char *)ptr, (char **)&endptr, 10);
+  if (endptr == data->rx_buf + data->rx_buf_len)
+  {
+    /* Length split by the replay chunking */
+    return -EAGAIN;
+  }
+  if (endptr == ptr || *endptr != ',')
+  {
+    return -EINVAL;
+  }
+  offset = endptr - data->rx_buf + 1;
+
+  if (data->rx_buf_len >= (offset + rx_data_len))
+  {
+    perf_matched++;
+    return offset + rx_data_len;
+  }
+  return -EAGAIN;
+}
+
+int32_t modem_cmd_handler_perf(uint32_t iterations)
+{
+  static const struct modem_cmd perf_response_cmds[] =
+  {
+    MODEM_CMD("OK", perf_on_cmd, 0U, ""),
+    MODEM_CMD("ERROR", perf_on_cmd, 0U, ""),
+  };
+  /* Same prefixes as the driver unsolicited list, plus the commands attached by requests */
+  static const struct modem_cmd perf_unsol_cmds[] =
+  {
+    MODEM_CMD("ready", perf_on_cmd, 0U, ""),
+    MODEM_CMD("+CWLAP:", perf_on_cmd, 8U, ","),
+    MODEM_CMD_DIRECT("+BLE:GATTWRITE:", perf_on_cmd_pulldata),
+    MODEM_CMD_DIRECT("+BLE:GATTREAD:", perf_on_cmd_pulldata),
+    MODEM_CMD_DIRECT("+BLE:NOTIDATA:", perf_on_cmd_pulldata),
+    MODEM_CMD_DIRECT("+MQTT:SUBRECV:", perf_on_cmd_pulldata),
+    MODEM_CMD_ARGS_MAX("+IPD:", perf_on_cmd, 1U, 10U, ","),
+    MODEM_CMD_ARGS_MAX("+CW:", perf_on_cmd, 1U, 10U, ", "),
+    MODEM_CMD_ARGS_MAX("+BLE:", perf_on_cmd, 1U, 11U, ",:()"),
+    MODEM_CMD_ARGS_MAX("+CIP:", perf_on_cmd, 1U, 10U, ","),
+    MODEM_CMD_ARGS_MAX("+MQTT:", perf_on_cmd, 1U, 10U, ","),
+    MODEM_CMD("+PING:", perf_on_cmd, 1U, ""),
+    MODEM_CMD_DIRECT("+CIPRECVDATA:", perf_on_cmd_pulldata),
+    MODEM_CMD("Recv ", perf_on_cmd, 1U, " "),
+    MODEM_CMD("SEND OK", perf_on_cmd, 0U, ""),
+  };
+  struct modem_cmd_handler_config config =
+  {
+    .eol = "",
+    .response_cmds = perf_response_cmds,
+    .response_cmds_len = ARRAY_SIZE(perf_response_cmds),
+    .unsol_cmds = perf_unsol_cmds,
+    .unsol_cmds_len = ARRAY_SIZE(perf_unsol_cmds),
+  };
+  struct modem_iface iface = { .read = perf_iface_read, .write = NULL };
+  struct modem_cmd_handler handler = {0};
+  struct modem_cmd_handler_data data = {0};
+  char match_buf[128];
+  uint64_t total = (uint64_t)iterations * (sizeof(perf_stream) - 1);
+  TickType_t t0;
+  uint32_t elapsed_ms;
+  uint32_t lookups = 0;
+  int32_t ret = -ENOMEM;
+
+  if ((iterations == 0) || (total > UINT32_MAX))
+  {
+    return -EINVAL;
+  }
+
+  config.match_buf = match_buf;
+  config.match_buf_len = sizeof(match_buf);
+  data.rx_buf_base = pvPortMalloc(RX_BUF_ALLOC_SIZE);
+  if (data.rx_buf_base == NULL)
+  {
+    return -ENOMEM;
+  }
+
+  if (modem_cmd_handler_init(&handler, &data, &config) < 0)
+  {
+    vPortFree(data.rx_buf_base);
+    return -ENOMEM;
+  }
+  if ((data.sem_tx_lock == NULL) || (data.sem_parse_lock == NULL))
+  {
+    goto out;
+  }
+
+  perf_stream_pos = 0;
+  perf_stream_left = (size_t)total;
+  perf_matched = 0;
+
+  t0 = xTaskGetTickCount();
+  while (perf_stream_left > 0)
+  {
+    if (cmd_handler_process_iface_data(&data, &iface) < 0)
+    {
+      break;
+    }
+    cmd_handler_process_rx_buf(&data);
+  }
+  elapsed_ms = (uint32_t)(((uint64_t)(xTaskGetTickCount() - t0) * 1000) / configTICK_RATE_HZ);
+
+  LogInfo("Parsed                %" PRIu32 " bytes, %" PRIu32 " lines matched\n", (uint32_t)total, perf_matched);
+  LogInfo("Duration              %" PRIu32 " ms\n", elapsed_ms);
+  if (elapsed_ms > 0)
+  {
+    LogInfo("Parse throughput      %" PRIu32 ".%03" PRIu32 " MB/s\n",
+            (uint32_t)((total / elapsed_ms) / 1000), (uint32_t)((total / elapsed_ms) % 1000));
+  }
+
+  /* Command lookup alone, on each line of the stream */
+  t0 = xTaskGetTickCount();
+  for (uint32_t n = 0; n < iterations; n++)
+  {
+    const char *line = perf_stream;
+    const char *eol;
+
+    while ((eol = strchr(line, '\r')) != NULL)
+    {
+      size_t line_len = eol - line;
+
+      line_len = (line_len < sizeof(match_buf) - 1) ? line_len : sizeof(match_buf) - 1;
+      memcpy(match_buf, line, line_len);
+      match_buf[line_len] = '\0';
+      data.rx_buf = (uint8_t *)line;
+      data.rx_buf_len = line_len;
+      if ((find_cmd_direct_match(&data) != NULL) || (find_cmd_match(&data) != NULL))
+      {
+        lookups++;
+      }
+      line = eol + 2;
+    }
+  }
+  elapsed_ms = (uint32_t)(((uint64_t)(xTaskGetTickCount() - t0) * 1000) / configTICK_RATE_HZ);
+  data.rx_buf = data.rx_buf_base;
+  data.rx_buf_len = 0;
+
+  LogInfo("Command lookups       %" PRIu32 " in %" PRIu32 " ms\n", lookups, elapsed_ms);
+  ret = 0;
+
+out:
+  modem_cmd_handler_deinit(&data);
+  vPortFree(data.rx_buf_base);
+  return ret;
+}
+
 /** @} */
@@ -62,6 +62,9 @@ extern "C" {
 /** Size of the receive buffer */
 #define RX_BUF_SIZE        W61_MAX_SPI_XFER
 
+/** Size to allocate for the receive buffer storage, with room for a NUL terminator */
+#define RX_BUF_ALLOC_SIZE  (RX_BUF_SIZE + 1)
+
 #define EIO                 5       /*!< I/O error */
 #define EAGAIN              11      /*!< No more contexts */
 #define ENOMEM              12      /*!< Not enough core */
@@ -76,6 +79,9 @@ extern "C" {
 #define CMD_HANDLER         2       /*!< Command handler */
 #define CMD_MAX             3       /*!< Maximum command types */
 
+/** No command or node index in the command prefix tree */
+#define MODEM_CMD_TREE_NONE 0xFFFFU
+
 /* Flags for modem_send_cmd_ext */
 #define MODEM_NO_TX_LOCK    BIT(0)  /*!< No TX lock flag send */
 #define MODEM_NO_SET_CMDS   BIT(1)  /*!< No set commands flag send */
@@ -159,6 +165,23 @@ struct setup_cmd
   struct modem_cmd handle_cmd;
 };
 
+/**
+  * @brief  Node of the prefix tree indexing the response and unsolicited commands
+  */
+struct modem_cmd_node
+{
+  /** Character leading to this node */
+  uint8_t ch;
+  /** First child node index */
+  uint16_t child;
+  /** Next sibling node index */
+  uint16_t sibling;
+  /** First command, in table order, whose string ends at this node */
+  uint16_t match;
+  /** First direct command whose string ends at this node */
+  uint16_t direct;
+};
+
 /**
   * @brief  Modem command handler data
   */
@@ -168,6 +191,8 @@ struct modem_cmd_handler_data
   const struct modem_cmd *cmds[CMD_MAX];
   /** Command list lengths */
   size_t cmds_len[CMD_MAX];
+  /** Prefix tree of the CMD_RESP and CMD_UNSOL lists, node 0 is the root */
+  struct modem_cmd_node *cmd_tree;
   /** Buffer for matching commands */
   char *match_buf;
   /** Length of buffer for matching commands */
@@ -178,9 +203,11 @@ struct modem_cmd_handler_data
   const char *eol;
   /** Length of end of line string */
   size_t eol_len;
-  /** RX net buffer */
+  /** RX buffer storage of RX_BUF_ALLOC_SIZE bytes, allocated by the user before modem_cmd_handler_init() */
+  uint8_t *rx_buf_base;
+  /** Unprocessed data of the RX buffer, within rx_buf_base */
   uint8_t *rx_buf;
-  /** Length of RX net buffer */
+  /** Length of the unprocessed data */
   size_t rx_buf_len;
   /** TX lock */
   SemaphoreHandle_t sem_tx_lock;
@@ -457,6 +484,14 @@ int32_t modem_cmd_handler_init(struct modem_cmd_handler *handler,
                                struct modem_cmd_handler_data *data,
                                const struct modem_cmd_handler_config *config);
 
+/**
+  * @brief  De-initialize modem command handler
+  * @details Releases the resources allocated by @ref modem_cmd_handler_init. The RX buffer
+  *          storage is left to the user.
+  * @param  data: Command handler data to release
+  */
+void modem_cmd_handler_deinit(struct modem_cmd_handler_data *data);
+
 /**
   * @brief  Lock the modem for sending cmds
   * @details This is semaphore-based rather than mutex based, which means there's no
@@ -476,6 +511,18 @@ int32_t modem_cmd_handler_tx_lock(struct modem_cmd_handler *handler,
   */
 void modem_cmd_handler_tx_unlock(struct modem_cmd_handler *handler);
 
+/**
+  * @brief  Replace the RX buffer storage, handing the current one over to the caller
+  * @details The data consumed by the caller stays in the returned storage, the unprocessed data
+  *          following it is moved to the new storage. Only to be called from a direct command
+  *          handler, which then returns 0 so that the parsing goes on in the new storage.
+  * @param  data: Command handler data
+  * @param  buf: New RX buffer storage of RX_BUF_ALLOC_SIZE bytes
+  * @param  consumed: Number of bytes at the start of the unprocessed data kept in the returned storage
+  * @return Previous RX buffer storage, now owned by the caller
+  */
+uint8_t *modem_cmd_handler_swap_rx_buf(struct modem_cmd_handler_data *data, uint8_t *buf, size_t consumed);
+
 /**
   * @brief Process incoming data
   * @details This function will process any data available from the interface
@@ -493,6 +540,16 @@ static inline void modem_cmd_handler_process(struct modem_cmd_handler *handler,
   handler->process(handler, iface);
 }
 
+/**
+  * @brief  Measure the parser throughput
+  * @details Replays a recorded AT stream through the RX buffer and the command matching
+  *          of a private command handler instance, then logs the throughput in MB/s and
+  *          the command lookup rate. The modem state is not affected.
+  * @param  iterations: Number of times the recorded stream is replayed
+  * @return 0 if ok, < 0 if error
+  */
+int32_t modem_cmd_handler_perf(uint32_t iterations);
+
 /** @} */
 
 #ifdef __cplusplus
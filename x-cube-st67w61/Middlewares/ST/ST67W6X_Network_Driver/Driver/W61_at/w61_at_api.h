@@ -821,6 +821,16 @@ typedef struct
   char raw[26];                            /*!< Raw time string */
 } W61_Net_Time_t;
 
+/**
+  * @brief  Socket data channel message
+  */
+typedef struct
+{
+  void *buffer;                          /*!< SPI buffer holding the message */
+  uint8_t *data;                         /*!< Next socket data byte to read */
+  uint32_t len;                          /*!< Remaining socket data length */
+} W61_Net_DataFrame_t;
+
 /**
   * @brief  Net internal context
   */
@@ -846,6 +856,15 @@ typedef struct
   uint8_t DHCP_AP_IsEnabled;              /*!< Flag to indicate if DHCP client is enabled for the Soft-AP */
   int32_t AppBuffRecvDataSize;            /*!< Size of the buffer to receive data */
   uint8_t *AppBuffRecvData;               /*!< Buffer to receive data */
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+  volatile uint8_t DataChannel;           /*!< Set to 1 once the NCP exchanges socket data over the data channel */
+  volatile uint8_t DataChannelSorting;    /*!< Set while the SPI transfer task sorts the received messages */
+  SemaphoreHandle_t DataChannelLock;      /*!< Mutex serializing the data channel reads */
+  QueueHandle_t DataChannelRxq[W61_NET_MAX_CONNECTIONS];      /*!< Received messages of each connection */
+  W61_Net_DataFrame_t DataChannelCur[W61_NET_MAX_CONNECTIONS]; /*!< Message being read on each connection */
+  uint16_t DataChannelCredit[W61_NET_MAX_CONNECTIONS];        /*!< Messages consumed, not returned to the NCP yet */
+  uint32_t DataChannelDrops[W61_NET_MAX_CONNECTIONS];         /*!< Messages dropped since the last read */
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
 } W61_Net_Ctx_t;
 
 /** @} */
@@ -864,6 +883,9 @@ typedef struct
 {
   uint32_t topic_length;        /*!< Length of the topic */
   uint32_t message_length;      /*!< Length of the message */
+  uint8_t *topic;               /*!< Topic, null terminated */
+  uint8_t *message;             /*!< Message of message_length bytes, null terminated */
+  int32_t slot;                 /*!< Inbox slot lent to the upper layer, -1 if the message has been copied */
 } W61_MQTT_CbParamData_t;
 
 /**
@@ -873,6 +895,9 @@ typedef struct
 {
   int32_t AppBuffRecvDataSize;  /*!< Size of the buffer to receive data */
   uint8_t *AppBuffRecvData;     /*!< Buffer to receive data */
+  uint8_t ZeroCopy;             /*!< Received messages are lent in place instead of copied */
+  uint32_t InboxLent;           /*!< Inbox slots lent to the upper layer, one bit per slot */
+  uint8_t *Inbox[W61_MQTT_INBOX_SLOTS]; /*!< RX buffers of the inbox slots */
 } W61_MQTT_Ctx_t;
 
 /** @} */
@@ -1099,6 +1124,41 @@ typedef void (*W61_AT_Event_cb_t)(void *hObj, uint16_t *argc, char **argv);
   */
 typedef int32_t (*W61_AT_Event_data_cb_t)(uint32_t event_id, struct modem_cmd_handler_data *data, uint16_t len);
 
+/**
+  * @brief  W61 AT request structure, owned by the caller until the request is completed
+  */
+typedef struct W61_AT_Request_s W61_AT_Request_t;
+
+/**
+  * @brief  W61 AT request completion callback function type, called from the AT request task
+  * @param  req: pointer to the completed request
+  * @param  arg: argument given in the request
+  */
+typedef void (*W61_AT_Request_cb_t)(W61_AT_Request_t *req, void *arg);
+
+/**
+  * @brief  W61 AT request structure, owned by the caller until the request is completed
+  */
+struct W61_AT_Request_s
+{
+  const char *cmd;                                        /*!< AT command line including its CR LF */
+  const char *resp;                                       /*!< Response prefix to capture, NULL if none */
+  uint32_t timeout_ms;                                    /*!< Timeout of the NCP response */
+  W61_AT_Request_cb_t cb;                                 /*!< Completion callback, NULL to use W61_AT_Request_Wait */
+  void *arg;                                              /*!< Completion callback argument */
+  uint32_t tag;                                           /*!< Request tag, assigned at submission */
+  volatile uint8_t done;                                  /*!< Set when the request is completed */
+  W61_Status_t status;                                    /*!< Completion status */
+  uint16_t argc;                                          /*!< Number of arguments of the captured response */
+  char *argv[CONFIG_MODEM_CMD_HANDLER_MAX_PARAM_COUNT];   /*!< Arguments of the captured response */
+  char resp_buf[W61_AT_REQ_RESP_SIZE];                    /*!< Captured response line */
+  TaskHandle_t waiter;                                    /*!< Task notified on completion when cb is NULL */
+  TickType_t t_submit;                                    /*!< Submission time in ticks */
+  TickType_t t_done;                                      /*!< Completion time in ticks */
+  struct modem *mdm;                                      /*!< Modem the request is submitted to */
+  W61_AT_Request_t *next;                                 /*!< Next request in the submission queue */
+};
+
 /**
   * @brief  W61 AT Modem context structure
   */
@@ -1117,6 +1177,16 @@ typedef struct modem
   char **argv;                                            /*!< Argument values pointer */
   uint16_t rx_data_len;                                   /*!< Length of received data */
   void *rx_data;                                          /*!< Pointer to received data */
+#if (W61_AT_REQ_ENABLE == 1)
+  TaskHandle_t req_task_handle;                           /*!< AT request task handle */
+  W61_AT_Request_t *req_head;                             /*!< First submitted AT request not yet executed */
+  W61_AT_Request_t *req_tail;                             /*!< Last submitted AT request not yet executed */
+  uint32_t req_count;                                     /*!< Number of AT requests waiting for execution */
+  W61_AT_Request_t *req;                                  /*!< AT request being executed */
+  uint32_t req_tag;                                       /*!< Tag of the last submitted AT request */
+  volatile uint8_t req_stop;                              /*!< Set to stop the AT request task */
+  SemaphoreHandle_t req_stopped;                          /*!< Given by the AT request task when it exits */
+#endif /* W61_AT_REQ_ENABLE */
 } W61_Modem_t;
 
 /**
@@ -1189,19 +1259,31 @@ typedef struct
   * Print system warning message
   */
 
-#if (SYS_LOG_ENABLE == 1)
-#define SYS_LOG_DEBUG(...) LogDebug(__VA_ARGS__)
-#define SYS_LOG_ERROR(...) LogError(__VA_ARGS__)
-#define SYS_LOG_ERROR_EX(line, file, ...) LogErrorEx(line, file, __VA_ARGS__)
-#define SYS_LOG_INFO(...)  LogInfo(__VA_ARGS__)
-#define SYS_LOG_WARN(...)  LogWarn(__VA_ARGS__)
+#if (SYS_LOG_LEVEL >= LOG_ERROR)
+#define SYS_LOG_ERROR(...) LogModuleError(LOG_MODULE_SYS, __VA_ARGS__)
+#define SYS_LOG_ERROR_EX(line, file, ...) LogModuleErrorEx(LOG_MODULE_SYS, line, file, __VA_ARGS__)
 #else
-#define SYS_LOG_DEBUG(...)
 #define SYS_LOG_ERROR(...)
 #define SYS_LOG_ERROR_EX(line, file, ...)
-#define SYS_LOG_INFO(...)
+#endif /* SYS_LOG_LEVEL >= LOG_ERROR */
+
+#if (SYS_LOG_LEVEL >= LOG_WARN)
+#define SYS_LOG_WARN(...)  LogModuleWarn(LOG_MODULE_SYS, __VA_ARGS__)
+#else
 #define SYS_LOG_WARN(...)
-#endif /* SYS_LOG_ENABLE */
+#endif /* SYS_LOG_LEVEL >= LOG_WARN */
+
+#if (SYS_LOG_LEVEL >= LOG_INFO)
+#define SYS_LOG_INFO(...)  LogModuleInfo(LOG_MODULE_SYS, __VA_ARGS__)
+#else
+#define SYS_LOG_INFO(...)
+#endif /* SYS_LOG_LEVEL >= LOG_INFO */
+
+#if (SYS_LOG_LEVEL >= LOG_DEBUG)
+#define SYS_LOG_DEBUG(...) LogModuleDebug(LOG_MODULE_SYS, __VA_ARGS__)
+#else
+#define SYS_LOG_DEBUG(...)
+#endif /* SYS_LOG_LEVEL >= LOG_DEBUG */
 
 /** @} */
 
@@ -1232,17 +1314,29 @@ typedef struct
   * Print Wi-Fi warning message
   */
 
-#if (WIFI_LOG_ENABLE == 1)
-#define WIFI_LOG_DEBUG(...) LogDebug(__VA_ARGS__)
-#define WIFI_LOG_ERROR(...) LogError(__VA_ARGS__)
-#define WIFI_LOG_INFO(...)  LogInfo(__VA_ARGS__)
-#define WIFI_LOG_WARN(...)  LogWarn(__VA_ARGS__)
+#if (WIFI_LOG_LEVEL >= LOG_ERROR)
+#define WIFI_LOG_ERROR(...) LogModuleError(LOG_MODULE_WIFI, __VA_ARGS__)
 #else
-#define WIFI_LOG_DEBUG(...)
 #define WIFI_LOG_ERROR(...)
-#define WIFI_LOG_INFO(...)
+#endif /* WIFI_LOG_LEVEL >= LOG_ERROR */
+
+#if (WIFI_LOG_LEVEL >= LOG_WARN)
+#define WIFI_LOG_WARN(...)  LogModuleWarn(LOG_MODULE_WIFI, __VA_ARGS__)
+#else
 #define WIFI_LOG_WARN(...)
-#endif /* WIFI_LOG_ENABLE */
+#endif /* WIFI_LOG_LEVEL >= LOG_WARN */
+
+#if (WIFI_LOG_LEVEL >= LOG_INFO)
+#define WIFI_LOG_INFO(...)  LogModuleInfo(LOG_MODULE_WIFI, __VA_ARGS__)
+#else
+#define WIFI_LOG_INFO(...)
+#endif /* WIFI_LOG_LEVEL >= LOG_INFO */
+
+#if (WIFI_LOG_LEVEL >= LOG_DEBUG)
+#define WIFI_LOG_DEBUG(...) LogModuleDebug(LOG_MODULE_WIFI, __VA_ARGS__)
+#else
+#define WIFI_LOG_DEBUG(...)
+#endif /* WIFI_LOG_LEVEL >= LOG_DEBUG */
 
 /** @} */
 
@@ -1273,17 +1367,29 @@ typedef struct
   * Print BLE warning message
   */
 
-#if (BLE_LOG_ENABLE == 1)
-#define BLE_LOG_DEBUG(...) LogDebug(__VA_ARGS__)
-#define BLE_LOG_ERROR(...) LogError(__VA_ARGS__)
-#define BLE_LOG_INFO(...)  LogInfo(__VA_ARGS__)
-#define BLE_LOG_WARN(...)  LogWarn(__VA_ARGS__)
+#if (BLE_LOG_LEVEL >= LOG_ERROR)
+#define BLE_LOG_ERROR(...) LogModuleError(LOG_MODULE_BLE, __VA_ARGS__)
 #else
-#define BLE_LOG_DEBUG(...)
 #define BLE_LOG_ERROR(...)
-#define BLE_LOG_INFO(...)
+#endif /* BLE_LOG_LEVEL >= LOG_ERROR */
+
+#if (BLE_LOG_LEVEL >= LOG_WARN)
+#define BLE_LOG_WARN(...)  LogModuleWarn(LOG_MODULE_BLE, __VA_ARGS__)
+#else
 #define BLE_LOG_WARN(...)
-#endif /* BLE_LOG_ENABLE */
+#endif /* BLE_LOG_LEVEL >= LOG_WARN */
+
+#if (BLE_LOG_LEVEL >= LOG_INFO)
+#define BLE_LOG_INFO(...)  LogModuleInfo(LOG_MODULE_BLE, __VA_ARGS__)
+#else
+#define BLE_LOG_INFO(...)
+#endif /* BLE_LOG_LEVEL >= LOG_INFO */
+
+#if (BLE_LOG_LEVEL >= LOG_DEBUG)
+#define BLE_LOG_DEBUG(...) LogModuleDebug(LOG_MODULE_BLE, __VA_ARGS__)
+#else
+#define BLE_LOG_DEBUG(...)
+#endif /* BLE_LOG_LEVEL >= LOG_DEBUG */
 
 /** @} */
 
@@ -1314,17 +1420,29 @@ typedef struct
   * Print Network warning message
   */
 
-#if (NET_LOG_ENABLE == 1)
-#define NET_LOG_DEBUG(...) LogDebug(__VA_ARGS__)
-#define NET_LOG_ERROR(...) LogError(__VA_ARGS__)
-#define NET_LOG_INFO(...)  LogInfo(__VA_ARGS__)
-#define NET_LOG_WARN(...)  LogWarn(__VA_ARGS__)
+#if (NET_LOG_LEVEL >= LOG_ERROR)
+#define NET_LOG_ERROR(...) LogModuleError(LOG_MODULE_NET, __VA_ARGS__)
 #else
-#define NET_LOG_DEBUG(...)
 #define NET_LOG_ERROR(...)
-#define NET_LOG_INFO(...)
+#endif /* NET_LOG_LEVEL >= LOG_ERROR */
+
+#if (NET_LOG_LEVEL >= LOG_WARN)
+#define NET_LOG_WARN(...)  LogModuleWarn(LOG_MODULE_NET, __VA_ARGS__)
+#else
 #define NET_LOG_WARN(...)
-#endif /* NET_LOG_ENABLE */
+#endif /* NET_LOG_LEVEL >= LOG_WARN */
+
+#if (NET_LOG_LEVEL >= LOG_INFO)
+#define NET_LOG_INFO(...)  LogModuleInfo(LOG_MODULE_NET, __VA_ARGS__)
+#else
+#define NET_LOG_INFO(...)
+#endif /* NET_LOG_LEVEL >= LOG_INFO */
+
+#if (NET_LOG_LEVEL >= LOG_DEBUG)
+#define NET_LOG_DEBUG(...) LogModuleDebug(LOG_MODULE_NET, __VA_ARGS__)
+#else
+#define NET_LOG_DEBUG(...)
+#endif /* NET_LOG_LEVEL >= LOG_DEBUG */
 
 /** @} */
 
@@ -1355,17 +1473,29 @@ typedef struct
   * Print MQTT warning message
   */
 
-#if (MQTT_LOG_ENABLE == 1)
-#define MQTT_LOG_DEBUG(...) LogDebug(__VA_ARGS__)
-#define MQTT_LOG_ERROR(...) LogError(__VA_ARGS__)
-#define MQTT_LOG_INFO(...)  LogInfo(__VA_ARGS__)
-#define MQTT_LOG_WARN(...)  LogWarn(__VA_ARGS__)
+#if (MQTT_LOG_LEVEL >= LOG_ERROR)
+#define MQTT_LOG_ERROR(...) LogModuleError(LOG_MODULE_MQTT, __VA_ARGS__)
 #else
-#define MQTT_LOG_DEBUG(...)
 #define MQTT_LOG_ERROR(...)
-#define MQTT_LOG_INFO(...)
+#endif /* MQTT_LOG_LEVEL >= LOG_ERROR */
+
+#if (MQTT_LOG_LEVEL >= LOG_WARN)
+#define MQTT_LOG_WARN(...)  LogModuleWarn(LOG_MODULE_MQTT, __VA_ARGS__)
+#else
 #define MQTT_LOG_WARN(...)
-#endif /* MQTT_LOG_ENABLE */
+#endif /* MQTT_LOG_LEVEL >= LOG_WARN */
+
+#if (MQTT_LOG_LEVEL >= LOG_INFO)
+#define MQTT_LOG_INFO(...)  LogModuleInfo(LOG_MODULE_MQTT, __VA_ARGS__)
+#else
+#define MQTT_LOG_INFO(...)
+#endif /* MQTT_LOG_LEVEL >= LOG_INFO */
+
+#if (MQTT_LOG_LEVEL >= LOG_DEBUG)
+#define MQTT_LOG_DEBUG(...) LogModuleDebug(LOG_MODULE_MQTT, __VA_ARGS__)
+#else
+#define MQTT_LOG_DEBUG(...)
+#endif /* MQTT_LOG_LEVEL >= LOG_DEBUG */
 
 /** @} */
 
@@ -1630,6 +1760,47 @@ W61_Status_t W61_ExeATCommand(W61_Object_t *Obj, char *at_cmd);
   */
 W61_Status_t W61_GetNetMode(W61_Object_t *Obj, int32_t *Netmode);
 
+#if (W61_AT_REQ_ENABLE == 1)
+/**
+  * @brief  Queue an AT request without waiting for its execution.
+  *         Requests are executed in submission order by the AT request task, with the commands of
+  *         W61_AT_Common_SetExecute. The request must stay valid until it is completed or cancelled
+  * @param  Obj: pointer to module handle
+  * @param  req: pointer to the request, cmd, resp, timeout_ms, cb and arg filled by the caller
+  * @return Operation status, W61_STATUS_BUSY if the request queue is full
+  */
+W61_Status_t W61_AT_Request_Submit(W61_Object_t *Obj, W61_AT_Request_t *req);
+
+/**
+  * @brief  Wait for the completion of a request submitted without callback by the calling task.
+  *         Uses the task notification of the calling task. On timeout the request is cancelled
+  *         with W61_AT_Request_Cancel, it can be released on return in all cases
+  * @param  req: pointer to the request
+  * @param  timeout_ms: maximum time to wait, portMAX_DELAY to wait forever
+  * @return Completion status of the request, W61_STATUS_TIMEOUT if it was not executed in time
+  */
+W61_Status_t W61_AT_Request_Wait(W61_AT_Request_t *req, uint32_t timeout_ms);
+
+/**
+  * @brief  Cancel a submitted request. A request not executed yet is removed from the queue and
+  *         completed with W61_STATUS_TIMEOUT without calling its callback. A request being executed
+  *         cannot be aborted: the call waits for the end of its execution, bounded by its timeout.
+  *         The request is no longer referenced by the AT request task on return
+  * @param  req: pointer to the request
+  * @return Completion status of the request
+  */
+W61_Status_t W61_AT_Request_Cancel(W61_AT_Request_t *req);
+
+/**
+  * @brief  Load the AT request engine with producer tasks and report the command latency percentiles
+  * @param  Obj: pointer to module handle
+  * @param  producers: number of producer tasks
+  * @param  requests: number of requests per producer
+  * @return 0 on success, negative value on error
+  */
+int32_t W61_AT_Request_Stress(W61_Object_t *Obj, uint32_t producers, uint32_t requests);
+#endif /* W61_AT_REQ_ENABLE */
+
 /** @} */
 
 /* ===================================================================== */
@@ -2184,6 +2355,23 @@ W61_Status_t W61_Net_IsDataAvailableOnSocket(W61_Object_t *Obj, uint8_t Socket,
 W61_Status_t W61_Net_PullDataFromSocket(W61_Object_t *Obj, uint8_t Socket, uint32_t req_len, uint8_t *pData,
                                         uint32_t *Receivedlen, uint32_t Timeout);
 
+/**
+  * @brief  Discard the socket data received over the data channel and not read yet on a connection
+  * @param  Obj: pointer to module handle
+  * @param  Socket: number of the socket
+  * @return Operation status
+  */
+W61_Status_t W61_Net_DataChannel_Flush(W61_Object_t *Obj, uint8_t Socket);
+
+/**
+  * @brief  Sort the received data channel messages per connection and notify the upper layer.
+  *         Registered on the SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA traffic, called from the SPI transfer task.
+  *         Never blocks: the NCP sends no more than W61_NET_DATA_CHANNEL_RXQ_LEN messages per connection
+  *         ahead of the ones read, a message beyond this window is dropped and reported by the next read
+  * @param  arg: unused
+  */
+void W61_Net_DataChannel_Notify(void *arg);
+
 /**
   * @brief  Send AT command to get current SNTP status, timezone and servers and store results
   * @param  Obj: pointer to module handle
@@ -2305,6 +2493,25 @@ W61_Status_t W61_MQTT_Init(W61_Object_t *Obj, uint8_t *p_recv_data, uint32_t rec
   */
 W61_Status_t W61_MQTT_DeInit(W61_Object_t *Obj);
 
+/**
+  * @brief  Enable or disable the zero-copy delivery of the received messages.
+  *         When enabled, a received message is left in the RX buffer it was received in, which is lent
+  *         to the upper layer in one of the W61_MQTT_INBOX_SLOTS inbox slots until W61_MQTT_Release.
+  *         The message is copied in the receive buffer when all the slots are lent.
+  * @param  Obj: pointer to module handle
+  * @param  Enable: 1 to enable, 0 to disable. The slots still lent are freed on their release
+  * @return Operation status
+  */
+W61_Status_t W61_MQTT_SetZeroCopy(W61_Object_t *Obj, uint32_t Enable);
+
+/**
+  * @brief  Give back the inbox slot of a received message
+  * @param  Obj: pointer to module handle
+  * @param  Slot: slot of the message, W61_MQTT_CbParamData_t slot field. Nothing is done for -1
+  * @return Operation status
+  */
+W61_Status_t W61_MQTT_Release(W61_Object_t *Obj, int32_t Slot);
+
 /**
   * @brief  Send AT command to set MQTT User configuration
   * @param  Obj: pointer to module handle
@@ -21,6 +21,7 @@
 #include "w61_at_internal.h"
 #include "w61_io.h"
 #include <stdlib.h>
+#include <inttypes.h>
 #include "modem_cmd_handler.h"
 #include "stdio.h"
 #if (SYS_DBG_ENABLE_TA4 >= 1)
@@ -29,6 +30,28 @@
 
 /* Global variables ----------------------------------------------------------*/
 /* Private typedef -----------------------------------------------------------*/
+#if (W61_AT_REQ_ENABLE == 1)
+/** @defgroup ST67W61_AT_Common_Types ST67W61 AT Driver Common Types
+  * @ingroup ST67W61_AT_Common
+  * @{
+  */
+
+/**
+  * @brief  AT request stress test context shared by the producer tasks
+  */
+typedef struct
+{
+  W61_Object_t *Obj;                  /*!< Module handle */
+  uint32_t requests;                  /*!< Requests per producer */
+  TickType_t *latency;                /*!< Latency of each completed request */
+  volatile uint32_t count;            /*!< Number of latency samples */
+  volatile uint32_t errors;           /*!< Number of failed requests */
+  SemaphoreHandle_t sem_done;         /*!< Given by each producer when done */
+} W61_AT_Request_Stress_t;
+
+/** @} */
+
+#endif /* W61_AT_REQ_ENABLE */
 /* Private defines -----------------------------------------------------------*/
 /** @defgroup ST67W61_AT_Common_Defines ST67W61 AT Driver Common Defines
   * @ingroup ST67W61_AT_Common
@@ -41,6 +64,9 @@
 /** Timeout for io receive operation */
 #define IO_RECEIVE_TIMEOUT                      portMAX_DELAY
 
+/** Number of requests kept outstanding by each stress test producer */
+#define AT_REQ_STRESS_DEPTH                     4
+
 /** @} */
 
 /* Private macros ------------------------------------------------------------*/
@@ -69,6 +95,49 @@ static int32_t io_deinit(struct modem_iface *iface);
   */
 static void W61_Modem_Process_task(void *arg);
 
+#if (W61_AT_REQ_ENABLE == 1)
+/**
+  * @brief  AT request task, executes the submitted requests in order
+  * @param arg: pointer to the module handle
+  */
+static void W61_AT_Request_task(void *arg);
+
+/**
+  * @brief  Execute an AT request and complete it
+  * @param Obj: pointer to module handle
+  * @param req: pointer to the request
+  */
+static void W61_AT_Request_Execute(W61_Object_t *Obj, W61_AT_Request_t *req);
+
+/**
+  * @brief  Complete an AT request and notify its owner
+  * @param req: pointer to the request
+  * @param status: completion status
+  */
+static void W61_AT_Request_Complete(W61_AT_Request_t *req, W61_Status_t status);
+
+/**
+  * @brief  Completion callback of the AT commands executed synchronously through the AT request task
+  * @param req: pointer to the request
+  * @param arg: semaphore of the waiting task
+  */
+static void W61_AT_Request_Sync_cb(W61_AT_Request_t *req, void *arg);
+
+/**
+  * @brief  AT request stress test producer task
+  * @param arg: pointer to the stress test context
+  */
+static void W61_AT_Request_Stress_task(void *arg);
+
+/**
+  * @brief  Compare two latency samples for qsort
+  * @param a: pointer to the first sample
+  * @param b: pointer to the second sample
+  * @return negative, zero or positive value
+  */
+static int compare_ticks(const void *a, const void *b);
+#endif /* W61_AT_REQ_ENABLE */
+
 /**
   * @brief  Write data to the modem interface
   * @param iface: pointer to the modem interface
@@ -100,6 +169,18 @@ static int32_t modem_iface_spi_read(struct modem_iface *iface,
  */
 MODEM_CMD_DECLARE(on_cmd_query);
 
+#if (W61_AT_REQ_ENABLE == 1)
+/**
+  * @brief  Callback function to capture the response of the AT request being executed
+  * @param  data: pointer to the modem_cmd_handler_data structure
+  * @param  len: length of the data
+  * @param  argv: array of argument strings
+  * @param  argc: number of argument
+  * @return 0 on success, negative value on error
+ */
+MODEM_CMD_DECLARE(on_cmd_request);
+#endif /* W61_AT_REQ_ENABLE */
+
 /**
   * @brief  Callback function to handle "OK" events
   * @param  data: pointer to the modem_cmd_handler_data structure
@@ -335,9 +416,9 @@ int32_t W61_AT_ModemInit(W61_Object_t *Obj)
   }
 
   /* Assign rx_buff */
-  /** Linear RX buffer to process */
-  mdm->modem_cmd_handler_data.rx_buf = pvPortMalloc(RX_BUF_SIZE);
-  if (mdm->modem_cmd_handler_data.rx_buf == NULL)
+  /** RX buffer to process */
+  mdm->modem_cmd_handler_data.rx_buf_base = pvPortMalloc(RX_BUF_ALLOC_SIZE);
+  if (mdm->modem_cmd_handler_data.rx_buf_base == NULL)
   {
     goto __err;
   }
@@ -377,13 +458,47 @@ int32_t W61_AT_ModemInit(W61_Object_t *Obj)
     goto __err;
   }
 
+#if (W61_AT_REQ_ENABLE == 1)
+  mdm->req_head = NULL;
+  mdm->req_tail = NULL;
+  mdm->req_count = 0;
+  mdm->req_stop = 0;
+  mdm->req_stopped = xSemaphoreCreateBinary();
+  if (mdm->req_stopped == NULL)
+  {
+    ret = -1;
+    goto __err;
+  }
+
+  xReturned = xTaskCreate(W61_AT_Request_task,
+                          (char *)"AT_Request",
+                          W61_AT_REQ_TASK_STACK_SIZE_BYTES >> 2,
+                          Obj,
+                          W61_AT_REQ_TASK_PRIO,
+                          &mdm->req_task_handle);
+  if (xReturned != pdPASS)
+  {
+    SYS_LOG_ERROR("xTaskCreate failed to create\n");
+    ret = -1;
+    goto __err;
+  }
+#endif /* W61_AT_REQ_ENABLE */
+
   W61_AT_Common_SetExecute(Obj, (uint8_t *)"AT\r\n", W61_NCP_TIMEOUT);
 
   return W61_Status(ret);
 __err:
-  if (mdm->modem_cmd_handler_data.rx_buf != NULL)
+#if (W61_AT_REQ_ENABLE == 1)
+  if (mdm->req_stopped != NULL)
   {
-    vPortFree(mdm->modem_cmd_handler_data.rx_buf);
+    vSemaphoreDelete(mdm->req_stopped);
+    mdm->req_stopped = NULL;
+  }
+#endif /* W61_AT_REQ_ENABLE */
+  if (mdm->modem_cmd_handler_data.rx_buf_base != NULL)
+  {
+    vPortFree(mdm->modem_cmd_handler_data.rx_buf_base);
+    mdm->modem_cmd_handler_data.rx_buf_base = NULL;
     mdm->modem_cmd_handler_data.rx_buf = NULL;
   }
   if (mdm->sem_response != NULL)
@@ -406,16 +521,61 @@ __err:
     vTaskDelete(mdm->modem_task_handle);
     mdm->modem_task_handle = NULL;
   }
+  modem_cmd_handler_deinit(&mdm->modem_cmd_handler_data);
   return W61_Status(ret);
 }
 
 void W61_AT_ModemDeInit(W61_Object_t *Obj)
 {
   struct modem *mdm = (struct modem *) &Obj->Modem;
+#if (W61_AT_REQ_ENABLE == 1)
+  W61_AT_Request_t *req;
+
+  if (mdm->req_task_handle != NULL)
+  {
+    /* Let the request being executed complete, the task exits before the next one */
+    taskENTER_CRITICAL();
+    mdm->req_stop = 1;
+    taskEXIT_CRITICAL();
+    (void)xTaskNotifyGive(mdm->req_task_handle);
+    (void)xSemaphoreTake(mdm->req_stopped, portMAX_DELAY);
+    mdm->req_task_handle = NULL;
+  }
+  /* Release the owners of the requests still queued */
+  while (1)
+  {
+    taskENTER_CRITICAL();
+    req = mdm->req_head;
+    if (req != NULL)
+    {
+      mdm->req_head = req->next;
+      mdm->req_count--;
+    }
+    taskEXIT_CRITICAL();
+    if (req == NULL)
+    {
+      break;
+    }
+    W61_AT_Request_Complete(req, W61_STATUS_ERROR);
+  }
+  mdm->req_tail = NULL;
+  if (mdm->req_stopped != NULL)
+  {
+    vSemaphoreDelete(mdm->req_stopped);
+    mdm->req_stopped = NULL;
+  }
+#endif /* W61_AT_REQ_ENABLE */
+  /* The modem task reads the AT receive queue, stop it before the queue is deleted */
+  if (mdm->modem_task_handle != NULL)
+  {
+    vTaskDelete(mdm->modem_task_handle);
+    mdm->modem_task_handle = NULL;
+  }
   io_deinit(&mdm->iface);
-  if (mdm->modem_cmd_handler_data.rx_buf != NULL)
+  if (mdm->modem_cmd_handler_data.rx_buf_base != NULL)
   {
-    vPortFree(mdm->modem_cmd_handler_data.rx_buf);
+    vPortFree(mdm->modem_cmd_handler_data.rx_buf_base);
+    mdm->modem_cmd_handler_data.rx_buf_base = NULL;
     mdm->modem_cmd_handler_data.rx_buf = NULL;
   }
   if (mdm->sem_response != NULL)
@@ -433,11 +593,7 @@ void W61_AT_ModemDeInit(W61_Object_t *Obj)
     vSemaphoreDelete(mdm->sem_tx_ready);
     mdm->sem_tx_ready = NULL;
   }
-  if (mdm->modem_task_handle != NULL)
-  {
-    vTaskDelete(mdm->modem_task_handle);
-    mdm->modem_task_handle = NULL;
-  }
+  modem_cmd_handler_deinit(&mdm->modem_cmd_handler_data);
 }
 
 W61_Status_t W61_Status(int32_t ret)
@@ -465,6 +621,28 @@ W61_Status_t W61_Status(int32_t ret)
 W61_Status_t W61_AT_Common_SetExecute(W61_Object_t *Obj, uint8_t *p_cmd, uint32_t timeout_ms)
 {
   struct modem *mdm = &Obj->Modem;
+#if (W61_AT_REQ_ENABLE == 1)
+  StaticSemaphore_t sem_done_buf;
+  W61_AT_Request_t req = {0};
+
+  /* Executed in submission order with the asynchronous requests. A completion callback
+   * runs on the AT request task and cannot wait for it: its commands are sent directly */
+  if ((mdm->req_task_handle != NULL) && (xTaskGetCurrentTaskHandle() != mdm->req_task_handle))
+  {
+    req.cmd = (const char *)p_cmd;
+    req.timeout_ms = timeout_ms;
+    req.cb = W61_AT_Request_Sync_cb;
+    req.arg = xSemaphoreCreateBinaryStatic(&sem_done_buf);
+    if (W61_AT_Request_Submit(Obj, &req) == W61_STATUS_OK)
+    {
+      /* Bounded by the timeouts of the requests queued ahead, completed with an error on deinit */
+      (void)xSemaphoreTake((SemaphoreHandle_t)req.arg, portMAX_DELAY);
+      vSemaphoreDelete((SemaphoreHandle_t)req.arg);
+      return req.status;
+    }
+    vSemaphoreDelete((SemaphoreHandle_t)req.arg);
+  }
+#endif /* W61_AT_REQ_ENABLE */
   return W61_Status(modem_cmd_send(&mdm->iface,
                                    &mdm->modem_cmd_handler,
                                    NULL,
@@ -583,6 +761,210 @@ out:
   return W61_Status(ret);
 }
 
+#if (W61_AT_REQ_ENABLE == 1)
+W61_Status_t W61_AT_Request_Submit(W61_Object_t *Obj, W61_AT_Request_t *req)
+{
+  struct modem *mdm;
+
+  if ((Obj == NULL) || (req == NULL) || (req->cmd == NULL))
+  {
+    return W61_STATUS_ERROR;
+  }
+  mdm = (struct modem *) &Obj->Modem;
+  if (mdm->req_task_handle == NULL)
+  {
+    return W61_STATUS_ERROR;
+  }
+
+  req->done = 0;
+  req->status = W61_STATUS_ERROR;
+  req->argc = 0;
+  req->resp_buf[0] = '\0';
+  req->waiter = (req->cb == NULL) ? xTaskGetCurrentTaskHandle() : NULL;
+  req->mdm = mdm;
+  req->next = NULL;
+  req->t_submit = xTaskGetTickCount();
+
+  taskENTER_CRITICAL();
+  if ((mdm->req_stop != 0) || (mdm->req_count >= W61_AT_REQ_QUEUE_LEN))
+  {
+    taskEXIT_CRITICAL();
+    return (mdm->req_stop != 0) ? W61_STATUS_ERROR : W61_STATUS_BUSY;
+  }
+  req->tag = ++mdm->req_tag;
+  if (mdm->req_tail != NULL)
+  {
+    mdm->req_tail->next = req;
+  }
+  else
+  {
+    mdm->req_head = req;
+  }
+  mdm->req_tail = req;
+  mdm->req_count++;
+  taskEXIT_CRITICAL();
+
+  (void)xTaskNotifyGive(mdm->req_task_handle);
+  return W61_STATUS_OK;
+}
+
+W61_Status_t W61_AT_Request_Wait(W61_AT_Request_t *req, uint32_t timeout_ms)
+{
+  TickType_t timeout = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  TickType_t t0 = xTaskGetTickCount();
+  TickType_t elapsed;
+
+  if (req == NULL)
+  {
+    return W61_STATUS_ERROR;
+  }
+
+  /* Each completion gives one notification: the ones of other requests of this task
+   * are consumed here and the loop goes on until this request is done */
+  while (req->done == 0)
+  {
+    elapsed = xTaskGetTickCount() - t0;
+    if ((timeout != portMAX_DELAY) && (elapsed >= timeout))
+    {
+      /* The request must not outlive the frame of its owner in the queue */
+      return W61_AT_Request_Cancel(req);
+    }
+    (void)ulTaskNotifyTake(pdFALSE, (timeout == portMAX_DELAY) ? portMAX_DELAY : timeout - elapsed);
+  }
+  return req->status;
+}
+
+W61_Status_t W61_AT_Request_Cancel(W61_AT_Request_t *req)
+{
+  struct modem *mdm;
+  W61_AT_Request_t *prev = NULL;
+  W61_AT_Request_t *cur;
+  uint8_t removed = 0;
+
+  if ((req == NULL) || (req->mdm == NULL))
+  {
+    return W61_STATUS_ERROR;
+  }
+  mdm = req->mdm;
+
+  taskENTER_CRITICAL();
+  if (req->done == 0)
+  {
+    for (cur = mdm->req_head; cur != NULL; prev = cur, cur = cur->next)
+    {
+      if (cur == req)
+      {
+        if (prev != NULL)
+        {
+          prev->next = req->next;
+        }
+        else
+        {
+          mdm->req_head = req->next;
+        }
+        if (mdm->req_tail == req)
+        {
+          mdm->req_tail = prev;
+        }
+        mdm->req_count--;
+        removed = 1;
+        break;
+      }
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  if (removed != 0)
+  {
+    req->status = W61_STATUS_TIMEOUT;
+    req->t_done = xTaskGetTickCount();
+    req->done = 1;
+    return W61_STATUS_TIMEOUT;
+  }
+
+  /* Being executed: the NCP cannot be told to drop the command, wait for its response or timeout */
+  while (req->done == 0)
+  {
+    vTaskDelay(1);
+  }
+  return req->status;
+}
+
+int32_t W61_AT_Request_Stress(W61_Object_t *Obj, uint32_t producers, uint32_t requests)
+{
+  W61_AT_Request_Stress_t ctx = {0};
+  uint32_t started = 0;
+  uint32_t elapsed_ms;
+  TickType_t t0;
+  int32_t ret = -ENOMEM;
+
+  if ((Obj == NULL) || (Obj->Modem.req_task_handle == NULL) || (producers == 0) || (requests == 0) ||
+      ((uint64_t)producers * requests > (UINT32_MAX / sizeof(TickType_t))))
+  {
+    return -EINVAL;
+  }
+
+  ctx.Obj = Obj;
+  ctx.requests = requests;
+  ctx.latency = pvPortMalloc(producers * requests * sizeof(TickType_t));
+  ctx.sem_done = xSemaphoreCreateCounting(producers, 0);
+  if ((ctx.latency == NULL) || (ctx.sem_done == NULL))
+  {
+    goto out;
+  }
+
+  t0 = xTaskGetTickCount();
+  for (; started < producers; started++)
+  {
+    if (xTaskCreate(W61_AT_Request_Stress_task, (char *)"AT_Stress", 512 >> 2, &ctx,
+                    W61_AT_REQ_TASK_PRIO - 1, NULL) != pdPASS)
+    {
+      break;
+    }
+  }
+  for (uint32_t i = 0; i < started; i++)
+  {
+    (void)xSemaphoreTake(ctx.sem_done, portMAX_DELAY);
+  }
+  elapsed_ms = (uint32_t)(((uint64_t)(xTaskGetTickCount() - t0) * 1000) / configTICK_RATE_HZ);
+
+  if ((started < producers) || (ctx.count == 0))
+  {
+    ret = -1;
+    goto out;
+  }
+
+  qsort(ctx.latency, ctx.count, sizeof(TickType_t), compare_ticks);
+  LogInfo("Producers             %" PRIu32 ", %" PRIu32 " requests each, %d outstanding per producer\n",
+          producers, requests, AT_REQ_STRESS_DEPTH);
+  LogInfo("Completed             %" PRIu32 ", %" PRIu32 " errors\n", ctx.count, ctx.errors);
+  LogInfo("Duration              %" PRIu32 " ms\n", elapsed_ms);
+  LogInfo("Latency p50           %" PRIu32 " ms\n",
+          (uint32_t)(((uint64_t)ctx.latency[(ctx.count * 50) / 100] * 1000) / configTICK_RATE_HZ));
+  LogInfo("Latency p99           %" PRIu32 " ms\n",
+          (uint32_t)(((uint64_t)ctx.latency[(ctx.count * 99) / 100] * 1000) / configTICK_RATE_HZ));
+  LogInfo("Latency max           %" PRIu32 " ms\n",
+          (uint32_t)(((uint64_t)ctx.latency[ctx.count - 1] * 1000) / configTICK_RATE_HZ));
+  if (elapsed_ms > 0)
+  {
+    LogInfo("Throughput            %" PRIu32 " commands/s\n",
+            (uint32_t)(((uint64_t)ctx.count * 1000) / elapsed_ms));
+  }
+  ret = 0;
+
+out:
+  if (ctx.sem_done != NULL)
+  {
+    vSemaphoreDelete(ctx.sem_done);
+  }
+  if (ctx.latency != NULL)
+  {
+    vPortFree(ctx.latency);
+  }
+  return ret;
+}
+#endif /* W61_AT_REQ_ENABLE */
+
 void W61_AT_RemoveStrQuotes(char *inbuf)
 {
   int32_t len = strlen(inbuf);
@@ -659,6 +1041,12 @@ static int32_t io_init(struct modem_iface *iface)
   {
     return -1;
   }
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+  if (BusIo_SPI_Bind(SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA, 8, W61_Net_DataChannel_Notify) != 0)
+  {
+    return -1;
+  }
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
   iface->read = modem_iface_spi_read;
   iface->write = modem_iface_spi_write;
   return 0;
@@ -690,6 +1078,160 @@ static void W61_Modem_Process_task(void *arg)
   }
 }
 
+#if (W61_AT_REQ_ENABLE == 1)
+static void W61_AT_Request_task(void *arg)
+{
+  W61_Object_t *Obj = (W61_Object_t *) arg;
+  struct modem *mdm = (struct modem *) &Obj->Modem;
+  W61_AT_Request_t *req;
+
+  while (mdm->req_stop == 0)
+  {
+    taskENTER_CRITICAL();
+    req = mdm->req_head;
+    if (req != NULL)
+    {
+      mdm->req_head = req->next;
+      if (mdm->req_head == NULL)
+      {
+        mdm->req_tail = NULL;
+      }
+      mdm->req_count--;
+    }
+    taskEXIT_CRITICAL();
+
+    if (req == NULL)
+    {
+      /* Notified on each submission and on stop */
+      (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+    W61_AT_Request_Execute(Obj, req);
+  }
+
+  (void)xSemaphoreGive(mdm->req_stopped);
+  vTaskDelete(NULL);
+}
+
+static void W61_AT_Request_Execute(W61_Object_t *Obj, W61_AT_Request_t *req)
+{
+  struct modem *mdm = (struct modem *) &Obj->Modem;
+  struct modem_cmd handlers[] = {{
+      .cmd = req->resp,
+      .cmd_len = (req->resp != NULL) ? (uint16_t)strlen(req->resp) : 0,
+      .func = on_cmd_request,
+      .arg_count_min = 1,
+      .arg_count_max = CONFIG_MODEM_CMD_HANDLER_MAX_PARAM_COUNT,
+      .delim = ",:",
+      .direct = false,
+    }
+  };
+  int32_t ret;
+
+  (void)xSemaphoreTake(mdm->modem_cmd_handler_data.sem_tx_lock, portMAX_DELAY);
+  /* The response lines are matched against the request of this execution only */
+  mdm->req = req;
+  ret = modem_cmd_send_ext(&mdm->iface,
+                           &mdm->modem_cmd_handler,
+                           (req->resp != NULL) ? handlers : NULL,
+                           (req->resp != NULL) ? ARRAY_SIZE(handlers) : 0,
+                           (const uint8_t *)req->cmd,
+                           mdm->sem_response,
+                           pdMS_TO_TICKS(req->timeout_ms),
+                           MODEM_NO_TX_LOCK);
+  mdm->req = NULL;
+  (void)xSemaphoreGive(mdm->modem_cmd_handler_data.sem_tx_lock);
+
+  W61_AT_Request_Complete(req, W61_Status(ret));
+}
+
+static void W61_AT_Request_Complete(W61_AT_Request_t *req, W61_Status_t status)
+{
+  W61_AT_Request_cb_t cb = req->cb;
+  void *arg = req->arg;
+  TaskHandle_t waiter = req->waiter;
+
+  req->status = status;
+  req->t_done = xTaskGetTickCount();
+  /* The owner may release the request as soon as done is set */
+  req->done = 1;
+  if (cb != NULL)
+  {
+    cb(req, arg);
+  }
+  else if (waiter != NULL)
+  {
+    (void)xTaskNotifyGive(waiter);
+  }
+}
+
+static void W61_AT_Request_Sync_cb(W61_AT_Request_t *req, void *arg)
+{
+  (void)xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+static void W61_AT_Request_Stress_task(void *arg)
+{
+  W61_AT_Request_Stress_t *ctx = (W61_AT_Request_Stress_t *) arg;
+  W61_AT_Request_t *reqs = pvPortMalloc(AT_REQ_STRESS_DEPTH * sizeof(W61_AT_Request_t));
+  uint32_t submitted = 0;
+  uint32_t completed = 0;
+  uint32_t slot;
+  uint32_t index;
+
+  while ((reqs != NULL) && (completed < ctx->requests))
+  {
+    /* Keep AT_REQ_STRESS_DEPTH requests outstanding */
+    while ((submitted < ctx->requests) && (submitted - completed < AT_REQ_STRESS_DEPTH))
+    {
+      slot = submitted % AT_REQ_STRESS_DEPTH;
+      memset(&reqs[slot], 0, sizeof(W61_AT_Request_t));
+      reqs[slot].cmd = "AT\r\n";
+      reqs[slot].timeout_ms = W61_NCP_TIMEOUT;
+      if (W61_AT_Request_Submit(ctx->Obj, &reqs[slot]) != W61_STATUS_OK)
+      {
+        break;
+      }
+      submitted++;
+    }
+    if (submitted == completed)
+    {
+      /* Request queue full, let the other producers drain it */
+      vTaskDelay(1);
+      continue;
+    }
+
+    slot = completed % AT_REQ_STRESS_DEPTH;
+    if (W61_AT_Request_Wait(&reqs[slot], portMAX_DELAY) != W61_STATUS_OK)
+    {
+      taskENTER_CRITICAL();
+      ctx->errors++;
+      taskEXIT_CRITICAL();
+    }
+    taskENTER_CRITICAL();
+    index = ctx->count++;
+    taskEXIT_CRITICAL();
+    ctx->latency[index] = reqs[slot].t_done - reqs[slot].t_submit;
+    completed++;
+  }
+
+  if (reqs != NULL)
+  {
+    vPortFree(reqs);
+  }
+  (void)xSemaphoreGive(ctx->sem_done);
+  vTaskDelete(NULL);
+}
+
+static int compare_ticks(const void *a, const void *b)
+{
+  TickType_t ta = *(const TickType_t *)a;
+  TickType_t tb = *(const TickType_t *)b;
+
+  return (ta > tb) - (ta < tb);
+}
+#endif /* W61_AT_REQ_ENABLE */
+
 static int32_t modem_iface_spi_write(struct modem_iface *iface,
                                      const uint8_t *buf, size_t size)
 {
@@ -733,6 +1275,45 @@ MODEM_CMD_DEFINE(on_cmd_query)
   return 0;
 }
 
+#if (W61_AT_REQ_ENABLE == 1)
+MODEM_CMD_DEFINE(on_cmd_request)
+{
+  struct modem *mdm = (struct modem *) data->user_data;
+  W61_AT_Request_t *req = mdm->req;
+  int32_t mlen;
+  int32_t offset;
+
+  if (req == NULL)
+  {
+    return 0;
+  }
+
+  /* Copy the line up to the end of the last argument, truncated to the request buffer */
+  mlen = (argv[argc - 1] - mdm->cmd_match_buf) + strlen((char *) argv[argc - 1]);
+  if (mlen > (int32_t)sizeof(req->resp_buf) - 1)
+  {
+    mlen = (int32_t)sizeof(req->resp_buf) - 1;
+  }
+  memcpy(req->resp_buf, (char *) mdm->cmd_match_buf, mlen);
+  req->resp_buf[mlen] = '\0';
+
+  /* Offset argv to the request buffer, dropping the arguments cut by the truncation */
+  req->argc = 0;
+  for (int32_t i = 0; i < argc; i++)
+  {
+    offset = argv[i] - mdm->cmd_match_buf;
+    if (offset >= mlen)
+    {
+      break;
+    }
+    req->argv[i] = &req->resp_buf[offset];
+    req->argc++;
+  }
+
+  return 0;
+}
+#endif /* W61_AT_REQ_ENABLE */
+
 MODEM_CMD_DIRECT_DEFINE(on_cmd_tx_ready)
 {
   struct modem *mdm = (struct modem *) data->user_data;
@@ -156,7 +156,8 @@ void W61_AT_ModemDeInit(W61_Object_t *Obj);
 W61_Status_t W61_Status(int32_t ret);
 
 /**
-  * @brief  Send the AT command for Set and Execute mode, and check the status response
+  * @brief  Send the AT command for Set and Execute mode, and check the status response.
+  *         With W61_AT_REQ_ENABLE the command is queued to the AT request task and waited for
   * @param  Obj: pointer to module handle
   * @param  p_cmd: pointer to pass command string
   * @param  timeout_ms: timeout for the W61_SetExecute
@@ -83,6 +83,13 @@ static void W61_MQTT_AT_Event(void *hObj, uint16_t *argc, char **argv);
   */
 static int32_t W61_MQTT_data_event(uint32_t event_id, struct modem_cmd_handler_data *data, uint16_t len);
 
+/**
+  * @brief  Take a free inbox slot to lend a received message
+  * @param  Obj: pointer to module handle
+  * @return Slot index, -1 if all the slots are lent
+  */
+static int32_t W61_MQTT_Inbox_Take(W61_Object_t *Obj);
+
 /* Functions Definition ------------------------------------------------------*/
 W61_Status_t W61_MQTT_Init(W61_Object_t *Obj, uint8_t *p_recv_data, uint32_t recv_data_buf_len)
 {
@@ -104,12 +111,87 @@ W61_Status_t W61_MQTT_DeInit(W61_Object_t *Obj)
 {
   W61_NULL_ASSERT(Obj);
 
+  Obj->Callbacks.MQTT_event_cb = NULL;
+  Obj->Callbacks.MQTT_event_data_cb = NULL;
+
   Obj->MQTTCtx.AppBuffRecvData = NULL;
   Obj->MQTTCtx.AppBuffRecvDataSize = 0;
 
-  Obj->Callbacks.MQTT_event_cb = NULL;
-  Obj->Callbacks.MQTT_event_data_cb = NULL;
+  return W61_MQTT_SetZeroCopy(Obj, 0);
+}
+
+W61_Status_t W61_MQTT_SetZeroCopy(W61_Object_t *Obj, uint32_t Enable)
+{
+  uint8_t *detached;
+  W61_NULL_ASSERT(Obj);
+
+  if (Enable == 0)
+  {
+    /* Stop lending first, the modem task may be taking a slot in the meantime */
+    Obj->MQTTCtx.ZeroCopy = 0;
+    for (int32_t i = 0; i < W61_MQTT_INBOX_SLOTS; i++)
+    {
+      detached = NULL;
+      taskENTER_CRITICAL();
+      if ((Obj->MQTTCtx.InboxLent & (1UL << i)) == 0) /* A lent slot is freed on its release */
+      {
+        detached = Obj->MQTTCtx.Inbox[i];
+        Obj->MQTTCtx.Inbox[i] = NULL;
+      }
+      taskEXIT_CRITICAL();
+      if (detached != NULL)
+      {
+        vPortFree(detached);
+      }
+    }
+    return W61_STATUS_OK;
+  }
+
+  for (int32_t i = 0; i < W61_MQTT_INBOX_SLOTS; i++)
+  {
+    if (((Obj->MQTTCtx.InboxLent & (1UL << i)) == 0) && (Obj->MQTTCtx.Inbox[i] == NULL))
+    {
+      Obj->MQTTCtx.Inbox[i] = pvPortMalloc(RX_BUF_ALLOC_SIZE);
+      if (Obj->MQTTCtx.Inbox[i] == NULL)
+      {
+        MQTT_LOG_ERROR("Inbox slot allocation failed\n");
+        (void)W61_MQTT_SetZeroCopy(Obj, 0); /* Free the slots already allocated */
+        return W61_STATUS_ERROR;
+      }
+    }
+  }
+  Obj->MQTTCtx.ZeroCopy = 1;
+  return W61_STATUS_OK;
+}
+
+W61_Status_t W61_MQTT_Release(W61_Object_t *Obj, int32_t Slot)
+{
+  uint8_t *orphan = NULL;
+  W61_NULL_ASSERT(Obj);
+
+  if (Slot < 0)
+  {
+    return W61_STATUS_OK; /* The message has been copied */
+  }
+  if ((Slot >= W61_MQTT_INBOX_SLOTS) || ((Obj->MQTTCtx.InboxLent & (1UL << Slot)) == 0))
+  {
+    return W61_STATUS_ERROR;
+  }
 
+  taskENTER_CRITICAL();
+  if (Obj->MQTTCtx.ZeroCopy == 0)
+  {
+    /* Zero-copy disabled while the message was lent */
+    orphan = Obj->MQTTCtx.Inbox[Slot];
+    Obj->MQTTCtx.Inbox[Slot] = NULL;
+  }
+  Obj->MQTTCtx.InboxLent &= ~(1UL << Slot);
+  taskEXIT_CRITICAL();
+
+  if (orphan != NULL)
+  {
+    vPortFree(orphan);
+  }
   return W61_STATUS_OK;
 }
 
@@ -480,6 +562,7 @@ static int32_t W61_MQTT_data_event(uint32_t event_id, struct modem_cmd_handler_d
   uint32_t topic_len;
   uint32_t message_len;
   uint16_t rx_data_len;
+  int32_t slot = -1;
 
   data->rx_buf[data->rx_buf_len] = 0;
 
@@ -500,15 +583,32 @@ static int32_t W61_MQTT_data_event(uint32_t event_id, struct modem_cmd_handler_d
   }
   endptr++; /* Skip the comma */
 
-  /* Check if the buffer is large enough to hold the topic and message */
-  if ((topic_len + message_len + 1) > Obj->MQTTCtx.AppBuffRecvDataSize) /* +1 for the intermediate comma */
+  header_len = endptr - data->rx_buf;
+  rx_data_len = header_len + topic_len + message_len + 1; /* +1 for the intermediate comma */
+  if (data->rx_buf_len < rx_data_len)
   {
-    return -ENOMEM;
+    return -EAGAIN;
   }
 
-  header_len = endptr - data->rx_buf;
-  rx_data_len = header_len + topic_len + message_len + 1; /* +1 for the intermediate comma */
-  if (data->rx_buf_len >= rx_data_len)
+  cb_param_mqtt_data.topic_length = topic_len;
+  cb_param_mqtt_data.message_length = message_len;
+  if (Obj->MQTTCtx.ZeroCopy == 1)
+  {
+    slot = W61_MQTT_Inbox_Take(Obj);
+  }
+
+  if (slot >= 0)
+  {
+    /* Lend the RX buffer holding the message and go on parsing in the one of the slot */
+    Obj->MQTTCtx.Inbox[slot] = modem_cmd_handler_swap_rx_buf(data, Obj->MQTTCtx.Inbox[slot], rx_data_len);
+    /* The separators following the topic and the message are not needed anymore */
+    endptr[topic_len] = '\0';
+    endptr[topic_len + 1 + message_len] = '\0';
+    cb_param_mqtt_data.topic = endptr;
+    cb_param_mqtt_data.message = &endptr[topic_len + 1];
+    rx_data_len = 0; /* Already removed from the RX buffer */
+  }
+  else if ((topic_len + message_len + 2) <= Obj->MQTTCtx.AppBuffRecvDataSize) /* +2 for the terminations */
   {
     /* Copy the topic */
     memcpy(Obj->MQTTCtx.AppBuffRecvData, endptr, topic_len);
@@ -517,17 +617,46 @@ static int32_t W61_MQTT_data_event(uint32_t event_id, struct modem_cmd_handler_d
     endptr += topic_len + 1; /* Skip the comma after topic */
     /* Copy the message */
     memcpy(&Obj->MQTTCtx.AppBuffRecvData[topic_len + 1], endptr, message_len);
-    cb_param_mqtt_data.topic_length = topic_len;
-    cb_param_mqtt_data.message_length = message_len;
-    if (Obj->ulcbs.UL_mqtt_cb != NULL)
-    {
-      Obj->ulcbs.UL_mqtt_cb(W61_MQTT_EVT_SUBSCRIPTION_RECEIVED_ID, &cb_param_mqtt_data);
-    }
+    /* Null-terminate the message */
+    Obj->MQTTCtx.AppBuffRecvData[topic_len + 1 + message_len] = '\0';
+    cb_param_mqtt_data.topic = Obj->MQTTCtx.AppBuffRecvData;
+    cb_param_mqtt_data.message = &Obj->MQTTCtx.AppBuffRecvData[topic_len + 1];
+  }
+  else
+  {
+    /* Drop the message rather than stalling the parser on it */
+    MQTT_LOG_ERROR("Received message of %" PRIu32 " bytes does not fit in the receive buffer\n", message_len);
     return rx_data_len;
   }
+  cb_param_mqtt_data.slot = slot;
+
+  if (Obj->ulcbs.UL_mqtt_cb != NULL)
+  {
+    Obj->ulcbs.UL_mqtt_cb(W61_MQTT_EVT_SUBSCRIPTION_RECEIVED_ID, &cb_param_mqtt_data);
+  }
   else
   {
-    return -EAGAIN;
+    (void)W61_MQTT_Release(Obj, slot);
+  }
+  return rx_data_len;
+}
+
+static int32_t W61_MQTT_Inbox_Take(W61_Object_t *Obj)
+{
+  int32_t slot = -1;
+
+  taskENTER_CRITICAL();
+  for (int32_t i = 0; i < W61_MQTT_INBOX_SLOTS; i++)
+  {
+    if ((Obj->MQTTCtx.Inbox[i] != NULL) && ((Obj->MQTTCtx.InboxLent & (1UL << i)) == 0))
+    {
+      Obj->MQTTCtx.InboxLent |= (1UL << i);
+      slot = i;
+      break;
+    }
   }
+  taskEXIT_CRITICAL();
+  return slot;
 }
+
 /** @} */
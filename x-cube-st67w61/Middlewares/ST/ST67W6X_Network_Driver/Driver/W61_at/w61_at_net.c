@@ -212,6 +212,63 @@ static W61_Status_t W61_Net_StrToProtocol(char *protocol_str, W61_Net_Protocol_e
   */
 static W61_Status_t W61_Net_ProtocolToStr(W61_Net_Protocol_e Protocol, char *protocol_str);
 
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+/**
+  * @brief  Create the data channel receive state and request the NCP to use the data channel
+  * @param  Obj: pointer to module handle
+  * @return W61_Status_t status of the operation
+  */
+static W61_Status_t W61_Net_DataChannel_Init(W61_Object_t *Obj);
+
+/**
+  * @brief  Free the data channel receive state
+  * @param  Obj: pointer to module handle
+  */
+static void W61_Net_DataChannel_DeInit(W61_Object_t *Obj);
+
+/**
+  * @brief  Send socket data in a data channel message
+  * @param  Obj: pointer to module handle
+  * @param  Socket: number of the socket
+  * @param  RemoteIp: destination IP address of an unconnected UDP socket, NULL otherwise
+  * @param  RemotePort: destination port of an unconnected UDP socket, 0 otherwise
+  * @param  pdata: pointer to data
+  * @param  Reqlen: length of the data, up to the SPI MTU minus the message header
+  * @param  Timeout: timeout in ms
+  * @return W61_Status_t status of the operation
+  */
+static W61_Status_t W61_Net_DataChannel_Send(W61_Object_t *Obj, uint8_t Socket, uint8_t *RemoteIp,
+                                             uint16_t RemotePort, uint8_t *pdata, uint32_t Reqlen, uint32_t Timeout);
+
+/**
+  * @brief  Copy the socket data received over the data channel
+  * @param  Obj: pointer to module handle
+  * @param  Socket: number of the socket
+  * @param  Reqlen: maximum number of bytes to copy
+  * @param  pData: pointer to data
+  * @param  Receivedlen: pointer to the number of bytes copied
+  * @return W61_Status_t status of the operation
+  */
+static W61_Status_t W61_Net_DataChannel_Read(W61_Object_t *Obj, uint8_t Socket, uint32_t Reqlen, uint8_t *pData,
+                                             uint32_t *Receivedlen);
+
+/**
+  * @brief  Return the messages consumed on a connection to the NCP receive window
+  * @param  Obj: pointer to module handle
+  * @param  Socket: number of the socket
+  * @param  Consumed: number of messages just consumed
+  * @param  Force: 1 to return the credits right away, 0 to wait for half of the window
+  */
+static void W61_Net_DataChannel_Credit(W61_Object_t *Obj, uint8_t Socket, uint32_t Consumed, uint8_t Force);
+
+/**
+  * @brief  Move the messages received by the SPI layer to the queue of their connection and notify the upper
+  *         layer. A message beyond the receive window of its connection is dropped and counted
+  * @param  Obj: pointer to module handle
+  */
+static void W61_Net_DataChannel_Sort(W61_Object_t *Obj);
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
+
 /* Functions Definition ------------------------------------------------------*/
 W61_Status_t W61_Net_Init(W61_Object_t *Obj)
 {
@@ -239,6 +296,13 @@ W61_Status_t W61_Net_Init(W61_Object_t *Obj)
       break;
     }
   }
+
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+  if (ret == W61_STATUS_OK)
+  {
+    ret = W61_Net_DataChannel_Init(Obj);
+  }
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
   return ret;
 }
 
@@ -250,6 +314,10 @@ W61_Status_t W61_Net_DeInit(W61_Object_t *Obj)
   Obj->Callbacks.Net_event_ping_cb = NULL;
   Obj->Callbacks.Net_event_data_cb = NULL;
 
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+  W61_Net_DataChannel_DeInit(Obj);
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
+
   return W61_STATUS_OK;
 }
 
@@ -772,6 +840,19 @@ W61_Status_t W61_Net_SendData(W61_Object_t *Obj, uint8_t Socket, uint8_t *pdata,
   W61_NULL_ASSERT(pdata);
   W61_NULL_ASSERT(SentLen);
 
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+  if (Obj->NetCtx.DataChannel == 1)
+  {
+    if (Reqlen > SPI_XFER_MTU_BYTES - sizeof(struct spi_sock_data_hdr))
+    {
+      Reqlen = SPI_XFER_MTU_BYTES - sizeof(struct spi_sock_data_hdr);
+    }
+    ret = W61_Net_DataChannel_Send(Obj, Socket, NULL, 0, pdata, Reqlen, Timeout);
+    *SentLen = (ret == W61_STATUS_OK) ? Reqlen : 0;
+    return ret;
+  }
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
+
   if (Reqlen > SPI_XFER_MTU_BYTES)
   {
     Reqlen = SPI_XFER_MTU_BYTES;
@@ -805,6 +886,22 @@ W61_Status_t W61_Net_SendData_Non_Connected(W61_Object_t *Obj, uint8_t Socket, c
   W61_NULL_ASSERT(pdata);
   W61_NULL_ASSERT(SentLen);
 
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+  if (Obj->NetCtx.DataChannel == 1)
+  {
+    uint8_t ip_addr[4] = {0};
+
+    if (Reqlen > SPI_XFER_MTU_BYTES - sizeof(struct spi_sock_data_hdr))
+    {
+      Reqlen = SPI_XFER_MTU_BYTES - sizeof(struct spi_sock_data_hdr);
+    }
+    Parser_StrToIP(IpAddress, ip_addr);
+    ret = W61_Net_DataChannel_Send(Obj, Socket, ip_addr, (uint16_t)Port, pdata, Reqlen, Timeout);
+    *SentLen = (ret == W61_STATUS_OK) ? Reqlen : 0;
+    return ret;
+  }
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
+
   if (Reqlen > SPI_XFER_MTU_BYTES)
   {
     Reqlen = SPI_XFER_MTU_BYTES;
@@ -882,6 +979,13 @@ W61_Status_t W61_Net_PullDataFromSocket(W61_Object_t *Obj, uint8_t Socket, uint3
     MODEM_CMD_DIRECT("+CIPRECVDATA:", on_cmd_pulldata),
   };
 
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+  if (Obj->NetCtx.DataChannel == 1)
+  {
+    return W61_Net_DataChannel_Read(Obj, Socket, Reqlen, pData, Receivedlen);
+  }
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
+
   if (Reqlen > W61_MAX_SPI_XFER - 64)
   {
     Reqlen = W61_MAX_SPI_XFER - 64;
@@ -906,6 +1010,76 @@ W61_Status_t W61_Net_PullDataFromSocket(W61_Object_t *Obj, uint8_t Socket, uint3
   return ret;
 }
 
+W61_Status_t W61_Net_DataChannel_Flush(W61_Object_t *Obj, uint8_t Socket)
+{
+  W61_NULL_ASSERT(Obj);
+
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+  W61_Net_Ctx_t *ctx = &Obj->NetCtx;
+  W61_Net_DataFrame_t frame;
+  uint32_t consumed = 0;
+
+  if ((ctx->DataChannel == 0) || (Socket >= W61_NET_MAX_CONNECTIONS))
+  {
+    return W61_STATUS_OK;
+  }
+
+  (void)xSemaphoreTake(ctx->DataChannelLock, portMAX_DELAY);
+  if (ctx->DataChannelCur[Socket].buffer != NULL)
+  {
+    (void)BusIo_SPI_Free(ctx->DataChannelCur[Socket].buffer);
+    ctx->DataChannelCur[Socket].buffer = NULL;
+    consumed++;
+  }
+  while (xQueueReceive(ctx->DataChannelRxq[Socket], &frame, 0) == pdTRUE)
+  {
+    (void)BusIo_SPI_Free(frame.buffer);
+    consumed++;
+  }
+  taskENTER_CRITICAL();
+  ctx->DataChannelDrops[Socket] = 0;
+  taskEXIT_CRITICAL();
+  (void)xSemaphoreGive(ctx->DataChannelLock);
+
+  /* Reopen the receive window so that the NCP is not held back while closing */
+  W61_Net_DataChannel_Credit(Obj, Socket, consumed, 1);
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
+
+  return W61_STATUS_OK;
+}
+
+void W61_Net_DataChannel_Notify(void *arg)
+{
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+  W61_Object_t *Obj = W61_ObjGet();
+  W61_Net_DataFrame_t frame;
+  uint8_t active = 0;
+
+  if (Obj != NULL)
+  {
+    /* DeInit waits for the end of the sorting before it deletes the connection queues */
+    taskENTER_CRITICAL();
+    active = Obj->NetCtx.DataChannel;
+    Obj->NetCtx.DataChannelSorting = active;
+    taskEXIT_CRITICAL();
+  }
+
+  if (active == 0)
+  {
+    /* Data channel not negotiated, nobody reads the messages */
+    while (BusIo_SPI_ReceivePtr(SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA, &frame.buffer, &frame.data, 0) >= 0)
+    {
+      (void)BusIo_SPI_Free(frame.buffer);
+    }
+    return;
+  }
+
+  /* No lock is taken: the SPI transfer task must not wait for a reader */
+  W61_Net_DataChannel_Sort(Obj);
+  Obj->NetCtx.DataChannelSorting = 0;
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
+}
+
 W61_Status_t W61_Net_SetServerMaxConnections(W61_Object_t *Obj, uint8_t MaxConnections)
 {
   char cmd[W61_CMDRSP_STRING_SIZE];
@@ -1466,6 +1640,286 @@ static void W61_Net_data_event(void *hObj, uint16_t *argc, char **argv)
   return;
 }
 
+#if (W61_NET_DATA_CHANNEL_ENABLE == 1)
+static W61_Status_t W61_Net_DataChannel_Init(W61_Object_t *Obj)
+{
+  W61_Net_Ctx_t *ctx = &Obj->NetCtx;
+  W61_Status_t ret;
+
+  char cmd[W61_CMD_MATCH_BUFF_SIZE];
+
+  ctx->DataChannel = 0;
+  ctx->DataChannelSorting = 0;
+  memset(ctx->DataChannelCur, 0, sizeof(ctx->DataChannelCur));
+  memset(ctx->DataChannelCredit, 0, sizeof(ctx->DataChannelCredit));
+  memset(ctx->DataChannelDrops, 0, sizeof(ctx->DataChannelDrops));
+
+  ctx->DataChannelLock = xSemaphoreCreateMutex();
+  if (ctx->DataChannelLock == NULL)
+  {
+    goto _err;
+  }
+  for (uint8_t i = 0; i < W61_NET_MAX_CONNECTIONS; i++)
+  {
+    ctx->DataChannelRxq[i] = xQueueCreate(W61_NET_DATA_CHANNEL_RXQ_LEN, sizeof(W61_Net_DataFrame_t));
+    if (ctx->DataChannelRxq[i] == NULL)
+    {
+      goto _err;
+    }
+  }
+
+  /* Socket data is then exchanged in SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA messages instead of +IPD / AT+CIPRECVDATA.
+   * The NCP sends up to W61_NET_DATA_CHANNEL_RXQ_LEN messages per connection ahead of the credits returned */
+  snprintf(cmd, W61_CMD_MATCH_BUFF_SIZE, "AT+CIPDATACHAN=1,%" PRIu32 "\r\n", (uint32_t)W61_NET_DATA_CHANNEL_RXQ_LEN);
+  ret = W61_AT_Common_SetExecute(Obj, (uint8_t *)cmd, W61_NCP_TIMEOUT);
+  if (ret != W61_STATUS_OK)
+  {
+    NET_LOG_WARN("NCP has no socket data channel, using AT+CIPSEND / AT+CIPRECVDATA\n");
+    W61_Net_DataChannel_DeInit(Obj);
+    return W61_STATUS_OK;
+  }
+
+  ctx->DataChannel = 1;
+  return W61_STATUS_OK;
+
+_err:
+  NET_LOG_ERROR("Could not allocate the socket data channel\n");
+  W61_Net_DataChannel_DeInit(Obj);
+  return W61_STATUS_ERROR;
+}
+
+static void W61_Net_DataChannel_DeInit(W61_Object_t *Obj)
+{
+  W61_Net_Ctx_t *ctx = &Obj->NetCtx;
+  W61_Net_DataFrame_t frame;
+
+  /* Stop sorting the messages in the SPI transfer task */
+  taskENTER_CRITICAL();
+  ctx->DataChannel = 0;
+  taskEXIT_CRITICAL();
+  while (ctx->DataChannelSorting != 0)
+  {
+    vTaskDelay(1);
+  }
+  if (ctx->DataChannelLock != NULL)
+  {
+    (void)xSemaphoreTake(ctx->DataChannelLock, portMAX_DELAY);
+  }
+
+  for (uint8_t i = 0; i < W61_NET_MAX_CONNECTIONS; i++)
+  {
+    if (ctx->DataChannelCur[i].buffer != NULL)
+    {
+      (void)BusIo_SPI_Free(ctx->DataChannelCur[i].buffer);
+      ctx->DataChannelCur[i].buffer = NULL;
+    }
+    if (ctx->DataChannelRxq[i] != NULL)
+    {
+      while (xQueueReceive(ctx->DataChannelRxq[i], &frame, 0) == pdTRUE)
+      {
+        (void)BusIo_SPI_Free(frame.buffer);
+      }
+      vQueueDelete(ctx->DataChannelRxq[i]);
+      ctx->DataChannelRxq[i] = NULL;
+    }
+  }
+  if (ctx->DataChannelLock != NULL)
+  {
+    vSemaphoreDelete(ctx->DataChannelLock);
+    ctx->DataChannelLock = NULL;
+  }
+}
+
+static W61_Status_t W61_Net_DataChannel_Send(W61_Object_t *Obj, uint8_t Socket, uint8_t *RemoteIp,
+                                             uint16_t RemotePort, uint8_t *pdata, uint32_t Reqlen, uint32_t Timeout)
+{
+  struct spi_sock_data_hdr hdr = {0};
+  struct spi_iovec iov[2];
+
+  if (Socket >= W61_NET_MAX_CONNECTIONS)
+  {
+    return W61_STATUS_ERROR;
+  }
+
+  hdr.sock = Socket;
+  hdr.len = (uint16_t)Reqlen;
+  if (RemoteIp != NULL)
+  {
+    memcpy(hdr.remote_ip, RemoteIp, sizeof(hdr.remote_ip));
+    hdr.remote_port = RemotePort;
+  }
+  /* The pending receive credits of the connection ride along */
+  taskENTER_CRITICAL();
+  hdr.credit = Obj->NetCtx.DataChannelCredit[Socket];
+  Obj->NetCtx.DataChannelCredit[Socket] = 0;
+  taskEXIT_CRITICAL();
+
+  iov[0].base = &hdr;
+  iov[0].len = sizeof(hdr);
+  iov[1].base = pdata;
+  iov[1].len = Reqlen;
+
+  /* Header and payload are gathered in one SPI buffer, there is no prompt nor send report to wait for */
+  if (BusIo_SPI_SendDataVec(SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA, iov, 2, 0, NULL, NULL, Timeout) < 0)
+  {
+    taskENTER_CRITICAL();
+    Obj->NetCtx.DataChannelCredit[Socket] += hdr.credit;
+    taskEXIT_CRITICAL();
+    NET_LOG_ERROR("Could not send data on socket %" PRIu16 "\n", Socket);
+    return W61_STATUS_ERROR;
+  }
+  return W61_STATUS_OK;
+}
+
+static W61_Status_t W61_Net_DataChannel_Read(W61_Object_t *Obj, uint8_t Socket, uint32_t Reqlen, uint8_t *pData,
+                                             uint32_t *Receivedlen)
+{
+  W61_Net_Ctx_t *ctx = &Obj->NetCtx;
+  W61_Net_DataFrame_t *cur;
+  uint32_t consumed = 0;
+  uint32_t drops;
+  uint32_t len;
+
+  *Receivedlen = 0;
+  if (Socket >= W61_NET_MAX_CONNECTIONS)
+  {
+    return W61_STATUS_ERROR;
+  }
+
+  (void)xSemaphoreTake(ctx->DataChannelLock, portMAX_DELAY);
+  taskENTER_CRITICAL();
+  drops = ctx->DataChannelDrops[Socket];
+  ctx->DataChannelDrops[Socket] = 0;
+  taskEXIT_CRITICAL();
+  if (drops != 0)
+  {
+    /* The stream has a hole, report it rather than the data past it */
+    (void)xSemaphoreGive(ctx->DataChannelLock);
+    NET_LOG_ERROR("%" PRIu32 " data channel messages dropped on socket %" PRIu16 "\n", drops, Socket);
+    return W61_STATUS_ERROR;
+  }
+
+  cur = &ctx->DataChannelCur[Socket];
+  while (*Receivedlen < Reqlen)
+  {
+    if ((cur->buffer == NULL) && (xQueueReceive(ctx->DataChannelRxq[Socket], cur, 0) != pdTRUE))
+    {
+      break;
+    }
+
+    len = Reqlen - *Receivedlen;
+    if (len > cur->len)
+    {
+      len = cur->len;
+    }
+    memcpy(&pData[*Receivedlen], cur->data, len);
+    cur->data += len;
+    cur->len -= len;
+    *Receivedlen += len;
+
+    if (cur->len == 0)
+    {
+      (void)BusIo_SPI_Free(cur->buffer);
+      cur->buffer = NULL;
+      consumed++;
+    }
+  }
+  (void)xSemaphoreGive(ctx->DataChannelLock);
+
+  W61_Net_DataChannel_Credit(Obj, Socket, consumed, 0);
+  return W61_STATUS_OK;
+}
+
+static void W61_Net_DataChannel_Credit(W61_Object_t *Obj, uint8_t Socket, uint32_t Consumed, uint8_t Force)
+{
+  W61_Net_Ctx_t *ctx = &Obj->NetCtx;
+  struct spi_sock_data_hdr hdr = {0};
+  struct spi_iovec iov;
+  uint16_t credit = 0;
+
+  taskENTER_CRITICAL();
+  ctx->DataChannelCredit[Socket] += Consumed;
+  if ((ctx->DataChannelCredit[Socket] > 0) &&
+      ((Force != 0) || (ctx->DataChannelCredit[Socket] >= (W61_NET_DATA_CHANNEL_RXQ_LEN + 1) / 2)))
+  {
+    credit = ctx->DataChannelCredit[Socket];
+    ctx->DataChannelCredit[Socket] = 0;
+  }
+  taskEXIT_CRITICAL();
+
+  if (credit == 0)
+  {
+    return;
+  }
+
+  /* Message without socket data */
+  hdr.sock = Socket;
+  hdr.credit = credit;
+  iov.base = &hdr;
+  iov.len = sizeof(hdr);
+  if (BusIo_SPI_SendDataVec(SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA, &iov, 1, 0, NULL, NULL, W61_NET_TIMEOUT) < 0)
+  {
+    /* Returned with the next ones */
+    taskENTER_CRITICAL();
+    ctx->DataChannelCredit[Socket] += credit;
+    taskEXIT_CRITICAL();
+  }
+}
+
+static void W61_Net_DataChannel_Sort(W61_Object_t *Obj)
+{
+  W61_Net_Ctx_t *ctx = &Obj->NetCtx;
+  W61_Net_CbParamData_t cb_param_net_data;
+  struct spi_sock_data_hdr *hdr;
+  W61_Net_DataFrame_t frame;
+  uint8_t sock;
+  int32_t len;
+
+  while (1)
+  {
+    len = BusIo_SPI_ReceivePtr(SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA, &frame.buffer, &frame.data, 0);
+    if ((len < 0) || (frame.buffer == NULL))
+    {
+      break;
+    }
+
+    hdr = (struct spi_sock_data_hdr *)frame.data;
+    if ((len < (int32_t)sizeof(*hdr)) || (hdr->sock >= W61_NET_MAX_CONNECTIONS) ||
+        (hdr->len == 0) || (hdr->len > len - sizeof(*hdr)))
+    {
+      NET_LOG_ERROR("Invalid socket data message\n");
+      (void)BusIo_SPI_Free(frame.buffer);
+      continue;
+    }
+    frame.data += sizeof(*hdr);
+    frame.len = hdr->len;
+
+    /* The message may be read and released as soon as it is queued */
+    sock = hdr->sock;
+    cb_param_net_data.socket_id = sock;
+    cb_param_net_data.available_data_length = hdr->len;
+    snprintf(cb_param_net_data.remote_ip, sizeof(cb_param_net_data.remote_ip), "%" PRIu16 ".%" PRIu16 ".%"
+             PRIu16 ".%" PRIu16, hdr->remote_ip[0], hdr->remote_ip[1], hdr->remote_ip[2], hdr->remote_ip[3]);
+    cb_param_net_data.remote_port = hdr->remote_port;
+
+    if (xQueueSend(ctx->DataChannelRxq[sock], &frame, 0) != pdTRUE)
+    {
+      /* Beyond the receive window of the connection, the next read reports the loss */
+      (void)BusIo_SPI_Free(frame.buffer);
+      taskENTER_CRITICAL();
+      ctx->DataChannelDrops[sock]++;
+      taskEXIT_CRITICAL();
+      continue;
+    }
+
+    if (Obj->ulcbs.UL_net_cb != NULL)
+    {
+      Obj->ulcbs.UL_net_cb(W61_NET_EVT_SOCK_DATA_ID, &cb_param_net_data);
+    }
+  }
+}
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
+
 static W61_Status_t W61_Net_StrToProtocol(char *protocol_str, W61_Net_Protocol_e *Protocol)
 {
   if (strcmp(protocol_str, "TCP") == 0)
@@ -51,6 +51,15 @@ extern "C" {
 #define WIFI_LOG_ENABLE                         0
 #endif /* WIFI_LOG_ENABLE */
 
+#ifndef WIFI_LOG_LEVEL
+/** Highest Wi-Fi log level compiled in, the global LOG_LEVEL by default. The Wi-Fi messages above it cost nothing */
+#if (WIFI_LOG_ENABLE == 1)
+#define WIFI_LOG_LEVEL                          LOG_LEVEL
+#else
+#define WIFI_LOG_LEVEL                          LOG_NONE
+#endif /* WIFI_LOG_ENABLE */
+#endif /* WIFI_LOG_LEVEL */
+
 /** @} */
 
 /** @addtogroup ST67W61_AT_BLE_Constants
@@ -85,6 +94,15 @@ extern "C" {
 #define BLE_LOG_ENABLE                          0
 #endif /* BLE_LOG_ENABLE */
 
+#ifndef BLE_LOG_LEVEL
+/** Highest BLE log level compiled in, the global LOG_LEVEL by default. The BLE messages above it cost nothing */
+#if (BLE_LOG_ENABLE == 1)
+#define BLE_LOG_LEVEL                           LOG_LEVEL
+#else
+#define BLE_LOG_LEVEL                           LOG_NONE
+#endif /* BLE_LOG_ENABLE */
+#endif /* BLE_LOG_LEVEL */
+
 /** @} */
 
 /** @addtogroup ST67W61_AT_Net_Constants
@@ -96,6 +114,26 @@ extern "C" {
 #define NET_LOG_ENABLE                          0
 #endif /* NET_LOG_ENABLE */
 
+#ifndef NET_LOG_LEVEL
+/** Highest NET log level compiled in, the global LOG_LEVEL by default. The NET messages above it cost nothing */
+#if (NET_LOG_ENABLE == 1)
+#define NET_LOG_LEVEL                           LOG_LEVEL
+#else
+#define NET_LOG_LEVEL                           LOG_NONE
+#endif /* NET_LOG_ENABLE */
+#endif /* NET_LOG_LEVEL */
+
+#ifndef W61_NET_DATA_CHANNEL_ENABLE
+/** Carry socket payloads in SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA messages instead of AT+CIPSEND / AT+CIPRECVDATA.
+  * Falls back to the AT commands when the NCP firmware rejects AT+CIPDATACHAN */
+#define W61_NET_DATA_CHANNEL_ENABLE             0
+#endif /* W61_NET_DATA_CHANNEL_ENABLE */
+
+#ifndef W61_NET_DATA_CHANNEL_RXQ_LEN
+/** Receive window of each connection: number of data channel messages the NCP may send ahead of the ones read */
+#define W61_NET_DATA_CHANNEL_RXQ_LEN            4
+#endif /* W61_NET_DATA_CHANNEL_RXQ_LEN */
+
 /** @} */
 
 /** @addtogroup ST67W61_AT_MQTT_Constants
@@ -107,6 +145,25 @@ extern "C" {
 #define MQTT_LOG_ENABLE                         0
 #endif /* MQTT_LOG_ENABLE */
 
+#ifndef MQTT_LOG_LEVEL
+/** Highest MQTT log level compiled in, the global LOG_LEVEL by default. The MQTT messages above it cost nothing */
+#if (MQTT_LOG_ENABLE == 1)
+#define MQTT_LOG_LEVEL                          LOG_LEVEL
+#else
+#define MQTT_LOG_LEVEL                          LOG_NONE
+#endif /* MQTT_LOG_ENABLE */
+#endif /* MQTT_LOG_LEVEL */
+
+#ifndef W61_MQTT_INBOX_SLOTS
+/** Number of received MQTT messages that can be lent to the application at the same time in zero-copy mode.
+  * Each slot costs one RX buffer of W61_MAX_SPI_XFER bytes, allocated when the zero-copy mode is enabled */
+#define W61_MQTT_INBOX_SLOTS                    4
+#endif /* W61_MQTT_INBOX_SLOTS */
+
+#if ((W61_MQTT_INBOX_SLOTS < 1) || (W61_MQTT_INBOX_SLOTS > 32))
+#error "W61_MQTT_INBOX_SLOTS must be between 1 and 32"
+#endif /* W61_MQTT_INBOX_SLOTS */
+
 /** @} */
 
 /** @addtogroup ST67W61_AT_Common_Constants
@@ -118,6 +175,15 @@ extern "C" {
 #define SYS_LOG_ENABLE                          0
 #endif /* SYS_LOG_ENABLE */
 
+#ifndef SYS_LOG_LEVEL
+/** Highest SYS log level compiled in, the global LOG_LEVEL by default. The SYS messages above it cost nothing */
+#if (SYS_LOG_ENABLE == 1)
+#define SYS_LOG_LEVEL                           LOG_LEVEL
+#else
+#define SYS_LOG_LEVEL                           LOG_NONE
+#endif /* SYS_LOG_ENABLE */
+#endif /* SYS_LOG_LEVEL */
+
 #ifndef W61_AT_LOG_ENABLE
 /** Enable AT log */
 #define W61_AT_LOG_ENABLE                       0
@@ -134,6 +200,33 @@ extern "C" {
 #define W61_ASSERT_ENABLE                       0
 #endif /* W61_ASSERT_ENABLE */
 
+#ifndef W61_AT_REQ_ENABLE
+/** Enable the asynchronous AT request engine (W61_AT_Request_Submit / W61_AT_Request_Wait).
+  * W61_AT_Common_SetExecute commands, e.g. the socket and Wi-Fi join ones, are then queued to its task too.
+  * Requires configSUPPORT_STATIC_ALLOCATION */
+#define W61_AT_REQ_ENABLE                       0
+#endif /* W61_AT_REQ_ENABLE */
+
+#ifndef W61_AT_REQ_QUEUE_LEN
+/** Number of AT requests that can be queued ahead of the one being executed */
+#define W61_AT_REQ_QUEUE_LEN                    8
+#endif /* W61_AT_REQ_QUEUE_LEN */
+
+#ifndef W61_AT_REQ_RESP_SIZE
+/** Size of the response line captured in each AT request */
+#define W61_AT_REQ_RESP_SIZE                    128
+#endif /* W61_AT_REQ_RESP_SIZE */
+
+#ifndef W61_AT_REQ_TASK_STACK_SIZE_BYTES
+/** Stack of the AT request task, completion callbacks run on it */
+#define W61_AT_REQ_TASK_STACK_SIZE_BYTES        1024
+#endif /* W61_AT_REQ_TASK_STACK_SIZE_BYTES */
+
+#ifndef W61_AT_REQ_TASK_PRIO
+/** AT request task priority, lower than W61_MDM_RX_TASK_PRIO */
+#define W61_AT_REQ_TASK_PRIO                    52
+#endif /* W61_AT_REQ_TASK_PRIO */
+
 /** @} */
 
 #ifdef __cplusplus
@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file    spi_buf_pool.h
+  * @brief   Lock-free fixed-size buffer pool of the SPI bus interface
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SPI_BUF_POOL_H
+#define SPI_BUF_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * Fixed-size SPI buffer pool class
+  *
+  * Slots are tracked with a bitmap updated by compare-and-swap so that buffers
+  * can be allocated and released from any task without taking a lock.
+  * The pool has no OS dependency, it is exercised on a host by Tests/spi_buf_pool_stress.c.
+  */
+struct spi_buffer_pool
+{
+  /* Slot storage */
+  uint8_t *mem;
+  /* Size of one slot, descriptor included */
+  uint32_t slot_size;
+  /* Data capacity of one slot */
+  uint32_t cap;
+  /* Number of slots, up to 32 */
+  uint32_t count;
+  /* Bitmap of allocated slots */
+  atomic_uint_fast32_t used;
+  /* Number of allocated slots */
+  atomic_uint_fast32_t in_use;
+  /* Highest number of allocated slots */
+  atomic_uint_fast32_t hwm;
+  /* Allocations which found the class exhausted */
+  atomic_uint_fast32_t alloc_fail;
+};
+
+/* Exported functions --------------------------------------------------------*/
+/* Take a free slot from the pool class, NULL if exhausted. */
+static inline void *spi_buffer_pool_get(struct spi_buffer_pool *pool)
+{
+  uint_fast32_t used;
+  uint_fast32_t in_use;
+  uint_fast32_t hwm;
+  uint32_t slot;
+
+  used = atomic_load_explicit(&pool->used, memory_order_relaxed);
+  do
+  {
+    for (slot = 0; slot < pool->count; slot++)
+    {
+      if (!(used & (1UL << slot)))
+      {
+        break;
+      }
+    }
+
+    if (slot == pool->count)
+    {
+      atomic_fetch_add_explicit(&pool->alloc_fail, 1, memory_order_relaxed);
+      return NULL;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&pool->used, &used, used | (1UL << slot),
+                                                  memory_order_acquire, memory_order_relaxed));
+
+  /* Track the high-water mark. */
+  in_use = atomic_fetch_add_explicit(&pool->in_use, 1, memory_order_relaxed) + 1;
+  hwm = atomic_load_explicit(&pool->hwm, memory_order_relaxed);
+  while ((in_use > hwm) &&
+         !atomic_compare_exchange_weak_explicit(&pool->hwm, &hwm, in_use,
+                                                memory_order_relaxed, memory_order_relaxed))
+  {
+  }
+
+  return pool->mem + slot * pool->slot_size;
+}
+
+/* Return 1 if the buffer belongs to the pool class and has been released. */
+static inline int32_t spi_buffer_pool_put(struct spi_buffer_pool *pool, void *buf)
+{
+  uint8_t *p = (uint8_t *)buf;
+  uint32_t slot;
+
+  if ((p < pool->mem) || (p >= pool->mem + pool->count * pool->slot_size))
+  {
+    return 0;
+  }
+
+  slot = (p - pool->mem) / pool->slot_size;
+  atomic_fetch_sub_explicit(&pool->in_use, 1, memory_order_relaxed);
+  atomic_fetch_and_explicit(&pool->used, ~(1UL << slot), memory_order_release);
+  return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SPI_BUF_POOL_H */
@@ -26,6 +26,7 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdatomic.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
@@ -38,6 +39,7 @@
 #include "w61_default_config.h"
 
 #include "spi_iface.h"
+#include "spi_buf_pool.h"
 #include "spi_port.h"
 
 #define SPI_HEADER_MAGIC_CODE 0x55AA
@@ -52,6 +54,79 @@
 #define SPI_THREAD_PRIO       53
 #endif /* SPI_THREAD_PRIO */
 
+#ifndef SPI_BUF_POOL_MTU_COUNT
+/** Number of MTU sized buffers in the SPI buffer pool (0 to always use the heap) */
+#define SPI_BUF_POOL_MTU_COUNT    8
+#endif /* SPI_BUF_POOL_MTU_COUNT */
+
+#ifndef SPI_BUF_POOL_SMALL_COUNT
+/** Number of small buffers in the SPI buffer pool (0 to always use the heap) */
+#define SPI_BUF_POOL_SMALL_COUNT  16
+#endif /* SPI_BUF_POOL_SMALL_COUNT */
+
+#ifndef SPI_BUF_POOL_SMALL_SIZE
+/** Capacity of the small SPI buffers, sized for AT replies and TCP ACKs */
+#define SPI_BUF_POOL_SMALL_SIZE   256
+#endif /* SPI_BUF_POOL_SMALL_SIZE */
+
+/** Receive into an MTU buffer, then copy messages shorter than SPI_RX_SHORT_COPY_THRESHOLD */
+#define SPI_RX_BUF_MODE_COPY_SHORT  0
+/** Read the slave header first and receive the payload into a buffer sized from it */
+#define SPI_RX_BUF_MODE_RIGHT_SIZED 1
+
+#ifndef SPI_RX_BUF_MODE
+/** SPI RX buffer strategy: SPI_RX_BUF_MODE_COPY_SHORT or SPI_RX_BUF_MODE_RIGHT_SIZED */
+#define SPI_RX_BUF_MODE           SPI_RX_BUF_MODE_RIGHT_SIZED
+#endif /* SPI_RX_BUF_MODE */
+
+#ifndef SPI_RX_SHORT_COPY_THRESHOLD
+/** Size under which a received message is moved to a smaller buffer in SPI_RX_BUF_MODE_COPY_SHORT */
+#define SPI_RX_SHORT_COPY_THRESHOLD 256
+#endif /* SPI_RX_SHORT_COPY_THRESHOLD */
+
+#ifndef SPI_XFER_PIPELINE
+/** Prepare the next TX buffer while the current transfer waits for DMA or header ack */
+#define SPI_XFER_PIPELINE         1
+#endif /* SPI_XFER_PIPELINE */
+
+#ifndef SPI_TRACE_ENABLE
+/** Record the SPI_TP_* trace points and accumulate per-stage latency */
+#define SPI_TRACE_ENABLE          0
+#endif /* SPI_TRACE_ENABLE */
+
+#if !defined(SPI_TRACE_TIMESTAMP) && \
+    (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__) || \
+     defined(__ARM_ARCH_8_1M_MAIN__) || defined(__ARM7M__) || defined(__ARM7EM__) || \
+     defined(__ARM8M_MAINLINE__) || defined(__ARM8EM_MAINLINE__))
+/* ARMv7-M and ARMv8-M mainline cores have the DWT cycle counter */
+#define SPI_TRACE_DWT             1
+#define SPI_DWT_CTRL              (*(volatile uint32_t *)0xE0001000UL)
+#define SPI_DWT_CYCCNT            (*(volatile uint32_t *)0xE0001004UL)
+#define SPI_DEMCR                 (*(volatile uint32_t *)0xE000EDFCUL)
+#define SPI_DEMCR_TRCENA          (1UL << 24)
+#define SPI_DWT_CTRL_CYCCNTENA    (1UL << 0)
+/** Timestamp source of the trace points: the DWT cycle counter */
+#define SPI_TRACE_TIMESTAMP()     (SPI_DWT_CYCCNT)
+/** Frequency of SPI_TRACE_TIMESTAMP */
+#define SPI_TRACE_TIMESTAMP_HZ    configCPU_CLOCK_HZ
+#endif /* SPI_TRACE_TIMESTAMP */
+
+#ifndef SPI_TRACE_TIMESTAMP
+/** Timestamp source of the trace points on cores without DWT, 1 ms resolution with the default tick rate */
+#define SPI_TRACE_TIMESTAMP()     (xPortIsInsideInterrupt() ? xTaskGetTickCountFromISR() : xTaskGetTickCount())
+/** Frequency of SPI_TRACE_TIMESTAMP */
+#define SPI_TRACE_TIMESTAMP_HZ    configTICK_RATE_HZ
+#endif /* SPI_TRACE_TIMESTAMP */
+
+#ifndef SPI_XFER_CLOCK_HZ
+/** SPI clock frequency used as line rate reference by spi_perf, 0 if unknown */
+#define SPI_XFER_CLOCK_HZ         0
+#endif /* SPI_XFER_CLOCK_HZ */
+
+#if (SPI_BUF_POOL_MTU_COUNT > 32) || (SPI_BUF_POOL_SMALL_COUNT > 32)
+#error "SPI buffer pool classes are limited to 32 buffers"
+#endif /* SPI_BUF_POOL_xxx_COUNT */
+
 struct spi_header
 {
   uint16_t magic;
@@ -64,6 +139,8 @@ struct spi_header
   uint16_t rsvd;
 } __attribute__((packed));
 
+_Static_assert(sizeof(struct spi_header) == SPI_XFER_HEADER_LEN, "SPI_XFER_HEADER_LEN mismatch");
+
 #define SPI_HEADER_INIT(h, _type, _len) do {                                     \
                                              (h)->magic = SPI_HEADER_MAGIC_CODE; \
                                              (h)->type = _type;                  \
@@ -88,11 +165,62 @@ enum
   SPI_XFER_F_SKIP_FIRST_TXN_WAIT = 0x1,
 };
 
+/* spi_buffer flags. */
+enum
+{
+  /* Payload was copied from the caller's memory. */
+  SPI_BUFFER_F_COPIED = 0x1,
+  /* Master header already initialized by the pipeline. */
+  SPI_BUFFER_F_HDR_READY = 0x2,
+};
+
 #define SPI_STAT_INC(stat, mb, val) (stat)->mb += (val)
 
 #define SPI_TXQ_LEN 8
 #define SPI_RXQ_LEN 8
 
+/* SPI transfer trace points. */
+enum
+{
+  SPI_TP_NONE = 0,
+  SPI_TP_WRITE = 1,
+  SPI_TP_ASSERT_CS = 2,
+  SPI_TP_SLAVE_TXN_RDY = 3,
+  SPI_TP_FIRST_TXN_START = 4,
+  SPI_TP_FIRST_TXN_END = 5,
+  SPI_TP_SECOND_TXN_START = 6,
+  SPI_TP_SECOND_TXN_END = 7,
+  SPI_TP_WAIT_HDR_ACK_START = 8,
+  SPI_TP_HDR_ACKED = 9,
+  SPI_TP_WAIT_HDR_ACK_END = 10,
+  SPI_TP_DEASSERT_CS = 11,
+  SPI_TP_READ = 12,
+  SPI_TP_NUM = 12,
+};
+
+/* Transfer stages measured between two trace points. */
+enum
+{
+  /* Chip select asserted until slave ready */
+  SPI_STAGE_TXN_RDY,
+  /* Header exchange */
+  SPI_STAGE_FIRST_TXN,
+  /* Remaining payload */
+  SPI_STAGE_SECOND_TXN,
+  /* Wait for the slave header ack */
+  SPI_STAGE_HDR_ACK,
+  /* Chip select asserted until deasserted */
+  SPI_STAGE_CS,
+  SPI_STAGE_NUM,
+};
+
+struct spi_stage_stat
+{
+  uint32_t count;
+  uint32_t max;
+  uint64_t total;
+};
+
 /**
   * SPI transfer engine structure
   *
@@ -121,36 +249,102 @@ struct spi_xfer_engine
   uint8_t rxq_bound;
   /* Current transmit buffer */
   struct spi_buffer *txbuf;
+  /* Next transmit buffer, dequeued while the current transfer is in progress */
+  struct spi_buffer *next_txbuf;
+#if (SPI_RX_BUF_MODE == SPI_RX_BUF_MODE_RIGHT_SIZED)
+  /* Landing area of the first part of each transaction */
+  uint32_t rx_scratch[(SPI_XFER_MTU_BYTES + SPI_XFER_HEADER_LEN + 3) / sizeof(uint32_t)];
+#endif /* SPI_RX_BUF_MODE */
   /* Transfer statistics */
   struct spi_stat stat;
   spi_rxd_notify_func_t cb[SPI_MSG_CTRL_TRAFFIC_TYPE_MAX];
   void *cb_arg[SPI_MSG_CTRL_TRAFFIC_TYPE_MAX];
+#if (SPI_TRACE_ENABLE == 1)
+  /* Last timestamp of each trace point */
+  uint32_t tp_ts[SPI_TP_NUM + 1];
+  /* Per-stage latency */
+  struct spi_stage_stat stage[SPI_STAGE_NUM];
+#endif /* SPI_TRACE_ENABLE */
 };
 
 static struct spi_xfer_engine xfer_engine = {0};
 #define SPI_BUF_ALIGN_MASK  (0x3)
 
-/* SPI transfer trace points. */
+/* Capacity of the MTU class: a full message including its header. */
+#define SPI_BUF_POOL_MTU_SIZE \
+  ((SPI_XFER_MTU_BYTES + sizeof(struct spi_header) + SPI_BUF_ALIGN_MASK) & ~SPI_BUF_ALIGN_MASK)
+
+#define SPI_BUF_POOL_SLOT_SIZE(cap) \
+  ((sizeof(struct spi_buffer) + (cap) + SPI_BUF_ALIGN_MASK) & ~SPI_BUF_ALIGN_MASK)
+
+#define SPI_BUF_POOL_MEM_WORDS(count, cap) \
+  ((((count) > 0) ? (count) : 1) * SPI_BUF_POOL_SLOT_SIZE(cap) / sizeof(uint32_t))
+
 enum
 {
-  SPI_TP_NONE = 0,
-  SPI_TP_WRITE = 1,
-  SPI_TP_ASSERT_CS = 2,
-  SPI_TP_SLAVE_TXN_RDY = 3,
-  SPI_TP_FIRST_TXN_START = 4,
-  SPI_TP_FIRST_TXN_END = 5,
-  SPI_TP_SECOND_TXN_START = 6,
-  SPI_TP_SECOND_TXN_END = 7,
-  SPI_TP_WAIT_HDR_ACK_START = 8,
-  SPI_TP_HDR_ACKED = 9,
-  SPI_TP_WAIT_HDR_ACK_END = 10,
-  SPI_TP_DEASSERT_CS = 11,
-  SPI_TP_READ = 12,
-  SPI_TP_NUM = 12,
+  SPI_BUF_POOL_SMALL,
+  SPI_BUF_POOL_MTU,
+  SPI_BUF_POOL_NUM,
+};
+
+static uint32_t spi_buf_pool_small_mem[SPI_BUF_POOL_MEM_WORDS(SPI_BUF_POOL_SMALL_COUNT, SPI_BUF_POOL_SMALL_SIZE)];
+static uint32_t spi_buf_pool_mtu_mem[SPI_BUF_POOL_MEM_WORDS(SPI_BUF_POOL_MTU_COUNT, SPI_BUF_POOL_MTU_SIZE)];
+
+/* Ordered by capacity, smallest first. */
+static struct spi_buffer_pool spi_buf_pool[SPI_BUF_POOL_NUM] =
+{
+  [SPI_BUF_POOL_SMALL] = {
+    .mem = (uint8_t *)spi_buf_pool_small_mem,
+    .slot_size = SPI_BUF_POOL_SLOT_SIZE(SPI_BUF_POOL_SMALL_SIZE),
+    .cap = SPI_BUF_POOL_SLOT_SIZE(SPI_BUF_POOL_SMALL_SIZE) - sizeof(struct spi_buffer),
+    .count = SPI_BUF_POOL_SMALL_COUNT,
+  },
+  [SPI_BUF_POOL_MTU] = {
+    .mem = (uint8_t *)spi_buf_pool_mtu_mem,
+    .slot_size = SPI_BUF_POOL_SLOT_SIZE(SPI_BUF_POOL_MTU_SIZE),
+    .cap = SPI_BUF_POOL_SLOT_SIZE(SPI_BUF_POOL_MTU_SIZE) - sizeof(struct spi_buffer),
+    .count = SPI_BUF_POOL_MTU_COUNT,
+  },
 };
 
 static void spi_on_transaction_complete(void);
 
+#if (SPI_TRACE_ENABLE == 1)
+/* Start and end trace points of each stage. */
+static const uint8_t spi_stage_tp[SPI_STAGE_NUM][2] =
+{
+  [SPI_STAGE_TXN_RDY] = {SPI_TP_ASSERT_CS, SPI_TP_FIRST_TXN_START},
+  [SPI_STAGE_FIRST_TXN] = {SPI_TP_FIRST_TXN_START, SPI_TP_FIRST_TXN_END},
+  [SPI_STAGE_SECOND_TXN] = {SPI_TP_SECOND_TXN_START, SPI_TP_SECOND_TXN_END},
+  [SPI_STAGE_HDR_ACK] = {SPI_TP_WAIT_HDR_ACK_START, SPI_TP_WAIT_HDR_ACK_END},
+  [SPI_STAGE_CS] = {SPI_TP_ASSERT_CS, SPI_TP_DEASSERT_CS},
+};
+
+static void spi_trace_point(struct spi_xfer_engine *engine, uint32_t tp)
+{
+  uint32_t ts = SPI_TRACE_TIMESTAMP();
+  uint32_t delta;
+
+  engine->tp_ts[tp] = ts;
+  for (int32_t i = 0; i < SPI_STAGE_NUM; i++)
+  {
+    if (spi_stage_tp[i][1] == tp)
+    {
+      delta = ts - engine->tp_ts[spi_stage_tp[i][0]];
+      engine->stage[i].count++;
+      engine->stage[i].total += delta;
+      if (delta > engine->stage[i].max)
+      {
+        engine->stage[i].max = delta;
+      }
+    }
+  }
+}
+
+#undef spi_trace
+#define spi_trace(tp, ...) spi_trace_point(&xfer_engine, (tp))
+#endif /* SPI_TRACE_ENABLE */
+
 static inline void spi_buffer_set_traffic_type(struct spi_buffer *buf, uint8_t type)
 {
   buf->cb[0] = type;
@@ -222,15 +416,33 @@ static inline void *spi_buffer_pull(struct spi_buffer *buf, uint64_t size)
 struct spi_buffer *spi_buffer_alloc(uint32_t size, uint32_t reserve)
 {
   uint32_t cap;
-  uint32_t extra;
-  struct spi_buffer *buf;
+  struct spi_buffer *buf = NULL;
   int32_t desc_size = sizeof(struct spi_buffer);
 
   cap = (size + reserve + SPI_BUF_ALIGN_MASK) & ~SPI_BUF_ALIGN_MASK;
-  buf = pvPortMalloc(cap + desc_size);
+
+  /* Use the smallest pool class able to hold the buffer. */
+  for (int32_t i = 0; i < SPI_BUF_POOL_NUM; i++)
+  {
+    if ((spi_buf_pool[i].count > 0) && (cap <= spi_buf_pool[i].cap))
+    {
+      buf = (struct spi_buffer *)spi_buffer_pool_get(&spi_buf_pool[i]);
+      if (buf)
+      {
+        cap = spi_buf_pool[i].cap;
+      }
+      break;
+    }
+  }
+
+  /* Fall back on the heap when the class is exhausted or the size is out of range. */
   if (!buf)
   {
-    return NULL;
+    buf = pvPortMalloc(cap + desc_size);
+    if (!buf)
+    {
+      return NULL;
+    }
   }
 
   buf->flags = 0;
@@ -238,15 +450,8 @@ struct spi_buffer *spi_buffer_alloc(uint32_t size, uint32_t reserve)
   buf->cap = cap;
   buf->data = (char *)buf + desc_size + reserve;
   memset(buf->cb, 0, sizeof(buf->cb));
-  /* Fill in the debug pattern. */
-  extra = cap - size - reserve;
-  while (extra)
-  {
-    uint8_t *p = (uint8_t *)buf + desc_size;
-
-    p[cap - extra] = 0x88;
-    extra--;
-  }
+  buf->release = NULL;
+  buf->release_arg = NULL;
   return buf;
 }
 
@@ -257,10 +462,25 @@ struct spi_buffer *spi_tx_buffer_alloc(uint32_t size)
 
 void spi_buffer_free(struct spi_buffer *buf)
 {
-  if (buf)
+  if (!buf)
+  {
+    return;
+  }
+
+  if (buf->release)
+  {
+    buf->release(buf->release_arg);
+  }
+
+  for (int32_t i = 0; i < SPI_BUF_POOL_NUM; i++)
   {
-    vPortFree(buf);
+    if (spi_buffer_pool_put(&spi_buf_pool[i], buf))
+    {
+      return;
+    }
   }
+
+  vPortFree(buf);
 }
 
 /* Get tx buffer from in non-blocking mode. */
@@ -274,10 +494,18 @@ static struct spi_buffer *spi_get_txbuf(struct spi_xfer_engine *engine)
     return engine->txbuf;
   }
 
-  ret = xQueueReceive(engine->txq, &buf, 0);
-  if (ret != pdTRUE)
+  if (engine->next_txbuf)
   {
-    buf = NULL;
+    buf = engine->next_txbuf;
+    engine->next_txbuf = NULL;
+  }
+  else
+  {
+    ret = xQueueReceive(engine->txq, &buf, 0);
+    if (ret != pdTRUE)
+    {
+      buf = NULL;
+    }
   }
 
   engine->txbuf = buf;
@@ -285,10 +513,51 @@ static struct spi_buffer *spi_get_txbuf(struct spi_xfer_engine *engine)
   {
     SPI_STAT_INC(&engine->stat, tx_pkts, 1);
     SPI_STAT_INC(&engine->stat, tx_bytes, buf->len);
+    if (buf->flags & SPI_BUFFER_F_COPIED)
+    {
+      SPI_STAT_INC(&engine->stat, tx_copy_bytes, buf->len - sizeof(struct spi_header));
+    }
+    else if (buf->release)
+    {
+      SPI_STAT_INC(&engine->stat, tx_zero_copy, 1);
+    }
   }
   return buf;
 }
 
+/* Build the master header of a TX buffer. */
+static inline void spi_txbuf_init_header(struct spi_buffer *buf)
+{
+  struct spi_header *pmh = buf->data;
+
+  SPI_HEADER_INIT(pmh, spi_buffer_get_traffic_type(buf), buf->len - sizeof(struct spi_header));
+  buf->flags |= SPI_BUFFER_F_HDR_READY;
+}
+
+/*
+ * Use the time the bus is busy with the current transfer to dequeue the next
+ * TX buffer and build its header, so the next transfer starts as soon as the
+ * slave acknowledges the current one.
+ */
+static void spi_prepare_next(struct spi_xfer_engine *engine)
+{
+#if (SPI_XFER_PIPELINE == 1)
+  if (engine->next_txbuf)
+  {
+    return;
+  }
+
+  if (xQueueReceive(engine->txq, &engine->next_txbuf, 0) != pdTRUE)
+  {
+    engine->next_txbuf = NULL;
+    return;
+  }
+
+  spi_txbuf_init_header(engine->next_txbuf);
+  SPI_STAT_INC(&engine->stat, tx_prepared, 1);
+#endif /* SPI_XFER_PIPELINE */
+}
+
 /* Return 1 if the header is valid. */
 static int32_t inline spi_header_validate(struct spi_header *hdr)
 {
@@ -369,6 +638,7 @@ static int32_t spi_txrx(struct spi_xfer_engine *engine, void *tx_buf, void *rx_b
       SPI_STAT_INC(&engine->stat, io_err, 1);
       return -2;
     }
+    spi_prepare_next(engine);
     /* Wait for spi transaction completion. */
     if (!spi_wait_event(engine, SPI_EVT_HW_XFER_DONE, SPI_WAIT_MSG_XFER_TIMEOUT_MS))
     {
@@ -414,6 +684,7 @@ static int32_t spi_rx(struct spi_xfer_engine *engine, void *rx_buf, uint16_t len
       SPI_STAT_INC(&engine->stat, io_err, 1);
       return -2;
     }
+    spi_prepare_next(engine);
     /* Wait for spi transaction completion. */
     if (!spi_wait_event(engine, SPI_EVT_HW_XFER_DONE, SPI_WAIT_MSG_XFER_TIMEOUT_MS))
     {
@@ -426,6 +697,49 @@ static int32_t spi_rx(struct spi_xfer_engine *engine, void *rx_buf, uint16_t len
   return 0;
 }
 
+/* Queue a received message to the reader bound to its type. */
+static void spi_dispatch_rxbuf(struct spi_xfer_engine *engine, struct spi_buffer *rxbuf, uint8_t msg_type)
+{
+  BaseType_t ret;
+
+  spi_buffer_set_traffic_type(rxbuf, msg_type);
+
+  /*
+   * Note: Thread safety consideration required here.
+   * If a queue is unbound by another thread while we're accessing it,
+   * or if multiple transfers are accessing rxq_bound bitmap concurrently,
+   * race conditions could occur. Consider using appropriate synchronization.
+   */
+
+  /* Select appropriate queue based on type */
+  if (msg_type < SPI_MSG_CTRL_TRAFFIC_TYPE_MAX &&
+      (engine->rxq_bound & (1 << msg_type)))
+  {
+    /* Never wait for room here: a reader blocked on a reply would then stall the bus for every traffic type */
+    ret = xQueueSend(engine->rxq[msg_type], &rxbuf, 0);
+    if (ret != pdTRUE)
+    {
+      spi_trace(SPI_TP_NONE, "type %d rxq full, msg discarded\r\n", msg_type);
+      spi_buffer_free(rxbuf);
+      SPI_STAT_INC(&engine->stat, rx_drop, 1);
+    }
+    else
+    {
+      if (engine->cb[msg_type])
+      {
+        engine->cb[msg_type](engine->cb_arg[msg_type]);
+      }
+    }
+  }
+  else
+  {
+    /* No queue bound for this type, discard message */
+    spi_trace(SPI_TP_NONE, "No queue bound for type %d, msg discarded\r\n", msg_type);
+    spi_buffer_free(rxbuf);
+    SPI_STAT_INC(&engine->stat, rx_drop, 1);
+  }
+}
+
 static int32_t spi_xfer_one(struct spi_xfer_engine *engine, struct spi_buffer *txbuf,
                             int32_t wait_txn_rdy)
 {
@@ -437,6 +751,7 @@ static int32_t spi_xfer_one(struct spi_xfer_engine *engine, struct spi_buffer *t
   struct spi_header *pmh;
   struct spi_header *psh;
   struct spi_buffer *rxbuf = NULL;
+  uint8_t *rxp;
   int32_t rx_restore = 0;
 
   spi_trace(SPI_TP_NONE, "wait_txn_rdy %" PRIi32 "\n", wait_txn_rdy);
@@ -452,6 +767,10 @@ static int32_t spi_xfer_one(struct spi_xfer_engine *engine, struct spi_buffer *t
   /* Re-initialize events in case of pending ones. */
   spi_clear_event(engine, SPI_EVT_HW_XFER_DONE | SPI_EVT_HDR_ACKED);
 
+#if (SPI_RX_BUF_MODE == SPI_RX_BUF_MODE_RIGHT_SIZED)
+  /* The first part lands in the scratch area, the buffer is sized once the slave header is known. */
+  rxp = (uint8_t *)engine->rx_scratch;
+#else
   /* Yes, this allocation will be wasted if there is no data from slave. */
   rxbuf = spi_buffer_alloc(SPI_XFER_MTU_BYTES + sizeof(struct spi_header), 0);
   if (!rxbuf)
@@ -460,6 +779,8 @@ static int32_t spi_xfer_one(struct spi_xfer_engine *engine, struct spi_buffer *t
     SPI_STAT_INC(&engine->stat, mem_err, 1);
     return -1;
   }
+  rxp = rxbuf->data;
+#endif /* SPI_RX_BUF_MODE */
 
   spi_trace(SPI_TP_FIRST_TXN_START, "start the first transaction\n");
   if (txbuf)
@@ -473,8 +794,11 @@ static int32_t spi_xfer_one(struct spi_xfer_engine *engine, struct spi_buffer *t
 
       msglen = txbuf->len - sizeof(struct spi_header);
 
-      /* Initialize master header. */
-      SPI_HEADER_INIT(pmh, type, msglen);
+      /* Initialize master header, unless prepared while the previous transfer was running. */
+      if (!(txbuf->flags & SPI_BUFFER_F_HDR_READY))
+      {
+        SPI_HEADER_INIT(pmh, type, msglen);
+      }
       txp = txbuf->data;
       xfer_size = (txbuf->len + SPI_BUF_ALIGN_MASK) & ~SPI_BUF_ALIGN_MASK;
     }
@@ -493,13 +817,13 @@ static int32_t spi_xfer_one(struct spi_xfer_engine *engine, struct spi_buffer *t
     xfer_size = sizeof(struct spi_header);
   }
 
-  if (spi_txrx(engine, txp, rxbuf->data, xfer_size))
+  if (spi_txrx(engine, txp, rxp, xfer_size))
   {
     spi_err("Failed to do the first transaction\n");
     goto out;
   }
 
-  psh = rxbuf->data;
+  psh = (struct spi_header *)rxp;
   spi_trace(SPI_TP_FIRST_TXN_END,
             "slave spi header, magic 0x%" PRIx16 ", len (%" PRIu16 ", 0x%" PRIx16 "), version %" PRIu16
             ", type %" PRIx16 ", flags 0x%" PRIx16 ", rsvd 0x%" PRIx16 "\n",
@@ -528,16 +852,45 @@ static int32_t spi_xfer_one(struct spi_xfer_engine *engine, struct spi_buffer *t
   }
   engine->rx_stall = psh->rx_stall;
 
+#if (SPI_RX_BUF_MODE == SPI_RX_BUF_MODE_RIGHT_SIZED)
+  if (psh->len)
+  {
+    /* Payload bytes already clocked in with the master message. */
+    uint16_t received = xfer_size - sizeof(struct spi_header);
+
+    if (received > psh->len)
+    {
+      received = psh->len;
+    }
+
+    rxbuf = spi_buffer_alloc(psh->len, 0);
+    if (rxbuf)
+    {
+      spi_port_memcpy(rxbuf->data, rxp + sizeof(struct spi_header), received);
+      SPI_STAT_INC(&engine->stat, rx_copy_bytes, received);
+      rxp = (uint8_t *)rxbuf->data + received;
+    }
+    else
+    {
+      /* Still clock the payload out of the slave to keep the link in sync. */
+      spi_err("No mem for rxbuf\n");
+      SPI_STAT_INC(&engine->stat, mem_err, 1);
+      SPI_STAT_INC(&engine->stat, rx_drop, 1);
+      rxp += xfer_size;
+    }
+  }
+#else
+  rxp += xfer_size;
+#endif /* SPI_RX_BUF_MODE */
+
   /* Receive the remaining data from slave if any. */
   if (psh->len + sizeof(struct spi_header) > xfer_size)
   {
-    uint8_t *rxp = (uint8_t *)rxbuf->data;
     uint16_t remain = psh->len + sizeof(struct spi_header) - xfer_size;
 
     spi_trace(SPI_TP_SECOND_TXN_START, "Receiving remaining data\n");
     engine->state = SPI_XFER_STATE_SECOND_PART;
     remain = (remain + SPI_BUF_ALIGN_MASK) & ~SPI_BUF_ALIGN_MASK;
-    rxp += xfer_size;
     if (spi_rx(engine, rxp, remain))
     {
       spi_err("Failed to receive the remaining bytes\n");
@@ -560,63 +913,37 @@ static int32_t spi_xfer_one(struct spi_xfer_engine *engine, struct spi_buffer *t
   {
     SPI_STAT_INC(&engine->stat, rx_pkts, 1);
     SPI_STAT_INC(&engine->stat, rx_bytes, psh->len);
+#if (SPI_RX_BUF_MODE == SPI_RX_BUF_MODE_RIGHT_SIZED)
+    if (rxbuf)
+    {
+      spi_dispatch_rxbuf(engine, rxbuf, psh->type);
+    }
+#else
     spi_buffer_pull(rxbuf, sizeof(struct spi_header));
     /* Rx buffer length fix-up */
     rxbuf->len = psh->len;
-    /* Get message type from header and store in buffer's control block */
-    uint8_t msg_type = psh->type;
-    spi_buffer_set_traffic_type(rxbuf, msg_type);
-
-    /*
-     * Note: Thread safety consideration required here.
-     * If a queue is unbound by another thread while we're accessing it,
-     * or if multiple transfers are accessing rxq_bound bitmap concurrently,
-     * race conditions could occur. Consider using appropriate synchronization.
-     */
-
-    /* Select appropriate queue based on type */
-    if (msg_type < SPI_MSG_CTRL_TRAFFIC_TYPE_MAX &&
-        (engine->rxq_bound & (1 << msg_type)))
-    {
-      if (psh->len < 256)
-      {
-        struct spi_buffer *rxbuf_resized = spi_buffer_alloc(psh->len, 0);
-        if (!rxbuf_resized)
-        {
-          spi_err("No mem for rxbuf\n");
-          SPI_STAT_INC(&engine->stat, mem_err, 1);
-        }
-        else
-        {
-          rxbuf_resized->flags = rxbuf->flags;
-          spi_port_memcpy(rxbuf_resized->data, rxbuf->data, psh->len);
-          spi_buffer_free(rxbuf);
-          rxbuf = rxbuf_resized;
-        }
-      }
 
-      ret = xQueueSend(engine->rxq[msg_type], &rxbuf, portMAX_DELAY);
-      if (ret != pdTRUE)
+    /* Right-size short messages so they do not hold an MTU buffer while queued */
+    if (psh->len < SPI_RX_SHORT_COPY_THRESHOLD)
+    {
+      struct spi_buffer *rxbuf_resized = spi_buffer_alloc(psh->len, 0);
+      if (!rxbuf_resized)
       {
-        spi_trace(SPI_TP_NONE, "failed to send to type %d rxq, msg discarded\r\n", msg_type);
-        spi_buffer_free(rxbuf);
-        SPI_STAT_INC(&engine->stat, rx_drop, 1);
+        spi_err("No mem for rxbuf\n");
+        SPI_STAT_INC(&engine->stat, mem_err, 1);
       }
       else
       {
-        if (engine->cb[msg_type])
-        {
-          engine->cb[msg_type](engine->cb_arg[msg_type]);
-        }
+        rxbuf_resized->flags = rxbuf->flags;
+        spi_port_memcpy(rxbuf_resized->data, rxbuf->data, psh->len);
+        SPI_STAT_INC(&engine->stat, rx_copy_bytes, psh->len);
+        spi_buffer_free(rxbuf);
+        rxbuf = rxbuf_resized;
       }
     }
-    else
-    {
-      /* No queue bound for this type, discard message */
-      spi_trace(SPI_TP_NONE, "No queue bound for type %d, msg discarded\r\n", msg_type);
-      spi_buffer_free(rxbuf);
-      SPI_STAT_INC(&engine->stat, rx_drop, 1);
-    }
+
+    spi_dispatch_rxbuf(engine, rxbuf, psh->type);
+#endif /* SPI_RX_BUF_MODE */
   }
   else if (rxbuf)
   {
@@ -625,6 +952,7 @@ static int32_t spi_xfer_one(struct spi_xfer_engine *engine, struct spi_buffer *t
 
   /* Wait until slave acknowledged header. */
   spi_trace(SPI_TP_WAIT_HDR_ACK_START, "waiting for header ack\n");
+  spi_prepare_next(engine);
   while (!spi_wait_event(engine, SPI_EVT_HDR_ACKED, SPI_WAIT_HDR_ACK_TIMEOUT_MS))
   {
     if (!spi_port_is_ready())
@@ -748,6 +1076,12 @@ int32_t spi_transaction_init(void)
 
   spi_port_init(spi_on_transaction_complete);
 
+#if (SPI_TRACE_ENABLE == 1) && defined(SPI_TRACE_DWT)
+  /* Start the cycle counter used to timestamp the trace points */
+  SPI_DEMCR |= SPI_DEMCR_TRCENA;
+  SPI_DWT_CTRL |= SPI_DWT_CTRL_CYCCNTENA;
+#endif /* SPI_TRACE_ENABLE && SPI_TRACE_DWT */
+
   /* Create SPI transfer engine task */
   xfer_engine.stop = 0;
   xTaskCreate(spi_xfer_engine_task, "spi_xfer_engine", SPI_THREAD_STACK_SIZE >> 2,
@@ -796,6 +1130,12 @@ int32_t spi_transaction_deinit(void)
     xfer_engine.task = NULL;
   }
 
+  if (xfer_engine.next_txbuf)
+  {
+    spi_buffer_free(xfer_engine.next_txbuf);
+    xfer_engine.next_txbuf = NULL;
+  }
+
   /* Clean up resources in case of error */
   if (xfer_engine.txq)
   {
@@ -1022,6 +1362,7 @@ int32_t spi_write(struct spi_msg *msg, int32_t timeout_ms)
 
       data_len = msg->data_len;
       spi_port_memcpy(buf->data, msg->data, msg->data_len);
+      buf->flags |= SPI_BUFFER_F_COPIED;
       break;
 
     case SPI_MSG_OP_BUFFER:
@@ -1079,6 +1420,142 @@ int32_t spi_write(struct spi_msg *msg, int32_t timeout_ms)
   return data_len;
 }
 
+/**
+  * Write a message gathered from several segments to the SPI interface
+  *
+  * The segments are sent as a single framed message. When the message is a
+  * single 4-byte aligned segment, SPI_MSG_F_HEADROOM is set in msg->flags and
+  * msg->release is provided, the header is written in front of the segment and
+  * the data is transferred without copy: msg->release is then called from the
+  * transfer task once the data is no longer referenced. Otherwise the segments
+  * are copied into one SPI buffer and msg->release is called before returning.
+  * msg->release is never called when an error is returned.
+  *
+  * @param msg:        Message carrying the traffic type control and release callback
+  * @param iov:        Segments to send
+  * @param iovcnt:     Number of segments
+  * @param timeout_ms: Timeout for queue operations in milliseconds (-1 for infinite)
+  * @return            Number of bytes written or negative error code
+  */
+int32_t spi_writev(struct spi_msg *msg, const struct spi_iovec *iov, uint32_t iovcnt, int32_t timeout_ms)
+{
+  BaseType_t ret;
+  struct spi_buffer *buf;
+  TickType_t ticks;
+  uint8_t traffic_type = SPI_MSG_CTRL_TRAFFIC_AT_CMD;
+  uint32_t data_len = 0;
+  int32_t zero_copy;
+  uint8_t *p;
+
+  if (!msg || !iov || !iovcnt)
+  {
+    return -1;
+  }
+
+  if (!xfer_engine.initialized)
+  {
+    spi_err("SPI transaction is NOT initialized!\r\n");
+    return -2;
+  }
+
+  /* Process control information if present */
+  if (msg->ctrl)
+  {
+    /* Check for traffic type control information */
+    if (msg->ctrl->type == SPI_MSG_CTRL_TRAFFIC_TYPE)
+    {
+      /* Validate control data length */
+      if (msg->ctrl->len == SPI_MSG_CTRL_TRAFFIC_TYPE_LEN && msg->ctrl->val)
+      {
+        /* Extract traffic type */
+        traffic_type = *((uint8_t *)msg->ctrl->val);
+      }
+      else
+      {
+        spi_err("Invalid traffic type control info\r\n");
+      }
+    }
+    /* Additional control types can be handled here in the future */
+  }
+
+  for (uint32_t i = 0; i < iovcnt; i++)
+  {
+    data_len += iov[i].len;
+  }
+
+  if (!data_len || (data_len > SPI_XFER_MTU_BYTES))
+  {
+    return -1;
+  }
+
+  zero_copy = (iovcnt == 1) && (msg->flags & SPI_MSG_F_HEADROOM) && msg->release &&
+              !((uintptr_t)iov[0].base & SPI_BUF_ALIGN_MASK);
+  if (zero_copy)
+  {
+    /* Only a descriptor is needed, the header goes in the caller's headroom. */
+    spi_trace(SPI_TP_WRITE, "spi_writev zero-copy mode\r\n");
+    buf = spi_buffer_alloc(0, 0);
+    if (!buf)
+    {
+      return -3;
+    }
+
+    buf->data = (uint8_t *)iov[0].base - sizeof(struct spi_header);
+    buf->len = data_len + sizeof(struct spi_header);
+  }
+  else
+  {
+    spi_trace(SPI_TP_WRITE, "spi_writev gather mode\r\n");
+    buf = spi_buffer_alloc(data_len, sizeof(struct spi_header));
+    if (!buf)
+    {
+      return -3;
+    }
+
+    p = buf->data;
+    for (uint32_t i = 0; i < iovcnt; i++)
+    {
+      spi_port_memcpy(p, iov[i].base, iov[i].len);
+      p += iov[i].len;
+    }
+    buf->flags |= SPI_BUFFER_F_COPIED;
+    spi_buffer_push(buf, sizeof(struct spi_header));
+  }
+
+  spi_buffer_set_traffic_type(buf, traffic_type);
+  if (zero_copy)
+  {
+    /* Ownership moves to the transfer engine, released by spi_buffer_free. */
+    buf->release = msg->release;
+    buf->release_arg = msg->release_arg;
+  }
+
+  if (timeout_ms < 0)
+  {
+    ticks = portMAX_DELAY;
+  }
+  else
+    ticks = pdMS_TO_TICKS(timeout_ms);
+
+  ret = xQueueSend(xfer_engine.txq, &buf, ticks);
+  if (ret != pdTRUE)
+  {
+    /* The caller keeps ownership of its data on error. */
+    buf->release = NULL;
+    spi_buffer_free(buf);
+    return -5;
+  }
+
+  if (!zero_copy && msg->release)
+  {
+    msg->release(msg->release_arg);
+  }
+
+  xEventGroupSetBits(xfer_engine.event, SPI_EVT_TXN_PENDING);
+
+  return data_len;
+}
+
 /**
   * Bind a specific traffic type to a dedicated receive queue
   *
@@ -1132,6 +1609,20 @@ int32_t spi_bind(unsigned char type, int32_t rxq_size)
   return 0;
 }
 
+/* Pool counters live outside the engine so buffers stay usable across deinit. */
+static void spi_pool_fill_stats(struct spi_stat *stat)
+{
+  struct spi_buffer_pool *small = &spi_buf_pool[SPI_BUF_POOL_SMALL];
+  struct spi_buffer_pool *mtu = &spi_buf_pool[SPI_BUF_POOL_MTU];
+
+  stat->pool_small_in_use = atomic_load_explicit(&small->in_use, memory_order_relaxed);
+  stat->pool_small_hwm = atomic_load_explicit(&small->hwm, memory_order_relaxed);
+  stat->pool_small_alloc_fail = atomic_load_explicit(&small->alloc_fail, memory_order_relaxed);
+  stat->pool_mtu_in_use = atomic_load_explicit(&mtu->in_use, memory_order_relaxed);
+  stat->pool_mtu_hwm = atomic_load_explicit(&mtu->hwm, memory_order_relaxed);
+  stat->pool_mtu_alloc_fail = atomic_load_explicit(&mtu->alloc_fail, memory_order_relaxed);
+}
+
 int32_t spi_get_stats(struct spi_stat *stat)
 {
   if (!stat)
@@ -1140,6 +1631,7 @@ int32_t spi_get_stats(struct spi_stat *stat)
   }
 
   *stat = xfer_engine.stat;
+  spi_pool_fill_stats(stat);
   return 0;
 }
 
@@ -1262,11 +1754,23 @@ static void spi_show_stat(struct spi_stat *stat)
   num2string64(count_ui64, STR64BIT_DIGIT, stat->tx_bytes);
   LogInfo("TX                    %-10s bytes\n", count_ui64);
 
+  num2string64(count_ui64, STR64BIT_DIGIT, stat->tx_zero_copy);
+  LogInfo("TX zero-copy          %-10s pkts\n", count_ui64);
+  num2string64(count_ui64, STR64BIT_DIGIT, stat->tx_copy_bytes);
+  LogInfo("TX copied             %-10s bytes\n", count_ui64);
+
+  num2string64(count_ui64, STR64BIT_DIGIT, stat->tx_prepared);
+  LogInfo("TX prepared ahead     %-10s pkts\n", count_ui64);
+
   num2string64(count_ui64, STR64BIT_DIGIT, stat->rx_pkts);
   LogInfo("RX                    %-10s pkts\n", count_ui64);
   num2string64(count_ui64, STR64BIT_DIGIT, stat->rx_bytes);
   LogInfo("RX                    %-10s bytes\n", count_ui64);
 
+  num2string64(count_ui64, STR64BIT_DIGIT, stat->rx_copy_bytes);
+  LogInfo("RX copied             %-10s bytes (%" PRIu32 " per 1000 received)\n", count_ui64,
+          (uint32_t)(stat->rx_bytes ? (stat->rx_copy_bytes * 1000) / stat->rx_bytes : 0));
+
   num2string64(count_ui64, STR64BIT_DIGIT, stat->rx_drop);
   LogInfo("drop                  %s\n", count_ui64);
   num2string64(count_ui64, STR64BIT_DIGIT, stat->mem_err);
@@ -1282,10 +1786,42 @@ static void spi_show_stat(struct spi_stat *stat)
   LogInfo("wait_txn_timeout      %s\n", count_ui64);
   num2string64(count_ui64, STR64BIT_DIGIT, stat->wait_hdr_ack_timeouts);
   LogInfo("wait_hdr_ack_timeout  %s\n", count_ui64);
+
+  LogInfo("small pool            %" PRIu32 "/%" PRIu32 " in use, hwm %" PRIu32 ", alloc_fail %" PRIu32 "\n",
+          (uint32_t)stat->pool_small_in_use, (uint32_t)SPI_BUF_POOL_SMALL_COUNT,
+          (uint32_t)stat->pool_small_hwm, (uint32_t)stat->pool_small_alloc_fail);
+  LogInfo("MTU pool              %" PRIu32 "/%" PRIu32 " in use, hwm %" PRIu32 ", alloc_fail %" PRIu32 "\n",
+          (uint32_t)stat->pool_mtu_in_use, (uint32_t)SPI_BUF_POOL_MTU_COUNT,
+          (uint32_t)stat->pool_mtu_hwm, (uint32_t)stat->pool_mtu_alloc_fail);
 }
 
+#if (SPI_TRACE_ENABLE == 1)
+static const char *spi_stage_str[] =
+{
+  [SPI_STAGE_TXN_RDY] = "wait txn ready",
+  [SPI_STAGE_FIRST_TXN] = "first part",
+  [SPI_STAGE_SECOND_TXN] = "second part",
+  [SPI_STAGE_HDR_ACK] = "wait header ack",
+  [SPI_STAGE_CS] = "chip select",
+};
+
+static void spi_show_stages(struct spi_xfer_engine *engine)
+{
+  for (int32_t i = 0; i < SPI_STAGE_NUM; i++)
+  {
+    struct spi_stage_stat *st = &engine->stage[i];
+    uint32_t avg_us = st->count ? (uint32_t)((st->total * 1000000ULL) / ((uint64_t)st->count * SPI_TRACE_TIMESTAMP_HZ)) : 0;
+    uint32_t max_us = (uint32_t)(((uint64_t)st->max * 1000000ULL) / SPI_TRACE_TIMESTAMP_HZ);
+
+    LogInfo("%-21s %" PRIu32 " times, avg %" PRIu32 " us, max %" PRIu32 " us\n",
+            spi_stage_str[i], st->count, avg_us, max_us);
+  }
+}
+#endif /* SPI_TRACE_ENABLE */
+
 void spi_dump(void)
 {
+  struct spi_stat stat;
   EventBits_t bits;
   char pending_events[64] = {0};
   uint32_t pos = 0;
@@ -1315,7 +1851,11 @@ void spi_dump(void)
 
   LogInfo("Slave data ready pin  %s\n", spi_port_is_ready() == 1 ? "High" : "Low");
 
-  spi_show_stat(&xfer_engine.stat);
+  spi_get_stats(&stat);
+  spi_show_stat(&stat);
+#if (SPI_TRACE_ENABLE == 1)
+  spi_show_stages(&xfer_engine);
+#endif /* SPI_TRACE_ENABLE */
   LogInfo("TX queue items        %" PRIu32 "\n", uxQueueMessagesWaiting(xfer_engine.txq));
 
   for (int32_t i = 0; i < SPI_MSG_CTRL_TRAFFIC_TYPE_MAX; i++)
@@ -1327,3 +1867,63 @@ void spi_dump(void)
     }
   }
 }
+
+/**
+  * Measure the SPI goodput over the traffic running during the given period
+  *
+  * Goodput counts the payload bytes moved in both directions, SPI headers
+  * excluded. It is reported against the line rate of one direction, i.e. the
+  * SPI clock, so a link busy in both directions can exceed 100%.
+  *
+  * @param duration_ms: Measurement period in milliseconds
+  * @param clock_hz:    SPI clock frequency, 0 to use SPI_XFER_CLOCK_HZ
+  */
+void spi_perf(uint32_t duration_ms, uint32_t clock_hz)
+{
+  struct spi_stat start;
+  struct spi_stat end;
+  TickType_t t0;
+  uint32_t elapsed_ms;
+  uint64_t tx_payload;
+  uint64_t rx_payload;
+  uint64_t goodput_bps;
+
+  if (!xfer_engine.initialized)
+  {
+    spi_err("spi transaction is NOT initialized!\n");
+    return;
+  }
+
+  if (clock_hz == 0)
+  {
+    clock_hz = SPI_XFER_CLOCK_HZ;
+  }
+
+  spi_get_stats(&start);
+  t0 = xTaskGetTickCount();
+  vTaskDelay(pdMS_TO_TICKS(duration_ms));
+  spi_get_stats(&end);
+  elapsed_ms = (uint32_t)(((uint64_t)(xTaskGetTickCount() - t0) * 1000) / configTICK_RATE_HZ);
+  if (elapsed_ms == 0)
+  {
+    return;
+  }
+
+  tx_payload = (end.tx_bytes - start.tx_bytes) - (end.tx_pkts - start.tx_pkts) * sizeof(struct spi_header);
+  rx_payload = end.rx_bytes - start.rx_bytes;
+  goodput_bps = ((tx_payload + rx_payload) * 8 * 1000) / elapsed_ms;
+  (void)goodput_bps; /* Only read by the logs, which can be compiled out */
+
+  LogInfo("Duration              %" PRIu32 " ms\n", elapsed_ms);
+  LogInfo("TX payload            %" PRIu32 " bytes, %" PRIu32 " pkts\n",
+          (uint32_t)tx_payload, (uint32_t)(end.tx_pkts - start.tx_pkts));
+  LogInfo("RX payload            %" PRIu32 " bytes, %" PRIu32 " pkts\n",
+          (uint32_t)rx_payload, (uint32_t)(end.rx_pkts - start.rx_pkts));
+  LogInfo("Goodput               %" PRIu32 " kbit/s\n", (uint32_t)(goodput_bps / 1000));
+  if (clock_hz)
+  {
+    LogInfo("Line rate usage       %" PRIu32 ".%" PRIu32 " %% of %" PRIu32 " kbit/s\n",
+            (uint32_t)((goodput_bps * 100) / clock_hz), (uint32_t)(((goodput_bps * 1000) / clock_hz) % 10),
+            clock_hz / 1000);
+  }
+}
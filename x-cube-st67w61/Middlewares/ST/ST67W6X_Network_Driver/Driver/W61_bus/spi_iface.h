@@ -32,6 +32,9 @@ extern "C" {
 
 /* Includes ------------------------------------------------------------------*/
 /* Exported types ------------------------------------------------------------*/
+/* Called once a zero-copy write no longer references the caller's data. */
+typedef void (*spi_buffer_release_func_t)(void *arg);
+
 struct spi_msg_control
 {
   /* Ref SPI_MSG_CTRL_xxx */
@@ -55,6 +58,12 @@ struct spi_msg
     struct spi_buffer *buffer;
     /* For spi_read_buffer */
     struct spi_buffer **buffer_ptr;
+    /* For spi_writev. */
+    struct
+    {
+      spi_buffer_release_func_t release;
+      void *release_arg;
+    };
   };
   struct spi_msg_control *ctrl;
   uint32_t flags;
@@ -75,6 +84,21 @@ struct spi_stat
   uint64_t wait_hdr_ack_timeouts;
   uint64_t mem_err;
   uint64_t rx_stall;
+  /* TX messages sent straight from the caller's memory. */
+  uint64_t tx_zero_copy;
+  /* TX payload bytes copied into an SPI buffer. */
+  uint64_t tx_copy_bytes;
+  /* RX payload bytes copied between buffers by the transfer engine. */
+  uint64_t rx_copy_bytes;
+  /* TX buffers prepared while the previous transfer was in progress. */
+  uint64_t tx_prepared;
+  /* SPI buffer pool usage, filled by spi_get_stats. */
+  uint32_t pool_small_in_use;
+  uint32_t pool_small_hwm;
+  uint32_t pool_small_alloc_fail;
+  uint32_t pool_mtu_in_use;
+  uint32_t pool_mtu_hwm;
+  uint32_t pool_mtu_alloc_fail;
 };
 
 struct spi_buffer
@@ -87,6 +111,15 @@ struct spi_buffer
   uint32_t flags;
   /* Control block for private data. */
   unsigned char cb[16];
+  /* Owner of external data, called when the buffer is freed. */
+  spi_buffer_release_func_t release;
+  void *release_arg;
+};
+
+struct spi_iovec
+{
+  void *base;
+  uint32_t len;
 };
 
 typedef void (*spi_rxd_notify_func_t)(void *arg);
@@ -98,11 +131,30 @@ typedef enum
   SPI_MSG_CTRL_TRAFFIC_NETWORK_AP,
   SPI_MSG_CTRL_TRAFFIC_HCI,
   SPI_MSG_CTRL_TRAFFIC_OT,
+  /* Socket payloads framed with struct spi_sock_data_hdr, sockets are controlled over AT. */
+  SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA,
   SPI_MSG_CTRL_TRAFFIC_TYPE_MAX,
 } spi_msg_ctrl_t;
 
+/* Header in front of the payload of a SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA message. */
+struct spi_sock_data_hdr
+{
+  /* NCP connection number. */
+  uint8_t sock;
+  uint8_t rsvd0;
+  /* Length of the socket data following the header. */
+  uint16_t len;
+  /* Remote peer: source on receive, destination of unconnected UDP sends. IP bytes in network order. */
+  uint8_t remote_ip[4];
+  uint16_t remote_port;
+  /* Host to NCP: messages of the connection consumed by the host, returned to the NCP receive window. */
+  uint16_t credit;
+};
+
 /* Exported constants --------------------------------------------------------*/
 #define SPI_MSG_F_TRUNCATED            0x1
+/* spi_writev: the first segment has SPI_XFER_HEADER_LEN writable bytes in front of it. */
+#define SPI_MSG_F_HEADROOM             0x2
 
 #define SPI_MSG_CTRL_TRAFFIC_TYPE      0x1
 #define SPI_MSG_CTRL_TRAFFIC_TYPE_LEN  1
@@ -114,6 +166,9 @@ typedef enum
 /** Maximum SPI buffer size */
 #define SPI_XFER_MTU_BYTES             W61_MAX_SPI_XFER
 
+/** Size of the header prepended to each SPI message */
+#define SPI_XFER_HEADER_LEN            8
+
 /* Exported macro ------------------------------------------------------------*/
 #define SPI_MSG_CONTROL_INIT(c, t, l, v) do {                                    \
                                               struct spi_msg_control *_c = &(c); \
@@ -156,6 +211,8 @@ int32_t spi_read(struct spi_msg *msg, int32_t timeout_ms);
 
 int32_t spi_write(struct spi_msg *msg, int32_t timeout_ms);
 
+int32_t spi_writev(struct spi_msg *msg, const struct spi_iovec *iov, uint32_t iovcnt, int32_t timeout_ms);
+
 int32_t spi_rxd_callback_register(spi_msg_ctrl_t type, spi_rxd_notify_func_t cb, void *arg);
 
 void spi_show_throuput_enable(int32_t en);
@@ -168,6 +225,8 @@ int32_t spi_on_header_ack(void);
 
 void spi_dump(void);
 
+void spi_perf(uint32_t duration_ms, uint32_t clock_hz);
+
 int32_t spi_get_stats(struct spi_stat *stat);
 
 #ifdef __cplusplus
@@ -0,0 +1,843 @@
+/**
+  ******************************************************************************
+  * @file    spi_port_sim.c
+  * @brief   Simulated NCP behind the SPI bus porting layer
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/**
+  * This file replaces the project spi_port.c when SPI_PORT_SIM_ENABLE is set.
+  * It emulates the NCP side of the SPI link: the 0x55AA header exchange, the
+  * RDY line edges and a scripted subset of the AT command set, so that the
+  * driver stack can be exercised without a module, e.g. on a FreeRTOS port
+  * running on a host.
+  *
+  * Scripted commands:
+  *  - "ready" is sent SPI_PORT_SIM_BOOT_TIME_MS after init
+  *  - AT+CWJAP=...          : +CW:CONNECTED, +CW:GOTIP, OK
+  *  - AT+CIPSTART=<id>,...  : +CIP:<id>,CONNECTED, OK
+  *  - AT+CIPCLOSE=<id>      : +CIP:<id>,DISCONNECTED, OK
+  *  - AT+CIPSEND=<id>,<len> : OK, '>', then after <len> data bytes "Recv <len> bytes", SEND OK.
+  *                            The data is looped back to the socket and announced with +IPD
+  *  - AT+CIPRECVDATA=<id>,<len> : +CIPRECVDATA:<n>,<data>, OK
+  *  - AT+CIPDATACHAN=<0|1>[,<window>] : OK. When set, looped back data is pushed in
+  *                            SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA messages instead of being announced with +IPD.
+  *                            At most <window> messages per socket are pushed ahead of the credits returned
+  *                            by the host, no limit when omitted or 0
+  *  - any other AT command  : OK
+  * SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA messages are looped back to their socket like AT+CIPSEND data.
+  * Other traffic types are discarded unless handled by the hook set with spi_port_sim_set_handler.
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+#include "semphr.h"
+
+/* For redefinitions purposes */
+#include "w61_default_config.h"
+
+#include "spi_iface.h"
+#include "spi_port.h"
+#include "spi_port_sim.h"
+
+#ifndef SPI_PORT_SIM_ENABLE
+/** Enable the simulated NCP, the project spi_port.c must then be removed from the build */
+#define SPI_PORT_SIM_ENABLE         0
+#endif /* SPI_PORT_SIM_ENABLE */
+
+#if (SPI_PORT_SIM_ENABLE == 1)
+
+/* Private defines -----------------------------------------------------------*/
+#ifndef SPI_PORT_SIM_THREAD_STACK_SIZE
+/** Simulated NCP thread stack size */
+#define SPI_PORT_SIM_THREAD_STACK_SIZE  1024
+#endif /* SPI_PORT_SIM_THREAD_STACK_SIZE */
+
+#ifndef SPI_PORT_SIM_THREAD_PRIO
+/** Simulated NCP thread priority */
+#define SPI_PORT_SIM_THREAD_PRIO        52
+#endif /* SPI_PORT_SIM_THREAD_PRIO */
+
+#ifndef SPI_PORT_SIM_QUEUE_LEN
+/** Depth of the simulated NCP message queues */
+#define SPI_PORT_SIM_QUEUE_LEN          16
+#endif /* SPI_PORT_SIM_QUEUE_LEN */
+
+#ifndef SPI_PORT_SIM_SOCKETS
+/** Number of sockets emulated by the simulated NCP */
+#define SPI_PORT_SIM_SOCKETS            5
+#endif /* SPI_PORT_SIM_SOCKETS */
+
+#ifndef SPI_PORT_SIM_SOCK_BUF_SIZE
+/** Loopback buffer size of each emulated socket */
+#define SPI_PORT_SIM_SOCK_BUF_SIZE      4096
+#endif /* SPI_PORT_SIM_SOCK_BUF_SIZE */
+
+#ifndef SPI_PORT_SIM_BOOT_TIME_MS
+/** Delay before the simulated NCP sends "ready", letting the host bind its traffic queues */
+#define SPI_PORT_SIM_BOOT_TIME_MS       20
+#endif /* SPI_PORT_SIM_BOOT_TIME_MS */
+
+#define SPI_PORT_SIM_HEADER_MAGIC       0x55AA
+#define SPI_PORT_SIM_HEADER_LEN         8
+#define SPI_PORT_SIM_FRAME_SIZE         (SPI_XFER_MTU_BYTES + SPI_PORT_SIM_HEADER_LEN + 4)
+#define SPI_PORT_SIM_LINE_SIZE          256
+
+/** Room kept for "+CIPRECVDATA:<len>," in front of the socket data */
+#define SPI_PORT_SIM_RECVDATA_HDR_LEN   20
+
+/* Private typedef -----------------------------------------------------------*/
+/* Same layout as the spi_iface.c header. */
+struct spi_port_sim_header
+{
+  uint16_t magic;
+  uint16_t len;
+  uint8_t version : 2;
+  uint8_t rx_stall : 1;
+  uint8_t flags : 5;
+  uint8_t type;
+  uint16_t rsvd;
+} __attribute__((packed));
+
+_Static_assert(sizeof(struct spi_port_sim_header) == SPI_PORT_SIM_HEADER_LEN, "Simulated SPI header size mismatch");
+
+struct spi_port_sim_msg
+{
+  uint8_t type;
+  uint16_t len;
+  uint8_t data[];
+};
+
+struct spi_port_sim_socket
+{
+  uint32_t len;
+  uint16_t remote_port;
+  char remote_ip[16];
+  /* Messages that may still be pushed to the host, when the data channel has a window. */
+  uint32_t credit;
+  uint8_t data[SPI_PORT_SIM_SOCK_BUF_SIZE];
+};
+
+struct spi_port_sim
+{
+  TaskHandle_t task;
+  SemaphoreHandle_t stopped;
+  /* Frames from the host, consumed by the simulated NCP task. */
+  QueueHandle_t inq;
+  /* Messages to the host, consumed by the transactions. */
+  QueueHandle_t outq;
+  spi_transaction_complete_t transaction_complete_cb;
+  spi_port_sim_handler_t handler;
+  void *handler_arg;
+
+  volatile int32_t rdy;
+  volatile int32_t cs;
+
+  /* Current transaction. */
+  uint32_t clocked;
+  uint32_t out_len;
+  uint32_t in_len;
+  int32_t acked;
+  uint32_t out_frame[SPI_PORT_SIM_FRAME_SIZE / sizeof(uint32_t) + 1];
+  uint32_t in_frame[SPI_PORT_SIM_FRAME_SIZE / sizeof(uint32_t) + 1];
+
+  /* AT command state, owned by the simulated NCP task. */
+  char line[SPI_PORT_SIM_LINE_SIZE];
+  uint32_t line_len;
+  int32_t send_sock;
+  uint32_t send_remain;
+  uint32_t send_len;
+  /* Set by AT+CIPDATACHAN=1, socket data then goes in SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA messages. */
+  int32_t data_chan;
+  /* Receive window of each socket set by AT+CIPDATACHAN, 0 for none. */
+  uint32_t window;
+  struct spi_port_sim_socket sock[SPI_PORT_SIM_SOCKETS];
+
+  struct spi_port_sim_stat stat;
+};
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_port_sim sim;
+
+/* Private function prototypes -----------------------------------------------*/
+static void spi_port_sim_raise_rdy(void);
+static void spi_port_sim_check_ack(void);
+static void spi_port_sim_clock(const uint8_t *tx_buf, uint8_t *rx_buf, uint16_t len);
+static void spi_port_sim_printf(const char *fmt, ...);
+static void spi_port_sim_recvdata(uint32_t id, uint32_t req_len);
+static void spi_port_sim_sock_ready(uint32_t id);
+static void spi_port_sim_sock_input(const uint8_t *data, uint32_t len);
+static void spi_port_sim_at_line(char *line, uint32_t len);
+static void spi_port_sim_at_input(const uint8_t *data, uint32_t len);
+static void spi_port_sim_task(void *arg);
+
+/* Functions Definition ------------------------------------------------------*/
+void *spi_port_memcpy(void *dest, const void *src, unsigned int len)
+{
+  return memcpy(dest, src, len);
+}
+
+int32_t spi_port_init(spi_transaction_complete_t transaction_complete_cb)
+{
+  memset(&sim, 0, sizeof(sim));
+  sim.send_sock = -1;
+  sim.transaction_complete_cb = transaction_complete_cb;
+
+  sim.inq = xQueueCreate(SPI_PORT_SIM_QUEUE_LEN, sizeof(void *));
+  sim.outq = xQueueCreate(SPI_PORT_SIM_QUEUE_LEN, sizeof(void *));
+  sim.stopped = xSemaphoreCreateBinary();
+  if (!sim.inq || !sim.outq || !sim.stopped)
+  {
+    spi_err("Failed to create simulated NCP queues\n");
+    goto error;
+  }
+
+  if (xTaskCreate(spi_port_sim_task, "spi_port_sim", SPI_PORT_SIM_THREAD_STACK_SIZE >> 2,
+                  &sim, SPI_PORT_SIM_THREAD_PRIO, &sim.task) != pdPASS)
+  {
+    spi_err("Failed to create simulated NCP task\n");
+    goto error;
+  }
+
+  return 0;
+
+error:
+  if (sim.inq)
+  {
+    vQueueDelete(sim.inq);
+  }
+  if (sim.outq)
+  {
+    vQueueDelete(sim.outq);
+  }
+  if (sim.stopped)
+  {
+    vSemaphoreDelete(sim.stopped);
+  }
+  sim.inq = NULL;
+  sim.outq = NULL;
+  sim.stopped = NULL;
+  return -1;
+}
+
+int32_t spi_port_deinit(void)
+{
+  struct spi_port_sim_msg *msg = NULL;
+
+  if (!sim.task)
+  {
+    return 0;
+  }
+
+  /* A NULL message stops the simulated NCP task. */
+  (void)xQueueSend(sim.inq, &msg, portMAX_DELAY);
+  (void)xSemaphoreTake(sim.stopped, portMAX_DELAY);
+  sim.task = NULL;
+
+  while (xQueueReceive(sim.inq, &msg, 0) == pdTRUE)
+  {
+    vPortFree(msg);
+  }
+  while (xQueueReceive(sim.outq, &msg, 0) == pdTRUE)
+  {
+    vPortFree(msg);
+  }
+  vQueueDelete(sim.inq);
+  vQueueDelete(sim.outq);
+  vSemaphoreDelete(sim.stopped);
+  sim.inq = NULL;
+  sim.outq = NULL;
+  sim.stopped = NULL;
+  sim.rdy = 0;
+  sim.transaction_complete_cb = NULL;
+
+  return 0;
+}
+
+int32_t spi_port_transfer(void *tx_buf, void *rx_buf, uint16_t len, uint32_t timeout)
+{
+  (void)timeout;
+
+  if (!sim.cs || !rx_buf)
+  {
+    return -1;
+  }
+
+  spi_port_sim_clock(tx_buf, rx_buf, len);
+  return 0;
+}
+
+int32_t spi_port_transfer_dma(void *tx_buf, void *rx_buf, uint16_t len)
+{
+  if (!sim.cs || !rx_buf)
+  {
+    return -1;
+  }
+
+  spi_port_sim_clock(tx_buf, rx_buf, len);
+
+  /* The transfer completes immediately, signal it like the DMA interrupt would. */
+  if (sim.transaction_complete_cb)
+  {
+    sim.transaction_complete_cb();
+  }
+  return 0;
+}
+
+int32_t spi_port_is_ready(void)
+{
+  return sim.rdy;
+}
+
+int32_t spi_port_set_cs(int32_t state)
+{
+  struct spi_port_sim_header *hdr;
+  struct spi_port_sim_msg *msg = NULL;
+
+  if (state)
+  {
+    sim.cs = 1;
+    sim.clocked = 0;
+    sim.stat.transactions++;
+    sim.in_len = 0;
+    sim.acked = 0;
+
+    /* Load the next message to the host, or an empty header. */
+    hdr = (struct spi_port_sim_header *)sim.out_frame;
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = SPI_PORT_SIM_HEADER_MAGIC;
+    sim.out_len = 0;
+    if (sim.outq && (xQueueReceive(sim.outq, &msg, 0) == pdTRUE))
+    {
+      hdr->type = msg->type;
+      hdr->len = msg->len;
+      memcpy((uint8_t *)sim.out_frame + sizeof(*hdr), msg->data, msg->len);
+      sim.out_len = msg->len;
+      sim.stat.frames_out++;
+      sim.stat.bytes_out += msg->len;
+      vPortFree(msg);
+    }
+
+    /* Slave is ready for the transaction. */
+    sim.rdy = 1;
+    spi_on_txn_data_ready();
+    return 0;
+  }
+
+  hdr = (struct spi_port_sim_header *)sim.in_frame;
+  if ((sim.clocked >= sizeof(*hdr)) && (hdr->magic == SPI_PORT_SIM_HEADER_MAGIC) && (hdr->len > 0) &&
+      (hdr->len <= SPI_XFER_MTU_BYTES) && (sim.in_len >= sizeof(*hdr) + hdr->len))
+  {
+    /* Hand the host message over to the simulated NCP task. */
+    msg = pvPortMalloc(sizeof(*msg) + hdr->len);
+    if (msg)
+    {
+      msg->type = hdr->type;
+      msg->len = hdr->len;
+      memcpy(msg->data, (uint8_t *)sim.in_frame + sizeof(*hdr), hdr->len);
+      if (xQueueSend(sim.inq, &msg, 0) != pdTRUE)
+      {
+        vPortFree(msg);
+        msg = NULL;
+      }
+    }
+
+    if (msg)
+    {
+      sim.stat.frames_in++;
+      sim.stat.bytes_in += hdr->len;
+    }
+    else
+    {
+      sim.stat.drops++;
+    }
+  }
+
+  taskENTER_CRITICAL();
+  sim.cs = 0;
+  taskEXIT_CRITICAL();
+
+  /* Raise RDY again if more messages are pending. */
+  spi_port_sim_raise_rdy();
+  return 0;
+}
+
+int32_t spi_port_sim_set_handler(spi_port_sim_handler_t handler, void *arg)
+{
+  taskENTER_CRITICAL();
+  sim.handler = handler;
+  sim.handler_arg = arg;
+  taskEXIT_CRITICAL();
+  return 0;
+}
+
+int32_t spi_port_sim_respond(uint8_t type, const void *data, uint32_t len)
+{
+  struct spi_port_sim_msg *msg;
+
+  if (!sim.outq || (len > SPI_XFER_MTU_BYTES) || (!data && len))
+  {
+    return -1;
+  }
+
+  msg = pvPortMalloc(sizeof(*msg) + len);
+  if (!msg)
+  {
+    return -1;
+  }
+  msg->type = type;
+  msg->len = (uint16_t)len;
+  memcpy(msg->data, data, len);
+
+  if (xQueueSend(sim.outq, &msg, portMAX_DELAY) != pdTRUE)
+  {
+    vPortFree(msg);
+    return -1;
+  }
+
+  spi_port_sim_raise_rdy();
+  return 0;
+}
+
+int32_t spi_port_sim_inject(const char *line)
+{
+  if (!line)
+  {
+    return -1;
+  }
+
+  spi_port_sim_printf("%s\r\n", line);
+  return 0;
+}
+
+int32_t spi_port_sim_get_stats(struct spi_port_sim_stat *stat)
+{
+  if (!stat)
+  {
+    return -1;
+  }
+
+  *stat = sim.stat;
+  return 0;
+}
+
+/* Private Functions Definition ----------------------------------------------*/
+static void spi_port_sim_raise_rdy(void)
+{
+  int32_t notify = 0;
+
+  taskENTER_CRITICAL();
+  if (!sim.cs && !sim.rdy && sim.outq && uxQueueMessagesWaiting(sim.outq))
+  {
+    sim.rdy = 1;
+    notify = 1;
+  }
+  taskEXIT_CRITICAL();
+
+  if (notify)
+  {
+    spi_on_txn_data_ready();
+  }
+}
+
+static void spi_port_sim_check_ack(void)
+{
+  struct spi_port_sim_header *hdr = (struct spi_port_sim_header *)sim.in_frame;
+  uint32_t in_total = sizeof(*hdr);
+
+  if (sim.acked || (sim.clocked < sizeof(*hdr)))
+  {
+    return;
+  }
+
+  if ((hdr->magic == SPI_PORT_SIM_HEADER_MAGIC) && (hdr->len <= SPI_XFER_MTU_BYTES))
+  {
+    in_total += hdr->len;
+  }
+
+  /* The slave acknowledges once both messages went through the bus. */
+  if ((sim.clocked >= sizeof(*hdr) + sim.out_len) && (sim.in_len >= in_total))
+  {
+    sim.acked = 1;
+    sim.rdy = 0;
+    spi_on_header_ack();
+  }
+}
+
+static void spi_port_sim_clock(const uint8_t *tx_buf, uint8_t *rx_buf, uint16_t len)
+{
+  uint32_t out_total = sizeof(struct spi_port_sim_header) + sim.out_len;
+  uint32_t n;
+
+  /* Shift out the slave message, then zeros. */
+  n = (sim.clocked < out_total) ? (out_total - sim.clocked) : 0;
+  n = (n > len) ? len : n;
+  memcpy(rx_buf, (uint8_t *)sim.out_frame + sim.clocked, n);
+  memset(rx_buf + n, 0, len - n);
+
+  /* Shift in the master message. */
+  if (tx_buf && (sim.in_len == sim.clocked))
+  {
+    n = (sim.in_len < SPI_PORT_SIM_FRAME_SIZE) ? (SPI_PORT_SIM_FRAME_SIZE - sim.in_len) : 0;
+    n = (n > len) ? len : n;
+    memcpy((uint8_t *)sim.in_frame + sim.in_len, tx_buf, n);
+    sim.in_len += n;
+  }
+
+  sim.clocked += len;
+  sim.stat.bytes_clocked += len;
+  spi_port_sim_check_ack();
+}
+
+static void spi_port_sim_printf(const char *fmt, ...)
+{
+  char buf[SPI_PORT_SIM_LINE_SIZE];
+  va_list args;
+  int32_t len;
+
+  va_start(args, fmt);
+  len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+
+  if (len > 0)
+  {
+    len = (len >= (int32_t)sizeof(buf)) ? (int32_t)sizeof(buf) - 1 : len;
+    (void)spi_port_sim_respond(SPI_MSG_CTRL_TRAFFIC_AT_CMD, buf, (uint32_t)len);
+  }
+}
+
+static void spi_port_sim_recvdata(uint32_t id, uint32_t req_len)
+{
+  struct spi_port_sim_socket *sock = &sim.sock[id];
+  struct spi_port_sim_msg *msg;
+  uint32_t max_len = SPI_XFER_MTU_BYTES - SPI_PORT_SIM_RECVDATA_HDR_LEN;
+  uint32_t len = sock->len;
+  int32_t hdr_len;
+
+  len = (len > req_len) ? req_len : len;
+  len = (len > max_len) ? max_len : len;
+
+  msg = pvPortMalloc(sizeof(*msg) + SPI_XFER_MTU_BYTES);
+  if (!msg)
+  {
+    spi_port_sim_printf("ERROR\r\n");
+    return;
+  }
+
+  hdr_len = snprintf((char *)msg->data, SPI_PORT_SIM_RECVDATA_HDR_LEN, "+CIPRECVDATA:%" PRIu32 ",", len);
+  memcpy(&msg->data[hdr_len], sock->data, len);
+  msg->type = SPI_MSG_CTRL_TRAFFIC_AT_CMD;
+  msg->len = (uint16_t)(hdr_len + len);
+
+  sock->len -= len;
+  memmove(sock->data, &sock->data[len], sock->len);
+
+  if (xQueueSend(sim.outq, &msg, portMAX_DELAY) != pdTRUE)
+  {
+    vPortFree(msg);
+    return;
+  }
+  spi_port_sim_raise_rdy();
+  spi_port_sim_printf("\r\nOK\r\n");
+}
+
+/* Hand the data looped back to a socket over to the host. */
+static void spi_port_sim_sock_ready(uint32_t id)
+{
+  struct spi_port_sim_socket *sock = &sim.sock[id];
+  struct spi_sock_data_hdr *hdr;
+  struct spi_port_sim_msg *msg;
+  uint32_t max_len = SPI_XFER_MTU_BYTES - sizeof(*hdr);
+  uint32_t ip[4] = {0};
+  uint32_t off = 0;
+  uint32_t len;
+
+  if (!sim.data_chan)
+  {
+    spi_port_sim_printf("+IPD:%" PRIu32 ",%" PRIu32 ",\"%s\",%" PRIu16 "\r\n",
+                        id, sock->len, sock->remote_ip, sock->remote_port);
+    return;
+  }
+
+  (void)sscanf(sock->remote_ip, "%" SCNu32 ".%" SCNu32 ".%" SCNu32 ".%" SCNu32, &ip[0], &ip[1], &ip[2], &ip[3]);
+  while ((off < sock->len) && ((sim.window == 0) || (sock->credit > 0)))
+  {
+    len = sock->len - off;
+    len = (len > max_len) ? max_len : len;
+
+    msg = pvPortMalloc(sizeof(*msg) + sizeof(*hdr) + len);
+    if (!msg)
+    {
+      sim.stat.drops++;
+      break;
+    }
+    msg->type = SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA;
+    msg->len = (uint16_t)(sizeof(*hdr) + len);
+    hdr = (struct spi_sock_data_hdr *)msg->data;
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->sock = (uint8_t)id;
+    hdr->len = (uint16_t)len;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+      hdr->remote_ip[i] = (uint8_t)ip[i];
+    }
+    hdr->remote_port = sock->remote_port;
+    memcpy(&msg->data[sizeof(*hdr)], &sock->data[off], len);
+
+    if (xQueueSend(sim.outq, &msg, portMAX_DELAY) != pdTRUE)
+    {
+      vPortFree(msg);
+      break;
+    }
+    spi_port_sim_raise_rdy();
+    off += len;
+    if (sim.window)
+    {
+      sock->credit--;
+    }
+  }
+
+  /* Keep what the window holds back until the host returns credits. */
+  memmove(sock->data, &sock->data[off], sock->len - off);
+  sock->len -= off;
+}
+
+static void spi_port_sim_sock_input(const uint8_t *data, uint32_t len)
+{
+  const struct spi_sock_data_hdr *hdr = (const struct spi_sock_data_hdr *)data;
+  struct spi_port_sim_socket *sock;
+  uint32_t room;
+
+  if ((len < sizeof(*hdr)) || (hdr->sock >= SPI_PORT_SIM_SOCKETS) || (hdr->len > len - sizeof(*hdr)))
+  {
+    sim.stat.drops++;
+    return;
+  }
+
+  sock = &sim.sock[hdr->sock];
+  sock->credit += hdr->credit;
+  if (hdr->len == 0)
+  {
+    /* Credits only. */
+    spi_port_sim_sock_ready(hdr->sock);
+    return;
+  }
+
+  if (hdr->remote_port)
+  {
+    /* Unconnected UDP send, the data comes back from the destination. */
+    snprintf(sock->remote_ip, sizeof(sock->remote_ip), "%u.%u.%u.%u",
+             hdr->remote_ip[0], hdr->remote_ip[1], hdr->remote_ip[2], hdr->remote_ip[3]);
+    sock->remote_port = hdr->remote_port;
+  }
+
+  room = SPI_PORT_SIM_SOCK_BUF_SIZE - sock->len;
+  if (hdr->len > room)
+  {
+    sim.stat.drops++;
+  }
+  memcpy(&sock->data[sock->len], data + sizeof(*hdr), (hdr->len > room) ? room : hdr->len);
+  sock->len += (hdr->len > room) ? room : hdr->len;
+  spi_port_sim_sock_ready(hdr->sock);
+}
+
+static void spi_port_sim_at_line(char *line, uint32_t len)
+{
+  uint32_t id = 0;
+  uint32_t arg = 0;
+  uint32_t port = 0;
+  char ip[16] = {0};
+
+  sim.stat.at_cmds++;
+
+  if ((len == 0) || (strncmp(line, "AT", 2) != 0))
+  {
+    return;
+  }
+
+  if (sscanf(line, "AT+CIPSEND=%" SCNu32 ",%" SCNu32, &id, &arg) == 2)
+  {
+    if ((id >= SPI_PORT_SIM_SOCKETS) || (arg == 0) || (arg > SPI_XFER_MTU_BYTES))
+    {
+      spi_port_sim_printf("ERROR\r\n");
+      return;
+    }
+    sim.send_sock = (int32_t)id;
+    sim.send_remain = arg;
+    sim.send_len = arg;
+    spi_port_sim_printf("OK\r\n");
+    spi_port_sim_printf(">");
+    return;
+  }
+
+  if (sscanf(line, "AT+CIPRECVDATA=%" SCNu32 ",%" SCNu32, &id, &arg) == 2)
+  {
+    if (id >= SPI_PORT_SIM_SOCKETS)
+    {
+      spi_port_sim_printf("ERROR\r\n");
+      return;
+    }
+    spi_port_sim_recvdata(id, arg);
+    return;
+  }
+
+  if (sscanf(line, "AT+CIPSTART=%" SCNu32 ",\"%*[^\"]\",\"%15[^\"]\",%" SCNu32, &id, ip, &port) >= 1)
+  {
+    if (id >= SPI_PORT_SIM_SOCKETS)
+    {
+      spi_port_sim_printf("ERROR\r\n");
+      return;
+    }
+    sim.sock[id].len = 0;
+    sim.sock[id].credit = sim.window;
+    sim.sock[id].remote_port = (uint16_t)port;
+    snprintf(sim.sock[id].remote_ip, sizeof(sim.sock[id].remote_ip), "%s", ip[0] ? ip : "127.0.0.1");
+    spi_port_sim_printf("+CIP:%" PRIu32 ",CONNECTED\r\n", id);
+    spi_port_sim_printf("OK\r\n");
+    return;
+  }
+
+  if (sscanf(line, "AT+CIPDATACHAN=%" SCNu32 ",%" SCNu32, &arg, &id) >= 1)
+  {
+    sim.data_chan = (arg != 0);
+    sim.window = (sim.data_chan && (id > 0)) ? id : 0;
+    spi_port_sim_printf("OK\r\n");
+    return;
+  }
+
+  if (sscanf(line, "AT+CIPCLOSE=%" SCNu32, &id) == 1)
+  {
+    if (id < SPI_PORT_SIM_SOCKETS)
+    {
+      sim.sock[id].len = 0;
+      spi_port_sim_printf("+CIP:%" PRIu32 ",DISCONNECTED\r\n", id);
+    }
+    spi_port_sim_printf("OK\r\n");
+    return;
+  }
+
+  if (strncmp(line, "AT+CWJAP=", 9) == 0)
+  {
+    spi_port_sim_printf("+CW:CONNECTED\r\n");
+    spi_port_sim_printf("+CW:GOTIP\r\n");
+  }
+
+  spi_port_sim_printf("OK\r\n");
+}
+
+static void spi_port_sim_at_input(const uint8_t *data, uint32_t len)
+{
+  while (len > 0)
+  {
+    /* Raw data following a CIPSEND prompt. */
+    if (sim.send_sock >= 0)
+    {
+      struct spi_port_sim_socket *sock = &sim.sock[sim.send_sock];
+      uint32_t n = (len > sim.send_remain) ? sim.send_remain : len;
+      uint32_t room = SPI_PORT_SIM_SOCK_BUF_SIZE - sock->len;
+
+      memcpy(&sock->data[sock->len], data, (n > room) ? room : n);
+      sock->len += (n > room) ? room : n;
+      data += n;
+      len -= n;
+      sim.send_remain -= n;
+
+      if (sim.send_remain == 0)
+      {
+        spi_port_sim_printf("Recv %" PRIu32 " bytes\r\n", sim.send_len);
+        spi_port_sim_printf("SEND OK\r\n");
+        spi_port_sim_sock_ready((uint32_t)sim.send_sock);
+        sim.send_sock = -1;
+      }
+      continue;
+    }
+
+    if (*data == '\n')
+    {
+      /* Strip the CR and run the command. */
+      if ((sim.line_len > 0) && (sim.line[sim.line_len - 1] == '\r'))
+      {
+        sim.line_len--;
+      }
+      sim.line[sim.line_len] = '\0';
+
+      if (!sim.handler ||
+          !sim.handler(SPI_MSG_CTRL_TRAFFIC_AT_CMD, (const uint8_t *)sim.line, sim.line_len, sim.handler_arg))
+      {
+        spi_port_sim_at_line(sim.line, sim.line_len);
+      }
+      sim.line_len = 0;
+    }
+    else if (sim.line_len < SPI_PORT_SIM_LINE_SIZE - 1)
+    {
+      sim.line[sim.line_len++] = (char)*data;
+    }
+    data++;
+    len--;
+  }
+}
+
+static void spi_port_sim_task(void *arg)
+{
+  struct spi_port_sim *s = arg;
+  struct spi_port_sim_msg *msg;
+
+  /* Boot message of the NCP, once the host is done with its SPI initialization. */
+  vTaskDelay(pdMS_TO_TICKS(SPI_PORT_SIM_BOOT_TIME_MS));
+  (void)spi_port_sim_inject("ready");
+
+  while (1)
+  {
+    if (xQueueReceive(s->inq, &msg, portMAX_DELAY) != pdTRUE)
+    {
+      continue;
+    }
+    if (!msg)
+    {
+      break;
+    }
+
+    if (msg->type == SPI_MSG_CTRL_TRAFFIC_AT_CMD)
+    {
+      spi_port_sim_at_input(msg->data, msg->len);
+    }
+    else if (s->handler && s->handler(msg->type, msg->data, msg->len, s->handler_arg))
+    {
+      /* Handled by the hook. */
+    }
+    else if (msg->type == SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA)
+    {
+      spi_port_sim_sock_input(msg->data, msg->len);
+    }
+    else
+    {
+      s->stat.drops++;
+    }
+    vPortFree(msg);
+  }
+
+  (void)xSemaphoreGive(s->stopped);
+  vTaskDelete(NULL);
+}
+
+#endif /* SPI_PORT_SIM_ENABLE */
@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @file    spi_port_sim.h
+  * @brief   Simulated NCP behind the SPI bus porting layer
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SPI_PORT_SIM_H
+#define SPI_PORT_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Scripted command hook of the simulated NCP
+  * @param  type: SPI traffic type of the message
+  * @param  data: AT command line without its CR LF when type is SPI_MSG_CTRL_TRAFFIC_AT_CMD, raw payload otherwise
+  * @param  len: Length of data in bytes
+  * @param  arg: Argument given to spi_port_sim_set_handler
+  * @retval 1 if the message has been handled, 0 to fall back to the built-in behavior
+  */
+typedef int32_t (*spi_port_sim_handler_t)(uint8_t type, const uint8_t *data, uint32_t len, void *arg);
+
+/**
+  * @brief  Simulated NCP statistics
+  */
+struct spi_port_sim_stat
+{
+  uint32_t frames_in;       /*!< Frames received from the host */
+  uint32_t frames_out;      /*!< Frames sent to the host */
+  uint64_t bytes_in;        /*!< Payload bytes received from the host */
+  uint64_t bytes_out;       /*!< Payload bytes sent to the host */
+  uint32_t at_cmds;         /*!< AT command lines processed */
+  uint32_t drops;           /*!< Frames discarded by the simulated NCP */
+  uint32_t transactions;    /*!< SPI transactions, i.e. chip select assertions */
+  uint64_t bytes_clocked;   /*!< Bytes clocked on the bus, headers and padding included */
+};
+
+/* Exported functions ------------------------------------------------------- */
+/**
+  * @brief  Register a hook called for each message before the built-in script
+  * @param  handler: Hook function, NULL to remove it
+  * @param  arg: Argument passed to the hook
+  * @retval 0 if successful, -1 otherwise
+  */
+int32_t spi_port_sim_set_handler(spi_port_sim_handler_t handler, void *arg);
+
+/**
+  * @brief  Queue a message from the simulated NCP to the host
+  * @param  type: SPI traffic type of the message
+  * @param  data: Message payload
+  * @param  len: Length of the payload in bytes, up to the SPI MTU
+  * @retval 0 if successful, -1 otherwise
+  */
+int32_t spi_port_sim_respond(uint8_t type, const void *data, uint32_t len);
+
+/**
+  * @brief  Queue an unsolicited AT line from the simulated NCP, e.g. "+CW:CONNECTED"
+  * @param  line: AT line without its CR LF
+  * @retval 0 if successful, -1 otherwise
+  */
+int32_t spi_port_sim_inject(const char *line);
+
+/**
+  * @brief  Get the simulated NCP statistics
+  * @param  stat: Statistics structure to fill
+  * @retval 0 if successful, -1 otherwise
+  */
+int32_t spi_port_sim_get_stats(struct spi_port_sim_stat *stat);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SPI_PORT_SIM_H */
@@ -65,7 +65,8 @@ int32_t BusIo_SPI_Bind(uint8_t type, int32_t rxq_size, BusIo_SPI_rxd_notify_func
     return ret;
   }
 
-  if ((cb != NULL) && ((type == SPI_MSG_CTRL_TRAFFIC_NETWORK_STA) || (type == SPI_MSG_CTRL_TRAFFIC_NETWORK_AP)))
+  if ((cb != NULL) && ((type == SPI_MSG_CTRL_TRAFFIC_NETWORK_STA) || (type == SPI_MSG_CTRL_TRAFFIC_NETWORK_AP) ||
+                       (type == SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA)))
   {
     ret = spi_rxd_callback_register((spi_msg_ctrl_t)type, cb, NULL);
   }
@@ -89,6 +90,19 @@ int32_t BusIo_SPI_SendData(uint8_t type, uint8_t *pBuf, uint16_t length, uint32_
   return spi_write(&m, Timeout);
 }
 
+int32_t BusIo_SPI_SendDataVec(uint8_t type, const struct spi_iovec *iov, uint32_t iovcnt, uint32_t headroom,
+                              spi_buffer_release_func_t release, void *arg, uint32_t Timeout)
+{
+  struct spi_msg_control ctrl;
+  struct spi_msg m;
+
+  SPI_MSG_CONTROL_INIT(ctrl, SPI_MSG_CTRL_TRAFFIC_TYPE, SPI_MSG_CTRL_TRAFFIC_TYPE_LEN, &type);
+  SPI_MSG_INIT(m, SPI_MSG_OP_DATA, &ctrl, (headroom >= SPI_XFER_HEADER_LEN) ? SPI_MSG_F_HEADROOM : 0);
+  m.release = release;
+  m.release_arg = arg;
+  return spi_writev(&m, iov, iovcnt, Timeout);
+}
+
 int32_t BusIo_SPI_ReceiveData(uint8_t type, uint8_t *pBuf, uint16_t length, uint32_t Timeout)
 {
   struct spi_msg_control ctrl;
@@ -127,10 +141,6 @@ int32_t BusIo_SPI_ReceivePtr(uint8_t type, void **buffer, uint8_t **data, uint32
 
 int32_t BusIo_SPI_Free(void *buffer)
 {
-  if (buffer)
-  {
-    vPortFree(buffer);
-  }
-
+  spi_buffer_free((struct spi_buffer *)buffer);
   return 0;
 }
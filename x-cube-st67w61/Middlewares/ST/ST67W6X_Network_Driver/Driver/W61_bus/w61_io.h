@@ -81,6 +81,21 @@ void BusIo_SPI_Delay(uint32_t Delay);
   */
 int32_t BusIo_SPI_SendData(uint8_t type, uint8_t *pBuf, uint16_t length, uint32_t Timeout);
 
+/**
+  * @brief  Send one message made of several segments to the ST67W611M module over the SPI interface.
+  *         A single segment with at least SPI_XFER_HEADER_LEN bytes of headroom is sent without copy.
+  * @param  type: Traffic type to use (must be < SPI_MSG_CTRL_TRAFFIC_TYPE_MAX)
+  * @param  iov: segments to send
+  * @param  iovcnt: number of segments
+  * @param  headroom: writable bytes available in front of the first segment
+  * @param  release: called once the segments are no longer referenced, not called on error
+  * @param  arg: argument passed to release
+  * @param  Timeout: max time to wait before returning
+  * @retval forward spi_writev ret
+  */
+int32_t BusIo_SPI_SendDataVec(uint8_t type, const struct spi_iovec *iov, uint32_t iovcnt, uint32_t headroom,
+                              spi_buffer_release_func_t release, void *arg, uint32_t Timeout);
+
 /**
   * @brief  Receive data from the ST67W611M module over the SPI interface
   * @param  type: Traffic type to use (must be < SPI_MSG_CTRL_TRAFFIC_TYPE_MAX)
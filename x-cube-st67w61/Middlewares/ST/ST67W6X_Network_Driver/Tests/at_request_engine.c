@@ -0,0 +1,205 @@
+/**
+  ******************************************************************************
+  * @file    at_request_engine.c
+  * @brief   Host test of the AT request engine cancellation and shutdown
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*
+ * The driver runs on the FreeRTOS POSIX shim against the simulated NCP, whose hook holds
+ * the response of AT+SLOW for SLOW_MS and records every command line it receives.
+ *  - A request whose wait times out before its execution is dequeued and never sent.
+ *  - Cancelling the request being executed returns once its response is received.
+ *  - W61_AT_Common_SetExecute goes through the request queue.
+ *  - W61_DeInit lets the request being executed complete and releases the queued ones
+ *    with an error, instead of deleting the request task under them.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "w61_at_api.h"
+#include "w61_at_common.h"
+#include "spi_iface.h"
+#include "spi_port_sim.h"
+#include "logging.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define SLOW_MS             200
+#define MAX_LINES           32
+
+/* Private variables ---------------------------------------------------------*/
+/* Command lines received by the simulated NCP */
+static char lines[MAX_LINES][16];
+static volatile uint32_t line_count;
+
+static volatile uint32_t completed;
+static W61_Status_t completed_status[3];
+static uint32_t failures;
+
+/* Private function prototypes -----------------------------------------------*/
+static void check(int32_t cond, const char *what);
+static int32_t sent(const char *cmd);
+static int32_t sim_hook(uint8_t type, const uint8_t *data, uint32_t len, void *arg);
+static void request_cb(W61_AT_Request_t *req, void *arg);
+static void test_log_output(const char *message);
+static void test_task(void *arg);
+
+/* Functions Definition ------------------------------------------------------*/
+int main(void)
+{
+  (void)vLoggingInit(test_log_output);
+  if (xTaskCreate(test_task, "test", 4096, NULL, 20, NULL) != pdPASS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  /* The test task ends the process */
+  while (1)
+  {
+    vTaskDelay(1000);
+  }
+}
+
+/* Private Functions Definition ----------------------------------------------*/
+static void check(int32_t cond, const char *what)
+{
+  if (!cond)
+  {
+    printf("FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+static int32_t sent(const char *cmd)
+{
+  for (uint32_t i = 0; i < line_count; i++)
+  {
+    if (strcmp(lines[i], cmd) == 0)
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int32_t sim_hook(uint8_t type, const uint8_t *data, uint32_t len, void *arg)
+{
+  if ((type != SPI_MSG_CTRL_TRAFFIC_AT_CMD) || (line_count >= MAX_LINES))
+  {
+    return 0;
+  }
+
+  len = (len < sizeof(lines[0]) - 1) ? len : sizeof(lines[0]) - 1;
+  memcpy(lines[line_count], data, len);
+  lines[line_count][len] = '\0';
+  line_count++;
+
+  if (strcmp(lines[line_count - 1], "AT+SLOW") == 0)
+  {
+    vTaskDelay(pdMS_TO_TICKS(SLOW_MS));
+  }
+  /* The built-in script answers OK */
+  return 0;
+}
+
+static void request_cb(W61_AT_Request_t *req, void *arg)
+{
+  completed_status[(uintptr_t)arg] = req->status;
+  completed++;
+}
+
+static void test_log_output(const char *message)
+{
+  fputs(message, stderr);
+}
+
+static void test_task(void *arg)
+{
+  W61_Object_t *Obj = W61_ObjGet();
+  W61_AT_Request_t req[3];
+  W61_Status_t status;
+  uint32_t tag;
+  TickType_t t0;
+
+  if (W61_Init(Obj) != W61_STATUS_OK)
+  {
+    printf("driver init failed\n");
+    exit(EXIT_FAILURE);
+  }
+  /* Set once the simulated NCP is started */
+  (void)spi_port_sim_set_handler(sim_hook, NULL);
+
+  /* Requests timing out in the queue are withdrawn */
+  memset(req, 0, sizeof(req));
+  req[0].cmd = "AT+SLOW\r\n";
+  req[1].cmd = "AT+B\r\n";
+  req[2].cmd = "AT+C\r\n";
+  for (uint32_t i = 0; i < 3; i++)
+  {
+    req[i].timeout_ms = 2 * SLOW_MS;
+    check(W61_AT_Request_Submit(Obj, &req[i]) == W61_STATUS_OK, "submit");
+  }
+  t0 = xTaskGetTickCount();
+  check(W61_AT_Request_Wait(&req[2], 20) == W61_STATUS_TIMEOUT, "wait timeout of a queued request");
+  check(W61_AT_Request_Wait(&req[1], 20) == W61_STATUS_TIMEOUT, "wait timeout of a queued request");
+  check(xTaskGetTickCount() - t0 < pdMS_TO_TICKS(SLOW_MS), "queued requests withdrawn without waiting");
+  /* Their frames can be reused right away */
+  memset(&req[1], 0xA5, 2 * sizeof(req[0]));
+  check(W61_AT_Request_Wait(&req[0], portMAX_DELAY) == W61_STATUS_OK, "request executed");
+  check(W61_AT_Common_SetExecute(Obj, (uint8_t *)"AT+D\r\n", W61_NCP_TIMEOUT) == W61_STATUS_OK, "next command");
+  check(!sent("AT+B") && !sent("AT+C"), "withdrawn requests not sent");
+
+  /* Cancelling the request being executed waits for its response */
+  memset(req, 0, sizeof(req));
+  req[0].cmd = "AT+SLOW\r\n";
+  req[0].timeout_ms = 2 * SLOW_MS;
+  check(W61_AT_Request_Submit(Obj, &req[0]) == W61_STATUS_OK, "submit");
+  vTaskDelay(pdMS_TO_TICKS(SLOW_MS / 4));
+  status = W61_AT_Request_Cancel(&req[0]);
+  check((status == W61_STATUS_OK) && (req[0].done == 1), "cancel of the running request waits for it");
+
+  /* Synchronous commands are queued as requests */
+  tag = Obj->Modem.req_tag;
+  check(W61_AT_Common_SetExecute(Obj, (uint8_t *)"AT+E\r\n", W61_NCP_TIMEOUT) == W61_STATUS_OK, "set execute");
+  check(Obj->Modem.req_tag == tag + 1, "set execute goes through the request engine");
+
+  /* Deinit with requests queued */
+  memset(req, 0, sizeof(req));
+  req[0].cmd = "AT+SLOW\r\n";
+  req[1].cmd = "AT+F\r\n";
+  req[2].cmd = "AT+G\r\n";
+  for (uint32_t i = 0; i < 3; i++)
+  {
+    req[i].timeout_ms = 2 * SLOW_MS;
+    req[i].cb = request_cb;
+    req[i].arg = (void *)(uintptr_t)i;
+    check(W61_AT_Request_Submit(Obj, &req[i]) == W61_STATUS_OK, "submit");
+  }
+  vTaskDelay(pdMS_TO_TICKS(SLOW_MS / 4));
+  (void)W61_DeInit(Obj);
+  check(completed == 3, "all requests completed on deinit");
+  check(completed_status[0] == W61_STATUS_OK, "running request completed on deinit");
+  check((completed_status[1] == W61_STATUS_ERROR) && (completed_status[2] == W61_STATUS_ERROR),
+        "queued requests released on deinit");
+  check(!sent("AT+F") && !sent("AT+G"), "queued requests not sent after deinit");
+
+  printf("%u commands sent, %u failures\n", (unsigned)line_count, (unsigned)failures);
+  exit((failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
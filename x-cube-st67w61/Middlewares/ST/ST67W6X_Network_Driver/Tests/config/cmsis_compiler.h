@@ -0,0 +1,30 @@
+/**
+  ******************************************************************************
+  * @file    cmsis_compiler.h
+  * @brief   Host replacement of the CMSIS compiler intrinsics used by the driver
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef CMSIS_COMPILER_H
+#define CMSIS_COMPILER_H
+
+/* Exported macros -----------------------------------------------------------*/
+/** Count leading zeros, 32 for 0 like the CLZ instruction */
+#define __CLZ(x)        (((x) == 0U) ? 32U : (uint32_t)__builtin_clz(x))
+#define __NOP()         __asm volatile ("nop")
+#define __DSB()         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DMB()         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __ISB()         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#endif /* CMSIS_COMPILER_H */
@@ -0,0 +1,29 @@
+/**
+  ******************************************************************************
+  * @file    logging_config.h
+  * @brief   Logging configuration of the host tests
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef LOGGING_CONFIG_H
+#define LOGGING_CONFIG_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "logging_levels.h"
+
+/* Exported constants --------------------------------------------------------*/
+/** Global verbosity level (LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG) */
+#define LOG_LEVEL                               LOG_WARN
+
+#endif /* LOGGING_CONFIG_H */
@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file    w61_driver_config.h
+  * @brief   Driver configuration of the host tests
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef W61_DRIVER_CONFIG_H
+#define W61_DRIVER_CONFIG_H
+
+/* Exported constants --------------------------------------------------------*/
+/** All available configuration defines in
+  * Middlewares\ST\ST67W6X_Network_Driver\Driver\W61_at\w61_default_config.h
+  */
+
+/** The NCP is the simulated one of Driver/W61_bus/spi_port_sim.c */
+#define SPI_PORT_SIM_ENABLE                     1
+
+/** Maximum SPI buffer size */
+#define W61_MAX_SPI_XFER                        6000
+
+/** Enable/Disable module logging */
+#define WIFI_LOG_ENABLE                         1
+#define NET_LOG_ENABLE                          1
+#define SYS_LOG_ENABLE                          1
+
+#include "logging.h"
+
+#endif /* W61_DRIVER_CONFIG_H */
@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @file    FreeRTOS.h
+  * @brief   Host shim of the FreeRTOS kernel API on POSIX threads
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Only the subset of the kernel API used by the driver bus, AT and socket layers is
+ * provided. Tasks are POSIX threads and their priorities are ignored, there is no
+ * interrupt context: the FromISR variants are the task variants with no timeout.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define configTICK_RATE_HZ          ((TickType_t)1000)
+#define configCPU_CLOCK_HZ          1000000000UL
+#define configMAX_PRIORITIES        56
+#define configMAX_TASK_NAME_LEN     16
+
+#define pdFALSE                     ((BaseType_t)0)
+#define pdTRUE                      ((BaseType_t)1)
+#define pdFAIL                      pdFALSE
+#define pdPASS                      pdTRUE
+#define errQUEUE_EMPTY              ((BaseType_t)0)
+#define errQUEUE_FULL               ((BaseType_t)0)
+
+#define portMAX_DELAY               ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS          ((TickType_t)1000 / configTICK_RATE_HZ)
+
+/* Exported macros -----------------------------------------------------------*/
+#define pdMS_TO_TICKS(xTimeInMs)    ((TickType_t)(((uint64_t)(xTimeInMs) * configTICK_RATE_HZ) / 1000U))
+
+#define configASSERT(x)             if (!(x)) { abort(); }
+
+#define portMEMORY_BARRIER()        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define portYIELD_FROM_ISR(x)       (void)(x)
+#define portEND_SWITCHING_ISR(x)    (void)(x)
+
+/* Exported functions ------------------------------------------------------- */
+void *pvPortMalloc(size_t xSize);
+void vPortFree(void *pv);
+BaseType_t xPortIsInsideInterrupt(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* INC_FREERTOS_H */
@@ -0,0 +1,577 @@
+/**
+  ******************************************************************************
+  * @file    freertos_posix.c
+  * @brief   Host shim of the FreeRTOS kernel API on POSIX threads
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Each object is a mutex and condition variables. Blocking calls wait on a condition
+ * variable against the monotonic clock, one tick is one millisecond. A task deleted by
+ * another one is cancelled at its next blocking call and joined, so the task is gone
+ * when vTaskDelete returns, like on the target. Task control blocks are never freed,
+ * a stale handle stays valid.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE /* PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP */
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+/* Private typedef -----------------------------------------------------------*/
+struct tskTaskControlBlock
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  uint32_t notify;
+  UBaseType_t priority;
+  TaskFunction_t code;
+  void *arg;
+  char name[configMAX_TASK_NAME_LEN];
+};
+
+struct QueueDefinition
+{
+  pthread_mutex_t lock;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+  uint8_t *items;
+  UBaseType_t length;
+  UBaseType_t item_size;
+  UBaseType_t count;
+  UBaseType_t head;
+};
+
+struct EventGroupDef_t
+{
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  EventBits_t bits;
+};
+
+/* Private variables ---------------------------------------------------------*/
+static pthread_mutex_t critical_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static pthread_once_t clock_once = PTHREAD_ONCE_INIT;
+static struct timespec clock_origin;
+static __thread TaskHandle_t current_task;
+
+/* Private function prototypes -----------------------------------------------*/
+static void clock_init(void);
+static void cond_init(pthread_cond_t *cond);
+static void deadline(TickType_t ticks, struct timespec *ts);
+static int wait(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks, const struct timespec *ts);
+static void unlock(void *lock);
+static void *task_entry(void *arg);
+static TaskHandle_t task_alloc(const char *name, UBaseType_t priority);
+
+/* Functions Definition ------------------------------------------------------*/
+void *pvPortMalloc(size_t xSize)
+{
+  return malloc(xSize);
+}
+
+void vPortFree(void *pv)
+{
+  free(pv);
+}
+
+BaseType_t xPortIsInsideInterrupt(void)
+{
+  return pdFALSE;
+}
+
+void vPortEnterCritical(void)
+{
+  (void)pthread_mutex_lock(&critical_lock);
+}
+
+void vPortExitCritical(void)
+{
+  (void)pthread_mutex_unlock(&critical_lock);
+}
+
+/* Tasks ---------------------------------------------------------------------*/
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *const pcName, const uint32_t usStackDepth,
+                       void *const pvParameters, UBaseType_t uxPriority, TaskHandle_t *const pxCreatedTask)
+{
+  TaskHandle_t task = task_alloc(pcName, uxPriority);
+
+  (void)usStackDepth;
+  if (task == NULL)
+  {
+    return pdFAIL;
+  }
+  task->code = pxTaskCode;
+  task->arg = pvParameters;
+  if (pxCreatedTask != NULL)
+  {
+    *pxCreatedTask = task;
+  }
+  if (pthread_create(&task->thread, NULL, task_entry, task) != 0)
+  {
+    return pdFAIL;
+  }
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+  if ((xTaskToDelete == NULL) || (xTaskToDelete == current_task))
+  {
+    (void)pthread_detach(pthread_self());
+    pthread_exit(NULL);
+  }
+  (void)pthread_cancel(xTaskToDelete->thread);
+  (void)pthread_join(xTaskToDelete->thread, NULL);
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+  struct timespec ts;
+
+  if (xTicksToDelay == 0)
+  {
+    (void)sched_yield();
+    return;
+  }
+  ts.tv_sec = xTicksToDelay / configTICK_RATE_HZ;
+  ts.tv_nsec = (long)(xTicksToDelay % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ);
+  while (nanosleep(&ts, &ts) != 0)
+  {
+  }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+  struct timespec now;
+
+  (void)pthread_once(&clock_once, clock_init);
+  (void)clock_gettime(CLOCK_MONOTONIC, &now);
+  return (TickType_t)((now.tv_sec - clock_origin.tv_sec) * configTICK_RATE_HZ +
+                      (now.tv_nsec - clock_origin.tv_nsec) / (1000000000L / configTICK_RATE_HZ));
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+  return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+  if (current_task == NULL)
+  {
+    /* Thread not created by xTaskCreate, e.g. main */
+    current_task = task_alloc("main", 0);
+    configASSERT(current_task != NULL);
+    current_task->thread = pthread_self();
+  }
+  return current_task;
+}
+
+char *pcTaskGetName(TaskHandle_t xTaskToQuery)
+{
+  return ((xTaskToQuery != NULL) ? xTaskToQuery : xTaskGetCurrentTaskHandle())->name;
+}
+
+UBaseType_t uxTaskPriorityGet(const TaskHandle_t xTask)
+{
+  return (xTask != NULL) ? xTask->priority : xTaskGetCurrentTaskHandle()->priority;
+}
+
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority)
+{
+  ((xTask != NULL) ? xTask : xTaskGetCurrentTaskHandle())->priority = uxNewPriority;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+  (void)pthread_mutex_lock(&xTaskToNotify->lock);
+  xTaskToNotify->notify++;
+  (void)pthread_cond_signal(&xTaskToNotify->cond);
+  (void)pthread_mutex_unlock(&xTaskToNotify->lock);
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  struct timespec ts;
+  uint32_t value;
+
+  deadline(xTicksToWait, &ts);
+  (void)pthread_mutex_lock(&task->lock);
+  pthread_cleanup_push(unlock, &task->lock);
+  while ((task->notify == 0) && (wait(&task->cond, &task->lock, xTicksToWait, &ts) == 0))
+  {
+  }
+  value = task->notify;
+  if (value != 0)
+  {
+    task->notify = (xClearCountOnExit != pdFALSE) ? 0 : value - 1;
+  }
+  pthread_cleanup_pop(1);
+  return value;
+}
+
+/* Queues and semaphores -----------------------------------------------------*/
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+  QueueHandle_t queue;
+
+  if (uxQueueLength == 0)
+  {
+    return NULL;
+  }
+  queue = calloc(1, sizeof(*queue));
+  if (queue == NULL)
+  {
+    return NULL;
+  }
+  if (uxItemSize != 0)
+  {
+    queue->items = malloc(uxQueueLength * uxItemSize);
+    if (queue->items == NULL)
+    {
+      free(queue);
+      return NULL;
+    }
+  }
+  queue->length = uxQueueLength;
+  queue->item_size = uxItemSize;
+  (void)pthread_mutex_init(&queue->lock, NULL);
+  cond_init(&queue->not_empty);
+  cond_init(&queue->not_full);
+  return queue;
+}
+
+QueueHandle_t xQueueCreateCountingSemaphore(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+  QueueHandle_t queue = xQueueCreate(uxMaxCount, 0);
+
+  if (queue != NULL)
+  {
+    queue->count = uxInitialCount;
+  }
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+  if (xQueue == NULL)
+  {
+    return;
+  }
+  (void)pthread_cond_destroy(&xQueue->not_empty);
+  (void)pthread_cond_destroy(&xQueue->not_full);
+  (void)pthread_mutex_destroy(&xQueue->lock);
+  free(xQueue->items);
+  free(xQueue);
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void *const pvItemToQueue, TickType_t xTicksToWait,
+                             BaseType_t xFront)
+{
+  volatile BaseType_t ret = pdFAIL;
+  struct timespec ts;
+  UBaseType_t slot;
+
+  deadline(xTicksToWait, &ts);
+  (void)pthread_mutex_lock(&xQueue->lock);
+  pthread_cleanup_push(unlock, &xQueue->lock);
+  while ((xQueue->count == xQueue->length) && (wait(&xQueue->not_full, &xQueue->lock, xTicksToWait, &ts) == 0))
+  {
+  }
+  if (xQueue->count < xQueue->length)
+  {
+    if (xFront != 0)
+    {
+      xQueue->head = (xQueue->head + xQueue->length - 1) % xQueue->length;
+      slot = xQueue->head;
+    }
+    else
+    {
+      slot = (xQueue->head + xQueue->count) % xQueue->length;
+    }
+    if (xQueue->item_size != 0)
+    {
+      memcpy(&xQueue->items[slot * xQueue->item_size], pvItemToQueue, xQueue->item_size);
+    }
+    xQueue->count++;
+    (void)pthread_cond_signal(&xQueue->not_empty);
+    ret = pdPASS;
+  }
+  pthread_cleanup_pop(1);
+  return ret;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *const pvBuffer, TickType_t xTicksToWait)
+{
+  volatile BaseType_t ret = pdFAIL;
+  struct timespec ts;
+
+  deadline(xTicksToWait, &ts);
+  (void)pthread_mutex_lock(&xQueue->lock);
+  pthread_cleanup_push(unlock, &xQueue->lock);
+  while ((xQueue->count == 0) && (wait(&xQueue->not_empty, &xQueue->lock, xTicksToWait, &ts) == 0))
+  {
+  }
+  if (xQueue->count > 0)
+  {
+    if (xQueue->item_size != 0)
+    {
+      memcpy(pvBuffer, &xQueue->items[xQueue->head * xQueue->item_size], xQueue->item_size);
+    }
+    xQueue->head = (xQueue->head + 1) % xQueue->length;
+    xQueue->count--;
+    (void)pthread_cond_signal(&xQueue->not_full);
+    ret = pdPASS;
+  }
+  pthread_cleanup_pop(1);
+  return ret;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *const pvBuffer, TickType_t xTicksToWait)
+{
+  volatile BaseType_t ret = pdFAIL;
+  struct timespec ts;
+
+  deadline(xTicksToWait, &ts);
+  (void)pthread_mutex_lock(&xQueue->lock);
+  pthread_cleanup_push(unlock, &xQueue->lock);
+  while ((xQueue->count == 0) && (wait(&xQueue->not_empty, &xQueue->lock, xTicksToWait, &ts) == 0))
+  {
+  }
+  if (xQueue->count > 0)
+  {
+    if (xQueue->item_size != 0)
+    {
+      memcpy(pvBuffer, &xQueue->items[xQueue->head * xQueue->item_size], xQueue->item_size);
+    }
+    ret = pdPASS;
+  }
+  pthread_cleanup_pop(1);
+  return ret;
+}
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue)
+{
+  UBaseType_t count;
+
+  (void)pthread_mutex_lock(&xQueue->lock);
+  count = xQueue->count;
+  (void)pthread_mutex_unlock(&xQueue->lock);
+  return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(const QueueHandle_t xQueue)
+{
+  UBaseType_t spaces;
+
+  (void)pthread_mutex_lock(&xQueue->lock);
+  spaces = xQueue->length - xQueue->count;
+  (void)pthread_mutex_unlock(&xQueue->lock);
+  return spaces;
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue)
+{
+  (void)pthread_mutex_lock(&xQueue->lock);
+  xQueue->count = 0;
+  xQueue->head = 0;
+  (void)pthread_cond_broadcast(&xQueue->not_full);
+  (void)pthread_mutex_unlock(&xQueue->lock);
+  return pdPASS;
+}
+
+/* Event groups --------------------------------------------------------------*/
+EventGroupHandle_t xEventGroupCreate(void)
+{
+  EventGroupHandle_t group = calloc(1, sizeof(*group));
+
+  if (group != NULL)
+  {
+    (void)pthread_mutex_init(&group->lock, NULL);
+    cond_init(&group->cond);
+  }
+  return group;
+}
+
+void vEventGroupDelete(EventGroupHandle_t xEventGroup)
+{
+  if (xEventGroup == NULL)
+  {
+    return;
+  }
+  (void)pthread_cond_destroy(&xEventGroup->cond);
+  (void)pthread_mutex_destroy(&xEventGroup->lock);
+  free(xEventGroup);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet)
+{
+  EventBits_t bits;
+
+  (void)pthread_mutex_lock(&xEventGroup->lock);
+  xEventGroup->bits |= uxBitsToSet;
+  bits = xEventGroup->bits;
+  (void)pthread_cond_broadcast(&xEventGroup->cond);
+  (void)pthread_mutex_unlock(&xEventGroup->lock);
+  return bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear)
+{
+  EventBits_t bits;
+
+  (void)pthread_mutex_lock(&xEventGroup->lock);
+  bits = xEventGroup->bits;
+  xEventGroup->bits &= ~uxBitsToClear;
+  (void)pthread_mutex_unlock(&xEventGroup->lock);
+  return bits;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t xEventGroup)
+{
+  EventBits_t bits;
+
+  (void)pthread_mutex_lock(&xEventGroup->lock);
+  bits = xEventGroup->bits;
+  (void)pthread_mutex_unlock(&xEventGroup->lock);
+  return bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToWaitFor,
+                                const BaseType_t xClearOnExit, const BaseType_t xWaitForAllBits,
+                                TickType_t xTicksToWait)
+{
+  struct timespec ts;
+  EventBits_t bits;
+  int done;
+
+  deadline(xTicksToWait, &ts);
+  (void)pthread_mutex_lock(&xEventGroup->lock);
+  pthread_cleanup_push(unlock, &xEventGroup->lock);
+  do
+  {
+    bits = xEventGroup->bits;
+    done = (xWaitForAllBits != pdFALSE) ? ((bits & uxBitsToWaitFor) == uxBitsToWaitFor) :
+           ((bits & uxBitsToWaitFor) != 0);
+  } while (!done && (wait(&xEventGroup->cond, &xEventGroup->lock, xTicksToWait, &ts) == 0));
+  if (done && (xClearOnExit != pdFALSE))
+  {
+    xEventGroup->bits &= ~uxBitsToWaitFor;
+  }
+  pthread_cleanup_pop(1);
+  return bits;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet,
+                                     BaseType_t *pxHigherPriorityTaskWoken)
+{
+  (void)xEventGroupSetBits(xEventGroup, uxBitsToSet);
+  if (pxHigherPriorityTaskWoken != NULL)
+  {
+    *pxHigherPriorityTaskWoken = pdFALSE;
+  }
+  return pdPASS;
+}
+
+/* Private Functions Definition ----------------------------------------------*/
+static void clock_init(void)
+{
+  (void)clock_gettime(CLOCK_MONOTONIC, &clock_origin);
+}
+
+static void cond_init(pthread_cond_t *cond)
+{
+  pthread_condattr_t attr;
+
+  (void)pthread_condattr_init(&attr);
+  (void)pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  (void)pthread_cond_init(cond, &attr);
+  (void)pthread_condattr_destroy(&attr);
+}
+
+/* Absolute time of a timeout, unused for 0 and portMAX_DELAY */
+static void deadline(TickType_t ticks, struct timespec *ts)
+{
+  if ((ticks == 0) || (ticks == portMAX_DELAY))
+  {
+    return;
+  }
+  (void)clock_gettime(CLOCK_MONOTONIC, ts);
+  ts->tv_sec += ticks / configTICK_RATE_HZ;
+  ts->tv_nsec += (long)(ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ);
+  if (ts->tv_nsec >= 1000000000L)
+  {
+    ts->tv_sec++;
+    ts->tv_nsec -= 1000000000L;
+  }
+}
+
+/* Return 0 when woken up, -1 once the timeout has elapsed */
+static int wait(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks, const struct timespec *ts)
+{
+  if (ticks == 0)
+  {
+    return -1;
+  }
+  if (ticks == portMAX_DELAY)
+  {
+    return (pthread_cond_wait(cond, lock) == 0) ? 0 : -1;
+  }
+  return (pthread_cond_timedwait(cond, lock, ts) == ETIMEDOUT) ? -1 : 0;
+}
+
+static void unlock(void *lock)
+{
+  (void)pthread_mutex_unlock((pthread_mutex_t *)lock);
+}
+
+static void *task_entry(void *arg)
+{
+  current_task = (TaskHandle_t)arg;
+  current_task->code(current_task->arg);
+  /* A FreeRTOS task must not return, delete it like the kernel would assert */
+  vTaskDelete(NULL);
+  return NULL;
+}
+
+static TaskHandle_t task_alloc(const char *name, UBaseType_t priority)
+{
+  TaskHandle_t task = calloc(1, sizeof(*task));
+
+  if (task == NULL)
+  {
+    return NULL;
+  }
+  (void)pthread_mutex_init(&task->lock, NULL);
+  cond_init(&task->cond);
+  task->priority = priority;
+  if (name != NULL)
+  {
+    strncpy(task->name, name, sizeof(task->name) - 1);
+  }
+  return task;
+}
@@ -0,0 +1,25 @@
+/**
+  ******************************************************************************
+  * @file    message_buffer.h
+  * @brief   Host shim of the FreeRTOS message buffer API, no function is used by the driver
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef MESSAGE_BUFFER_H
+#define MESSAGE_BUFFER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+
+#endif /* MESSAGE_BUFFER_H */
@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file    queue.h
+  * @brief   Host shim of the FreeRTOS queue API on POSIX threads
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_QUEUE_H
+#define INC_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct QueueDefinition *QueueHandle_t;
+
+/* Exported macros -----------------------------------------------------------*/
+#define xQueueSend(q, item, ticks)          xQueueGenericSend((q), (item), (ticks), 0)
+#define xQueueSendToBack(q, item, ticks)    xQueueGenericSend((q), (item), (ticks), 0)
+#define xQueueSendToFront(q, item, ticks)   xQueueGenericSend((q), (item), (ticks), 1)
+#define xQueueSendFromISR(q, item, woken)   ((void)(woken), xQueueGenericSend((q), (item), 0, 0))
+
+/* Exported functions ------------------------------------------------------- */
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+void vQueueDelete(QueueHandle_t xQueue);
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void *const pvItemToQueue, TickType_t xTicksToWait,
+                             BaseType_t xFront);
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *const pvBuffer, TickType_t xTicksToWait);
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *const pvBuffer, TickType_t xTicksToWait);
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue);
+UBaseType_t uxQueueSpacesAvailable(const QueueHandle_t xQueue);
+BaseType_t xQueueReset(QueueHandle_t xQueue);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* INC_QUEUE_H */
@@ -0,0 +1,57 @@
+/**
+  ******************************************************************************
+  * @file    semphr.h
+  * @brief   Host shim of the FreeRTOS semaphore API on POSIX threads
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "queue.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Like the kernel, a semaphore is a queue of zero-sized items */
+typedef QueueHandle_t SemaphoreHandle_t;
+/* Static semaphores are allocated on the heap like the others, the buffer is unused */
+typedef struct
+{
+  void *pvDummy;
+} StaticSemaphore_t;
+
+/* Exported macros -----------------------------------------------------------*/
+#define xSemaphoreCreateBinary()                    xQueueCreateCountingSemaphore(1, 0)
+#define xSemaphoreCreateCounting(max, initial)      xQueueCreateCountingSemaphore((max), (initial))
+#define xSemaphoreCreateMutex()                     xQueueCreateCountingSemaphore(1, 1)
+#define xSemaphoreCreateBinaryStatic(buf)           ((void)(buf), xQueueCreateCountingSemaphore(1, 0))
+#define vSemaphoreDelete(sem)                       vQueueDelete((QueueHandle_t)(sem))
+#define xSemaphoreTake(sem, ticks)                  xQueueReceive((QueueHandle_t)(sem), NULL, (ticks))
+#define xSemaphoreGive(sem)                         xQueueGenericSend((QueueHandle_t)(sem), NULL, 0, 0)
+#define xSemaphoreTakeFromISR(sem, woken)           ((void)(woken), xQueueReceive((QueueHandle_t)(sem), NULL, 0))
+#define xSemaphoreGiveFromISR(sem, woken)           ((void)(woken), xQueueGenericSend((QueueHandle_t)(sem), NULL, 0, 0))
+#define uxSemaphoreGetCount(sem)                    uxQueueMessagesWaiting((QueueHandle_t)(sem))
+
+/* Exported functions ------------------------------------------------------- */
+QueueHandle_t xQueueCreateCountingSemaphore(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SEMAPHORE_H */
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file    task.h
+  * @brief   Host shim of the FreeRTOS task API on POSIX threads
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct tskTaskControlBlock *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+/* Exported macros -----------------------------------------------------------*/
+#define taskENTER_CRITICAL()                vPortEnterCritical()
+#define taskEXIT_CRITICAL()                 vPortExitCritical()
+#define taskENTER_CRITICAL_FROM_ISR()       (vPortEnterCritical(), 0)
+#define taskEXIT_CRITICAL_FROM_ISR(x)       ((void)(x), vPortExitCritical())
+#define taskYIELD()                         vTaskDelay(0)
+
+/* Exported functions ------------------------------------------------------- */
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *const pcName, const uint32_t usStackDepth,
+                       void *const pvParameters, UBaseType_t uxPriority, TaskHandle_t *const pxCreatedTask);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(const TickType_t xTicksToDelay);
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+char *pcTaskGetName(TaskHandle_t xTaskToQuery);
+UBaseType_t uxTaskPriorityGet(const TaskHandle_t xTask);
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* INC_TASK_H */
@@ -0,0 +1,25 @@
+/**
+  ******************************************************************************
+  * @file    trcRecorder.h
+  * @brief   Host shim of the trace recorder, tracing is disabled
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TRC_RECORDER_H
+#define TRC_RECORDER_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+
+#endif /* TRC_RECORDER_H */
@@ -0,0 +1,350 @@
+/**
+  ******************************************************************************
+  * @file    http_parser_fuzz.c
+  * @brief   Host split-input fuzz test of the HTTP response parser
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Core/w6x_http_parser.c is fed from slices of any size, as they come out of the socket.
+ * Each response of the corpus is parsed whole, split in two at every offset and byte by
+ * byte: the outcome, the response properties, the bytes consumed and the body delivered
+ * must be the same every time, and the outcome must be the one expected by the file.
+ * Mutations of the corpus files (byte changes, insertions, deletions) are then checked the
+ * same way, without expected outcome. The random generator restarts from the seed for each
+ * file, a failure is replayed by running the file alone with the same seed.
+ *
+ * A corpus file starts with a line giving the expected outcome, "complete", "error" or
+ * "cut" (the connection ends before the response), followed by "head" for the response to
+ * a HEAD request. The rest of the file is the response as received.
+ *
+ * Usage: http_parser_fuzz [-n mutations per file] [-s seed] corpus files
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "w6x_http_parser.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define FUZZ_MAX_INPUT      4096
+
+#define FUZZ_COMPLETE       0
+#define FUZZ_ERROR          1
+#define FUZZ_CUT            2
+
+/* Private typedef -----------------------------------------------------------*/
+/** Outcome of the parsing of an input */
+typedef struct
+{
+  int32_t outcome;            /*!< FUZZ_COMPLETE, FUZZ_ERROR or FUZZ_CUT */
+  uint32_t consumed;          /*!< Bytes consumed up to the end of the response or the error */
+  uint8_t flags;              /*!< Parser flags */
+  uint16_t version;           /*!< HTTP version */
+  uint16_t status;            /*!< Status code */
+  uint32_t content_length;    /*!< Content-Length value */
+  uint32_t header_len;        /*!< Header length given to the header callback */
+  uint32_t headers_calls;     /*!< Calls of the header callback */
+  int32_t keep_alive;         /*!< Keep-alive verdict of a complete response */
+  uint32_t body_len;          /*!< Body bytes delivered */
+  uint8_t body[FUZZ_MAX_INPUT]; /*!< Body delivered */
+} fuzz_result_t;
+
+/* Private variables ---------------------------------------------------------*/
+static const char *const outcome_names[] = {"complete", "error", "cut"};
+
+static fuzz_result_t reference;
+static fuzz_result_t result;
+static uint8_t mutant[FUZZ_MAX_INPUT];
+static uint32_t cuts[FUZZ_MAX_INPUT];
+static uint32_t seed = 0x12345678U;
+static uint32_t rng_state;
+static uint32_t runs;
+static uint32_t failures;
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t fuzz_headers_cb(void *arg, const W6X_HTTP_Parser_t *parser);
+static int32_t fuzz_body_cb(void *arg, const uint8_t *data, uint32_t len);
+static void fuzz_run(const uint8_t *data, uint32_t len, uint8_t flags, const uint32_t *ends, uint32_t count,
+                     fuzz_result_t *res);
+static int32_t fuzz_same(const fuzz_result_t *a, const fuzz_result_t *b);
+static int32_t fuzz_check(const char *name, const uint8_t *data, uint32_t len, uint8_t flags, int32_t expected);
+static uint32_t fuzz_rand(void);
+static uint32_t fuzz_mutate(const uint8_t *data, uint32_t len);
+static int32_t fuzz_file(const char *name, uint32_t mutations);
+
+/* Functions Definition ------------------------------------------------------*/
+int main(int argc, char **argv)
+{
+  uint32_t mutations = 1000;
+  int32_t files = 0;
+
+  for (int32_t i = 1; i < argc; i++)
+  {
+    if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc))
+    {
+      mutations = strtoul(argv[++i], NULL, 0);
+    }
+    else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+    {
+      seed = strtoul(argv[++i], NULL, 0) | 1U;
+    }
+    else if (fuzz_file(argv[i], mutations) == 0)
+    {
+      files++;
+    }
+    else
+    {
+      failures++;
+    }
+  }
+
+  if (files == 0)
+  {
+    fprintf(stderr, "usage: %s [-n mutations per file] [-s seed] corpus files\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  printf("%d files, %u parser runs, %u failures\n", (int)files, (unsigned)runs, (unsigned)failures);
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Private Functions Definition ----------------------------------------------*/
+static int32_t fuzz_headers_cb(void *arg, const W6X_HTTP_Parser_t *parser)
+{
+  fuzz_result_t *res = (fuzz_result_t *)arg;
+
+  res->header_len = parser->header_len;
+  res->headers_calls++;
+  return 0;
+}
+
+static int32_t fuzz_body_cb(void *arg, const uint8_t *data, uint32_t len)
+{
+  fuzz_result_t *res = (fuzz_result_t *)arg;
+
+  /* The body is a part of the input, it cannot overflow */
+  if (res->body_len + len > FUZZ_MAX_INPUT)
+  {
+    return -1;
+  }
+  memcpy(&res->body[res->body_len], data, len);
+  res->body_len += len;
+  return 0;
+}
+
+/* Parse data delivered in count slices, ends giving the end offset of each */
+static void fuzz_run(const uint8_t *data, uint32_t len, uint8_t flags, const uint32_t *ends, uint32_t count,
+                     fuzz_result_t *res)
+{
+  W6X_HTTP_Parser_t parser;
+  uint32_t pos = 0;
+  int32_t n;
+
+  memset(res, 0, sizeof(*res) - sizeof(res->body));
+  W6X_HTTP_Parser_Init(&parser, flags, fuzz_headers_cb, fuzz_body_cb, res);
+  runs++;
+
+  for (uint32_t i = 0; (i < count) && (parser.state != W6X_HTTP_PARSER_STATE_COMPLETE); i++)
+  {
+    n = W6X_HTTP_Parser_Execute(&parser, &data[pos], ends[i] - pos);
+    if (n < 0)
+    {
+      res->outcome = FUZZ_ERROR;
+      res->consumed = pos;
+      return;
+    }
+    pos += (uint32_t)n;
+    if ((parser.state != W6X_HTTP_PARSER_STATE_COMPLETE) && (pos != ends[i]))
+    {
+      /* The whole slice is consumed unless the response ends in it */
+      res->outcome = FUZZ_ERROR;
+      res->consumed = UINT32_MAX;
+      return;
+    }
+  }
+
+  res->outcome = (W6X_HTTP_Parser_Finish(&parser) == 0) ? FUZZ_COMPLETE : FUZZ_CUT;
+  res->consumed = pos;
+  res->flags = parser.flags;
+  res->version = parser.version;
+  res->status = parser.status;
+  res->content_length = parser.content_length;
+  res->keep_alive = W6X_HTTP_Parser_Keep_Alive(&parser);
+}
+
+static int32_t fuzz_same(const fuzz_result_t *a, const fuzz_result_t *b)
+{
+  /* The error offset depends on the slice in which it is detected */
+  if ((a->outcome == FUZZ_ERROR) || (b->outcome == FUZZ_ERROR))
+  {
+    return (a->outcome == b->outcome) && (a->consumed != UINT32_MAX) && (b->consumed != UINT32_MAX);
+  }
+  return (a->outcome == b->outcome) && (a->consumed == b->consumed) && (a->flags == b->flags) &&
+         (a->version == b->version) && (a->status == b->status) && (a->content_length == b->content_length) &&
+         (a->header_len == b->header_len) && (a->headers_calls == b->headers_calls) &&
+         (a->keep_alive == b->keep_alive) && (a->body_len == b->body_len) &&
+         (memcmp(a->body, b->body, a->body_len) == 0);
+}
+
+/* Parse data whole, split at every offset and byte by byte, expected is -1 when unknown */
+static int32_t fuzz_check(const char *name, const uint8_t *data, uint32_t len, uint8_t flags, int32_t expected)
+{
+  uint32_t split[2];
+
+  split[1] = len;
+  fuzz_run(data, len, flags, &split[1], 1, &reference);
+  if ((expected >= 0) && (reference.outcome != expected))
+  {
+    printf("FAILED: %s: %s, %s expected\n", name, outcome_names[reference.outcome], outcome_names[expected]);
+    return -1;
+  }
+  if ((reference.outcome == FUZZ_COMPLETE) && (reference.headers_calls != 1U))
+  {
+    printf("FAILED: %s: header callback called %u times\n", name, (unsigned)reference.headers_calls);
+    return -1;
+  }
+
+  for (split[0] = 0; split[0] <= len; split[0]++)
+  {
+    fuzz_run(data, len, flags, split, 2, &result);
+    if (!fuzz_same(&reference, &result))
+    {
+      printf("FAILED: %s: %s whole, %s split at %u\n", name, outcome_names[reference.outcome],
+             outcome_names[result.outcome], (unsigned)split[0]);
+      return -1;
+    }
+  }
+
+  for (uint32_t i = 0; i < len; i++)
+  {
+    cuts[i] = i + 1U;
+  }
+  fuzz_run(data, len, flags, cuts, len, &result);
+  if (!fuzz_same(&reference, &result))
+  {
+    printf("FAILED: %s: %s whole, %s byte by byte\n", name, outcome_names[reference.outcome],
+           outcome_names[result.outcome]);
+    return -1;
+  }
+  return 0;
+}
+
+static uint32_t fuzz_rand(void)
+{
+  /* xorshift32 */
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static uint32_t fuzz_mutate(const uint8_t *data, uint32_t len)
+{
+  /* Bytes the parser gives a meaning to, more likely to reach its corner cases */
+  static const uint8_t interesting[] = "\r\n :;,0123456789aAfF";
+  uint32_t edits = 1U + (fuzz_rand() % 4U);
+  uint32_t pos;
+
+  memcpy(mutant, data, len);
+  for (uint32_t i = 0; i < edits; i++)
+  {
+    pos = (len > 0U) ? fuzz_rand() % len : 0U;
+    switch (fuzz_rand() % 4U)
+    {
+      case 0:
+        if (len > 0U)
+        {
+          mutant[pos] = (uint8_t)fuzz_rand();
+        }
+        break;
+      case 1:
+        if (len > 0U)
+        {
+          mutant[pos] = interesting[fuzz_rand() % (sizeof(interesting) - 1U)];
+        }
+        break;
+      case 2:
+        if (len < FUZZ_MAX_INPUT)
+        {
+          memmove(&mutant[pos + 1U], &mutant[pos], len - pos);
+          mutant[pos] = interesting[fuzz_rand() % (sizeof(interesting) - 1U)];
+          len++;
+        }
+        break;
+      default:
+        if (len > 0U)
+        {
+          memmove(&mutant[pos], &mutant[pos + 1U], len - pos - 1U);
+          len--;
+        }
+        break;
+    }
+  }
+  return len;
+}
+
+static int32_t fuzz_file(const char *name, uint32_t mutations)
+{
+  static uint8_t data[FUZZ_MAX_INPUT + 1];
+  char line[32] = {0};
+  uint8_t flags = 0;
+  int32_t expected = -1;
+  uint32_t len;
+  uint32_t mutant_len;
+  FILE *f;
+
+  f = fopen(name, "rb");
+  if ((f == NULL) || (fgets(line, sizeof(line), f) == NULL))
+  {
+    printf("FAILED: %s: cannot be read\n", name);
+    if (f != NULL)
+    {
+      (void)fclose(f);
+    }
+    return -1;
+  }
+  len = (uint32_t)fread(data, 1, sizeof(data), f);
+  (void)fclose(f);
+
+  for (int32_t i = 0; i < 3; i++)
+  {
+    if (strncmp(line, outcome_names[i], strlen(outcome_names[i])) == 0)
+    {
+      expected = i;
+    }
+  }
+  if ((expected < 0) || (len > FUZZ_MAX_INPUT))
+  {
+    printf("FAILED: %s: no expected outcome or larger than %d bytes\n", name, FUZZ_MAX_INPUT);
+    return -1;
+  }
+  flags = (strstr(line, "head") != NULL) ? W6X_HTTP_PARSER_FLAG_NO_BODY : 0U;
+  rng_state = seed;
+
+  if (fuzz_check(name, data, len, flags, expected) != 0)
+  {
+    return -1;
+  }
+  for (uint32_t i = 0; i < mutations; i++)
+  {
+    mutant_len = fuzz_mutate(data, len);
+    if (fuzz_check(name, mutant, mutant_len, flags, -1) != 0)
+    {
+      printf("  mutation %u of seed 0x%08X\n", (unsigned)i, (unsigned)seed);
+      return -1;
+    }
+  }
+  return 0;
+}
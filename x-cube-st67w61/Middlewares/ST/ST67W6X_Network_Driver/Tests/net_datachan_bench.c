@@ -0,0 +1,233 @@
+/**
+  ******************************************************************************
+  * @file    net_datachan_bench.c
+  * @brief   Host benchmark of the socket data path, AT commands versus data channel
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*
+ * The whole driver stack runs on the FreeRTOS POSIX shim against the simulated NCP of
+ * Driver/W61_bus/spi_port_sim.c, which loops the data sent on a socket back to it. Each
+ * round sends a burst of chunks without reading, then reads the echo back and checks it.
+ * A burst larger than W61_NET_DATA_CHANNEL_RXQ_LEN exercises the receive window: no
+ * message may be lost and the SPI task never waits for the reader.
+ *
+ * The binary is built once with W61_NET_DATA_CHANNEL_ENABLE=0 (AT+CIPSEND / +IPD /
+ * AT+CIPRECVDATA) and once with 1 (SPI_MSG_CTRL_TRAFFIC_SOCKET_DATA messages).
+ * The host throughput only compares the CPU cost of the two paths. The bus cost is taken
+ * from the simulated NCP counters: SPI transactions and bytes clocked per KB echoed, and
+ * the bus time they would take at the given SPI clock with the given per-transaction
+ * turnaround (CS, RDY handshake and header exchange). Both times are simply added, the
+ * overlap of host processing and bus transfers on a target is not modeled.
+ *
+ * Usage: net_datachan_bench [chunk bytes] [chunks per burst] [rounds] [SPI Hz] [turnaround us]
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "w61_at_api.h"
+#include "spi_port_sim.h"
+#include "logging.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define BENCH_SOCKET        0
+#define BENCH_MAX_DATA      4096
+#define BENCH_TIMEOUT_MS    2000
+
+/* Private variables ---------------------------------------------------------*/
+static SemaphoreHandle_t data_event;
+static uint8_t tx_data[BENCH_MAX_DATA];
+static uint8_t rx_data[BENCH_MAX_DATA];
+
+static uint32_t chunk = 512;
+static uint32_t burst = 8;
+static uint32_t rounds = 2000;
+static double spi_hz = 40e6;
+static double turnaround_us = 10.0;
+static int32_t result = EXIT_FAILURE;
+
+/* Private function prototypes -----------------------------------------------*/
+static void bench_log_output(const char *message);
+static void bench_net_cb(W61_event_id_t event_id, void *event_args);
+static int32_t bench_round(W61_Object_t *Obj, uint32_t round);
+static double bench_now(void);
+static void bench_task(void *arg);
+
+/* Functions Definition ------------------------------------------------------*/
+int main(int argc, char **argv)
+{
+  TaskHandle_t task;
+
+  chunk = (argc > 1) ? strtoul(argv[1], NULL, 0) : chunk;
+  burst = (argc > 2) ? strtoul(argv[2], NULL, 0) : burst;
+  rounds = (argc > 3) ? strtoul(argv[3], NULL, 0) : rounds;
+  spi_hz = (argc > 4) ? strtod(argv[4], NULL) : spi_hz;
+  turnaround_us = (argc > 5) ? strtod(argv[5], NULL) : turnaround_us;
+  if ((chunk == 0) || (burst == 0) || (rounds == 0) || (chunk * burst > BENCH_MAX_DATA))
+  {
+    fprintf(stderr, "chunk x burst must be in 1..%d\n", BENCH_MAX_DATA);
+    return EXIT_FAILURE;
+  }
+
+  (void)vLoggingInit(bench_log_output);
+  data_event = xSemaphoreCreateBinary();
+  if ((data_event == NULL) || (xTaskCreate(bench_task, "bench", 4096, NULL, 20, &task) != pdPASS))
+  {
+    return EXIT_FAILURE;
+  }
+
+  /* The benchmark task ends the process */
+  while (1)
+  {
+    vTaskDelay(1000);
+  }
+}
+
+/* Private Functions Definition ----------------------------------------------*/
+static void bench_log_output(const char *message)
+{
+  fputs(message, stderr);
+}
+
+static void bench_net_cb(W61_event_id_t event_id, void *event_args)
+{
+  if (event_id == W61_NET_EVT_SOCK_DATA_ID)
+  {
+    (void)xSemaphoreGive(data_event);
+  }
+}
+
+static int32_t bench_round(W61_Object_t *Obj, uint32_t round)
+{
+  uint32_t total = chunk * burst;
+  uint32_t received = 0;
+  uint32_t len;
+
+  for (uint32_t i = 0; i < total; i++)
+  {
+    tx_data[i] = (uint8_t)(round * 31 + i);
+  }
+
+  for (uint32_t i = 0; i < burst; i++)
+  {
+    if ((W61_Net_SendData(Obj, BENCH_SOCKET, &tx_data[i * chunk], chunk, &len, BENCH_TIMEOUT_MS) != W61_STATUS_OK) ||
+        (len != chunk))
+    {
+      fprintf(stderr, "round %u: send failed\n", (unsigned)round);
+      return -1;
+    }
+  }
+
+  while (received < total)
+  {
+    if (W61_Net_PullDataFromSocket(Obj, BENCH_SOCKET, total - received, &rx_data[received], &len,
+                                   BENCH_TIMEOUT_MS) != W61_STATUS_OK)
+    {
+      fprintf(stderr, "round %u: read failed after %u bytes\n", (unsigned)round, (unsigned)received);
+      return -1;
+    }
+    received += len;
+    if ((len == 0) && (xSemaphoreTake(data_event, pdMS_TO_TICKS(BENCH_TIMEOUT_MS)) != pdTRUE))
+    {
+      fprintf(stderr, "round %u: %u bytes missing\n", (unsigned)round, (unsigned)(total - received));
+      return -1;
+    }
+  }
+
+  if (memcmp(tx_data, rx_data, total) != 0)
+  {
+    fprintf(stderr, "round %u: echo corrupted\n", (unsigned)round);
+    return -1;
+  }
+  return 0;
+}
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void bench_task(void *arg)
+{
+  W61_Object_t *Obj = W61_ObjGet();
+  W61_Net_Connection_t conn = {0};
+  struct spi_port_sim_stat start;
+  struct spi_port_sim_stat end;
+  double kbytes;
+  double host_s;
+  double bus_s;
+  double t0;
+
+  (void)W61_RegisterULcb(Obj, NULL, NULL, bench_net_cb, NULL, NULL);
+  if ((W61_Init(Obj) != W61_STATUS_OK) || (W61_Net_Init(Obj) != W61_STATUS_OK))
+  {
+    fprintf(stderr, "driver init failed\n");
+    goto __exit;
+  }
+
+  conn.Protocol = W61_NET_TCP_CONNECTION;
+  conn.Number = BENCH_SOCKET;
+  conn.RemotePort = 5001;
+  strncpy(conn.RemoteIP, "192.168.1.10", sizeof(conn.RemoteIP) - 1);
+  if (W61_Net_StartClientConnection(Obj, &conn) != W61_STATUS_OK)
+  {
+    fprintf(stderr, "connection failed\n");
+    goto __exit;
+  }
+
+  (void)spi_port_sim_get_stats(&start);
+  t0 = bench_now();
+  for (uint32_t round = 0; round < rounds; round++)
+  {
+    if (bench_round(Obj, round) != 0)
+    {
+      goto __exit;
+    }
+  }
+  host_s = bench_now() - t0;
+  (void)spi_port_sim_get_stats(&end);
+
+  /* The bus is full duplex, the data sent and its echo are clocked in the same transactions */
+  kbytes = (double)chunk * burst * rounds / 1024.0;
+  bus_s = (double)(end.bytes_clocked - start.bytes_clocked) * 8.0 / spi_hz +
+          (double)(end.transactions - start.transactions) * turnaround_us * 1e-6;
+  printf("%-12s chunk %5u x %2u: host %7.2f MB/s | per KB: %6.2f SPI transactions, %7.1f bytes clocked, "
+         "%5.2f AT commands | bus %6.2f Mbit/s at %.0f MHz, %.0f us turnaround\n",
+         (W61_NET_DATA_CHANNEL_ENABLE == 1) ? "data channel" : "AT commands", (unsigned)chunk, (unsigned)burst,
+         kbytes / 1024.0 / host_s,
+         (double)(end.transactions - start.transactions) / kbytes,
+         (double)(end.bytes_clocked - start.bytes_clocked) / kbytes,
+         (double)(end.at_cmds - start.at_cmds) / kbytes,
+         kbytes * 1024.0 * 8.0 / bus_s / 1e6, spi_hz / 1e6, turnaround_us);
+
+  if (end.drops != start.drops)
+  {
+    fprintf(stderr, "%u frames dropped by the NCP\n", (unsigned)(end.drops - start.drops));
+    goto __exit;
+  }
+  result = EXIT_SUCCESS;
+
+__exit:
+  exit(result);
+}
@@ -0,0 +1,203 @@
+/**
+  ******************************************************************************
+  * @file    spi_buf_pool_stress.c
+  * @brief   Host stress test of the lock-free SPI buffer pool
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Several threads allocate and release the slots of one pool class concurrently.
+ * Each slot carries an owner word taken with an atomic exchange on allocation: finding
+ * it already owned means the slot has been handed out twice. The owner also stamps the
+ * slot payload and checks it before the release. At the end every slot must be free,
+ * the counters balanced, and the whole class allocatable again: no slot was lost.
+ *
+ * Usage: spi_buf_pool_stress [threads] [iterations per thread]
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spi_buf_pool.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define POOL_COUNT      32
+#define POOL_SLOT_SIZE  64
+#define MAX_THREADS     64
+#define HOLD_MAX        4
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t pool_mem[POOL_COUNT * POOL_SLOT_SIZE];
+
+static struct spi_buffer_pool pool =
+{
+  .mem = pool_mem,
+  .slot_size = POOL_SLOT_SIZE,
+  .cap = POOL_SLOT_SIZE,
+  .count = POOL_COUNT,
+};
+
+/* Thread currently owning each slot, 0 if free */
+static atomic_uint owner[POOL_COUNT];
+
+static atomic_uint failures;
+static atomic_ulong alloc_count;
+static atomic_ulong release_count;
+static unsigned long iterations;
+
+/* Private functions ---------------------------------------------------------*/
+static void fail(const char *what, uint32_t slot, unsigned id)
+{
+  if (atomic_fetch_add(&failures, 1) < 10)
+  {
+    fprintf(stderr, "error: %s, slot %u, thread %u\n", what, (unsigned)slot, id);
+  }
+}
+
+static uint32_t slot_of(const uint8_t *p)
+{
+  return (uint32_t)((p - pool_mem) / POOL_SLOT_SIZE);
+}
+
+static void *worker(void *arg)
+{
+  unsigned id = (unsigned)(uintptr_t)arg;
+  uint8_t *held[HOLD_MAX];
+  unsigned n = 0;
+  unsigned seed = id;
+
+  for (unsigned long i = 0; i < iterations; i++)
+  {
+    /* Hold a few buffers at a time to keep the class close to exhaustion */
+    if ((n < HOLD_MAX) && ((n == 0) || (rand_r(&seed) & 1)))
+    {
+      uint8_t *p = spi_buffer_pool_get(&pool);
+      if (p != NULL)
+      {
+        uint32_t slot = slot_of(p);
+        if ((p - pool_mem) % POOL_SLOT_SIZE != 0)
+        {
+          fail("misaligned slot", slot, id);
+        }
+        if (atomic_exchange(&owner[slot], id) != 0)
+        {
+          fail("slot handed out twice", slot, id);
+        }
+        memset(p, (int)id, POOL_SLOT_SIZE);
+        held[n++] = p;
+        atomic_fetch_add(&alloc_count, 1);
+      }
+    }
+    else if (n > 0)
+    {
+      uint8_t *p = held[--n];
+      uint32_t slot = slot_of(p);
+      for (uint32_t j = 0; j < POOL_SLOT_SIZE; j++)
+      {
+        if (p[j] != (uint8_t)id)
+        {
+          fail("slot written by another owner", slot, id);
+          break;
+        }
+      }
+      if (atomic_exchange(&owner[slot], 0) != id)
+      {
+        fail("slot owner changed", slot, id);
+      }
+      if (spi_buffer_pool_put(&pool, p) != 1)
+      {
+        fail("slot not recognized", slot, id);
+      }
+      atomic_fetch_add(&release_count, 1);
+    }
+    if ((i & 0xFF) == 0)
+    {
+      sched_yield();
+    }
+  }
+
+  while (n > 0)
+  {
+    uint8_t *p = held[--n];
+    atomic_store(&owner[slot_of(p)], 0);
+    spi_buffer_pool_put(&pool, p);
+    atomic_fetch_add(&release_count, 1);
+  }
+  return NULL;
+}
+
+int main(int argc, const char *argv[])
+{
+  unsigned threads = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 10) : 8;
+  pthread_t tid[MAX_THREADS];
+  void *all[POOL_COUNT];
+  uint32_t slot;
+
+  iterations = (argc > 2) ? strtoul(argv[2], NULL, 10) : 200000;
+  if ((threads == 0) || (threads > MAX_THREADS))
+  {
+    fprintf(stderr, "error: threads must be in [1, %d]\n", MAX_THREADS);
+    return 1;
+  }
+
+  for (unsigned i = 0; i < threads; i++)
+  {
+    /* Thread ids start at 1, 0 marks a free slot */
+    if (pthread_create(&tid[i], NULL, worker, (void *)(uintptr_t)(i + 1)) != 0)
+    {
+      fprintf(stderr, "error: pthread_create\n");
+      return 1;
+    }
+  }
+  for (unsigned i = 0; i < threads; i++)
+  {
+    pthread_join(tid[i], NULL);
+  }
+
+  if (atomic_load(&alloc_count) != atomic_load(&release_count))
+  {
+    fail("unbalanced get/put", 0, 0);
+  }
+  if ((atomic_load(&pool.used) != 0) || (atomic_load(&pool.in_use) != 0))
+  {
+    fail("slots left allocated", 0, 0);
+  }
+  if (atomic_load(&pool.hwm) > POOL_COUNT)
+  {
+    fail("high-water mark above the class size", 0, 0);
+  }
+
+  /* No slot lost: the whole class is allocatable again, each slot once */
+  for (slot = 0; slot < POOL_COUNT; slot++)
+  {
+    all[slot] = spi_buffer_pool_get(&pool);
+    if ((all[slot] == NULL) || (atomic_exchange(&owner[slot_of(all[slot])], 1) != 0))
+    {
+      fail("slot lost", slot, 0);
+      break;
+    }
+  }
+  if (spi_buffer_pool_get(&pool) != NULL)
+  {
+    fail("class larger than its count", POOL_COUNT, 0);
+  }
+
+  printf("%u threads, %lu iterations: %lu allocations, %lu exhausted, hwm %u/%d, %u failures\n",
+         threads, iterations, (unsigned long)atomic_load(&alloc_count), (unsigned long)atomic_load(&pool.alloc_fail),
+         (unsigned)atomic_load(&pool.hwm), POOL_COUNT, (unsigned)atomic_load(&failures));
+  return (atomic_load(&failures) == 0) ? 0 : 1;
+}
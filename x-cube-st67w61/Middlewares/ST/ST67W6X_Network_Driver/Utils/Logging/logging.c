@@ -53,10 +53,12 @@
 /* Includes ------------------------------------------------------------------*/
 #include <inttypes.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdatomic.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
@@ -99,26 +101,17 @@
 #define MAX_LOG_MESSAGE_LENGTH                  2000
 #endif /* MAX_LOG_MESSAGE_LENGTH */
 
-#ifndef MAX_LOG_QUEUE_LENGTH
-/** Max queue length */
-#define MAX_LOG_QUEUE_LENGTH                    200
-#endif /* MAX_LOG_QUEUE_LENGTH */
+#ifndef LOG_RING_SIZE
+/** Size in bytes of the ring buffer carrying the log records to the output task.
+  * Multiple of 4, up to 65536, and large enough for a message of MAX_LOG_MESSAGE_LENGTH */
+#define LOG_RING_SIZE                           4096
+#endif /* LOG_RING_SIZE */
 
 #ifndef MAX_LOG_LEVEL
 /** Max log level */
 #define MAX_LOG_LEVEL                           LOG_DEBUG
 #endif /* MAX_LOG_LEVEL */
 
-#ifndef MAX_LOG_MEMORY
-/** Max log level */
-#define MAX_LOG_MEMORY                          4096
-#endif /* MAX_LOG_MEMORY */
-
-#ifndef LOG_MESSAGE_ID
-/** Log id. must be unique per queue producer */
-#define LOG_MESSAGE_ID                          1
-#endif /* LOG_MESSAGE_ID */
-
 #ifndef LOG_THREAD_STACK_SIZE
 /** Log thread stack size */
 #define LOG_THREAD_STACK_SIZE                   256
@@ -129,33 +122,75 @@
 #define LOG_THREAD_PRIO                         25
 #endif /* LOG_THREAD_PRIO */
 
-#ifndef LOG_MALLOC
-/** Log memory allocator */
-#define LOG_MALLOC                              pvPortMalloc
-#endif /* LOG_MALLOC */
+#ifndef LOG_DEFERRED_ENABLE
+/** Defer the formatting of the log messages to the output task.
+  * The caller only copies the format pointer, the arguments and the metadata in a ring buffer */
+#define LOG_DEFERRED_ENABLE                     0
+#endif /* LOG_DEFERRED_ENABLE */
+
+#ifndef LOG_DEFERRED_MAX_RECORD
+/** Max size in bytes of a deferred record, header and copied strings included */
+#define LOG_DEFERRED_MAX_RECORD                 128
+#endif /* LOG_DEFERRED_MAX_RECORD */
+
+#ifndef LOG_DEFERRED_MAX_STRING
+/** Max number of characters copied for each string argument of a deferred record */
+#define LOG_DEFERRED_MAX_STRING                 32
+#endif /* LOG_DEFERRED_MAX_STRING */
+
+#ifndef LOG_DEFERRED_OUTPUT_SIZE
+/** Size of the buffer of the output task formatting the deferred records */
+#define LOG_DEFERRED_OUTPUT_SIZE                256
+#endif /* LOG_DEFERRED_OUTPUT_SIZE */
+
+#ifndef LOG_DEFERRED_RAW
+/** Output the deferred records as hexadecimal lines starting with '#', to be decoded on the host with the
+  * firmware ELF file, instead of formatting them on the target */
+#define LOG_DEFERRED_RAW                        0
+#endif /* LOG_DEFERRED_RAW */
+
+#ifndef LOG_DEFERRED_THREAD_STACK_SIZE
+/** Log thread stack size when the output task formats the deferred records */
+#define LOG_DEFERRED_THREAD_STACK_SIZE          1024
+#endif /* LOG_DEFERRED_THREAD_STACK_SIZE */
+
+#ifndef LOG_BENCH_BATCH
+/** Number of messages logged by vLoggingBenchmark before letting the output task drain them */
+#define LOG_BENCH_BATCH                         16
+#endif /* LOG_BENCH_BATCH */
+
+/** Padding record, up to the end of the ring buffer */
+#define LOG_RECORD_PAD                          0U
 
-#ifndef LOG_FREE
-/** Log memory deallocator */
-#define LOG_FREE                                vPortFree
-#endif /* LOG_FREE */
+/** Record holding a formatted message */
+#define LOG_RECORD_TEXT                         1U
+
+/** Record holding a message to be formatted by the output task */
+#define LOG_RECORD_DEFERRED                     2U
+
+#if ((LOG_RING_SIZE % 4) != 0) || (LOG_RING_SIZE > 65536) || (LOG_RING_SIZE < (MAX_LOG_MESSAGE_LENGTH + 8))
+#error "LOG_RING_SIZE must be a multiple of 4, up to 65536, and hold a message of MAX_LOG_MESSAGE_LENGTH"
+#endif /* LOG_RING_SIZE */
 
 /** @} */
 
 /* Private typedef -----------------------------------------------------------*/
-/** @defgroup ST67W6X_Utilities_Logging_Types ST67W6X Utility Logging Types
+/** @addtogroup ST67W6X_Utilities_Logging_Types ST67W6X Utility Logging Types
   * @ingroup  ST67W6X_Utilities_Logging
   * @{
   */
 
 /**
-  * @brief  Logging message structure
+  * @brief  Header of the records of the ring buffer. The record data follows:
+  *         - LOG_RECORD_TEXT: the message, '\0' terminated
+  *         - LOG_RECORD_DEFERRED: the rest of ::LogRecord_t and the arguments
   */
 typedef struct
 {
-  uint32_t message_id;    /*!< Log id. must be unique per queue producer */
-  uint32_t message_len;   /*!< Length of the message */
-  char *message;          /*!< Pointer to the message */
-} LogMessage_t;
+  uint16_t len;                             /*!< Record length, multiple of 4, header included */
+  volatile uint8_t ready;                   /*!< Set by the producer once the record is complete */
+  uint8_t type;                             /*!< Record type, LOG_RECORD_xxx */
+} LogRecordTag_t;
 
 /**
   * @brief  LoggingConfig_t structure definition
@@ -163,10 +198,52 @@ typedef struct
 typedef struct
 {
   uint32_t VerboseLogLevel;                 /*!< Log level */
-  uint32_t allocated_log_mem;               /*!< Allocated log memory */
   void (*log_output)(const char *message);  /*!< Log output callback */
+  uint32_t deferred;                        /*!< Set when the messages are formatted by the output task */
+  atomic_uint_least32_t high_water;         /*!< Max number of bytes used in the ring buffer */
+  atomic_uint_least32_t messages;           /*!< Number of messages posted */
+  atomic_uint_least32_t dropped_messages;   /*!< Number of messages dropped, ring buffer full */
+  atomic_uint_least32_t dropped_bytes;      /*!< Number of bytes dropped, ring buffer full */
+  uint32_t reported_drops;                  /*!< Dropped messages already reported in the log */
 } LoggingConfig_t;
 
+#if (LOG_DEFERRED_ENABLE == 1)
+/**
+  * @brief  Deferred record header. The arguments follow, packed in the order of the format string:
+  *         - integers, pointers and doubles with their native size
+  *         - strings copied up to LOG_DEFERRED_MAX_STRING characters, '\0' included
+  */
+typedef struct
+{
+  LogRecordTag_t tag;                       /*!< Record header */
+  uint32_t level;                           /*!< Log level */
+  const char *format;                       /*!< Format string, in flash */
+  const char *file;                         /*!< File name, NULL if no metadata */
+  uint32_t line;                            /*!< Line number */
+  uint32_t timestamp;                       /*!< Tick count when the message was logged */
+  char task[configMAX_TASK_NAME_LEN];       /*!< Name of the calling task */
+} LogRecord_t;
+
+/**
+  * @brief  Argument classes of a conversion specification
+  */
+typedef enum
+{
+  LOG_ARG_NONE = 0,                         /*!< No argument: "%%" or unknown conversion */
+  LOG_ARG_INT,                              /*!< int, or smaller promoted type */
+  LOG_ARG_LONG,                             /*!< long */
+  LOG_ARG_LLONG,                            /*!< long long */
+  LOG_ARG_SIZE,                             /*!< size_t */
+  LOG_ARG_PTRDIFF,                          /*!< ptrdiff_t */
+  LOG_ARG_INTMAX,                           /*!< intmax_t */
+  LOG_ARG_DOUBLE,                           /*!< double */
+  LOG_ARG_LDOUBLE,                          /*!< long double */
+  LOG_ARG_PTR,                              /*!< Pointer printed with "%p" */
+  LOG_ARG_STR,                              /*!< String copied in the record */
+  LOG_ARG_COUNT,                            /*!< "%n", argument consumed and ignored */
+} LogArg_e;
+#endif /* LOG_DEFERRED_ENABLE */
+
 /** @} */
 
 /*Private variables -----------------------------------------------------------*/
@@ -176,17 +253,17 @@ typedef struct
   */
 
 /**
-  * @brief  LogMessage_t structure definition
+  * @brief  Semaphore waking up the output task when a record is posted in an empty ring buffer
   */
-static QueueHandle_t xLogQueue = NULL;
+static SemaphoreHandle_t xLogDoorbell = NULL;
 
 /**
-  * @brief  LogMessage_t structure definition
+  * @brief  Output task handle
   */
 static TaskHandle_t OutputTaskHandle;
 
 /**
-  * @brief  LogMessage_t structure definition
+  * @brief  Log level names
   */
 static const char *logLevelStrings[] =
 {
@@ -204,9 +281,35 @@ static LoggingConfig_t LoggingConfig =
 {
   .VerboseLogLevel = LOG_LEVEL,
   .log_output = NULL,
-  .allocated_log_mem = 0
+  .deferred = LOG_DEFERRED_ENABLE,
+  .reported_drops = 0
 };
 
+/** Runtime module masks, all the modules compiled in are enabled by default */
+volatile uint32_t ulLoggingModuleMask[LOG_DEBUG + 1] =
+{
+  0U,
+  0xFFFFFFFFU,
+  0xFFFFFFFFU,
+  0xFFFFFFFFU,
+  0xFFFFFFFFU
+};
+
+/** Ring buffer of the log records, no heap is used by the log transport.
+  * The free room is kept zeroed so that a reserved record reads as not ready until it is committed */
+static uint32_t LogRing[LOG_RING_SIZE / 4];
+
+/** Write index in LogRing, in bytes, free running, moved by the producers with a compare-and-swap */
+static atomic_uint_least32_t LogRingHead = 0;
+
+/** Read index in LogRing, in bytes, free running, moved by the output task */
+static atomic_uint_least32_t LogRingTail = 0;
+
+#if (LOG_DEFERRED_ENABLE == 1)
+/** Buffer of the output task to format the deferred records */
+static char LogDeferredOutput[LOG_DEFERRED_OUTPUT_SIZE];
+#endif /* LOG_DEFERRED_ENABLE */
+
 /** @} */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -216,41 +319,168 @@ static LoggingConfig_t LoggingConfig =
   */
 
 /**
-  * @brief  Logging print task pushing the log message in the queue to the output callback
+  * @brief  Logging print task pushing the records of the ring buffer to the output callback
   * @param  pvParameters: Task parameter
   */
 static void OutputTask(void *pvParameters);
 
+/**
+  * @brief  Reserve a record in the ring buffer
+  * @param  len: Record length, multiple of 4, header included
+  * @param  p_doorbell: Set to 1 if the ring buffer was empty, the output task must be woken up on commit
+  * @return Pointer to the record, NULL if the ring buffer is full
+  */
+static LogRecordTag_t *vLoggingReserve(uint32_t len, uint32_t *p_doorbell);
+
+/**
+  * @brief  Publish a record to the output task
+  * @param  tag: Record returned by vLoggingReserve
+  * @param  len: Record length, as reserved
+  * @param  type: Record type, LOG_RECORD_xxx
+  * @param  doorbell: Value returned by vLoggingReserve
+  */
+static void vLoggingCommit(LogRecordTag_t *tag, uint32_t len, uint8_t type, uint32_t doorbell);
+
+/**
+  * @brief  Format a message in a text record of the ring buffer
+  * @param  p_prefix: Prefix copied before the message
+  * @param  prefix_len: Length of the prefix
+  * @param  max_len: Max length of the message, prefix and '\0' included
+  * @param  p_format: Format string
+  * @param  args: Arguments of the format string
+  * @param  discard: Set to commit the record as padding, skipped by the output task
+  * @return Length of the message, '\0' included, 0 if dropped
+  */
+static int32_t vLoggingPost(const char *p_prefix, int32_t prefix_len, uint32_t max_len,
+                            const char *p_format, va_list args, uint32_t discard);
+
+/**
+  * @brief  Log a message in the given mode
+  * @param  deferred: Set to log a deferred record
+  * @param  discard: Set to commit the record as padding, skipped by the output task
+  * @param  log_level: Log level
+  * @param  metadata_print: Set to print the metadata
+  * @param  line_number: Line number
+  * @param  p_file_name: File name
+  * @param  p_format: Format string
+  * @param  args: Arguments of the format string
+  * @return Length of the record or message, 0 if dropped
+  */
+static int32_t vLoggingWrite(uint32_t deferred, uint32_t discard, uint32_t log_level, uint8_t metadata_print,
+                             uint32_t line_number, const char *p_file_name, const char *p_format, va_list args);
+
+/**
+  * @brief  Output the records of the ring buffer
+  * @return 1 if a record is still being written by its producer, 0 if the ring is empty
+  */
+static uint32_t vLoggingDrain(void);
+
+/**
+  * @brief  Convert an unsigned number to a decimal string
+  * @param  p_out: Output buffer, at least 11 characters
+  * @param  value: Number to convert
+  * @return Number of characters written, '\0' excluded
+  */
+static uint32_t vLoggingUtoa(char *p_out, uint32_t value);
+
+/**
+  * @brief  Build the metadata prefix of a log message
+  * @param  buf: Buffer to fill
+  * @param  size: Size of the buffer
+  * @param  log_level: Log level
+  * @param  timestamp: Tick count when the message was logged
+  * @param  task_name: Name of the calling task, NULL if unknown
+  * @param  p_file_name: File name, NULL to omit it
+  * @param  line_number: Line number, 0 to omit the file name
+  * @return Length of the prefix
+  */
+static int32_t vLoggingMetadata(char *buf, int32_t size, uint32_t log_level, uint32_t timestamp,
+                                const char *task_name, const char *p_file_name, uint32_t line_number);
+
+/**
+  * @brief  Log a benchmark message, committed as padding so that it is never output
+  * @param  deferred: Set to log a deferred record
+  * @param  p_format: Format string
+  * @return Length of the record or message, 0 if dropped
+  */
+static int32_t vLoggingBenchPrintf(uint32_t deferred, const char *p_format, ...);
+
+#if (LOG_DEFERRED_ENABLE == 1)
+/**
+  * @brief  Parse a conversion specification of a format string
+  * @param  p_spec: Conversion specification, starting after the '%'
+  * @param  stars: Number of '*' width or precision arguments, updated
+  * @param  arg: Class of the argument of the conversion, updated
+  * @return Length of the specification, conversion character included
+  */
+static uint32_t vLoggingParseSpec(const char *p_spec, uint32_t *stars, LogArg_e *arg);
+
+/**
+  * @brief  Log a message as a deferred record
+  * @param  log_level: Log level
+  * @param  metadata_print: Set to print the metadata
+  * @param  line_number: Line number
+  * @param  p_file_name: File name
+  * @param  p_format: Format string, must stay valid until the record is output
+  * @param  args: Arguments of the format string
+  * @param  discard: Set to commit the record as padding, skipped by the output task
+  * @return Length of the record, 0 if dropped
+  */
+static int32_t vLoggingDeferred(uint32_t log_level, uint8_t metadata_print, uint32_t line_number,
+                                const char *p_file_name, const char *p_format, va_list args, uint32_t discard);
+
+/**
+  * @brief  Format a deferred record
+  * @param  rec: Record to format
+  * @param  out: Output buffer
+  * @param  size: Size of the output buffer
+  */
+static void vLoggingFormatRecord(const LogRecord_t *rec, char *out, int32_t size);
+#endif /* LOG_DEFERRED_ENABLE */
+
 /* Functions Definition ------------------------------------------------------*/
 void *vLoggingInit(void (*LogOutput)(const char *message))
 {
   BaseType_t status;
   /* Default setting */
   LoggingConfig.VerboseLogLevel = LOG_DEBUG;
-  LoggingConfig.allocated_log_mem = 0;
+  atomic_store(&LoggingConfig.high_water, 0);
+  atomic_store(&LoggingConfig.messages, 0);
+  atomic_store(&LoggingConfig.dropped_messages, 0);
+  atomic_store(&LoggingConfig.dropped_bytes, 0);
+  LoggingConfig.reported_drops = 0;
+  (void)memset(LogRing, 0, sizeof(LogRing));
+  atomic_store(&LogRingHead, 0);
+  atomic_store(&LogRingTail, 0);
 
-  xLogQueue = NULL;
+  xLogDoorbell = NULL;
 
   if (LogOutput != NULL)
   {
     LoggingConfig.log_output = LogOutput;
-    xLogQueue = xQueueCreate(MAX_LOG_QUEUE_LENGTH, sizeof(LogMessage_t *));
-    if (xLogQueue == NULL)
+    xLogDoorbell = xSemaphoreCreateBinary();
+    if (xLogDoorbell == NULL)
     {
-      printf("Log queue creation failed\n");
+      printf("Log semaphore creation failed\n");
       return NULL;
     }
+#if (LOG_DEFERRED_ENABLE == 1)
+    /* The output task formats the deferred records */
+    status = xTaskCreate(OutputTask, "OutputTask", LOG_DEFERRED_THREAD_STACK_SIZE >> 2, NULL,
+                         LOG_THREAD_PRIO, &OutputTaskHandle);
+#else
     status = xTaskCreate(OutputTask, "OutputTask", LOG_THREAD_STACK_SIZE >> 2, NULL,
                          LOG_THREAD_PRIO, &OutputTaskHandle);
+#endif /* LOG_DEFERRED_ENABLE */
     if (status != pdPASS)
     {
-      vQueueDelete(xLogQueue);
-      xLogQueue = NULL;
+      vSemaphoreDelete(xLogDoorbell);
+      xLogDoorbell = NULL;
       printf("Log task creation failed\n");
       return NULL;
     }
   }
-  return xLogQueue;
+  return xLogDoorbell;
 }
 
 void vLoggingSetVerbosity(uint32_t level)
@@ -261,167 +491,813 @@ void vLoggingSetVerbosity(uint32_t level)
   }
 }
 
+void vLoggingSetModuleLevel(uint32_t module, uint32_t level)
+{
+  if ((module >= LOG_MODULE_COUNT) || (level > LOG_DEBUG))
+  {
+    return;
+  }
+
+  taskENTER_CRITICAL();
+  for (uint32_t i = LOG_ERROR; i <= LOG_DEBUG; i++)
+  {
+    if (i <= level)
+    {
+      ulLoggingModuleMask[i] |= (1UL << module);
+    }
+    else
+    {
+      ulLoggingModuleMask[i] &= ~(1UL << module);
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+uint32_t vLoggingGetModuleLevel(uint32_t module)
+{
+  uint32_t level = LOG_NONE;
+
+  if (module < LOG_MODULE_COUNT)
+  {
+    while ((level < LOG_DEBUG) && LogModuleEnabled(module, level + 1))
+    {
+      level++;
+    }
+  }
+  return level;
+}
+
 int32_t vLoggingPrintf(uint32_t log_level, const uint8_t metadata_print, const uint32_t line_number,
                        const char *const p_file_name, const char *const p_format, ...)
 {
-  int32_t offset = 0;
+  int32_t offset;
   va_list args;
-  char log_include_str[LOG_INCLUDE_MAX_LENGTH] = {0};
-  char dummy_str[2]; /* Dummy string for format length calculation */
 
   if ((log_level > LoggingConfig.VerboseLogLevel) || (log_level > MAX_LOG_LEVEL))
   {
     return -1;  /* Filter out messages above the threshold */
   }
 
-  if (LoggingConfig.allocated_log_mem > MAX_LOG_MEMORY)
+  if (xLogDoorbell == NULL)
   {
-    printf("Max log malloc reached\n");
-    return 0;
+    return -1;  /* Logging service not started */
+  }
+
+  va_start(args, p_format);
+  offset = vLoggingWrite(LoggingConfig.deferred, 0, log_level, metadata_print, line_number, p_file_name,
+                         p_format, args);
+  va_end(args);
+
+  return offset;
+}
+
+int32_t vLoggingVPrintf(uint32_t max_len, const char *const p_format, va_list args)
+{
+  if (xLogDoorbell == NULL)
+  {
+    return -1;  /* Logging service not started */
   }
 
-  /* Allocate memory for the log structure */
-  LogMessage_t *newLog = (LogMessage_t *)LOG_MALLOC(sizeof(LogMessage_t));
-  if (newLog == NULL)
+  if (max_len > MAX_LOG_MESSAGE_LENGTH)
   {
-    printf("Log malloc failed\n");
-    return 0;
+    max_len = MAX_LOG_MESSAGE_LENGTH;
   }
 
-  va_start(args, p_format);
+  return vLoggingPost(NULL, 0, max_len, p_format, args, 0);
+}
 
-  if (metadata_print)
+void vLoggingGetStats(LogStats_t *p_stats)
+{
+  if (p_stats != NULL)
   {
-    offset += snprintf(log_include_str, LOG_INCLUDE_MAX_LENGTH, "[%s] ", logLevelStrings[log_level]);
+    p_stats->ring_size = LOG_RING_SIZE;
+    p_stats->high_water = atomic_load(&LoggingConfig.high_water);
+    p_stats->messages = atomic_load(&LoggingConfig.messages);
+    p_stats->dropped_messages = atomic_load(&LoggingConfig.dropped_messages);
+    p_stats->dropped_bytes = atomic_load(&LoggingConfig.dropped_bytes);
+  }
+}
 
-#if LOG_INCLUDE_TIMESTAMP
-    /* Get the current timestamp and task name (if required) */
-    uint32_t timestamp = xTaskGetTickCount();
-    offset += snprintf(&log_include_str[offset], LOG_INCLUDE_MAX_LENGTH - offset, "[%" PRIu32 "] ", timestamp);
-#endif /* LOG_INCLUDE_TIMESTAMP */
+void vLoggingResetStats(void)
+{
+  taskENTER_CRITICAL();
+  atomic_store(&LoggingConfig.dropped_messages, 0);
+  atomic_store(&LoggingConfig.dropped_bytes, 0);
+  atomic_store(&LoggingConfig.high_water, atomic_load(&LogRingHead) - atomic_load(&LogRingTail));
+  LoggingConfig.reported_drops = 0;
+  taskEXIT_CRITICAL();
+}
 
-#if LOG_INCLUDE_TASKNAME
-    const char *taskName = pcTaskGetName(xTaskGetCurrentTaskHandle());
-    if ((taskName) && (offset < LOG_INCLUDE_MAX_LENGTH))
-    {
-      offset += snprintf(&log_include_str[offset], LOG_INCLUDE_MAX_LENGTH - offset, "[%s] ", taskName);
-    }
-#endif /* LOG_INCLUDE_TASKNAME */
+void vLoggingBenchmark(uint32_t count, uint32_t (*get_cycle)(void))
+{
+  UBaseType_t priority = uxTaskPriorityGet(NULL);
+  uint64_t total[2] = {0};
+  uint32_t max[2] = {0};
+  uint32_t modes = 1;
+  uint32_t t0;
+  uint32_t dt;
 
-#if LOG_INCLUDE_FILENAME
-    if ((offset < LOG_INCLUDE_MAX_LENGTH) && (p_file_name != NULL) && (line_number != 0))
+  if ((xLogDoorbell == NULL) || (count == 0) || (get_cycle == NULL))
+  {
+    return;
+  }
+#if (LOG_DEFERRED_ENABLE == 1)
+  modes = 2;
+#endif /* LOG_DEFERRED_ENABLE */
+
+  /* Keep the output task away during the calls: only the cost of the caller is measured */
+  if (priority <= LOG_THREAD_PRIO)
+  {
+    vTaskPrioritySet(NULL, LOG_THREAD_PRIO + 1);
+  }
+
+  /* The messages go through the ring buffer like the others, committed as padding: the output
+   * callback and the mode used by the other tasks are left untouched */
+  for (uint32_t mode = 0; mode < modes; mode++)
+  {
+    for (uint32_t i = 0; i < count; i++)
     {
-      /* Extract the filename if p_file_name contains a full path */
-      char *p_file = (char *)p_file_name;
-      char *lastSlash = strrchr(p_file, '/');
-      if (lastSlash != NULL)
+      t0 = get_cycle();
+      (void)vLoggingBenchPrintf(mode, "bench %" PRIu32 " %s 0x%08" PRIx32 "\n", i, "message", t0);
+      dt = get_cycle() - t0;
+      total[mode] += dt;
+      if (dt > max[mode])
       {
-        p_file = lastSlash + 1; /* Move past the '/' */
+        max[mode] = dt;
       }
-      else
+      if (((i + 1) % LOG_BENCH_BATCH) == 0)
       {
-        lastSlash = strrchr(p_file, '\\');
-        if (lastSlash != NULL)
+        /* Let the output task drain the batch so that no message is dropped */
+        while (atomic_load(&LogRingTail) != atomic_load(&LogRingHead))
         {
-          p_file = lastSlash + 1; /* Move past the '\\' */
+          vTaskDelay(1);
         }
       }
+    }
+    while (atomic_load(&LogRingTail) != atomic_load(&LogRingHead))
+    {
+      vTaskDelay(1);
+    }
+  }
+
+  vTaskPrioritySet(NULL, priority);
+
+  LogInfo("Log call cost over %" PRIu32 " messages, in CPU cycles\n", count);
+  LogInfo("  immediate: avg %" PRIu32 ", max %" PRIu32 "\n", (uint32_t)(total[0] / count), max[0]);
+  if (modes == 2)
+  {
+    LogInfo("  deferred : avg %" PRIu32 ", max %" PRIu32 "\n", (uint32_t)(total[1] / count), max[1]);
+  }
+}
 
-      offset += snprintf(&log_include_str[offset], LOG_INCLUDE_MAX_LENGTH - offset,
-                         "(%s:%" PRIu32 ") ",
-                         p_file, line_number);
+void vLoggingDeInit(void)
+{
+  if (OutputTaskHandle != NULL)
+  {
+    vTaskDelete(OutputTaskHandle);
+    OutputTaskHandle = NULL;
+  }
+
+  if (xLogDoorbell != NULL)
+  {
+    /* The records not yet output are discarded */
+    vSemaphoreDelete(xLogDoorbell);
+    xLogDoorbell = NULL;
+  }
+}
+/* Private Functions Definition ----------------------------------------------*/
+static void OutputTask(void *pvParameters)
+{
+  TickType_t wait = portMAX_DELAY;
+
+  for (;;)
+  {
+    /* Wait for records in the ring buffer */
+    (void)xSemaphoreTake(xLogDoorbell, wait);
+
+    /* Poll again shortly if a producer is still writing its record */
+    wait = (vLoggingDrain() == 0) ? portMAX_DELAY : 1;
+  }
+}
+
+static LogRecordTag_t *vLoggingReserve(uint32_t len, uint32_t *p_doorbell)
+{
+  LogRecordTag_t *tag;
+  uint32_t head;
+  uint32_t used;
+  uint32_t off;
+  uint32_t pad;
+  uint32_t hwm;
+
+  /* Claim the room by moving the head, the record is written afterwards */
+  head = atomic_load(&LogRingHead);
+  do
+  {
+    used = head - atomic_load(&LogRingTail);
+    off = head % LOG_RING_SIZE;
+    pad = ((LOG_RING_SIZE - off) < len) ? (LOG_RING_SIZE - off) : 0;
+    if ((used + pad + len) > LOG_RING_SIZE)
+    {
+      (void)atomic_fetch_add(&LoggingConfig.dropped_messages, 1);
+      (void)atomic_fetch_add(&LoggingConfig.dropped_bytes, len);
+      return NULL;
     }
-#endif /* LOG_INCLUDE_FILENAME */
+  } while (!atomic_compare_exchange_weak(&LogRingHead, &head, head + pad + len));
+
+  if (pad != 0)
+  {
+    /* Not enough room up to the end of the ring: skip it */
+    tag = (LogRecordTag_t *)&LogRing[off / 4];
+    tag->len = (uint16_t)pad;
+    tag->type = LOG_RECORD_PAD;
+    portMEMORY_BARRIER();
+    tag->ready = 1;
+    off = 0;
   }
+  tag = (LogRecordTag_t *)&LogRing[off / 4];
 
-  configASSERT(offset < LOG_INCLUDE_MAX_LENGTH)
+  /* Read after the head is moved: either the ring is seen empty here or the output task sees the record */
+  *p_doorbell = (atomic_load(&LogRingTail) == head) ? 1 : 0;
+
+  (void)atomic_fetch_add(&LoggingConfig.messages, 1);
+  used += pad + len;
+  hwm = atomic_load(&LoggingConfig.high_water);
+  while ((used > hwm) && !atomic_compare_exchange_weak(&LoggingConfig.high_water, &hwm, used))
+  {
+  }
+
+  return tag;
+}
+
+static void vLoggingCommit(LogRecordTag_t *tag, uint32_t len, uint8_t type, uint32_t doorbell)
+{
+  tag->len = (uint16_t)len;
+  tag->type = type;
+  portMEMORY_BARRIER();
+  tag->ready = 1;
+
+  if (doorbell == 1)
+  {
+    /* Wake up the output task */
+    (void)xSemaphoreGive(xLogDoorbell);
+  }
+}
+
+static int32_t vLoggingPost(const char *p_prefix, int32_t prefix_len, uint32_t max_len,
+                            const char *p_format, va_list args, uint32_t discard)
+{
+  LogRecordTag_t *tag;
+  uint32_t doorbell = 0;
+  uint32_t msg_len;
+  uint32_t len;
+  char *p_msg;
+  va_list args_len;
 
   /* Calculate the log message size */
-  int32_t alloc_len = vsnprintf(dummy_str, sizeof(dummy_str), p_format, args); /*Get format length */
-  alloc_len += offset + 1; /*offset for log include string + 1 for \0 */
+  va_copy(args_len, args);
+  msg_len = prefix_len + vsnprintf(NULL, 0, p_format, args_len) + 1; /* + 1 for '\0' */
+  va_end(args_len);
 
-  /* Max alloc_len is MAX_LOG_MESSAGE_LENGTH */
-  if (alloc_len > MAX_LOG_MESSAGE_LENGTH)
+  if (msg_len > max_len)
   {
-    alloc_len = MAX_LOG_MESSAGE_LENGTH;
+    msg_len = max_len;
   }
 
-  /* Allocate memory for the log message */
-  newLog->message = (char *)LOG_MALLOC(alloc_len);
-  if (newLog->message == NULL)
+  len = (sizeof(LogRecordTag_t) + msg_len + 3U) & ~3U;
+  tag = vLoggingReserve(len, &doorbell);
+  if (tag == NULL)
   {
-    LOG_FREE(newLog);
-    printf("Log message malloc failed\n");
-    va_end(args);
     return 0;
   }
 
-  /* Track log memory allocation */
-  LoggingConfig.allocated_log_mem += alloc_len;
-  newLog->message_len = alloc_len;
+  /* Format the message in place */
+  p_msg = (char *)tag + sizeof(LogRecordTag_t);
+  if (prefix_len > 0)
+  {
+    (void)memcpy(p_msg, p_prefix, prefix_len);
+  }
+  (void)vsnprintf(&p_msg[prefix_len], msg_len - prefix_len, p_format, args);
+
+  vLoggingCommit(tag, len, (discard == 1) ? LOG_RECORD_PAD : LOG_RECORD_TEXT, doorbell);
 
-  strncpy(newLog->message, log_include_str, offset);
+  return (int32_t)msg_len;
+}
 
-  offset += vsnprintf(newLog->message + offset, alloc_len, p_format, args);
+static uint32_t vLoggingDrain(void)
+{
+  LogRecordTag_t *tag;
+  uint32_t tail;
+  uint32_t len;
+  uint32_t drops;
 
-  va_end(args);
+  while ((tail = atomic_load(&LogRingTail)) != atomic_load(&LogRingHead))
+  {
+    tag = (LogRecordTag_t *)&LogRing[(tail % LOG_RING_SIZE) / 4];
+    if (tag->ready == 0)
+    {
+      return 1; /* Still being written */
+    }
+    if ((tag->type == LOG_RECORD_TEXT) && (LoggingConfig.log_output != NULL))
+    {
+      /* Output the message directly from the ring buffer */
+      LoggingConfig.log_output((const char *)tag + sizeof(LogRecordTag_t));
+      fflush(stdout);
+    }
+#if (LOG_DEFERRED_ENABLE == 1)
+    else if ((tag->type == LOG_RECORD_DEFERRED) && (LoggingConfig.log_output != NULL))
+    {
+      const LogRecord_t *rec = (const LogRecord_t *)tag;
+#if (LOG_DEFERRED_RAW == 1)
+      /* "#" followed by the record in hexadecimal, split in lines of the output buffer size */
+      const uint8_t *p_rec = (const uint8_t *)rec;
+      uint32_t n = 0;
+      for (uint32_t i = 0; i < rec->tag.len; i++)
+      {
+        if (n == 0)
+        {
+          LogDeferredOutput[n++] = '#';
+        }
+        n += snprintf(&LogDeferredOutput[n], sizeof(LogDeferredOutput) - n, "%02x", p_rec[i]);
+        if ((i == (rec->tag.len - 1U)) || ((n + 4) > sizeof(LogDeferredOutput)))
+        {
+          LogDeferredOutput[n++] = '\n';
+          LogDeferredOutput[n] = '\0';
+          LoggingConfig.log_output(LogDeferredOutput);
+          n = 0;
+        }
+      }
+#else
+      vLoggingFormatRecord(rec, LogDeferredOutput, sizeof(LogDeferredOutput));
+      LoggingConfig.log_output(LogDeferredOutput);
+#endif /* LOG_DEFERRED_RAW */
+      fflush(stdout);
+    }
+#endif /* LOG_DEFERRED_ENABLE */
+    else
+    {
+      /* Padding record, or no output callback */
+    }
+    /* Release the room to the producers, zeroed so that it reads as not ready once reserved again */
+    len = tag->len;
+    (void)memset(tag, 0, len);
+    atomic_store(&LogRingTail, tail + len);
+  }
+
+  /* Report the messages dropped since the last report, after the ones posted before them */
+  drops = atomic_load(&LoggingConfig.dropped_messages);
+  if ((drops != LoggingConfig.reported_drops) && (LoggingConfig.log_output != NULL))
+  {
+    /* Formatted by hand: the output task stack is small */
+    char notice[48] = "[WARN] Log overrun, ";
+    uint32_t n = strlen(notice);
+    n += vLoggingUtoa(&notice[n], drops - LoggingConfig.reported_drops);
+    (void)strcpy(&notice[n], " messages dropped\n");
+    LoggingConfig.reported_drops = drops;
+    LoggingConfig.log_output(notice);
+  }
+  return 0;
+}
+
+static uint32_t vLoggingUtoa(char *p_out, uint32_t value)
+{
+  char digits[10];
+  uint32_t n = 0;
+  uint32_t i = 0;
+
+  do
+  {
+    digits[n++] = (char)('0' + (value % 10U));
+    value /= 10U;
+  } while (value != 0U);
+
+  while (n > 0U)
+  {
+    p_out[i++] = digits[--n];
+  }
+  p_out[i] = '\0';
+  return i;
+}
+
+static int32_t vLoggingMetadata(char *buf, int32_t size, uint32_t log_level, uint32_t timestamp,
+                                const char *task_name, const char *p_file_name, uint32_t line_number)
+{
+  int32_t offset = 0;
 
-  newLog->message[offset++] = '\0';
+  offset += snprintf(buf, size, "[%s] ", logLevelStrings[log_level]);
 
-  newLog->message_id = LOG_MESSAGE_ID;
+#if LOG_INCLUDE_TIMESTAMP
+  offset += snprintf(&buf[offset], size - offset, "[%" PRIu32 "] ", timestamp);
+#else
+  (void)timestamp;
+#endif /* LOG_INCLUDE_TIMESTAMP */
+
+#if LOG_INCLUDE_TASKNAME
+  if ((task_name) && (offset < size))
+  {
+    offset += snprintf(&buf[offset], size - offset, "[%s] ", task_name);
+  }
+#else
+  (void)task_name;
+#endif /* LOG_INCLUDE_TASKNAME */
 
-  /* Send the log to the queue */
-  if (xQueueSendToBack(xLogQueue, &newLog, 0) != pdPASS)
+#if LOG_INCLUDE_FILENAME
+  if ((offset < size) && (p_file_name != NULL) && (line_number != 0))
   {
-    LOG_FREE(newLog->message);
-    LOG_FREE(newLog);
-    printf("Log queue full, message dropped\n");
+    /* Extract the filename if p_file_name contains a full path */
+    char *p_file = (char *)p_file_name;
+    char *lastSlash = strrchr(p_file, '/');
+    if (lastSlash != NULL)
+    {
+      p_file = lastSlash + 1; /* Move past the '/' */
+    }
+    else
+    {
+      lastSlash = strrchr(p_file, '\\');
+      if (lastSlash != NULL)
+      {
+        p_file = lastSlash + 1; /* Move past the '\\' */
+      }
+    }
+
+    offset += snprintf(&buf[offset], size - offset,
+                       "(%s:%" PRIu32 ") ",
+                       p_file, line_number);
   }
+#else
+  (void)p_file_name;
+  (void)line_number;
+#endif /* LOG_INCLUDE_FILENAME */
+
   return offset;
 }
 
-void vLoggingDeInit(void)
+static int32_t vLoggingWrite(uint32_t deferred, uint32_t discard, uint32_t log_level, uint8_t metadata_print,
+                             uint32_t line_number, const char *p_file_name, const char *p_format, va_list args)
 {
-  if (OutputTaskHandle != NULL)
+  int32_t offset = 0;
+  char log_include_str[LOG_INCLUDE_MAX_LENGTH] = {0};
+
+#if (LOG_DEFERRED_ENABLE == 1)
+  if (deferred == 1)
   {
-    vTaskDelete(OutputTaskHandle);
+    return vLoggingDeferred(log_level, metadata_print, line_number, p_file_name, p_format, args, discard);
   }
+#else
+  (void)deferred;
+#endif /* LOG_DEFERRED_ENABLE */
 
-  if (xLogQueue != NULL)
+  if (metadata_print)
   {
-    /* Check Queue empty to clean? */
-    vQueueDelete(xLogQueue);
+    offset = vLoggingMetadata(log_include_str, LOG_INCLUDE_MAX_LENGTH, log_level, xTaskGetTickCount(),
+                              pcTaskGetName(xTaskGetCurrentTaskHandle()), p_file_name, line_number);
   }
+
+  configASSERT(offset < LOG_INCLUDE_MAX_LENGTH)
+
+  return vLoggingPost(log_include_str, offset, MAX_LOG_MESSAGE_LENGTH, p_format, args, discard);
 }
-/* Private Functions Definition ----------------------------------------------*/
-static void OutputTask(void *pvParameters)
+
+static int32_t vLoggingBenchPrintf(uint32_t deferred, const char *p_format, ...)
 {
-  LogMessage_t *receivedLog = NULL;
+  int32_t offset;
+  va_list args;
 
-  for (;;)
+  va_start(args, p_format);
+  offset = vLoggingWrite(deferred, 1, LOG_ERROR, 1, __LINE__, __FILE_NAME__, p_format, args);
+  va_end(args);
+
+  return offset;
+}
+
+#if (LOG_DEFERRED_ENABLE == 1)
+static uint32_t vLoggingParseSpec(const char *p_spec, uint32_t *stars, LogArg_e *arg)
+{
+  uint32_t i = 0;
+  uint32_t length = 0; /* 1: h, 2: hh, 3: l, 4: ll, 5: z, 6: t, 7: j, 8: L */
+
+  *stars = 0;
+  *arg = LOG_ARG_NONE;
+
+  /* Flags, width and precision */
+  while ((p_spec[i] != '\0') && (strchr("-+ #0123456789.*", p_spec[i]) != NULL))
+  {
+    if (p_spec[i] == '*')
+    {
+      (*stars)++;
+    }
+    i++;
+  }
+
+  /* Length modifier */
+  switch (p_spec[i])
+  {
+    case 'h':
+      length = (p_spec[i + 1] == 'h') ? 2 : 1;
+      break;
+    case 'l':
+      length = (p_spec[i + 1] == 'l') ? 4 : 3;
+      break;
+    case 'z':
+      length = 5;
+      break;
+    case 't':
+      length = 6;
+      break;
+    case 'j':
+      length = 7;
+      break;
+    case 'L':
+      length = 8;
+      break;
+    default:
+      break;
+  }
+  i += ((length == 2) || (length == 4)) ? 2 : ((length != 0) ? 1 : 0);
+
+  /* Conversion */
+  switch (p_spec[i])
   {
-    /* Wait for a log message from the queue */
-    if (xQueueReceive(xLogQueue, &receivedLog, portMAX_DELAY) == pdPASS)
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'c':
+      *arg = (length == 3) ? LOG_ARG_LONG : (length == 4) ? LOG_ARG_LLONG : (length == 5) ? LOG_ARG_SIZE :
+             (length == 6) ? LOG_ARG_PTRDIFF : (length == 7) ? LOG_ARG_INTMAX : LOG_ARG_INT;
+      break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      *arg = (length == 8) ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+      break;
+    case 'p':
+      *arg = LOG_ARG_PTR;
+      break;
+    case 's':
+      *arg = LOG_ARG_STR;
+      break;
+    case 'n':
+      *arg = LOG_ARG_COUNT;
+      break;
+    case '\0':
+      return i;
+    default: /* "%%" or unknown conversion */
+      break;
+  }
+  return i + 1;
+}
+
+static int32_t vLoggingDeferred(uint32_t log_level, uint8_t metadata_print, uint32_t line_number,
+                                const char *p_file_name, const char *p_format, va_list args, uint32_t discard)
+{
+  uint32_t record[LOG_DEFERRED_MAX_RECORD / 4]; /* Record built on the stack, then copied in the ring */
+  LogRecord_t *rec = (LogRecord_t *)record;
+  uint8_t *p_arg = (uint8_t *)record + sizeof(LogRecord_t);
+  uint8_t *p_end = (uint8_t *)record + sizeof(record);
+  const char *p = p_format;
+  uint32_t stars;
+  LogArg_e arg;
+  uint32_t len;
+  uint32_t doorbell = 0;
+  LogRecord_t *dst;
+
+  rec->level = log_level;
+  rec->format = p_format;
+  rec->file = (metadata_print != 0) ? p_file_name : NULL;
+  rec->line = line_number;
+  rec->timestamp = xTaskGetTickCount();
+  rec->task[0] = '\0';
+#if LOG_INCLUDE_TASKNAME
+  if (metadata_print != 0)
+  {
+    /* The name is copied: the task may be deleted before the record is output */
+    strncpy(rec->task, pcTaskGetName(xTaskGetCurrentTaskHandle()), configMAX_TASK_NAME_LEN - 1);
+    rec->task[configMAX_TASK_NAME_LEN - 1] = '\0';
+  }
+#endif /* LOG_INCLUDE_TASKNAME */
+
+  /* Copy the raw arguments. The record is truncated at the first one which does not fit */
+  while ((p = strchr(p, '%')) != NULL)
+  {
+    p++;
+    p += vLoggingParseSpec(p, &stars, &arg);
+    for (; stars > 0; stars--)
+    {
+      int32_t star = va_arg(args, int32_t);
+      if ((p_arg + sizeof(star)) > p_end)
+      {
+        goto _copy;
+      }
+      memcpy(p_arg, &star, sizeof(star));
+      p_arg += sizeof(star);
+    }
+    switch (arg)
     {
-      if ((receivedLog) && (receivedLog->message != 0))
+#define LOG_PACK(type, va_type) \
+  { \
+    type value = (type)va_arg(args, va_type); \
+    if ((p_arg + sizeof(value)) > p_end) goto _copy; \
+    memcpy(p_arg, &value, sizeof(value)); \
+    p_arg += sizeof(value); \
+  } \
+  break
+      case LOG_ARG_INT:
+        LOG_PACK(int, int);
+      case LOG_ARG_LONG:
+        LOG_PACK(long, long);
+      case LOG_ARG_LLONG:
+        LOG_PACK(long long, long long);
+      case LOG_ARG_SIZE:
+        LOG_PACK(size_t, size_t);
+      case LOG_ARG_PTRDIFF:
+        LOG_PACK(ptrdiff_t, ptrdiff_t);
+      case LOG_ARG_INTMAX:
+        LOG_PACK(intmax_t, intmax_t);
+      case LOG_ARG_DOUBLE:
+        LOG_PACK(double, double);
+      case LOG_ARG_LDOUBLE:
+        LOG_PACK(long double, long double);
+      case LOG_ARG_PTR:
+        LOG_PACK(void *, void *);
+#undef LOG_PACK
+      case LOG_ARG_STR:
       {
-        if (LoggingConfig.log_output != NULL)
+        const char *str = va_arg(args, const char *);
+        if (str == NULL)
         {
-          LoggingConfig.log_output(receivedLog->message);
-          fflush(stdout);
+          str = "(null)";
         }
-        /* Free the memory after transfer completes */
-        LOG_FREE(receivedLog->message);
-        LOG_FREE(receivedLog);
+        len = strnlen(str, LOG_DEFERRED_MAX_STRING);
+        if ((p_arg + len + 1) > p_end)
+        {
+          goto _copy;
+        }
+        memcpy(p_arg, str, len);
+        p_arg[len] = '\0';
+        p_arg += len + 1;
+        break;
+      }
+      case LOG_ARG_COUNT:
+        (void)va_arg(args, void *);
+        break;
+      default:
+        break;
+    }
+  }
 
-        if ((receivedLog->message_id == LOG_MESSAGE_ID) &&
-            (LoggingConfig.allocated_log_mem >= receivedLog->message_len))
+_copy:
+  len = ((uint32_t)(p_arg - (uint8_t *)record) + 3U) & ~3U;
+
+  dst = (LogRecord_t *)vLoggingReserve(len, &doorbell);
+  if (dst == NULL)
+  {
+    return 0;
+  }
+
+  /* Copy the record behind its header, then publish it */
+  (void)memcpy((uint8_t *)dst + sizeof(LogRecordTag_t), (uint8_t *)record + sizeof(LogRecordTag_t),
+               len - sizeof(LogRecordTag_t));
+  vLoggingCommit(&dst->tag, len, (discard == 1) ? LOG_RECORD_PAD : LOG_RECORD_DEFERRED, doorbell);
+
+  return (int32_t)len;
+}
+
+static void vLoggingFormatRecord(const LogRecord_t *rec, char *out, int32_t size)
+{
+  const uint8_t *p_arg = (const uint8_t *)rec + sizeof(LogRecord_t);
+  const uint8_t *p_end = (const uint8_t *)rec + rec->tag.len;
+  const char *p = rec->format;
+  const char *p_next;
+  char spec[24];
+  uint32_t spec_len;
+  uint32_t stars;
+  LogArg_e arg;
+  int32_t offset = 0;
+  int32_t star;
+  int32_t n;
+
+  if (rec->file != NULL)
+  {
+    offset = vLoggingMetadata(out, size, rec->level, rec->timestamp, rec->task, rec->file, rec->line);
+  }
+
+  while ((*p != '\0') && (offset < (size - 1)))
+  {
+    /* Literal text up to the next conversion */
+    p_next = strchr(p, '%');
+    n = (p_next == NULL) ? (int32_t)strlen(p) : (int32_t)(p_next - p);
+    if (n > (size - 1 - offset))
+    {
+      n = size - 1 - offset;
+    }
+    memcpy(&out[offset], p, n);
+    offset += n;
+    p += n;
+    if ((p_next == NULL) || (offset >= (size - 1)))
+    {
+      break;
+    }
+
+    spec_len = 1 + vLoggingParseSpec(p + 1, &stars, &arg);
+    if (p_end < (p_arg + (stars * sizeof(int32_t))))
+    {
+      break; /* Truncated record: output the rest of the format as is */
+    }
+
+    /* Rebuild the specification with the '*' replaced by their values */
+    n = 0;
+    for (uint32_t i = 0; (i < spec_len) && (n < (int32_t)(sizeof(spec) - 12)); i++)
+    {
+      if (p[i] == '*')
+      {
+        memcpy(&star, p_arg, sizeof(star));
+        p_arg += sizeof(star);
+        if ((star < 0) && (n > 0) && (spec[n - 1] == '.'))
         {
-          LoggingConfig.allocated_log_mem -= receivedLog->message_len;
+          n--; /* Negative precision: as if omitted */
+          continue;
         }
+        n += snprintf(&spec[n], sizeof(spec) - n, "%" PRIi32, star);
+      }
+      else
+      {
+        spec[n++] = p[i];
       }
     }
+    spec[n] = '\0';
+
+    n = 0;
+    switch (arg)
+    {
+#define LOG_UNPACK(type) \
+  { \
+    type value; \
+    if ((p_arg + sizeof(value)) > p_end) goto _truncated; \
+    memcpy(&value, p_arg, sizeof(value)); \
+    p_arg += sizeof(value); \
+    n = snprintf(&out[offset], size - offset, spec, value); \
+  } \
+  break
+      case LOG_ARG_INT:
+        LOG_UNPACK(int);
+      case LOG_ARG_LONG:
+        LOG_UNPACK(long);
+      case LOG_ARG_LLONG:
+        LOG_UNPACK(long long);
+      case LOG_ARG_SIZE:
+        LOG_UNPACK(size_t);
+      case LOG_ARG_PTRDIFF:
+        LOG_UNPACK(ptrdiff_t);
+      case LOG_ARG_INTMAX:
+        LOG_UNPACK(intmax_t);
+      case LOG_ARG_DOUBLE:
+        LOG_UNPACK(double);
+      case LOG_ARG_LDOUBLE:
+        LOG_UNPACK(long double);
+      case LOG_ARG_PTR:
+        LOG_UNPACK(void *);
+#undef LOG_UNPACK
+      case LOG_ARG_STR:
+      {
+        const char *str = (const char *)p_arg;
+        uint32_t len = strnlen(str, (uint32_t)(p_end - p_arg));
+        if ((p_arg + len) >= p_end)
+        {
+          goto _truncated;
+        }
+        p_arg += len + 1;
+        n = snprintf(&out[offset], size - offset, spec, str);
+        break;
+      }
+      case LOG_ARG_COUNT:
+        break;
+      default:
+        n = snprintf(&out[offset], size - offset, "%s", (p[1] == '%') ? "%" : spec);
+        break;
+    }
+    offset += (n > 0) ? n : 0;
+    p += spec_len;
+  }
+  goto _end;
+
+_truncated:
+  /* Output the rest of the format as is */
+  offset += snprintf(&out[offset], size - offset, "%s", p);
+
+_end:
+  if (offset > (size - 1))
+  {
+    offset = size - 1;
   }
+  out[offset] = '\0';
 }
+#endif /* LOG_DEFERRED_ENABLE */
 
 /** @} */
@@ -1033,6 +1033,10 @@ static iperf_err_t iperf_run_tcp_server(void)
 
   timeout = TCP_RX_SOCKET_TIMEOUT;
   (void)NET_SETSOCKOPT(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#if (ST67_ARCH == W6X_ARCH_T01)
+  timeout = W6X_NET_RECV_THROUGHPUT; /* Bulk transfer: pull the data in the largest chunks */
+  (void)NET_SETSOCKOPT(client_socket, SOL_SOCKET, SO_RCVMODE, &timeout, sizeof(timeout));
+#endif /* ST67_ARCH */
 
   socket_recv(client_socket, listen_addr, IPERF_TRANS_TYPE_TCP);
 exit:
@@ -1231,6 +1235,8 @@ static iperf_err_t iperf_run_udp_server(void)
     }
 
 #if (ST67_ARCH == W6X_ARCH_T01)
+    timeout = W6X_NET_RECV_THROUGHPUT; /* Bulk transfer: pull the data in the largest chunks */
+    (void)NET_SETSOCKOPT(listen_socket, SOL_SOCKET, SO_RCVMODE, &timeout, sizeof(timeout));
     timeout = IPERF_SOCKET_RX_TIMEOUT * 1000;
     (void)NET_SETSOCKOPT(listen_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
 #else
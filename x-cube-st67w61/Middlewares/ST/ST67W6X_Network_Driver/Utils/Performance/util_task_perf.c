@@ -20,6 +20,7 @@
 #include <stdarg.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "util_task_perf.h"
@@ -143,6 +144,15 @@ int32_t task_perf_shell(int32_t argc, char **argv);
   * @retval ::SHELL_STATUS_OK on success
   */
 int32_t task_perf_shell_report(int32_t argc, char **argv);
+
+/**
+  * @brief  Logging cost measurement shell function
+  * @param  argc: number of arguments
+  * @param  argv: pointer to the arguments
+  * @retval ::SHELL_STATUS_OK on success
+  * @retval ::SHELL_STATUS_ERROR otherwise
+  */
+int32_t task_perf_shell_log(int32_t argc, char **argv);
 #endif /* TASK_PERF_ENABLE */
 
 /**
@@ -434,6 +444,40 @@ int32_t task_perf_shell_report(int32_t argc, char **argv)
 
 SHELL_CMD_EXPORT_ALIAS(task_perf_shell_report, task_report, task_report. Display task performance report);
 
+int32_t task_perf_shell_log(int32_t argc, char **argv)
+{
+  int32_t count = 256;
+
+  if (argc > 2)
+  {
+    return SHELL_STATUS_ERROR;
+  }
+  if (argc == 2)
+  {
+    count = atoi(argv[1]);
+    if (count <= 0)
+    {
+      return SHELL_STATUS_ERROR;
+    }
+  }
+
+  /* The cycle counter is shared with the task performance measurement */
+  if (task_perf.state != PERF_TASK_STATE_RUNNING)
+  {
+    util_task_port_reset();
+  }
+
+  vLoggingBenchmark((uint32_t)count, util_task_port_get_cycle);
+
+  if (task_perf.state != PERF_TASK_STATE_RUNNING)
+  {
+    util_task_port_stop();
+  }
+  return SHELL_STATUS_OK;
+}
+
+SHELL_CMD_EXPORT_ALIAS(task_perf_shell_log, log_perf, log_perf [ count ]. Measure the cost of a log call);
+
 #endif /* TASK_PERF_ENABLE */
 
 /** @} */
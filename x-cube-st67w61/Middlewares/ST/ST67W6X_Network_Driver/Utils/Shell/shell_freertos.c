@@ -23,18 +23,13 @@
 
 #include "shell_internal.h"
 #include "shell.h"
+#include "logging.h"
 
 #include "FreeRTOS.h"
 #include <semphr.h>
 #include "task.h"
 #include "queue.h"
 
-/* Private defines -----------------------------------------------------------*/
-#ifndef SHELL_MESSAGE_ID
-/** Log id. must be unique per queue producer */
-#define SHELL_MESSAGE_ID 2
-#endif /* SHELL_MESSAGE_ID */
-
 /* Private typedef -----------------------------------------------------------*/
 /** @addtogroup ST67W6X_Utilities_Shell_Types
   * @{
@@ -45,16 +40,6 @@
   */
 typedef struct _shell_freertos shell_free_rtos_t;
 
-/**
-  * @brief  Shell message structure
-  */
-typedef struct
-{
-  uint32_t message_id;    /*!< Log id. must be unique per queue producer */
-  uint32_t message_len;   /*!< Length of the message */
-  char *message;          /*!< Pointer to the message */
-} ShellMessage_t;
-
 /**
   * @brief  Internal state of the low level support implementation for the shell
   */
@@ -70,7 +55,7 @@ struct _shell_freertos
   uint8_t rx_buffer[SHELL_FREERTOS_RX_BUFF_SIZE];
   /** Rx buffer index. */
   uint32_t rx_buffer_idx;
-  /** Synchronization primitive used to output the data generated by the shell. */
+  /** Logging service used to output the data generated by the shell. */
   QueueHandle_t OutputQueue;
 
   /** This implementation read the user input from the uart, in interrupt mode, 1 byte at time.
@@ -218,55 +203,14 @@ void shell_freertos_on_new_data(uint8_t uart_rxbyte)
 
 void shell_freertos_printf(const char *const p_format, ...)
 {
-  /* Allocate memory for the log structure */
-  int32_t alloc_len;
   va_list args;
-  char dummy_str[2];/* Dummy string for format length calculation */
-  shell_free_rtos_t *p_shell = shell_freertos_get_instance();
-  ShellMessage_t *newShell = (ShellMessage_t *)pvPortMalloc(sizeof(ShellMessage_t));
-
-  if (newShell == NULL)
-  {
-    printf("Error: Shell malloc failed\n");
-    return;
-  }
 
   va_start(args, p_format);
 
-  alloc_len = vsnprintf(dummy_str, sizeof(dummy_str) - 1, p_format, args) + 1; /* +1 for'\0' */
-
-  if (alloc_len > SHELL_FREERTOS_MAX_PRINT_STRING_LENGTH)
-  {
-    alloc_len = SHELL_FREERTOS_MAX_PRINT_STRING_LENGTH;
-  }
-
-  /* Allocate memory for the log message */
-  newShell->message = (char *)pvPortMalloc(alloc_len);
-  if (newShell->message == NULL)
-  {
-    vPortFree(newShell);
-    printf("Error: Shell message malloc failed\n");
-    va_end(args);
-    return;
-  }
-
-  /* Append the actual log message */
-  (void)vsnprintf(newShell->message, alloc_len, p_format, args);
+  /* Post the output in the log ring buffer, no allocation. Drops are accounted by the logging service */
+  (void)vLoggingVPrintf(SHELL_FREERTOS_MAX_PRINT_STRING_LENGTH, p_format, args);
 
   va_end(args);
-
-  configASSERT(alloc_len != strlen(newShell->message));
-  newShell->message_len = alloc_len;
-
-  newShell->message_id = SHELL_MESSAGE_ID;
-
-  /* Send the log to the queue */
-  if (xQueueSendToBack(p_shell->OutputQueue, &newShell, 0) != pdPASS)
-  {
-    vPortFree(newShell->message);
-    vPortFree(newShell);
-    printf("Error: Shell queue full, message dropped\n");
-  }
 }
 
 static inline void shell_freertos_release_sem(void)
@@ -0,0 +1,195 @@
+/**
+ * @file
+ * A host benchmark of the egress of QoS 0 publish bursts.
+ *
+ * The client is connected through a socket pair to a broker stub running in the same
+ * thread. Each round queues a burst of small QoS 0 PUBLISH then flushes it. The benchmark
+ * provides its own PAL, which counts the mqtt_pal_sendall calls and can busy-wait in each
+ * one to model the cost of a socket write over a serial bus (one AT+CIPSEND transaction on
+ * an offloaded socket). The throughput and the number of writes per message are reported.
+ *
+ * Usage: burst_benchmark [messages] [burst] [us per write]
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <mqtt.h>
+
+/** @brief Bytes of send buffer reserved per message of the burst. */
+#define SENDBUF_PER_MESSAGE 128
+
+/** @brief The broker end of the socket pair and its receive state. */
+struct broker_stub {
+    int fd;
+    uint8_t buf[4096];
+    size_t len;
+    size_t publishes;
+};
+
+static double write_cost_us;
+static size_t write_calls;
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "error: %s\n", what);
+    exit(1);
+}
+
+ssize_t mqtt_pal_sendall(mqtt_pal_socket_handle fd, const void* buf, size_t len, int flags)
+{
+    size_t sent = 0;
+    double t0 = now_us();
+    ++write_calls;
+    while (now_us() - t0 < write_cost_us);
+    while (sent < len) {
+        ssize_t rv = send(fd, (const char*)buf + sent, len - sent, flags);
+        if (rv < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return sent == 0 ? MQTT_ERROR_SOCKET_ERROR : (ssize_t)sent;
+        }
+        sent += (size_t) rv;
+    }
+    return (ssize_t)sent;
+}
+
+ssize_t mqtt_pal_recvall(mqtt_pal_socket_handle fd, void* buf, size_t bufsz, int flags)
+{
+    size_t received = 0;
+    while (received < bufsz) {
+        ssize_t rv = recv(fd, (char*)buf + received, bufsz - received, flags);
+        if (rv == 0) return received == 0 ? MQTT_ERROR_SOCKET_ERROR : (ssize_t)received;
+        if (rv < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return received == 0 ? MQTT_ERROR_SOCKET_ERROR : (ssize_t)received;
+        }
+        received += (size_t) rv;
+    }
+    return (ssize_t)received;
+}
+
+static void publish_callback(void** unused, struct mqtt_response_publish *published)
+{
+    (void) unused;
+    (void) published;
+}
+
+/* Reads what the client sent: counts the PUBLISH, answers a CONNECT */
+static void broker_stub_read(struct broker_stub *stub)
+{
+    for (;;) {
+        ssize_t rv = recv(stub->fd, stub->buf + stub->len, sizeof(stub->buf) - stub->len, 0);
+        size_t pos = 0;
+        if (rv <= 0) {
+            if (rv < 0 && errno != EAGAIN && errno != EWOULDBLOCK) fail("broker recv");
+            return;
+        }
+        stub->len += (size_t) rv;
+
+        /* parse the complete packets */
+        for (;;) {
+            size_t hdr = 1;
+            size_t remaining = 0;
+            unsigned shift = 0;
+            uint8_t type;
+            do {
+                if (pos + hdr >= stub->len) goto partial;
+                remaining |= (size_t) (stub->buf[pos + hdr] & 0x7F) << shift;
+                shift += 7;
+            } while (stub->buf[pos + hdr++] & 0x80);
+            if (pos + hdr + remaining > stub->len) goto partial;
+
+            type = stub->buf[pos] >> 4;
+            if (type == MQTT_CONTROL_CONNECT) {
+                static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+                if (send(stub->fd, connack, sizeof(connack), 0) != sizeof(connack)) fail("broker CONNACK");
+            } else if (type == MQTT_CONTROL_PUBLISH) {
+                ++stub->publishes;
+            }
+            pos += hdr + remaining;
+        }
+partial:
+        memmove(stub->buf, stub->buf + pos, stub->len - pos);
+        stub->len -= pos;
+    }
+}
+
+static void sync_client(struct mqtt_client *client)
+{
+    enum MQTTErrors err = mqtt_sync(client);
+    if (err != MQTT_OK) fail(mqtt_error_str(err));
+}
+
+int main(int argc, const char *argv[])
+{
+    size_t messages = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    size_t burst = argc > 2 ? strtoul(argv[2], NULL, 10) : 32;
+    size_t sendbufsz = burst * SENDBUF_PER_MESSAGE;
+    uint8_t *sendbuf = malloc(sendbufsz);
+    uint8_t recvbuf[1024];
+    static struct mqtt_client client;
+    struct broker_stub stub = {0};
+    size_t done = 0;
+    double elapsed_us;
+    double t0;
+    int fds[2];
+
+    if (burst == 0 || burst > messages) fail("burst must be in [1, messages]");
+    if (sendbuf == NULL) fail("out of memory");
+    write_cost_us = argc > 3 ? strtod(argv[3], NULL) : 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) fail("socketpair");
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    stub.fd = fds[1];
+
+    mqtt_init(&client, fds[0], sendbuf, sendbufsz, recvbuf, sizeof(recvbuf), publish_callback);
+    mqtt_connect(&client, "burst_benchmark", NULL, NULL, 0, NULL, NULL, MQTT_CONNECT_CLEAN_SESSION, 400);
+    sync_client(&client);
+    broker_stub_read(&stub);
+    sync_client(&client);
+    if (client.error != MQTT_OK) fail(mqtt_error_str(client.error));
+
+    write_calls = 0;
+    t0 = now_us();
+    while (done < messages) {
+        size_t count = messages - done < burst ? messages - done : burst;
+        size_t i;
+
+        /* queue the burst */
+        for (i = 0; i < count; ++i) {
+            static const char payload[] = "{\"t\":21.5,\"h\":40}";
+            enum MQTTErrors err = mqtt_publish(&client, "sensors/bench", payload, sizeof(payload) - 1, MQTT_PUBLISH_QOS_0);
+            if (err != MQTT_OK) fail(mqtt_error_str(err));
+        }
+
+        /* flush it to the broker stub */
+        done += count;
+        while (stub.publishes < done) {
+            sync_client(&client);
+            broker_stub_read(&stub);
+        }
+    }
+    elapsed_us = now_us() - t0;
+
+    printf("batch size %d, %zu messages, burst %zu, %.0f us per write\n", MQTT_SEND_BATCH_SIZE, messages, burst, write_cost_us);
+    printf("  writes:  %8.3f per msg\n", (double) write_calls / messages);
+    printf("  total:   %8.0f msgs/s\n", messages / (elapsed_us / 1e6));
+
+    close(fds[0]);
+    close(fds[1]);
+    free(sendbuf);
+    return 0;
+}
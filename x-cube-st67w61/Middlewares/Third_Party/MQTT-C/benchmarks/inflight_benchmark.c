@@ -0,0 +1,186 @@
+/**
+ * @file
+ * A host benchmark of the acknowledgement handling of QoS 1 publishes.
+ *
+ * The client is connected through a socket pair to a broker stub running in the same
+ * thread. Each round queues a window of QoS 1 PUBLISH, flushes them to the stub, then
+ * the stub acknowledges them all in order. The time spent queuing the publishes and
+ * processing the PUBACKs is reported per message.
+ *
+ * Usage: inflight_benchmark [messages] [window]
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <mqtt.h>
+
+/** @brief Bytes of send buffer reserved per message of the window. */
+#define SENDBUF_PER_MESSAGE 128
+
+/** @brief The broker end of the socket pair and its receive state. */
+struct broker_stub {
+    int fd;
+    uint8_t buf[4096];
+    size_t len;
+    uint16_t *pids;
+    size_t npids;
+};
+
+static void publish_callback(void** unused, struct mqtt_response_publish *published)
+{
+    (void) unused;
+    (void) published;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "error: %s\n", what);
+    exit(1);
+}
+
+/* Reads what the client sent: collects the QoS 1 PUBLISH packet ids, answers a CONNECT */
+static void broker_stub_read(struct broker_stub *stub)
+{
+    for (;;) {
+        ssize_t rv = recv(stub->fd, stub->buf + stub->len, sizeof(stub->buf) - stub->len, 0);
+        size_t pos = 0;
+        if (rv <= 0) {
+            if (rv < 0 && errno != EAGAIN && errno != EWOULDBLOCK) fail("broker recv");
+            return;
+        }
+        stub->len += (size_t) rv;
+
+        /* parse the complete packets */
+        for (;;) {
+            size_t hdr = 1;
+            size_t remaining = 0;
+            unsigned shift = 0;
+            uint8_t type;
+            do {
+                if (pos + hdr >= stub->len) goto partial;
+                remaining |= (size_t) (stub->buf[pos + hdr] & 0x7F) << shift;
+                shift += 7;
+            } while (stub->buf[pos + hdr++] & 0x80);
+            if (pos + hdr + remaining > stub->len) goto partial;
+
+            type = stub->buf[pos] >> 4;
+            if (type == MQTT_CONTROL_CONNECT) {
+                static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+                if (send(stub->fd, connack, sizeof(connack), 0) != sizeof(connack)) fail("broker CONNACK");
+            } else if (type == MQTT_CONTROL_PUBLISH && ((stub->buf[pos] >> 1) & 0x03) == 1) {
+                const uint8_t *p = stub->buf + pos + hdr;
+                size_t topic_len = ((size_t) p[0] << 8) | p[1];
+                stub->pids[stub->npids++] = (uint16_t) ((p[2 + topic_len] << 8) | p[3 + topic_len]);
+            }
+            pos += hdr + remaining;
+        }
+partial:
+        memmove(stub->buf, stub->buf + pos, stub->len - pos);
+        stub->len -= pos;
+    }
+}
+
+static void sync_client(struct mqtt_client *client)
+{
+    enum MQTTErrors err = mqtt_sync(client);
+    if (err != MQTT_OK) fail(mqtt_error_str(err));
+}
+
+int main(int argc, const char *argv[])
+{
+    size_t messages = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000;
+    size_t window = argc > 2 ? strtoul(argv[2], NULL, 10) : messages;
+    size_t sendbufsz = window * SENDBUF_PER_MESSAGE;
+    uint8_t *sendbuf = malloc(sendbufsz);
+    uint8_t recvbuf[4096];
+    static struct mqtt_client client;
+    struct broker_stub stub = {0};
+    double publish_us = 0;
+    double ack_us = 0;
+    size_t done = 0;
+    int fds[2];
+
+    if (window == 0 || window > messages || window > 16384) fail("window must be in [1, min(messages, 16384)]");
+    stub.pids = malloc(window * sizeof(*stub.pids));
+    if (sendbuf == NULL || stub.pids == NULL) fail("out of memory");
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) fail("socketpair");
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    stub.fd = fds[1];
+
+    mqtt_init(&client, fds[0], sendbuf, sendbufsz, recvbuf, sizeof(recvbuf), publish_callback);
+    mqtt_connect(&client, "inflight_benchmark", NULL, NULL, 0, NULL, NULL, MQTT_CONNECT_CLEAN_SESSION, 400);
+    sync_client(&client);
+    broker_stub_read(&stub);
+    sync_client(&client);
+    if (client.error != MQTT_OK) fail(mqtt_error_str(client.error));
+
+    while (done < messages) {
+        size_t count = messages - done < window ? messages - done : window;
+        size_t i;
+        double t0;
+
+        /* queue the window, pick the packet ids */
+        t0 = now_us();
+        for (i = 0; i < count; ++i) {
+            static const char payload[] = "0123456789abcdef";
+            enum MQTTErrors err = mqtt_publish(&client, "bench", payload, sizeof(payload) - 1, MQTT_PUBLISH_QOS_1);
+            if (err != MQTT_OK) fail(mqtt_error_str(err));
+        }
+        publish_us += now_us() - t0;
+
+        /* flush the window to the broker stub */
+        stub.npids = 0;
+        while (stub.npids < count) {
+            sync_client(&client);
+            broker_stub_read(&stub);
+        }
+
+        /* acknowledge the window in order and let the client release the messages */
+        t0 = now_us();
+        for (i = 0; i < count; ++i) {
+            uint8_t puback[4] = { 0x40, 0x02, (uint8_t) (stub.pids[i] >> 8), (uint8_t) stub.pids[i] };
+            while (send(stub.fd, puback, sizeof(puback), 0) != sizeof(puback)) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) fail("broker PUBACK");
+                sync_client(&client);
+            }
+        }
+        sync_client(&client);
+        ack_us += now_us() - t0;
+
+        done += count;
+    }
+
+    /* every publish must have been released by its PUBACK */
+    {
+        ssize_t i;
+        for (i = 0; i < mqtt_mq_length(&client.mq); ++i) {
+            if (mqtt_mq_get(&client.mq, i)->state == MQTT_QUEUED_AWAITING_ACK) fail("unacknowledged publish");
+        }
+    }
+
+    printf("index size %d, %zu messages, window %zu\n", MQTT_MQ_INDEX_SIZE, messages, window);
+    printf("  publish: %8.3f us/msg\n", publish_us / messages);
+    printf("  puback:  %8.3f us/msg\n", ack_us / messages);
+    printf("  total:   %8.0f msgs/s\n", messages / ((publish_us + ack_us) / 1e6));
+
+    close(fds[0]);
+    close(fds[1]);
+    free(stub.pids);
+    free(sendbuf);
+    return 0;
+}
@@ -960,6 +960,37 @@ struct mqtt_queued_message {
     uint16_t packet_id;
 };
 
+#if !defined(MQTT_MQ_INDEX_SIZE)
+/**
+ * @brief The number of entries of the in-flight index of a message queue.
+ * @ingroup details
+ *
+ * The index finds the queued message acknowledged by a packet ID in constant time. It should
+ * hold every message the send buffer can queue, the lookups fall back to a linear search of
+ * the queue otherwise. Must be a power of two, 0 removes the index.
+ */
+#define MQTT_MQ_INDEX_SIZE 32
+#endif
+
+#if (MQTT_MQ_INDEX_SIZE & (MQTT_MQ_INDEX_SIZE - 1)) != 0
+#error "MQTT_MQ_INDEX_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief An entry of the in-flight index of a mqtt_message_queue.
+ * @ingroup details
+ */
+struct mqtt_mq_index_entry {
+    /** @brief The sequence number of the message, see mqtt_message_queue::head_seq. */
+    uint32_t seq;
+
+    /** @brief The packet id of the message. */
+    uint16_t packet_id;
+
+    /** @brief The control type of the message. \c 0 if the entry is empty. */
+    uint8_t control_type;
+};
+
 /**
  * @brief A message queue.
  * @ingroup details
@@ -1002,6 +1033,22 @@ struct mqtt_message_queue {
      * @note This member should not be used manually.
      */
     struct mqtt_queued_message *queue_tail;
+
+#if MQTT_MQ_INDEX_SIZE > 0
+    /**
+     * @brief The sequence number of the message at index 0.
+     *
+     * @note Messages are numbered in the order they are registered, the message at 
+     *       index \c i has the sequence number <tt>head_seq + i</tt>.
+     */
+    uint32_t head_seq;
+
+    /** @brief Nonzero when a message could not be indexed, a missed lookup then searches the queue. */
+    uint8_t index_overflow;
+
+    /** @brief Open-addressed table of the messages carrying a packet id. */
+    struct mqtt_mq_index_entry index[MQTT_MQ_INDEX_SIZE];
+#endif
 };
 
 /**
@@ -1046,6 +1093,21 @@ void mqtt_mq_clean(struct mqtt_message_queue *mq);
  */
 struct mqtt_queued_message* mqtt_mq_register(struct mqtt_message_queue *mq, size_t nbytes);
 
+/**
+ * @brief Add a registered message to the in-flight index.
+ * @ingroup details
+ * 
+ * @note This function should be called once the \c control_type and \c packet_id of a
+ *       message returned by mqtt_mq_register are set. Messages that are never looked up by
+ *       packet ID (CONNECT, PINGREQ, DISCONNECT) need not be indexed.
+ * 
+ * @param mq The message queue.
+ * @param[in] msg The message to index.
+ * 
+ * @relates mqtt_message_queue
+ */
+void mqtt_mq_index(struct mqtt_message_queue *mq, struct mqtt_queued_message *msg);
+
 /**
  * @brief Find a message in the message queue.
  * @ingroup details
@@ -1069,7 +1131,7 @@ struct mqtt_queued_message* mqtt_mq_find(const struct mqtt_message_queue *mq, en
  *
  * @returns The mqtt_queued_message at \p index.
  */
-#define mqtt_mq_get(mq_ptr, index) (((struct mqtt_queued_message*) ((mq_ptr)->mem_end)) - 1 - index)
+#define mqtt_mq_get(mq_ptr, index) (((struct mqtt_queued_message*) ((mq_ptr)->mem_end)) - 1 - (index))
 
 /**
  * @brief Returns the number of messages in the message queue, \p mq_ptr.
@@ -1248,10 +1310,25 @@ struct mqtt_client {
  */
 uint16_t __mqtt_next_pid(struct mqtt_client *client);
 
+#if !defined(MQTT_SEND_BATCH_SIZE)
+/**
+ * @brief The maximum number of bytes passed to one \ref mqtt_pal_sendall call.
+ * @ingroup details
+ *
+ * The unsent messages packed next to each other in the send buffer are flushed together, a
+ * burst of small publishes then costs one socket write instead of one per message. A message
+ * larger than this is still sent with its own call. 0 sends each message separately.
+ */
+#define MQTT_SEND_BATCH_SIZE 4096
+#endif
+
 /**
  * @brief Handles egress client traffic.
  * @ingroup details
  * 
+ * The contiguous unsent messages are sent with a single \ref mqtt_pal_sendall call, up to
+ * \ref MQTT_SEND_BATCH_SIZE bytes.
+ * 
  * @param client The MQTT client.
  * 
  * @returns MQTT_OK upon success, an \ref MQTTErrors otherwise. 
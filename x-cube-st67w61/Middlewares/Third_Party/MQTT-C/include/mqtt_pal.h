@@ -70,6 +70,7 @@ extern "C" {
 #define CONFIG_FREERTOS
 #define MQTT_USE_CUSTOM_SOCKET_HANDLE
 /* #define MQTT_SECURE_SOCKET */
+/* #define MQTT_USE_W6X_SOCKET */ /* W6X_ARCH_T01 only: W6X_Net sockets offloaded to the NCP */
 #endif /* REDEFINE_FREERTOS_INTERFACE */
 
 /* UNIX-like platform support */
@@ -158,10 +159,17 @@ extern "C" {
     #include <stdarg.h>
     #include "FreeRTOS.h"
     #include "semphr.h"
-    #include "arpa/inet.h"
+    #if defined(MQTT_USE_W6X_SOCKET)
+        #include "w6x_api.h"
 
-    #define MQTT_PAL_HTONS(s) htons(s)
-    #define MQTT_PAL_NTOHS(s) ntohs(s)
+        #define MQTT_PAL_HTONS(s) PP_HTONS(s)
+        #define MQTT_PAL_NTOHS(s) PP_NTOHS(s)
+    #else
+        #include "arpa/inet.h"
+
+        #define MQTT_PAL_HTONS(s) htons(s)
+        #define MQTT_PAL_NTOHS(s) ntohs(s)
+    #endif
 
     #define MQTT_PAL_TIME() (xTaskGetTickCount() / 1000)
 
@@ -204,7 +212,7 @@ extern "C" {
         struct mbedtls_ssl_context;
         union custom_socket_handle_ctx
         {
-            /* TCP */
+            /* TCP, W6X socket */
             int fd;
 
             /* Mbedtls */
@@ -218,6 +226,7 @@ extern "C" {
             MQTTC_PAL_CONNTION_TYPE_TCP = 0,
             MQTTC_PAL_CONNTION_TYPE_TLS,
             MQTTC_PAL_CONNTION_TYPE_WBS,
+            MQTTC_PAL_CONNTION_TYPE_W6X,
             MQTTC_PAL_CONNTION_TYPE_NUM
         };
 
@@ -82,6 +82,25 @@ enum MQTTErrors mqtt_sync(struct mqtt_client *client) {
     return err;
 }
 
+#if MQTT_MQ_INDEX_SIZE > 0
+static struct mqtt_queued_message* __mqtt_mq_index_lookup(const struct mqtt_message_queue *mq, enum MQTTControlPacketType control_type, uint16_t packet_id);
+
+static int __mqtt_mq_pid_in_use(const struct mqtt_message_queue *mq, uint16_t packet_id) {
+    /* the control types carrying a packet id */
+    static const enum MQTTControlPacketType types[] = {
+        MQTT_CONTROL_PUBLISH, MQTT_CONTROL_PUBACK, MQTT_CONTROL_PUBREC, MQTT_CONTROL_PUBREL,
+        MQTT_CONTROL_PUBCOMP, MQTT_CONTROL_SUBSCRIBE, MQTT_CONTROL_UNSUBSCRIBE
+    };
+    size_t i;
+    for(i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+        if (__mqtt_mq_index_lookup(mq, types[i], packet_id) != NULL) {
+            return 1;
+        }
+    }
+    return 0;
+}
+#endif
+
 uint16_t __mqtt_next_pid(struct mqtt_client *client) {
     int pid_exists = 0;
     if (client->pid_lfsr == 0) {
@@ -99,6 +118,12 @@ uint16_t __mqtt_next_pid(struct mqtt_client *client) {
 
         /* check that the PID is unique */
         pid_exists = 0;
+#if MQTT_MQ_INDEX_SIZE > 0
+        if (!client->mq.index_overflow) {
+            pid_exists = __mqtt_mq_pid_in_use(&client->mq, client->pid_lfsr);
+            continue;
+        }
+#endif
         for(curr = mqtt_mq_get(&(client->mq), 0); curr >= client->mq.queue_tail; --curr) {
             if (curr->packet_id == client->pid_lfsr) {
                 pid_exists = 1;
@@ -301,6 +326,7 @@ enum MQTTErrors mqtt_publish(struct mqtt_client *client,
     /* save the control type and packet id of the message */
     msg->control_type = MQTT_CONTROL_PUBLISH;
     msg->packet_id = packet_id;
+    mqtt_mq_index(&client->mq, msg);
 
     MQTT_PAL_MUTEX_UNLOCK(&client->mutex);
     return MQTT_OK;
@@ -323,6 +349,7 @@ ssize_t __mqtt_puback(struct mqtt_client *client, uint16_t packet_id) {
     /* save the control type and packet id of the message */
     msg->control_type = MQTT_CONTROL_PUBACK;
     msg->packet_id = packet_id;
+    mqtt_mq_index(&client->mq, msg);
 
     return MQTT_OK;
 }
@@ -344,6 +371,7 @@ ssize_t __mqtt_pubrec(struct mqtt_client *client, uint16_t packet_id) {
     /* save the control type and packet id of the message */
     msg->control_type = MQTT_CONTROL_PUBREC;
     msg->packet_id = packet_id;
+    mqtt_mq_index(&client->mq, msg);
 
     return MQTT_OK;
 }
@@ -365,6 +393,7 @@ ssize_t __mqtt_pubrel(struct mqtt_client *client, uint16_t packet_id) {
     /* save the control type and packet id of the message */
     msg->control_type = MQTT_CONTROL_PUBREL;
     msg->packet_id = packet_id;
+    mqtt_mq_index(&client->mq, msg);
 
     return MQTT_OK;
 }
@@ -386,6 +415,7 @@ ssize_t __mqtt_pubcomp(struct mqtt_client *client, uint16_t packet_id) {
     /* save the control type and packet id of the message */
     msg->control_type = MQTT_CONTROL_PUBCOMP;
     msg->packet_id = packet_id;
+    mqtt_mq_index(&client->mq, msg);
 
     return MQTT_OK;
 }
@@ -415,6 +445,7 @@ enum MQTTErrors mqtt_subscribe(struct mqtt_client *client,
     /* save the control type and packet id of the message */
     msg->control_type = MQTT_CONTROL_SUBSCRIBE;
     msg->packet_id = packet_id;
+    mqtt_mq_index(&client->mq, msg);
 
     MQTT_PAL_MUTEX_UNLOCK(&client->mutex);
     return MQTT_OK;
@@ -442,6 +473,7 @@ enum MQTTErrors mqtt_unsubscribe(struct mqtt_client *client,
     /* save the control type and packet id of the message */
     msg->control_type = MQTT_CONTROL_UNSUBSCRIBE;
     msg->packet_id = packet_id;
+    mqtt_mq_index(&client->mq, msg);
 
     MQTT_PAL_MUTEX_UNLOCK(&client->mutex);
     return MQTT_OK;
@@ -508,6 +540,63 @@ enum MQTTErrors mqtt_disconnect(struct mqtt_client *client)
     return MQTT_OK;
 }
 
+static enum MQTTErrors __mqtt_mq_sent(struct mqtt_client *client, struct mqtt_queued_message *msg) {
+    uint8_t inspected;
+
+    /* update timeout watcher */
+    client->time_of_last_send = MQTT_PAL_TIME();
+    msg->time_sent = client->time_of_last_send;
+
+    /* 
+    Determine the state to put the message in.
+    Control Types:
+    MQTT_CONTROL_CONNECT     -> awaiting
+    MQTT_CONTROL_CONNACK     -> n/a
+    MQTT_CONTROL_PUBLISH     -> qos == 0 ? complete : awaiting
+    MQTT_CONTROL_PUBACK      -> complete
+    MQTT_CONTROL_PUBREC      -> awaiting
+    MQTT_CONTROL_PUBREL      -> awaiting
+    MQTT_CONTROL_PUBCOMP     -> complete
+    MQTT_CONTROL_SUBSCRIBE   -> awaiting
+    MQTT_CONTROL_SUBACK      -> n/a
+    MQTT_CONTROL_UNSUBSCRIBE -> awaiting
+    MQTT_CONTROL_UNSUBACK    -> n/a
+    MQTT_CONTROL_PINGREQ     -> awaiting
+    MQTT_CONTROL_PINGRESP    -> n/a
+    MQTT_CONTROL_DISCONNECT  -> complete
+    */
+    switch (msg->control_type) {
+    case MQTT_CONTROL_PUBACK:
+    case MQTT_CONTROL_PUBCOMP:
+    case MQTT_CONTROL_DISCONNECT:
+        msg->state = MQTT_QUEUED_COMPLETE;
+        break;
+    case MQTT_CONTROL_PUBLISH:
+        inspected = ( MQTT_PUBLISH_QOS_MASK & (msg->start[0]) ) >> 1; /* qos */
+        if (inspected == 0) {
+            msg->state = MQTT_QUEUED_COMPLETE;
+        } else if (inspected == 1) {
+            msg->state = MQTT_QUEUED_AWAITING_ACK;
+            /*set DUP flag for subsequent sends [Spec MQTT-3.3.1-1] */ 
+            msg->start[0] |= MQTT_PUBLISH_DUP;
+        } else {
+            msg->state = MQTT_QUEUED_AWAITING_ACK;
+        }
+        break;
+    case MQTT_CONTROL_CONNECT:
+    case MQTT_CONTROL_PUBREC:
+    case MQTT_CONTROL_PUBREL:
+    case MQTT_CONTROL_SUBSCRIBE:
+    case MQTT_CONTROL_UNSUBSCRIBE:
+    case MQTT_CONTROL_PINGREQ:
+        msg->state = MQTT_QUEUED_AWAITING_ACK;
+        break;
+    default:
+        return MQTT_ERROR_MALFORMED_REQUEST;
+    }
+    return MQTT_OK;
+}
+
 ssize_t __mqtt_send(struct mqtt_client *client) 
 {
     uint8_t inspected;
@@ -524,9 +613,16 @@ ssize_t __mqtt_send(struct mqtt_client *client)
 
     /* loop through all messages in the queue */
     len = mqtt_mq_length(&client->mq);
-    for(; i < len; ++i) {
+    while (i < len) {
         struct mqtt_queued_message *msg = mqtt_mq_get(&client->mq, i);
         int resend = 0;
+        int batch_end = i + 1;
+#if MQTT_SEND_BATCH_SIZE > 0
+        struct mqtt_queued_message *batch_last;
+#endif
+        size_t batch_sz;
+        ssize_t tmp;
+        size_t sent;
         if (msg->state == MQTT_QUEUED_UNSENT) {
             /* message has not been sent to lets send it */
             resend = 1;
@@ -554,82 +650,62 @@ ssize_t __mqtt_send(struct mqtt_client *client)
 
         /* goto next message if we don't need to send */
         if (!resend) {
+            ++i;
             continue;
         }
 
-        /* we're sending the message */
-        {
-          ssize_t tmp = mqtt_pal_sendall(client->socketfd, msg->start + client->send_offset, msg->size - client->send_offset, 0);
-          if (tmp < 0) {
+        /* the following unsent messages are packed right after this one, send them with it */
+        batch_sz = msg->size - client->send_offset;
+#if MQTT_SEND_BATCH_SIZE > 0
+        batch_last = msg;
+        while (batch_end < len) {
+            struct mqtt_queued_message *next = mqtt_mq_get(&client->mq, batch_end);
+            if (next->state != MQTT_QUEUED_UNSENT
+                || next->start != batch_last->start + batch_last->size
+                || batch_sz + next->size > MQTT_SEND_BATCH_SIZE) {
+                break;
+            }
+            if (next->control_type == MQTT_CONTROL_PUBLISH && (0x03 & ((next->start[0]) >> 1)) == 2) {
+                if (inflight_qos2) {
+                    break;
+                }
+                inflight_qos2 = 1;
+            }
+            batch_sz += next->size;
+            batch_last = next;
+            ++batch_end;
+        }
+#endif
+
+        /* we're sending the messages */
+        tmp = mqtt_pal_sendall(client->socketfd, msg->start + client->send_offset, batch_sz, 0);
+        if (tmp < 0) {
             client->error = (enum MQTTErrors)tmp;
             MQTT_PAL_MUTEX_UNLOCK(&client->mutex);
             return tmp;
-          } else {
-            client->send_offset += (unsigned long)tmp;
-            if(client->send_offset < msg->size) {
-              /* partial sent. Await additional calls */
-              break;
-            } else {
-              /* whole message has been sent */
-              client->send_offset = 0;
-            }
-
-          }
-
         }
 
-        /* update timeout watcher */
-        client->time_of_last_send = MQTT_PAL_TIME();
-        msg->time_sent = client->time_of_last_send;
-
-        /* 
-        Determine the state to put the message in.
-        Control Types:
-        MQTT_CONTROL_CONNECT     -> awaiting
-        MQTT_CONTROL_CONNACK     -> n/a
-        MQTT_CONTROL_PUBLISH     -> qos == 0 ? complete : awaiting
-        MQTT_CONTROL_PUBACK      -> complete
-        MQTT_CONTROL_PUBREC      -> awaiting
-        MQTT_CONTROL_PUBREL      -> awaiting
-        MQTT_CONTROL_PUBCOMP     -> complete
-        MQTT_CONTROL_SUBSCRIBE   -> awaiting
-        MQTT_CONTROL_SUBACK      -> n/a
-        MQTT_CONTROL_UNSUBSCRIBE -> awaiting
-        MQTT_CONTROL_UNSUBACK    -> n/a
-        MQTT_CONTROL_PINGREQ     -> awaiting
-        MQTT_CONTROL_PINGRESP    -> n/a
-        MQTT_CONTROL_DISCONNECT  -> complete
-        */
-        switch (msg->control_type) {
-        case MQTT_CONTROL_PUBACK:
-        case MQTT_CONTROL_PUBCOMP:
-        case MQTT_CONTROL_DISCONNECT:
-            msg->state = MQTT_QUEUED_COMPLETE;
-            break;
-        case MQTT_CONTROL_PUBLISH:
-            inspected = ( MQTT_PUBLISH_QOS_MASK & (msg->start[0]) ) >> 1; /* qos */
-            if (inspected == 0) {
-                msg->state = MQTT_QUEUED_COMPLETE;
-            } else if (inspected == 1) {
-                msg->state = MQTT_QUEUED_AWAITING_ACK;
-                /*set DUP flag for subsequent sends [Spec MQTT-3.3.1-1] */ 
-                msg->start[0] |= MQTT_PUBLISH_DUP;
-            } else {
-                msg->state = MQTT_QUEUED_AWAITING_ACK;
+        /* complete the messages sent entirely */
+        sent = (size_t)tmp;
+        for (; i < batch_end; ++i) {
+            enum MQTTErrors err;
+            msg = mqtt_mq_get(&client->mq, i);
+            if (sent < msg->size - client->send_offset) {
+                break;
             }
+            sent -= msg->size - client->send_offset;
+            client->send_offset = 0;
+            err = __mqtt_mq_sent(client, msg);
+            if (err != MQTT_OK) {
+                client->error = err;
+                MQTT_PAL_MUTEX_UNLOCK(&client->mutex);
+                return err;
+            }
+        }
+        if (i < batch_end) {
+            /* partial sent. Await additional calls */
+            client->send_offset += sent;
             break;
-        case MQTT_CONTROL_CONNECT:
-        case MQTT_CONTROL_PUBREC:
-        case MQTT_CONTROL_PUBREL:
-        case MQTT_CONTROL_SUBSCRIBE:
-        case MQTT_CONTROL_UNSUBSCRIBE:
-        case MQTT_CONTROL_PINGREQ:
-            msg->state = MQTT_QUEUED_AWAITING_ACK;
-            break;
-        default:
-            client->error = MQTT_ERROR_MALFORMED_REQUEST;
-            MQTT_PAL_MUTEX_UNLOCK(&client->mutex);
-            return MQTT_ERROR_MALFORMED_REQUEST;
         }
     }
 
@@ -1629,6 +1705,11 @@ void mqtt_mq_init(struct mqtt_message_queue *mq, void *buf, size_t bufsz)
     mq->curr = (uint8_t *)buf;
     mq->queue_tail = (struct mqtt_queued_message *)mq->mem_end;
     mq->curr_sz = buf == NULL ? 0 : mqtt_mq_currsz(mq);
+#if MQTT_MQ_INDEX_SIZE > 0
+    mq->head_seq = 0;
+    mq->index_overflow = 0;
+    memset(mq->index, 0, sizeof(mq->index));
+#endif
 }
 
 struct mqtt_queued_message* mqtt_mq_register(struct mqtt_message_queue *mq, size_t nbytes)
@@ -1655,6 +1736,11 @@ void mqtt_mq_clean(struct mqtt_message_queue *mq) {
     
     /* check if everything can be removed */
     if (new_head < mq->queue_tail) {
+#if MQTT_MQ_INDEX_SIZE > 0
+        mq->head_seq += (uint32_t) mqtt_mq_length(mq);
+        mq->index_overflow = 0;
+        memset(mq->index, 0, sizeof(mq->index));
+#endif
         mq->curr = (uint8_t *)mq->mem_start;
         mq->queue_tail = (struct mqtt_queued_message *)mq->mem_end;
         mq->curr_sz = (size_t) (mqtt_mq_currsz(mq));
@@ -1664,6 +1750,10 @@ void mqtt_mq_clean(struct mqtt_message_queue *mq) {
         return;
     }
 
+#if MQTT_MQ_INDEX_SIZE > 0
+    mq->head_seq += (uint32_t) (mqtt_mq_get(mq, 0) - new_head);
+#endif
+
     /* move buffered data */
     {
         size_t n = (size_t) (mq->curr - new_head->start);
@@ -1690,11 +1780,115 @@ void mqtt_mq_clean(struct mqtt_message_queue *mq) {
 
     /* get curr_sz */
     mq->curr_sz = (size_t) (mqtt_mq_currsz(mq));
+
+#if MQTT_MQ_INDEX_SIZE > 0
+    /* rebuild the index: drops the removed messages and retries the ones that did not fit */
+    mq->index_overflow = 0;
+    memset(mq->index, 0, sizeof(mq->index));
+    {
+        struct mqtt_queued_message *curr;
+        for(curr = mqtt_mq_get(mq, 0); curr >= mq->queue_tail; --curr) {
+            if (curr->control_type >= MQTT_CONTROL_PUBLISH && curr->control_type <= MQTT_CONTROL_UNSUBSCRIBE) {
+                mqtt_mq_index(mq, curr);
+            }
+        }
+    }
+#endif
+}
+
+#if MQTT_MQ_INDEX_SIZE > 0
+static uint32_t __mqtt_mq_index_hash(enum MQTTControlPacketType control_type, uint16_t packet_id) {
+    uint32_t h = ((uint32_t) control_type << 16 | packet_id) * 2654435761u;
+    return (h ^ (h >> 16)) & (MQTT_MQ_INDEX_SIZE - 1);
+}
+
+/* returns the queued message of an index entry, NULL if the entry is stale */
+static struct mqtt_queued_message* __mqtt_mq_index_get(const struct mqtt_message_queue *mq, const struct mqtt_mq_index_entry *entry) {
+    uint32_t i = entry->seq - mq->head_seq;
+    struct mqtt_queued_message *msg;
+    if (i >= (uint32_t) mqtt_mq_length(mq)) {
+        return NULL;
+    }
+    msg = mqtt_mq_get(mq, i);
+    if (msg->control_type != entry->control_type || msg->packet_id != entry->packet_id) {
+        return NULL;
+    }
+    return msg;
+}
+
+static struct mqtt_queued_message* __mqtt_mq_index_lookup(const struct mqtt_message_queue *mq, enum MQTTControlPacketType control_type, uint16_t packet_id) {
+    uint32_t h = __mqtt_mq_index_hash(control_type, packet_id);
+    uint32_t n;
+    for(n = 0; n < MQTT_MQ_INDEX_SIZE; ++n, h = (h + 1) & (MQTT_MQ_INDEX_SIZE - 1)) {
+        const struct mqtt_mq_index_entry *entry = &mq->index[h];
+        if (entry->control_type == 0) {
+            break;
+        }
+        if (entry->control_type == control_type && entry->packet_id == packet_id) {
+            struct mqtt_queued_message *msg = __mqtt_mq_index_get(mq, entry);
+            if (msg != NULL) {
+                return msg;
+            }
+        }
+    }
+    return NULL;
+}
+#endif
+
+void mqtt_mq_index(struct mqtt_message_queue *mq, struct mqtt_queued_message *msg) {
+#if MQTT_MQ_INDEX_SIZE > 0
+    uint32_t h = __mqtt_mq_index_hash(msg->control_type, msg->packet_id);
+    struct mqtt_mq_index_entry *slot = NULL;
+    uint32_t n;
+
+    /* entries only go stale when the queue is cleaned, which rebuilds the index: it is still full */
+    if (mq->index_overflow) {
+        return;
+    }
+
+    /* probe the chain: keep an older message with the same key, mqtt_mq_find returns the oldest */
+    for(n = 0; n < MQTT_MQ_INDEX_SIZE; ++n, h = (h + 1) & (MQTT_MQ_INDEX_SIZE - 1)) {
+        struct mqtt_mq_index_entry *entry = &mq->index[h];
+        if (entry->control_type == 0) {
+            if (slot == NULL) {
+                slot = entry;
+            }
+            break;
+        }
+        if (__mqtt_mq_index_get(mq, entry) == NULL) {
+            /* stale entry: reusable, but the chain goes on */
+            if (slot == NULL) {
+                slot = entry;
+            }
+        } else if (entry->control_type == msg->control_type && entry->packet_id == msg->packet_id) {
+            return;
+        }
+    }
+
+    if (slot == NULL) {
+        mq->index_overflow = 1;
+        return;
+    }
+    slot->seq = mq->head_seq + (uint32_t) (mqtt_mq_get(mq, 0) - msg);
+    slot->packet_id = msg->packet_id;
+    slot->control_type = (uint8_t) msg->control_type;
+#else
+    (void) mq;
+    (void) msg;
+#endif
 }
 
 struct mqtt_queued_message* mqtt_mq_find(const struct mqtt_message_queue *mq, enum MQTTControlPacketType control_type, const uint16_t *packet_id)
 {
     struct mqtt_queued_message *curr;
+#if MQTT_MQ_INDEX_SIZE > 0
+    if (packet_id != NULL) {
+        curr = __mqtt_mq_index_lookup(mq, control_type, *packet_id);
+        if (curr != NULL || !mq->index_overflow) {
+            return curr;
+        }
+    }
+#endif
     for(curr = mqtt_mq_get(mq, 0); curr >= mq->queue_tail; --curr) {
         if (curr->control_type == control_type) {
             if ((packet_id == NULL && curr->state != MQTT_QUEUED_COMPLETE) ||
@@ -36,6 +36,12 @@ SOFTWARE.
 #if defined(MQTT_SECURE_SOCKET)
 #include <mbedtls/ssl.h>
 #endif /* MQTT_SECURE_SOCKET */
+#if defined(MQTT_USE_W6X_SOCKET)
+#ifndef MQTT_PAL_W6X_SEND_SIZE
+/**@brief Bytes given to each W6X_Net_Send() call, one TCP segment per AT+CIPSEND transaction. */
+#define MQTT_PAL_W6X_SEND_SIZE 1460
+#endif /* MQTT_PAL_W6X_SEND_SIZE */
+#endif /* MQTT_USE_W6X_SOCKET */
 
 /**@brief Transport write handler. */
 typedef int (*transport_send_handler_t)(mqtt_pal_socket_handle fd, const void* buf, size_t len, int flags);
@@ -56,6 +62,7 @@ struct transport_func {
     transport_recv_handler_t _recv;
 };
 
+#if !defined(MQTT_USE_W6X_SOCKET)
 static ssize_t mqtt_pal_sendall_tcp(mqtt_pal_socket_handle fd, const void* buf, size_t len, int flags)
 {
     enum MQTTErrors error = (enum MQTTErrors)0;
@@ -116,6 +123,22 @@ static ssize_t mqtt_pal_recvall_tcp(mqtt_pal_socket_handle fd, void* buf, size_t
     }
     return (char*)buf - (const char*)start;
 }
+#else
+/* The sockets are offloaded to the NCP, there is no BSD socket on the host */
+static ssize_t mqtt_pal_sendall_tcp(mqtt_pal_socket_handle fd, const void* buf, size_t len, int flags)
+{
+    enum MQTTErrors error = (enum MQTTErrors)0;
+    error = MQTT_ERROR_SOCKET_ERROR;
+    return error;
+}
+
+static ssize_t mqtt_pal_recvall_tcp(mqtt_pal_socket_handle fd, void* buf, size_t bufsz, int flags)
+{
+    enum MQTTErrors error = (enum MQTTErrors)0;
+    error = MQTT_ERROR_SOCKET_ERROR;
+    return error;
+}
+#endif /* MQTT_USE_W6X_SOCKET */
 
 #if defined(MQTT_SECURE_SOCKET)
 static ssize_t mqtt_pal_sendall_tls(mqtt_pal_socket_handle fd, const void* buf, size_t len, int flags)
@@ -226,6 +249,78 @@ static ssize_t mqtt_pal_recvall_wbs(mqtt_pal_socket_handle fd, void* buf, size_t
     return error;
 }
 
+#if defined(MQTT_USE_W6X_SOCKET)
+static ssize_t mqtt_pal_sendall_w6x(mqtt_pal_socket_handle fd, const void* buf, size_t len, int flags)
+{
+    enum MQTTErrors error = (enum MQTTErrors)0;
+    size_t sent = 0;
+    while(sent < len) {
+        /*
+         * Each call is a bus transaction, the messages batched by
+         * __mqtt_send are cut in full segments instead of one per message.
+         */
+        size_t chunk = len - sent;
+        ssize_t rv;
+        if (chunk > MQTT_PAL_W6X_SEND_SIZE) {
+            chunk = MQTT_PAL_W6X_SEND_SIZE;
+        }
+        rv = W6X_Net_Send(fd->ctx.fd, (const char*)buf + sent, chunk, flags);
+        if (rv <= 0) {
+            error = MQTT_ERROR_SOCKET_ERROR;
+            break;
+        }
+        sent += (size_t) rv;
+    }
+    /* the batch is over, do not hold its tail in the coalescing buffer of the socket */
+    if (sent > 0 && W6X_Net_Flush(fd->ctx.fd) != 0) {
+        return MQTT_ERROR_SOCKET_ERROR;
+    }
+    if (sent == 0) {
+        return error;
+    }
+    return (ssize_t)sent;
+}
+
+static ssize_t mqtt_pal_recvall_w6x(mqtt_pal_socket_handle fd, void* buf, size_t bufsz, int flags)
+{
+    const void *const start = buf;
+    enum MQTTErrors error = (enum MQTTErrors)0;
+    ssize_t rv;
+    do {
+        rv = W6X_Net_Recv(fd->ctx.fd, buf, bufsz, flags | MSG_DONTWAIT);
+        if (rv == 0 || rv == W6X_NET_EAGAIN) {
+            /* should call recv later again */
+            break;
+        }
+        if (rv < 0) {
+            /* the connection is closed or failed */
+            error = MQTT_ERROR_SOCKET_ERROR;
+            break;
+        }
+        buf = (char*)buf + rv;
+        bufsz -= (unsigned long)rv;
+    } while (bufsz > 0);
+    if (buf == start) {
+        return error;
+    }
+    return (char*)buf - (const char*)start;
+}
+#else
+static ssize_t mqtt_pal_sendall_w6x(mqtt_pal_socket_handle fd, const void* buf, size_t len, int flags)
+{
+    enum MQTTErrors error = (enum MQTTErrors)0;
+    error = MQTT_ERROR_SOCKET_ERROR;
+    return error;
+}
+
+static ssize_t mqtt_pal_recvall_w6x(mqtt_pal_socket_handle fd, void* buf, size_t bufsz, int flags)
+{
+    enum MQTTErrors error = (enum MQTTErrors)0;
+    error = MQTT_ERROR_SOCKET_ERROR;
+    return error;
+}
+#endif /* MQTT_USE_W6X_SOCKET */
+
 const struct transport_func transport_fn[MQTTC_PAL_CONNTION_TYPE_NUM] = {
     {
         mqtt_pal_sendall_tcp,
@@ -238,6 +333,10 @@ const struct transport_func transport_fn[MQTTC_PAL_CONNTION_TYPE_NUM] = {
     {
         mqtt_pal_sendall_wbs,
         mqtt_pal_recvall_wbs,
+    },
+    {
+        mqtt_pal_sendall_w6x,
+        mqtt_pal_recvall_w6x,
     }
 };
 
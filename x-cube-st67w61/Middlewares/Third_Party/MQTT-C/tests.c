@@ -40,6 +40,42 @@ void make_socket_blocking(int socket)
 #endif
 }
 
+/* The PAL of the tests: the posix one, with each write capped to send_cap bytes when set
+ * to model a socket taking a few bytes at a time. */
+static size_t send_cap;
+
+ssize_t mqtt_pal_sendall(mqtt_pal_socket_handle fd, const void* buf, size_t len, int flags)
+{
+    size_t sent = 0;
+    if (send_cap != 0 && len > send_cap) {
+        len = send_cap;
+    }
+    while (sent < len) {
+        ssize_t rv = send(fd, (const char*)buf + sent, len - sent, flags);
+        if (rv < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return sent == 0 ? MQTT_ERROR_SOCKET_ERROR : (ssize_t)sent;
+        }
+        sent += (size_t) rv;
+    }
+    return (ssize_t)sent;
+}
+
+ssize_t mqtt_pal_recvall(mqtt_pal_socket_handle fd, void* buf, size_t bufsz, int flags)
+{
+    size_t received = 0;
+    while (received < bufsz) {
+        ssize_t rv = recv(fd, (char*)buf + received, bufsz - received, flags);
+        if (rv == 0) return received == 0 ? MQTT_ERROR_SOCKET_ERROR : (ssize_t)received;
+        if (rv < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return received == 0 ? MQTT_ERROR_SOCKET_ERROR : (ssize_t)received;
+        }
+        received += (size_t) rv;
+    }
+    return (ssize_t)received;
+}
+
 
 
 const char* addr = "test.mosquitto.org";
@@ -599,6 +635,141 @@ static void TEST__utility__message_queue(void **unused) {
     assert_true((void*) mq.queue_tail == mq.mem_end);
 }
 
+#if MQTT_MQ_INDEX_SIZE > 0
+/* queues a 4 bytes message and indexes it like the mqtt_* request functions */
+static struct mqtt_queued_message* queue_indexed(struct mqtt_message_queue *mq, enum MQTTControlPacketType control_type, uint16_t packet_id) {
+    struct mqtt_queued_message *msg = mqtt_mq_register(mq, 4);
+    msg->control_type = control_type;
+    msg->packet_id = packet_id;
+    mqtt_mq_index(mq, msg);
+    return msg;
+}
+
+static int index_entries(const struct mqtt_message_queue *mq) {
+    int n = 0;
+    for(int i = 0; i < MQTT_MQ_INDEX_SIZE; ++i) {
+        n += mq->index[i].control_type != 0;
+    }
+    return n;
+}
+
+#define MQ_INDEX_MSGS (MQTT_MQ_INDEX_SIZE + 8)
+static void TEST__utility__message_queue_index_overflow(void **unused) {
+    struct mqtt_queued_message mem[2*MQ_INDEX_MSGS];
+    struct mqtt_message_queue mq;
+    uint16_t pid;
+    mqtt_mq_init(&mq, mem, sizeof(mem));
+
+    /* fill the index, then go past it */
+    for(int i = 0; i < MQ_INDEX_MSGS; ++i) {
+        queue_indexed(&mq, MQTT_CONTROL_PUBLISH, (uint16_t) (1000 + i));
+        assert_true(mq.index_overflow == (i >= MQTT_MQ_INDEX_SIZE));
+        assert_true(index_entries(&mq) == (i < MQTT_MQ_INDEX_SIZE ? i + 1 : MQTT_MQ_INDEX_SIZE));
+    }
+
+    /* the messages left out of the index are found by the linear fallback */
+    for(int i = 0; i < MQ_INDEX_MSGS; ++i) {
+        pid = (uint16_t) (1000 + i);
+        assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBLISH, &pid) == mqtt_mq_get(&mq, i));
+        assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBACK, &pid) == NULL);
+    }
+    pid = 999;
+    assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBLISH, &pid) == NULL);
+}
+
+static void TEST__utility__message_queue_index_clean(void **unused) {
+    struct mqtt_queued_message mem[2*MQ_INDEX_MSGS];
+    struct mqtt_message_queue mq;
+    uint16_t pid;
+    mqtt_mq_init(&mq, mem, sizeof(mem));
+    for(int i = 0; i < MQ_INDEX_MSGS; ++i) {
+        queue_indexed(&mq, MQTT_CONTROL_PUBLISH, (uint16_t) (1000 + i));
+    }
+
+    /* partial clean still too long for the index */
+    for(int i = 0; i < 4; ++i) {
+        mqtt_mq_get(&mq, i)->state = MQTT_QUEUED_COMPLETE;
+    }
+    mqtt_mq_clean(&mq);
+    assert_true(mqtt_mq_length(&mq) == MQTT_MQ_INDEX_SIZE + 4);
+    assert_true(mq.head_seq == 4);
+    assert_true(mq.index_overflow == 1);
+    for(int i = 0; i < MQ_INDEX_MSGS; ++i) {
+        pid = (uint16_t) (1000 + i);
+        assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBLISH, &pid) == (i < 4 ? NULL : mqtt_mq_get(&mq, i - 4)));
+    }
+
+    /* partial clean that fits: the rebuilt index holds all the messages left */
+    for(int i = 0; i < 4; ++i) {
+        mqtt_mq_get(&mq, i)->state = MQTT_QUEUED_COMPLETE;
+    }
+    mqtt_mq_clean(&mq);
+    assert_true(mqtt_mq_length(&mq) == MQTT_MQ_INDEX_SIZE);
+    assert_true(mq.head_seq == 8);
+    assert_true(mq.index_overflow == 0);
+    assert_true(index_entries(&mq) == MQTT_MQ_INDEX_SIZE);
+    for(int i = 0; i < MQ_INDEX_MSGS; ++i) {
+        pid = (uint16_t) (1000 + i);
+        assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBLISH, &pid) == (i < 8 ? NULL : mqtt_mq_get(&mq, i - 8)));
+    }
+
+    /* a message queued on the full index is only found by the linear fallback until the next clean */
+    queue_indexed(&mq, MQTT_CONTROL_SUBSCRIBE, 2000);
+    assert_true(mq.index_overflow == 1);
+    pid = 2000;
+    assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_SUBSCRIBE, &pid) == mqtt_mq_get(&mq, MQTT_MQ_INDEX_SIZE));
+    mqtt_mq_get(&mq, 0)->state = MQTT_QUEUED_COMPLETE;
+    mqtt_mq_get(&mq, 1)->state = MQTT_QUEUED_COMPLETE;
+    mqtt_mq_clean(&mq);
+    assert_true(mq.head_seq == 10);
+    assert_true(mq.index_overflow == 0);
+    assert_true(index_entries(&mq) == MQTT_MQ_INDEX_SIZE - 1);
+    assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_SUBSCRIBE, &pid) == mqtt_mq_get(&mq, MQTT_MQ_INDEX_SIZE - 2));
+    for(int i = 10; i < MQ_INDEX_MSGS; ++i) {
+        pid = (uint16_t) (1000 + i);
+        assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBLISH, &pid) == mqtt_mq_get(&mq, i - 10));
+    }
+
+    /* full clean empties the index */
+    for(int i = 0; i < mqtt_mq_length(&mq); ++i) {
+        mqtt_mq_get(&mq, i)->state = MQTT_QUEUED_COMPLETE;
+    }
+    mqtt_mq_clean(&mq);
+    assert_true(mqtt_mq_length(&mq) == 0);
+    assert_true(mq.head_seq == MQ_INDEX_MSGS + 1);
+    assert_true(index_entries(&mq) == 0);
+    pid = 2000;
+    assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_SUBSCRIBE, &pid) == NULL);
+}
+
+static void TEST__utility__message_queue_index_duplicates(void **unused) {
+    struct mqtt_queued_message mem[16];
+    struct mqtt_message_queue mq;
+    struct mqtt_queued_message *older, *newer, *pubrel;
+    uint16_t pid = 7;
+    mqtt_mq_init(&mq, mem, sizeof(mem));
+
+    /* the oldest message of a key is returned, complete or not */
+    older = queue_indexed(&mq, MQTT_CONTROL_PUBLISH, pid);
+    pubrel = queue_indexed(&mq, MQTT_CONTROL_PUBREL, pid);
+    newer = queue_indexed(&mq, MQTT_CONTROL_PUBLISH, pid);
+    assert_true(index_entries(&mq) == 2);
+    assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBLISH, &pid) == older);
+    assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBREL, &pid) == pubrel);
+    older->state = MQTT_QUEUED_COMPLETE;
+    assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBLISH, &pid) == older);
+
+    /* once the older one is cleaned the newer one takes over */
+    mqtt_mq_clean(&mq);
+    assert_true(mqtt_mq_length(&mq) == 2);
+    newer = mqtt_mq_get(&mq, 1);
+    pubrel = mqtt_mq_get(&mq, 0);
+    assert_true(index_entries(&mq) == 2);
+    assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBLISH, &pid) == newer);
+    assert_true(mqtt_mq_find(&mq, MQTT_CONTROL_PUBREL, &pid) == pubrel);
+}
+#endif
+
 static void TEST__utility__pid_lfsr(void **unused) {
     struct mqtt_client client;
     uint8_t send[256], recv[256];
@@ -612,6 +783,133 @@ static void TEST__utility__pid_lfsr(void **unused) {
     assert_true(period == 65535u);
 }
 
+#if MQTT_MQ_INDEX_SIZE > 0
+static void TEST__utility__pid_unique(void **unused) {
+    struct mqtt_client client;
+    struct mqtt_queued_message send[2*MQ_INDEX_MSGS];
+    uint8_t recv[256];
+    uint16_t pids[MQ_INDEX_MSGS + 1];
+    mqtt_init(&client, -1, (uint8_t*) send, sizeof(send), recv, sizeof(recv), NULL);
+
+    /* the sequence the LFSR gives on an empty queue */
+    client.pid_lfsr = 163u;
+    for(int i = 0; i < MQ_INDEX_MSGS + 1; ++i) {
+        pids[i] = __mqtt_next_pid(&client);
+    }
+
+    /* PIDs in use are skipped: found by the index */
+    for(int i = 0; i < 10; ++i) {
+        queue_indexed(&client.mq, i % 2 ? MQTT_CONTROL_SUBSCRIBE : MQTT_CONTROL_PUBLISH, pids[i]);
+    }
+    client.pid_lfsr = 163u;
+    assert_true(__mqtt_next_pid(&client) == pids[10]);
+
+    /* ... and by the linear scan once the index overflows */
+    for(int i = 10; i < MQ_INDEX_MSGS; ++i) {
+        queue_indexed(&client.mq, MQTT_CONTROL_PUBLISH, pids[i]);
+    }
+    assert_true(client.mq.index_overflow == 1);
+    client.pid_lfsr = 163u;
+    assert_true(__mqtt_next_pid(&client) == pids[MQ_INDEX_MSGS]);
+}
+#endif
+
+/* checks the queue against the bytes the peer got, the messages being sent in the given order */
+static void assert_send_progress(const struct mqtt_client *client, const int *order, int n,
+                                 const enum MQTTQueuedMessageState *sent_state, size_t received) {
+    size_t offset = 0;
+    for(int k = 0; k < n; ++k) {
+        const struct mqtt_queued_message *msg = mqtt_mq_get(&client->mq, order[k]);
+        if (received >= offset + msg->size) {
+            assert_true(msg->state == sent_state[order[k]]);
+        } else {
+            assert_true(msg->state == MQTT_QUEUED_UNSENT);
+            if (received >= offset) {
+                /* the message the partial write stopped in */
+                assert_true(client->send_offset == received - offset);
+            }
+        }
+        offset += msg->size;
+    }
+}
+
+/* reads what the client wrote so far */
+static size_t drain_peer(int fd, uint8_t *wire, size_t len, size_t size) {
+    ssize_t rv;
+    while ((rv = recv(fd, wire + len, size - len, 0)) > 0) {
+        len += (size_t) rv;
+    }
+    return len;
+}
+
+static void TEST__utility__send_partial(void **unused) {
+    struct mqtt_queued_message sendmem[64];
+    uint8_t recvmem[256];
+    uint8_t expected[1024], wire[1024];
+    size_t expected_len = 0, received = 0, prev;
+    struct mqtt_client client;
+    int fds[2];
+    int calls = 0;
+    /* CONNECT, then PUBLISH QoS 0, 1, 2, 2 and 0: the second QoS 2 waits for the first one */
+    static const int order[] = { 0, 1, 2, 3, 5 };
+    static const enum MQTTQueuedMessageState sent_state[] = {
+        MQTT_QUEUED_AWAITING_ACK, MQTT_QUEUED_COMPLETE, MQTT_QUEUED_AWAITING_ACK,
+        MQTT_QUEUED_AWAITING_ACK, MQTT_QUEUED_AWAITING_ACK, MQTT_QUEUED_COMPLETE
+    };
+    static const int held[] = { 4 };
+
+    assert_true(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    mqtt_init(&client, fds[0], (uint8_t*) sendmem, sizeof(sendmem), recvmem, sizeof(recvmem), NULL);
+    assert_true(mqtt_connect(&client, "partial", NULL, NULL, 0, NULL, NULL, 0, 3600) == MQTT_OK);
+    client.time_of_last_send = MQTT_PAL_TIME(); /* no keep-alive PINGREQ in the way */
+    assert_true(mqtt_publish(&client, "t/0", "zero", 4, MQTT_PUBLISH_QOS_0) == MQTT_OK);
+    assert_true(mqtt_publish(&client, "t/1", "one", 3, MQTT_PUBLISH_QOS_1) == MQTT_OK);
+    assert_true(mqtt_publish(&client, "t/2", "two", 3, MQTT_PUBLISH_QOS_2) == MQTT_OK);
+    assert_true(mqtt_publish(&client, "t/2", "two again", 9, MQTT_PUBLISH_QOS_2) == MQTT_OK);
+    assert_true(mqtt_publish(&client, "t/0", "zero again", 10, MQTT_PUBLISH_QOS_0) == MQTT_OK);
+    assert_true(mqtt_mq_length(&client.mq) == 6);
+    for(int k = 0; k < 5; ++k) {
+        const struct mqtt_queued_message *msg = mqtt_mq_get(&client.mq, order[k]);
+        memcpy(expected + expected_len, msg->start, msg->size);
+        expected_len += msg->size;
+    }
+
+    /* a few bytes per write: each call leaves a message partially sent */
+    send_cap = 5;
+    do {
+        prev = received;
+        assert_true(__mqtt_send(&client) == MQTT_OK);
+        received = drain_peer(fds[1], wire, received, sizeof(wire));
+        assert_send_progress(&client, order, 5, sent_state, received);
+        assert_true(mqtt_mq_get(&client.mq, 4)->state == MQTT_QUEUED_UNSENT);
+        ++calls;
+    } while (received > prev);
+    assert_true(calls > 5);
+    assert_true(received == expected_len);
+    assert_true(memcmp(wire, expected, expected_len) == 0);
+    assert_true(client.send_offset == 0);
+
+    /* the first QoS 2 PUBLISH is acknowledged: the second one goes */
+    mqtt_mq_get(&client.mq, 3)->state = MQTT_QUEUED_COMPLETE;
+    memcpy(expected, mqtt_mq_get(&client.mq, 4)->start, mqtt_mq_get(&client.mq, 4)->size);
+    expected_len = mqtt_mq_get(&client.mq, 4)->size;
+    received = 0;
+    do {
+        prev = received;
+        assert_true(__mqtt_send(&client) == MQTT_OK);
+        received = drain_peer(fds[1], wire, received, sizeof(wire));
+        assert_send_progress(&client, held, 1, sent_state, received);
+    } while (received > prev);
+    assert_true(received == expected_len);
+    assert_true(memcmp(wire, expected, expected_len) == 0);
+    assert_true(client.send_offset == 0);
+
+    send_cap = 0;
+    close(fds[0]);
+    close(fds[1]);
+}
+
 void publish_callback(void** state, struct mqtt_response_publish *publish) {
     /*char *name = (char*) malloc(publish->topic_name_size + 1);
     memcpy(name, publish->topic_name, publish->topic_name_size);
@@ -1007,7 +1305,16 @@ int main(int argc, const char *argv[]) {
     printf("\n[MQTT-C Utilities Tests]\n");
     const struct CMUnitTest util_tests[] = {
         cmocka_unit_test(TEST__utility__message_queue),
+#if MQTT_MQ_INDEX_SIZE > 0
+        cmocka_unit_test(TEST__utility__message_queue_index_overflow),
+        cmocka_unit_test(TEST__utility__message_queue_index_clean),
+        cmocka_unit_test(TEST__utility__message_queue_index_duplicates),
+#endif
         cmocka_unit_test(TEST__utility__pid_lfsr),
+#if MQTT_MQ_INDEX_SIZE > 0
+        cmocka_unit_test(TEST__utility__pid_unique),
+#endif
+        cmocka_unit_test(TEST__utility__send_partial),
         cmocka_unit_test(TEST__utility__connect_disconnect),
         cmocka_unit_test(TEST__utility__ping),
     };
@@ -305,6 +305,7 @@ void main_app(void)
   /* Initialize the ST67W6X MQTT module */
   mqtt_recv_data.p_recv_data = mqtt_buffer;
   mqtt_recv_data.recv_data_buf_size = MQTT_TOPIC_BUFFER_SIZE + MQTT_MSG_BUFFER_SIZE;
+  mqtt_recv_data.zero_copy = 1;
   ret = W6X_MQTT_Init(&mqtt_recv_data);
   if (ret)
   {
@@ -569,12 +570,13 @@ static void APP_mqtt_cb(W6X_event_id_t event_id, void *event_args)
       break;
 
     case W6X_MQTT_EVT_SUBSCRIPTION_RECEIVED_ID:
-      mqtt_recv_data.p_recv_data[p_param_mqtt_data->topic_length] = '\0';
-      LogInfo("MQTT Subscription Received on topic %*s: %*s\n",
-              p_param_mqtt_data->topic_length,
-              mqtt_recv_data.p_recv_data,
-              p_param_mqtt_data->message_length,
-              &mqtt_recv_data.p_recv_data[p_param_mqtt_data->topic_length + 1]);
+      LogInfo("MQTT Subscription Received on topic %.*s: %.*s\n",
+              (int)p_param_mqtt_data->topic_length,
+              p_param_mqtt_data->topic,
+              (int)p_param_mqtt_data->message_length,
+              p_param_mqtt_data->message);
+      /* Give the message back to the driver */
+      W6X_MQTT_Release(p_param_mqtt_data);
       break;
 
     default:
@@ -31,6 +31,7 @@
 #include "app_config.h"
 #include "lwip.h"
 #include <lwip/errno.h>
+#include <lwip/sockets.h>
 #include <netdb.h>
 
 #include "mqtt.h"
@@ -111,6 +112,9 @@ typedef struct
 /** Stack size of the subscription process task */
 #define SUBSCRIPTION_TASK_STACK_SIZE    1024
 
+/** Delay in ms before the MQTT client refresher retries after an error */
+#define CLIENT_REFRESHER_RETRY_DELAY    1000
+
 #ifndef SNTP_TIMEZONE
 /** SNTP timezone configuration */
 #define SNTP_TIMEZONE                   1
@@ -289,6 +293,12 @@ static QueueHandle_t sub_msg_queue;
 /** Subscribed message process Task Handle */
 static TaskHandle_t  sub_task_handle;
 
+/** Loopback socket waking up the MQTT client refresher when a message is queued */
+static int32_t refresher_wakeup_fd = -1;
+
+/** Loopback address of the refresher wake-up socket */
+static struct sockaddr_in refresher_wakeup_addr;
+
 /** Green led status */
 bool green_led_status = false;
 
@@ -369,6 +379,25 @@ static void publish_callback_1(void **unused, struct mqtt_response_publish *publ
   */
 static void client_refresher(void *client);
 
+/**
+  * @brief  Create the loopback socket used to wake up the MQTT client refresher
+  * @return 0 on success, -1 otherwise
+  */
+static int32_t client_refresher_wakeup_init(void);
+
+/**
+  * @brief  Wake up the MQTT client refresher to send the messages just queued
+  */
+static void client_refresher_wakeup(void);
+
+/**
+  * @brief  Compute how long the MQTT client refresher can sleep
+  * @param  client: MQTT client structure
+  * @param  egress_pending: Set to true when a queued message waits for room in the socket
+  * @return Ticks until MQTT-C has to send a PINGREQ or resend an unacknowledged message
+  */
+static TickType_t client_refresher_timeout(struct mqtt_client *client, bool *egress_pending);
+
 /* USER CODE BEGIN PFP */
 
 /* USER CODE END PFP */
@@ -396,7 +425,8 @@ void main_app(void)
   struct addrinfo *p;
   struct addrinfo *servinfo;
   struct custom_socket_handle handle;
-  struct mqtt_client client;
+  /* Static: the client embeds the in-flight index of its message queue */
+  static struct mqtt_client client;
   /* Create an identified session (not mandatory) */
   const char *client_id = MQTT_CLIENT_ID;
   /* Ensure we have a clean session */
@@ -593,6 +623,13 @@ void main_app(void)
     goto _err;
   }
 
+  /* Create the socket used to signal the queued messages to the refresher */
+  if (client_refresher_wakeup_init() != 0)
+  {
+    LogError("Failed to create the MQTT client wake-up socket\n");
+    goto _err;
+  }
+
   /* start a thread to refresh the client (handle egress and ingree client traffic) */
   xTaskCreate(client_refresher, (char *)"client_ref", 1024,  &client, 10, NULL);
 
@@ -605,12 +642,14 @@ void main_app(void)
   snprintf((char *)mqtt_topic, MQTT_TOPIC_BUFFER_SIZE, "/devices/%s/control", mqtt_config.MQClientId);
   LogInfo("Subscribing to topic %s.\n", mqtt_topic);
   mqtt_subscribe(&client, (char *)mqtt_topic, 0);
+  client_refresher_wakeup();
   memset(mqtt_topic, 0, sizeof(mqtt_topic));
 
   /* Subscribe to a sensor topic with topic_level based on ClientID */
   snprintf((char *)mqtt_topic, MQTT_TOPIC_BUFFER_SIZE, "/sensors/%s", mqtt_config.MQClientId);
   LogInfo("Subscribing to topic %s.\n", mqtt_topic);
   mqtt_subscribe(&client, (char *)mqtt_topic, 0);
+  client_refresher_wakeup();
 
   /* Reuse the same topic to publish message */
   do
@@ -667,6 +706,7 @@ void main_app(void)
                        strlen((char *)mqtt_pubmsg) + 1, MQTT_PUBLISH_QOS_0);
     if (ret == MQTT_OK)
     {
+      client_refresher_wakeup();
       LogInfo("MQTT Publish OK\n");
     }
     vTaskDelay(2000);
@@ -1075,12 +1115,129 @@ static void publish_callback_1(void **unused, struct mqtt_response_publish *publ
 
 static void client_refresher(void *client)
 {
+  struct mqtt_client *p_client = (struct mqtt_client *) client;
+  /* Only the TCP connection type is used by this application */
+  int32_t sockfd = p_client->socketfd->ctx.fd;
+  int32_t maxfd = LWIP_MAX(sockfd, refresher_wakeup_fd) + 1;
+  fd_set read_fds;
+  fd_set write_fds;
+  struct timeval tv;
+  TickType_t timeout;
+  bool egress_pending;
+  uint8_t drain[8];
+
   while (1)
   {
-    mqtt_sync((struct mqtt_client *) client);
-    vTaskDelay(100);
+    /* Process the received packets, then send the queued messages and the PINGREQ when due */
+    if (mqtt_sync(p_client) != MQTT_OK)
+    {
+      vTaskDelay(pdMS_TO_TICKS(CLIENT_REFRESHER_RETRY_DELAY));
+      continue;
+    }
+
+    /* Sleep until the broker sends data, a message is queued or MQTT-C has a timer to serve */
+    timeout = client_refresher_timeout(p_client, &egress_pending);
+    FD_ZERO(&read_fds);
+    FD_ZERO(&write_fds);
+    FD_SET(sockfd, &read_fds);
+    FD_SET(refresher_wakeup_fd, &read_fds);
+    if (egress_pending)
+    {
+      FD_SET(sockfd, &write_fds);
+    }
+    tv.tv_sec = (timeout * portTICK_PERIOD_MS) / 1000;
+    tv.tv_usec = ((timeout * portTICK_PERIOD_MS) % 1000) * 1000;
+
+    if ((select(maxfd, &read_fds, &write_fds, NULL, &tv) > 0) && FD_ISSET(refresher_wakeup_fd, &read_fds))
+    {
+      /* A single synchronization serves all the pending wake-up requests */
+      while (recv(refresher_wakeup_fd, drain, sizeof(drain), 0) > 0)
+      {
+      }
+    }
+  }
+}
+
+static int32_t client_refresher_wakeup_init(void)
+{
+  socklen_t addr_len = sizeof(refresher_wakeup_addr);
+  int32_t iMode = 1;
+
+  refresher_wakeup_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (refresher_wakeup_fd < 0)
+  {
+    return -1;
+  }
+
+  /* Bind to an ephemeral loopback port and read it back to address the wake-up requests */
+  memset(&refresher_wakeup_addr, 0, sizeof(refresher_wakeup_addr));
+  refresher_wakeup_addr.sin_family = AF_INET;
+  refresher_wakeup_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if ((bind(refresher_wakeup_fd, (struct sockaddr *)&refresher_wakeup_addr, sizeof(refresher_wakeup_addr)) != 0) ||
+      (getsockname(refresher_wakeup_fd, (struct sockaddr *)&refresher_wakeup_addr, &addr_len) != 0))
+  {
+    close(refresher_wakeup_fd);
+    refresher_wakeup_fd = -1;
+    return -1;
+  }
+
+  ioctlsocket(refresher_wakeup_fd, FIONBIO, &iMode);
+  return 0;
+}
+
+static void client_refresher_wakeup(void)
+{
+  uint8_t event = 0;
+
+  /* Dropped when the receive box is full, the refresher is then already due to wake up */
+  (void)sendto(refresher_wakeup_fd, &event, sizeof(event), 0,
+               (struct sockaddr *)&refresher_wakeup_addr, sizeof(refresher_wakeup_addr));
+}
+
+static TickType_t client_refresher_timeout(struct mqtt_client *client, bool *egress_pending)
+{
+  struct mqtt_queued_message *msg;
+  mqtt_pal_time_t deadline;
+  TickType_t deadline_ticks;
+  TickType_t now;
+  bool inflight_qos2 = false;
+  bool qos2;
+  ssize_t len;
+  ssize_t i;
+
+  *egress_pending = false;
+
+  MQTT_PAL_MUTEX_LOCK(&client->mutex);
+  /* A PINGREQ is sent once the keep-alive period elapsed without sending anything */
+  deadline = client->time_of_last_send + client->keep_alive;
+
+  len = mqtt_mq_length(&client->mq);
+  for (i = 0; i < len; i++)
+  {
+    msg = mqtt_mq_get(&client->mq, i);
+    /* Mirror __mqtt_send(): a QoS 2 PUBLISH waits while another one is in flight */
+    qos2 = (msg->control_type == MQTT_CONTROL_PUBLISH) &&
+           ((msg->state == MQTT_QUEUED_UNSENT) || (msg->state == MQTT_QUEUED_AWAITING_ACK)) &&
+           (((msg->start[0] & MQTT_PUBLISH_QOS_MASK) >> 1) == 2);
+    if ((msg->state == MQTT_QUEUED_UNSENT) && !(qos2 && inflight_qos2))
+    {
+      /* Still queued after the synchronization: the socket is out of room */
+      *egress_pending = true;
+    }
+    else if ((msg->state == MQTT_QUEUED_AWAITING_ACK) && ((msg->time_sent + client->response_timeout) < deadline))
+    {
+      /* An unacknowledged message is sent again after the response timeout */
+      deadline = msg->time_sent + client->response_timeout;
+    }
+    inflight_qos2 |= qos2;
   }
+  MQTT_PAL_MUTEX_UNLOCK(&client->mutex);
+
+  /* MQTT_PAL_TIME() counts the ticks in thousands and MQTT-C acts once the deadline is passed */
+  deadline_ticks = (TickType_t)(deadline + 1) * 1000;
+  now = xTaskGetTickCount();
 
+  return (deadline_ticks > now) ? (deadline_ticks - now) : 0;
 }
 
 /* USER CODE BEGIN PFD */
@@ -57,6 +57,9 @@ typedef struct
 /** Bit indicating that AP interface has data ready to be processed */
 #define NET_IF_AP_RX_RDY        (1 << 1)
 
+/** Maximum number of pbufs in a chain sent without flattening it first */
+#define NET_IF_TX_MAX_SEGMENTS  8
+
 /* USER CODE BEGIN PD */
 
 /* USER CODE END PD */
@@ -95,6 +98,12 @@ static struct pbuf_custom *netif_pbuf_alloc(void *buffer);
   */
 static void netif_pbuf_free(struct pbuf *p);
 
+/**
+  * @brief  Release the pbuf referenced by a frame once sent over SPI
+  * @param  arg: Pointer to the pbuf
+  */
+static void netif_tx_release(void *arg);
+
 /**
   * @brief  Callback function to handle RX notification from STA interface
   * @param  arg: Pointer to the argument (not used)
@@ -157,6 +166,9 @@ err_t net_if_output(struct netif *net_if, struct pbuf *p_buf)
   int32_t ret = 0;
   struct pbuf *q;
   uint32_t link_id = 0;
+  W6X_Netif_Segment_t segments[NET_IF_TX_MAX_SEGMENTS];
+  uint32_t count = 0;
+  uint32_t headroom = 0;
 
   for (link_id = NETIF_STA; link_id < NETIF_MAX; link_id++)
   {
@@ -172,32 +184,60 @@ err_t net_if_output(struct netif *net_if, struct pbuf *p_buf)
 
   link_id = (link_id == NETIF_STA) ? W6X_NET_IF_STA : W6X_NET_IF_AP;
 
+  /* Long chains are flattened, keeping the link headroom to send the copy in place */
+  if (pbuf_clen(p_buf) > NET_IF_TX_MAX_SEGMENTS)
+  {
+    p_buf = pbuf_clone(PBUF_LINK, PBUF_RAM, p_buf);
+    if (p_buf == NULL)
+    {
+      return ERR_MEM;
+    }
+  }
+  else
+  {
+    pbuf_ref(p_buf);
+  }
+
+  /* Gather the whole frame in one SPI message */
   for (q = p_buf; q != NULL; q = q->next)
   {
-    ret = W6X_Netif_output(link_id, q->payload, q->len);
-    if (ret < 0)
+    segments[count].data = q->payload;
+    segments[count].len = q->len;
+    count++;
+  }
+
+  /* A single pbuf with link headroom is sent without copy, the SPI header being written in front of it */
+  if ((p_buf->next == NULL) && (pbuf_add_header(p_buf, W6X_NETIF_HEADROOM) == 0))
+  {
+    pbuf_remove_header(p_buf, W6X_NETIF_HEADROOM);
+    headroom = W6X_NETIF_HEADROOM;
+  }
+
+  /* The pbuf reference is released by netif_tx_release once the frame is sent */
+  ret = W6X_Netif_output_vec(link_id, segments, count, headroom, netif_tx_release, p_buf);
+  if (ret < 0)
+  {
+    pbuf_free(p_buf);
+    LogError("%s: spi_write ERROR : %d\n", __func__, ret);
+    switch (ret)
     {
-      LogError("%s: spi_write ERROR : %d\n", __func__, ret);
-      switch (ret)
-      {
-        case -1:
-          status = ERR_BUF;
-          break;
-        case -2:
-          status = ERR_VAL;
-          break;
-        case -3:
-          status = ERR_MEM;
-          break;
-        case -4:
-          status = ERR_BUF;
-          break;
-        case -5:
-          status = ERR_INPROGRESS;
-          break;
-        default:
-          status = ERR_VAL;
-      }
+      case -1:
+        status = ERR_BUF;
+        break;
+      case -2:
+        status = ERR_VAL;
+        break;
+      case -3:
+        status = ERR_MEM;
+        break;
+      case -4:
+        status = ERR_BUF;
+        break;
+      case -5:
+        status = ERR_INPROGRESS;
+        break;
+      default:
+        status = ERR_VAL;
     }
   }
 
@@ -241,6 +281,12 @@ static void netif_pbuf_free(struct pbuf *pb)
   }
 }
 
+static void netif_tx_release(void *arg)
+{
+  /* Called from the SPI transfer task: pbuf reference and heap updates are protected by LwIP */
+  pbuf_free((struct pbuf *)arg);
+}
+
 static void netif_sta_notify_callback(void *arg)
 {
   xTaskNotify(netif_task_handle, NET_IF_STA_RX_RDY, eSetBits);
@@ -303,6 +349,7 @@ static int32_t netif_rx_process(uint32_t link_id)
   {
     LogError("Memory allocation failure\n");
     W6X_Netif_free(buffer);
+    vPortFree(CONTAINER_OF(pbuf_custom, netif_pbuf_t, pb));
     vTaskDelay(pdMS_TO_TICKS(100));
     return -1;
   }
@@ -311,7 +358,7 @@ static int32_t netif_rx_process(uint32_t link_id)
   if (netif->input(pb, netif))
   {
     LogError("Input ERROR\n");
-    W6X_Netif_free(buffer);
+    /* Releases the driver buffer as well */
     netif_pbuf_free(pb);
     return -1;
   }